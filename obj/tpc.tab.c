@@ -0,0 +1,1920 @@
+/* A Bison parser, made by GNU Bison 3.8.2.  */
+
+/* Bison implementation for Yacc-like parsers in C
+
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
+
+   This program is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
+
+/* As a special exception, you may create a larger work that contains
+   part or all of the Bison parser skeleton and distribute that work
+   under terms of your choice, so long as that work isn't itself a
+   parser generator using the skeleton or a modified version thereof
+   as a parser skeleton.  Alternatively, if you modify or redistribute
+   the parser skeleton itself, you may (at your option) remove this
+   special exception, which will cause the skeleton and the resulting
+   Bison output files to be licensed under the GNU General Public
+   License without this special exception.
+
+   This special exception was added by the Free Software Foundation in
+   version 2.2 of Bison.  */
+
+/* C LALR(1) parser skeleton written by Richard Stallman, by
+   simplifying the original so-called "semantic" parser.  */
+
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
+/* All symbols defined below should begin with yy or YY, to avoid
+   infringing on user name space.  This should be done even for local
+   variables, as they might otherwise be expanded by user macros.
+   There are some unavoidable exceptions within include files to
+   define necessary library symbols; they are noted "INFRINGES ON
+   USER NAME SPACE" below.  */
+
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
+
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
+
+/* Skeleton name.  */
+#define YYSKELETON_NAME "yacc.c"
+
+/* Pure parsers.  */
+#define YYPURE 0
+
+/* Push parsers.  */
+#define YYPUSH 0
+
+/* Pull parsers.  */
+#define YYPULL 1
+
+
+
+
+/* First part of user prologue.  */
+#line 1 "src/tpc.y"
+
+#include <ctype.h>
+#include <stdio.h>
+#include "../src/tree.h"
+#include "../src/parser.h"
+#include "../src/scanner.h"
+#include "../src/error.h"
+#include "../src/source.h"
+#include "../src/tpc_bison.h"
+
+// The parser stack grows with the nesting of parentheses and unary
+// operators, it is reallocated as needed up to this depth
+#define YYMAXDEPTH 10000000
+
+void yyerror(NodeId* abr, char *msg);
+extern unsigned int nbline;
+extern unsigned int nbchar;
+
+static ParserHandler STREAM_HANDLER = NULL; // Streaming mode if not NULL
+static void* STREAM_DATA = NULL;
+static NodeId FUNCTION_START; // First node of the function being parsed
+
+static void stream_function_start(NodeId previous);
+static NodeId stream_function(NodeId fonct);
+
+#line 97 "obj/tpc.tab.c"
+
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
+# ifndef YY_NULLPTR
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
+#  else
+#   define YY_NULLPTR ((void*)0)
+#  endif
+# endif
+
+#include "tpc.tab.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
+{
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_CHARACTER = 3,                  /* CHARACTER  */
+  YYSYMBOL_ADDSUB = 4,                     /* ADDSUB  */
+  YYSYMBOL_DIVSTAR = 5,                    /* DIVSTAR  */
+  YYSYMBOL_EQ = 6,                         /* EQ  */
+  YYSYMBOL_ORDER = 7,                      /* ORDER  */
+  YYSYMBOL_NUM = 8,                        /* NUM  */
+  YYSYMBOL_IDENT = 9,                      /* IDENT  */
+  YYSYMBOL_VOID = 10,                      /* VOID  */
+  YYSYMBOL_RETURN = 11,                    /* RETURN  */
+  YYSYMBOL_IF = 12,                        /* IF  */
+  YYSYMBOL_ELSE = 13,                      /* ELSE  */
+  YYSYMBOL_WHILE = 14,                     /* WHILE  */
+  YYSYMBOL_OR = 15,                        /* OR  */
+  YYSYMBOL_AND = 16,                       /* AND  */
+  YYSYMBOL_TYPE = 17,                      /* TYPE  */
+  YYSYMBOL_18_ = 18,                       /* ';'  */
+  YYSYMBOL_19_ = 19,                       /* ','  */
+  YYSYMBOL_20_ = 20,                       /* '['  */
+  YYSYMBOL_21_ = 21,                       /* ']'  */
+  YYSYMBOL_22_ = 22,                       /* '('  */
+  YYSYMBOL_23_ = 23,                       /* ')'  */
+  YYSYMBOL_24_ = 24,                       /* '{'  */
+  YYSYMBOL_25_ = 25,                       /* '}'  */
+  YYSYMBOL_26_ = 26,                       /* '='  */
+  YYSYMBOL_27_ = 27,                       /* '!'  */
+  YYSYMBOL_YYACCEPT = 28,                  /* $accept  */
+  YYSYMBOL_Prog = 29,                      /* Prog  */
+  YYSYMBOL_DeclVars = 30,                  /* DeclVars  */
+  YYSYMBOL_Declarateurs = 31,              /* Declarateurs  */
+  YYSYMBOL_DeclFonctArray = 32,            /* DeclFonctArray  */
+  YYSYMBOL_DeclArray = 33,                 /* DeclArray  */
+  YYSYMBOL_ArrayLR = 34,                   /* ArrayLR  */
+  YYSYMBOL_DeclFoncts = 35,                /* DeclFoncts  */
+  YYSYMBOL_DeclFonct = 36,                 /* DeclFonct  */
+  YYSYMBOL_EnTeteFonct = 37,               /* EnTeteFonct  */
+  YYSYMBOL_38_1 = 38,                      /* $@1  */
+  YYSYMBOL_39_2 = 39,                      /* $@2  */
+  YYSYMBOL_Parametres = 40,                /* Parametres  */
+  YYSYMBOL_ListTypVar = 41,                /* ListTypVar  */
+  YYSYMBOL_Corps = 42,                     /* Corps  */
+  YYSYMBOL_SuiteInstr = 43,                /* SuiteInstr  */
+  YYSYMBOL_Instr = 44,                     /* Instr  */
+  YYSYMBOL_Exp = 45,                       /* Exp  */
+  YYSYMBOL_TB = 46,                        /* TB  */
+  YYSYMBOL_FB = 47,                        /* FB  */
+  YYSYMBOL_M = 48,                         /* M  */
+  YYSYMBOL_E = 49,                         /* E  */
+  YYSYMBOL_T = 50,                         /* T  */
+  YYSYMBOL_F = 51,                         /* F  */
+  YYSYMBOL_LValue = 52,                    /* LValue  */
+  YYSYMBOL_Arguments = 53,                 /* Arguments  */
+  YYSYMBOL_ListExp = 54                    /* ListExp  */
+};
+typedef enum yysymbol_kind_t yysymbol_kind_t;
+
+
+
+
+#ifdef short
+# undef short
+#endif
+
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
+
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
+
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
+
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
+#endif
+
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
+#else
+typedef short yytype_int16;
+#endif
+
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
+#endif
+
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
+#else
+typedef short yytype_uint8;
+#endif
+
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
+#else
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
+#endif
+
+#ifndef YYSIZE_T
+# ifdef __SIZE_TYPE__
+#  define YYSIZE_T __SIZE_TYPE__
+# elif defined size_t
+#  define YYSIZE_T size_t
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYSIZE_T size_t
+# else
+#  define YYSIZE_T unsigned
+# endif
+#endif
+
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_int8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
+
+#ifndef YY_
+# if defined YYENABLE_NLS && YYENABLE_NLS
+#  if ENABLE_NLS
+#   include <libintl.h> /* INFRINGES ON USER NAME SPACE */
+#   define YY_(Msgid) dgettext ("bison-runtime", Msgid)
+#  endif
+# endif
+# ifndef YY_
+#  define YY_(Msgid) Msgid
+# endif
+#endif
+
+
+#ifndef YY_ATTRIBUTE_PURE
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
+#endif
+
+#ifndef YY_ATTRIBUTE_UNUSED
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
+# else
+#  define YY_ATTRIBUTE_UNUSED
+# endif
+#endif
+
+/* Suppress unused-variable warnings by "using" E.  */
+#if ! defined lint || defined __GNUC__
+# define YY_USE(E) ((void) (E))
+#else
+# define YY_USE(E) /* empty */
+#endif
+
+/* Suppress an incorrect diagnostic about yylval being uninitialized.  */
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
+    _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
+    _Pragma ("GCC diagnostic pop")
+#else
+# define YY_INITIAL_VALUE(Value) Value
+#endif
+#ifndef YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END
+#endif
+#ifndef YY_INITIAL_VALUE
+# define YY_INITIAL_VALUE(Value) /* Nothing. */
+#endif
+
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
+
+#if !defined yyoverflow
+
+/* The parser invokes alloca or malloc; define the necessary symbols.  */
+
+# ifdef YYSTACK_USE_ALLOCA
+#  if YYSTACK_USE_ALLOCA
+#   ifdef __GNUC__
+#    define YYSTACK_ALLOC __builtin_alloca
+#   elif defined __BUILTIN_VA_ARG_INCR
+#    include <alloca.h> /* INFRINGES ON USER NAME SPACE */
+#   elif defined _AIX
+#    define YYSTACK_ALLOC __alloca
+#   elif defined _MSC_VER
+#    include <malloc.h> /* INFRINGES ON USER NAME SPACE */
+#    define alloca _alloca
+#   else
+#    define YYSTACK_ALLOC alloca
+#    if ! defined _ALLOCA_H && ! defined EXIT_SUCCESS
+#     include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+      /* Use EXIT_SUCCESS as a witness for stdlib.h.  */
+#     ifndef EXIT_SUCCESS
+#      define EXIT_SUCCESS 0
+#     endif
+#    endif
+#   endif
+#  endif
+# endif
+
+# ifdef YYSTACK_ALLOC
+   /* Pacify GCC's 'empty if-body' warning.  */
+#  define YYSTACK_FREE(Ptr) do { /* empty */; } while (0)
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+    /* The OS might guarantee only one guard page at the bottom of the stack,
+       and a page size can be as small as 4096 bytes.  So we cannot safely
+       invoke alloca (N) if N exceeds 4096.  Use a slightly smaller number
+       to allow for a few compiler-allocated temporary stack slots.  */
+#   define YYSTACK_ALLOC_MAXIMUM 4032 /* reasonable circa 2006 */
+#  endif
+# else
+#  define YYSTACK_ALLOC YYMALLOC
+#  define YYSTACK_FREE YYFREE
+#  ifndef YYSTACK_ALLOC_MAXIMUM
+#   define YYSTACK_ALLOC_MAXIMUM YYSIZE_MAXIMUM
+#  endif
+#  if (defined __cplusplus && ! defined EXIT_SUCCESS \
+       && ! ((defined YYMALLOC || defined malloc) \
+             && (defined YYFREE || defined free)))
+#   include <stdlib.h> /* INFRINGES ON USER NAME SPACE */
+#   ifndef EXIT_SUCCESS
+#    define EXIT_SUCCESS 0
+#   endif
+#  endif
+#  ifndef YYMALLOC
+#   define YYMALLOC malloc
+#   if ! defined malloc && ! defined EXIT_SUCCESS
+void *malloc (YYSIZE_T); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+#  ifndef YYFREE
+#   define YYFREE free
+#   if ! defined free && ! defined EXIT_SUCCESS
+void free (void *); /* INFRINGES ON USER NAME SPACE */
+#   endif
+#  endif
+# endif
+#endif /* !defined yyoverflow */
+
+#if (! defined yyoverflow \
+     && (! defined __cplusplus \
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+
+/* A type that is properly aligned for any stack member.  */
+union yyalloc
+{
+  yy_state_t yyss_alloc;
+  YYSTYPE yyvs_alloc;
+};
+
+/* The size of the maximum gap between one aligned stack and the next.  */
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
+
+/* The size of an array large to enough to hold all stacks, each with
+   N elements.  */
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+
+# define YYCOPY_NEEDED 1
+
+/* Relocate STACK from its old location to the new one.  The
+   local variables YYSIZE and YYSTACKSIZE give the old and new number of
+   elements in the stack, and YYPTR gives the new location of the
+   stack.  Advance YYPTR to a properly aligned location for the next
+   stack.  */
+# define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
+    do                                                                  \
+      {                                                                 \
+        YYPTRDIFF_T yynewbytes;                                         \
+        YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
+        Stack = &yyptr->Stack_alloc;                                    \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
+      }                                                                 \
+    while (0)
+
+#endif
+
+#if defined YYCOPY_NEEDED && YYCOPY_NEEDED
+/* Copy COUNT objects from SRC to DST.  The source and destination do
+   not overlap.  */
+# ifndef YYCOPY
+#  if defined __GNUC__ && 1 < __GNUC__
+#   define YYCOPY(Dst, Src, Count) \
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
+#  else
+#   define YYCOPY(Dst, Src, Count)              \
+      do                                        \
+        {                                       \
+          YYPTRDIFF_T yyi;                      \
+          for (yyi = 0; yyi < (Count); yyi++)   \
+            (Dst)[yyi] = (Src)[yyi];            \
+        }                                       \
+      while (0)
+#  endif
+# endif
+#endif /* !YYCOPY_NEEDED */
+
+/* YYFINAL -- State number of the termination state.  */
+#define YYFINAL  3
+/* YYLAST -- Last index in YYTABLE.  */
+#define YYLAST   129
+
+/* YYNTOKENS -- Number of terminals.  */
+#define YYNTOKENS  28
+/* YYNNTS -- Number of nonterminals.  */
+#define YYNNTS  27
+/* YYNRULES -- Number of rules.  */
+#define YYNRULES  61
+/* YYNSTATES -- Number of states.  */
+#define YYNSTATES  119
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   272
+
+
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
+
+/* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
+{
+       0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    27,     2,     2,     2,     2,     2,     2,
+      22,    23,     2,     2,    19,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,    18,
+       2,    26,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,    20,     2,    21,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,    24,     2,    25,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
+       5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
+      15,    16,    17
+};
+
+#if YYDEBUG
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_uint8 yyrline[] =
+{
+       0,    51,    51,    57,    62,    65,    69,    71,    73,    76,
+      84,    91,    96,    98,   102,   108,   108,   117,   117,   127,
+     128,   131,   138,   140,   147,   150,   155,   157,   160,   163,
+     166,   170,   173,   176,   178,   179,   180,   182,   185,   187,
+     190,   192,   196,   198,   202,   204,   208,   210,   214,   216,
+     219,   221,   222,   224,   226,   227,   232,   234,   237,   238,
+     241,   243
+};
+#endif
+
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
+/* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
+   First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
+static const char *const yytname[] =
+{
+  "\"end of file\"", "error", "\"invalid token\"", "CHARACTER", "ADDSUB",
+  "DIVSTAR", "EQ", "ORDER", "NUM", "IDENT", "VOID", "RETURN", "IF", "ELSE",
+  "WHILE", "OR", "AND", "TYPE", "';'", "','", "'['", "']'", "'('", "')'",
+  "'{'", "'}'", "'='", "'!'", "$accept", "Prog", "DeclVars",
+  "Declarateurs", "DeclFonctArray", "DeclArray", "ArrayLR", "DeclFoncts",
+  "DeclFonct", "EnTeteFonct", "$@1", "$@2", "Parametres", "ListTypVar",
+  "Corps", "SuiteInstr", "Instr", "Exp", "TB", "FB", "M", "E", "T", "F",
+  "LValue", "Arguments", "ListExp", YY_NULLPTR
+};
+
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
+{
+  return yytname[yysymbol];
+}
+#endif
+
+#define YYPACT_NINF (-98)
+
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
+
+#define YYTABLE_NINF (-1)
+
+#define yytable_value_is_error(Yyn) \
+  0
+
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
+static const yytype_int8 yypact[] =
+{
+     -98,    58,     6,   -98,    46,    59,     9,   -98,    42,    52,
+      -5,    63,   -98,    67,   -98,   -98,   -98,   -98,    70,   -98,
+     -98,    74,    62,    68,    40,    65,    40,    69,   -98,    79,
+      27,   -98,    81,   -98,    71,    72,   -98,    73,    69,     8,
+       0,    75,    76,   -98,   -98,   -98,   -98,   -98,    66,    80,
+     -98,    78,   -98,     2,     2,   -98,     2,   -98,    34,   -98,
+       2,     2,    55,    77,    93,    94,    98,    99,   -98,   -98,
+       2,     2,    35,     2,    82,    96,   -98,    48,    91,    84,
+      89,   -98,     2,    10,   -98,     2,   -98,     2,     2,     2,
+       2,     2,    20,    25,   -98,    57,   -98,    80,   -98,    92,
+       2,    86,   -98,    77,    93,    94,    98,    99,   -98,    53,
+      53,   -98,   -98,    91,   -98,   100,   -98,    53,   -98
+};
+
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
+{
+       4,     0,     0,     1,     0,     0,     2,    13,     0,     0,
+       7,     0,     8,     0,    12,     4,    14,    17,     0,    15,
+       3,     0,     0,    27,     0,     0,     0,     5,     6,     0,
+       0,    19,     0,    24,     0,    20,    10,     0,     7,    56,
+       0,     0,     0,    36,    27,    25,    57,    26,     0,    23,
+      18,     0,    16,     0,    59,    53,     0,    52,    56,    34,
+       0,     0,     0,    38,    40,    42,    44,    46,    48,    54,
+       0,     0,     0,     0,     0,     0,    22,     0,    61,     0,
+      58,    49,    59,     0,    50,     0,    33,     0,     0,     0,
+       0,     0,     0,     0,    35,     0,     9,    21,    11,     0,
+       0,     0,    51,    37,    39,    41,    43,    45,    47,     0,
+       0,    28,    32,    60,    55,    29,    31,     0,    30
+};
+
+/* YYPGOTO[NTERM-NUM].  */
+static const yytype_int8 yypgoto[] =
+{
+     -98,   -98,    97,   -98,    60,    95,   -98,   -98,   108,   -98,
+     -98,   -98,   101,   -98,   -98,    85,   -97,   -39,    30,    31,
+      29,    32,    33,   -54,   -30,    37,   -98
+};
+
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_int8 yydefgoto[] =
+{
+       0,     1,     2,    11,    33,    12,    46,     6,     7,     8,
+      26,    24,    34,    35,    16,    30,    47,    78,    63,    64,
+      65,    66,    67,    68,    69,    79,    80
+};
+
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
+static const yytype_int8 yytable[] =
+{
+      48,    62,    81,    55,    56,    55,    56,    84,    57,    58,
+      57,    58,   115,   116,    77,    18,     4,    19,    59,     4,
+     118,    83,    60,     5,    60,    85,    13,    61,    53,    61,
+      54,    92,    93,   102,    95,    85,    39,   108,    40,    41,
+      85,    42,    48,   109,    39,    43,    40,    41,   110,    42,
+      31,    44,    45,    43,    53,     9,    82,    32,     3,    44,
+      94,   113,    39,    85,    40,    41,    15,    42,    10,    98,
+      85,    43,    85,    86,    17,   111,    22,    44,    25,    48,
+      48,    20,    21,    27,    19,    29,    36,    48,    38,    18,
+      49,    51,    73,    87,    50,    75,    52,    70,    71,    88,
+      74,    89,    90,    96,    91,    97,    85,    99,   100,   114,
+     112,    76,    23,   117,    14,   103,    28,   105,   104,   101,
+       0,   106,     0,   107,     0,     0,     0,    37,     0,    72
+};
+
+static const yytype_int8 yycheck[] =
+{
+      30,    40,    56,     3,     4,     3,     4,    61,     8,     9,
+       8,     9,   109,   110,    53,    20,    10,    22,    18,    10,
+     117,    60,    22,    17,    22,    15,    17,    27,    20,    27,
+      22,    70,    71,    23,    73,    15,     9,    91,    11,    12,
+      15,    14,    72,    23,     9,    18,    11,    12,    23,    14,
+      10,    24,    25,    18,    20,     9,    22,    17,     0,    24,
+      25,   100,     9,    15,    11,    12,    24,    14,     9,    21,
+      15,    18,    15,    18,    22,    18,     9,    24,     8,   109,
+     110,    18,    19,     9,    22,    17,    21,   117,     9,    20,
+       9,    19,    26,    16,    23,    17,    23,    22,    22,     6,
+      20,     7,     4,    21,     5,     9,    15,    23,    19,    23,
+      18,    51,    15,    13,     6,    85,    21,    88,    87,    82,
+      -1,    89,    -1,    90,    -1,    -1,    -1,    26,    -1,    44
+};
+
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
+{
+       0,    29,    30,     0,    10,    17,    35,    36,    37,     9,
+       9,    31,    33,    17,    36,    24,    42,    22,    20,    22,
+      18,    19,     9,    30,    39,     8,    38,     9,    33,    17,
+      43,    10,    17,    32,    40,    41,    21,    40,     9,     9,
+      11,    12,    14,    18,    24,    25,    34,    44,    52,     9,
+      23,    19,    23,    20,    22,     3,     4,     8,     9,    18,
+      22,    27,    45,    46,    47,    48,    49,    50,    51,    52,
+      22,    22,    43,    26,    20,    17,    32,    45,    45,    53,
+      54,    51,    22,    45,    51,    15,    18,    16,     6,     7,
+       4,     5,    45,    45,    25,    45,    21,     9,    21,    23,
+      19,    53,    23,    46,    47,    48,    49,    50,    51,    23,
+      23,    18,    18,    45,    23,    44,    44,    13,    44
+};
+
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
+{
+       0,    28,    29,    30,    30,    31,    31,    31,    31,    32,
+      33,    34,    35,    35,    36,    38,    37,    39,    37,    40,
+      40,    41,    41,    41,    41,    42,    43,    43,    44,    44,
+      44,    44,    44,    44,    44,    44,    44,    45,    45,    46,
+      46,    47,    47,    48,    48,    49,    49,    50,    50,    51,
+      51,    51,    51,    51,    51,    51,    52,    52,    53,    53,
+      54,    54
+};
+
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
+{
+       0,     2,     2,     4,     0,     3,     3,     1,     1,     4,
+       4,     4,     2,     1,     2,     0,     6,     0,     6,     1,
+       1,     4,     3,     2,     1,     4,     2,     0,     4,     5,
+       7,     5,     5,     3,     2,     3,     1,     3,     1,     3,
+       1,     3,     1,     3,     1,     3,     1,     3,     1,     2,
+       2,     3,     1,     1,     1,     4,     1,     1,     1,     0,
+       3,     1
+};
+
+
+enum { YYENOMEM = -2 };
+
+#define yyerrok         (yyerrstatus = 0)
+#define yyclearin       (yychar = YYEMPTY)
+
+#define YYACCEPT        goto yyacceptlab
+#define YYABORT         goto yyabortlab
+#define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
+
+
+#define YYRECOVERING()  (!!yyerrstatus)
+
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (abr, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
+
+
+/* Enable debugging if requested.  */
+#if YYDEBUG
+
+# ifndef YYFPRINTF
+#  include <stdio.h> /* INFRINGES ON USER NAME SPACE */
+#  define YYFPRINTF fprintf
+# endif
+
+# define YYDPRINTF(Args)                        \
+do {                                            \
+  if (yydebug)                                  \
+    YYFPRINTF Args;                             \
+} while (0)
+
+
+
+
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
+do {                                                                      \
+  if (yydebug)                                                            \
+    {                                                                     \
+      YYFPRINTF (stderr, "%s ", Title);                                   \
+      yy_symbol_print (stderr,                                            \
+                  Kind, Value, abr); \
+      YYFPRINTF (stderr, "\n");                                           \
+    }                                                                     \
+} while (0)
+
+
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
+
+static void
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, NodeId * abr)
+{
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (abr);
+  if (!yyvaluep)
+    return;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
+
+static void
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, NodeId * abr)
+{
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
+
+  yy_symbol_value_print (yyo, yykind, yyvaluep, abr);
+  YYFPRINTF (yyo, ")");
+}
+
+/*------------------------------------------------------------------.
+| yy_stack_print -- Print the state stack from its BOTTOM up to its |
+| TOP (included).                                                   |
+`------------------------------------------------------------------*/
+
+static void
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
+{
+  YYFPRINTF (stderr, "Stack now");
+  for (; yybottom <= yytop; yybottom++)
+    {
+      int yybot = *yybottom;
+      YYFPRINTF (stderr, " %d", yybot);
+    }
+  YYFPRINTF (stderr, "\n");
+}
+
+# define YY_STACK_PRINT(Bottom, Top)                            \
+do {                                                            \
+  if (yydebug)                                                  \
+    yy_stack_print ((Bottom), (Top));                           \
+} while (0)
+
+
+/*------------------------------------------------.
+| Report that the YYRULE is going to be reduced.  |
+`------------------------------------------------*/
+
+static void
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule, NodeId * abr)
+{
+  int yylno = yyrline[yyrule];
+  int yynrhs = yyr2[yyrule];
+  int yyi;
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
+             yyrule - 1, yylno);
+  /* The symbols being reduced.  */
+  for (yyi = 0; yyi < yynrhs; yyi++)
+    {
+      YYFPRINTF (stderr, "   $%d = ", yyi + 1);
+      yy_symbol_print (stderr,
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)], abr);
+      YYFPRINTF (stderr, "\n");
+    }
+}
+
+# define YY_REDUCE_PRINT(Rule)          \
+do {                                    \
+  if (yydebug)                          \
+    yy_reduce_print (yyssp, yyvsp, Rule, abr); \
+} while (0)
+
+/* Nonzero means print parse trace.  It is left uninitialized so that
+   multiple parsers can coexist.  */
+int yydebug;
+#else /* !YYDEBUG */
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
+# define YY_STACK_PRINT(Bottom, Top)
+# define YY_REDUCE_PRINT(Rule)
+#endif /* !YYDEBUG */
+
+
+/* YYINITDEPTH -- initial size of the parser's stacks.  */
+#ifndef YYINITDEPTH
+# define YYINITDEPTH 200
+#endif
+
+/* YYMAXDEPTH -- maximum size the stacks can grow to (effective only
+   if the built-in stack extension method is used).
+
+   Do not make this value too large; the results are undefined if
+   YYSTACK_ALLOC_MAXIMUM < YYSTACK_BYTES (YYMAXDEPTH)
+   evaluated with infinite-precision integer arithmetic.  */
+
+#ifndef YYMAXDEPTH
+# define YYMAXDEPTH 10000
+#endif
+
+
+
+
+
+
+/*-----------------------------------------------.
+| Release the memory associated to this symbol.  |
+`-----------------------------------------------*/
+
+static void
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, NodeId * abr)
+{
+  YY_USE (yyvaluep);
+  YY_USE (abr);
+  if (!yymsg)
+    yymsg = "Deleting";
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+}
+
+
+/* Lookahead token kind.  */
+int yychar;
+
+/* The semantic value of the lookahead symbol.  */
+YYSTYPE yylval;
+/* Number of syntax errors so far.  */
+int yynerrs;
+
+
+
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (NodeId * abr)
+{
+    yy_state_fast_t yystate = 0;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus = 0;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
+
+  int yyn;
+  /* The return value of yyparse.  */
+  int yyresult;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
+  /* The variables used to return semantic value and location from the
+     action routines.  */
+  YYSTYPE yyval;
+
+
+
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+
+  /* The number of symbols on the RHS of the reduced rule.
+     Keep to zero when no symbol should be popped.  */
+  int yylen = 0;
+
+  YYDPRINTF ((stderr, "Starting parse\n"));
+
+  yychar = YYEMPTY; /* Cause a token to be read.  */
+
+  goto yysetstate;
+
+
+/*------------------------------------------------------------.
+| yynewstate -- push a new state, which is found in yystate.  |
+`------------------------------------------------------------*/
+yynewstate:
+  /* In all cases, when you get here, the value and location stacks
+     have just been pushed.  So pushing a state here evens the stacks.  */
+  yyssp++;
+
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
+
+  if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
+    {
+      /* Get the current used size of the three stacks, in elements.  */
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
+
+# if defined yyoverflow
+      {
+        /* Give user a chance to reallocate the stack.  Use copies of
+           these so that the &'s don't force the real ones into
+           memory.  */
+        yy_state_t *yyss1 = yyss;
+        YYSTYPE *yyvs1 = yyvs;
+
+        /* Each stack pointer address is followed by the size of the
+           data in use in that stack, in bytes.  This used to be a
+           conditional around just the two extra args, but that might
+           be undefined if yyoverflow is a macro.  */
+        yyoverflow (YY_("memory exhausted"),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yystacksize);
+        yyss = yyss1;
+        yyvs = yyvs1;
+      }
+# else /* defined YYSTACK_RELOCATE */
+      /* Extend the stack our own way.  */
+      if (YYMAXDEPTH <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (YYMAXDEPTH < yystacksize)
+        yystacksize = YYMAXDEPTH;
+
+      {
+        yy_state_t *yyss1 = yyss;
+        union yyalloc *yyptr =
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+        if (! yyptr)
+          YYNOMEM;
+        YYSTACK_RELOCATE (yyss_alloc, yyss);
+        YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+#  undef YYSTACK_RELOCATE
+        if (yyss1 != yyssa)
+          YYSTACK_FREE (yyss1);
+      }
+# endif
+
+      yyssp = yyss + yysize - 1;
+      yyvsp = yyvs + yysize - 1;
+
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
+
+      if (yyss + yystacksize - 1 <= yyssp)
+        YYABORT;
+    }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
+
+
+  if (yystate == YYFINAL)
+    YYACCEPT;
+
+  goto yybackup;
+
+
+/*-----------.
+| yybackup.  |
+`-----------*/
+yybackup:
+  /* Do appropriate processing given the current state.  Read a
+     lookahead token if we need one and don't already have one.  */
+
+  /* First try to decide what to do without reference to lookahead token.  */
+  yyn = yypact[yystate];
+  if (yypact_value_is_default (yyn))
+    goto yydefault;
+
+  /* Not known => get a lookahead token if don't already have one.  */
+
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
+  if (yychar == YYEMPTY)
+    {
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yylex ();
+    }
+
+  if (yychar <= YYEOF)
+    {
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
+      YYDPRINTF ((stderr, "Now at end of input.\n"));
+    }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      goto yyerrlab1;
+    }
+  else
+    {
+      yytoken = YYTRANSLATE (yychar);
+      YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc);
+    }
+
+  /* If the proper action on seeing token YYTOKEN is to reduce or to
+     detect an error, take that action.  */
+  yyn += yytoken;
+  if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
+    goto yydefault;
+  yyn = yytable[yyn];
+  if (yyn <= 0)
+    {
+      if (yytable_value_is_error (yyn))
+        goto yyerrlab;
+      yyn = -yyn;
+      goto yyreduce;
+    }
+
+  /* Count tokens shifted since error; after three, turn off error
+     status.  */
+  if (yyerrstatus)
+    yyerrstatus--;
+
+  /* Shift the lookahead token.  */
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
+  yystate = yyn;
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
+  goto yynewstate;
+
+
+/*-----------------------------------------------------------.
+| yydefault -- do the default action for the current state.  |
+`-----------------------------------------------------------*/
+yydefault:
+  yyn = yydefact[yystate];
+  if (yyn == 0)
+    goto yyerrlab;
+  goto yyreduce;
+
+
+/*-----------------------------.
+| yyreduce -- do a reduction.  |
+`-----------------------------*/
+yyreduce:
+  /* yyn is the number of a rule to reduce with.  */
+  yylen = yyr2[yyn];
+
+  /* If YYLEN is nonzero, implement the default value of the action:
+     '$$ = $1'.
+
+     Otherwise, the following line sets YYVAL to garbage.
+     This behavior is undocumented and Bison
+     users should not rely upon it.  Assigning to YYVAL
+     unconditionally makes the parser a bit smaller, and it avoids a
+     GCC warning that YYVAL may be used uninitialized.  */
+  yyval = yyvsp[1-yylen];
+
+
+  YY_REDUCE_PRINT (yyn);
+  switch (yyn)
+    {
+  case 2: /* Prog: DeclVars DeclFoncts  */
+#line 51 "src/tpc.y"
+                                        {*abr = makeNode(Prog);
+                                        addChild(*abr,(yyvsp[-1].node));
+                                        addChild(*abr,(yyvsp[0].node));
+                                        }
+#line 1216 "obj/tpc.tab.c"
+    break;
+
+  case 3: /* DeclVars: DeclVars TYPE Declarateurs ';'  */
+#line 57 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-3].node);
+                                        NodeId i = makeNode(Type);
+                                        addAttributKeyWord(i, (yyvsp[-2].prim_type));
+                                        addChild(i, (yyvsp[-1].node));
+                                        addChild((yyval.node), i);}
+#line 1226 "obj/tpc.tab.c"
+    break;
+
+  case 4: /* DeclVars: %empty  */
+#line 62 "src/tpc.y"
+                                        {(yyval.node) = makeNode(DeclVars);}
+#line 1232 "obj/tpc.tab.c"
+    break;
+
+  case 5: /* Declarateurs: Declarateurs ',' IDENT  */
+#line 65 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-2].node);
+                                        NodeId i = makeNode(Ident);
+                                        addAttributIdent(i, (yyvsp[0].ident));
+                                        addSibling((yyval.node), i);}
+#line 1241 "obj/tpc.tab.c"
+    break;
+
+  case 6: /* Declarateurs: Declarateurs ',' DeclArray  */
+#line 69 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-2].node);
+                                        addSibling((yyval.node), (yyvsp[0].node));}
+#line 1248 "obj/tpc.tab.c"
+    break;
+
+  case 7: /* Declarateurs: IDENT  */
+#line 71 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Ident);
+                                        addAttributIdent((yyval.node), (yyvsp[0].ident));}
+#line 1255 "obj/tpc.tab.c"
+    break;
+
+  case 8: /* Declarateurs: DeclArray  */
+#line 73 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1261 "obj/tpc.tab.c"
+    break;
+
+  case 9: /* DeclFonctArray: TYPE IDENT '[' ']'  */
+#line 76 "src/tpc.y"
+                                        {(yyval.node) = makeNode(DeclFonctArray);
+                                        addAttributKeyWord((yyval.node), (yyvsp[-3].prim_type));
+                                        NodeId ident = makeNode(Ident);
+                                        addAttributIdent(ident, (yyvsp[-2].ident));
+                                        addChild((yyval.node), ident);}
+#line 1271 "obj/tpc.tab.c"
+    break;
+
+  case 10: /* DeclArray: IDENT '[' NUM ']'  */
+#line 84 "src/tpc.y"
+                                        {(yyval.node) = makeNode(DeclArray);
+                                        addAttributIdent((yyval.node),(yyvsp[-3].ident));
+                                        NodeId num = makeNode(Num);
+                                        addAttributNum(num, (yyvsp[-1].num));
+                                        addChild((yyval.node), num);}
+#line 1281 "obj/tpc.tab.c"
+    break;
+
+  case 11: /* ArrayLR: IDENT '[' Exp ']'  */
+#line 91 "src/tpc.y"
+                                        {(yyval.node) = makeNode(ArrayLR);
+                                        addAttributIdent((yyval.node),(yyvsp[-3].ident));
+                                        addChild((yyval.node), (yyvsp[-1].node));}
+#line 1289 "obj/tpc.tab.c"
+    break;
+
+  case 12: /* DeclFoncts: DeclFoncts DeclFonct  */
+#line 96 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-1].node);
+                                        if ((yyvsp[0].node)) addChild((yyval.node),(yyvsp[0].node));}
+#line 1296 "obj/tpc.tab.c"
+    break;
+
+  case 13: /* DeclFoncts: DeclFonct  */
+#line 98 "src/tpc.y"
+                                        {(yyval.node) = makeNode(DeclFoncts);
+                                        if ((yyvsp[0].node)) addChild((yyval.node),(yyvsp[0].node));}
+#line 1303 "obj/tpc.tab.c"
+    break;
+
+  case 14: /* DeclFonct: EnTeteFonct Corps  */
+#line 102 "src/tpc.y"
+                                        {(yyval.node) = makeNode(DeclFonct);
+                                        addChild((yyval.node),(yyvsp[-1].node));
+                                        addChild((yyval.node),(yyvsp[0].node));
+                                        (yyval.node) = stream_function((yyval.node));}
+#line 1312 "obj/tpc.tab.c"
+    break;
+
+  case 15: /* $@1: %empty  */
+#line 108 "src/tpc.y"
+                                        {stream_function_start((yyvsp[-3].node));}
+#line 1318 "obj/tpc.tab.c"
+    break;
+
+  case 16: /* EnTeteFonct: TYPE IDENT '(' $@1 Parametres ')'  */
+#line 109 "src/tpc.y"
+                                        {(yyval.node) = makeNode(EnTeteFonct);
+                                        NodeId i = makeNode(Type);
+                                        addAttributKeyWord(i, (yyvsp[-5].prim_type));
+                                        addChild((yyval.node), i);
+                                        NodeId j = makeNode(Ident);
+                                        addAttributIdent(j, (yyvsp[-4].ident));
+                                        addChild((yyval.node), j);
+                                        addChild((yyval.node), (yyvsp[-1].node));}
+#line 1331 "obj/tpc.tab.c"
+    break;
+
+  case 17: /* $@2: %empty  */
+#line 117 "src/tpc.y"
+                                        {stream_function_start((yyvsp[-3].node));}
+#line 1337 "obj/tpc.tab.c"
+    break;
+
+  case 18: /* EnTeteFonct: VOID IDENT '(' $@2 Parametres ')'  */
+#line 118 "src/tpc.y"
+                                        {(yyval.node) = makeNode(EnTeteFonct);
+                                        addChild((yyval.node), makeNode(Void));
+                                        NodeId j = makeNode(Ident);
+                                        addAttributIdent(j, (yyvsp[-4].ident));
+                                        addChild((yyval.node), j);
+                                        addChild((yyval.node), (yyvsp[-1].node));}
+#line 1348 "obj/tpc.tab.c"
+    break;
+
+  case 19: /* Parametres: VOID  */
+#line 127 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Void);}
+#line 1354 "obj/tpc.tab.c"
+    break;
+
+  case 20: /* Parametres: ListTypVar  */
+#line 128 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1360 "obj/tpc.tab.c"
+    break;
+
+  case 21: /* ListTypVar: ListTypVar ',' TYPE IDENT  */
+#line 131 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-3].node);
+                                        NodeId i = makeNode(Type);
+                                        addAttributKeyWord(i, (yyvsp[-1].prim_type));
+                                        NodeId j = makeNode(Ident);
+                                        addAttributIdent(j, (yyvsp[0].ident));
+                                        addChild(i, j);
+                                        addChild((yyval.node),i);}
+#line 1372 "obj/tpc.tab.c"
+    break;
+
+  case 22: /* ListTypVar: ListTypVar ',' DeclFonctArray  */
+#line 138 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-2].node);
+                                        addChild((yyval.node), (yyvsp[0].node));}
+#line 1379 "obj/tpc.tab.c"
+    break;
+
+  case 23: /* ListTypVar: TYPE IDENT  */
+#line 140 "src/tpc.y"
+                                        {(yyval.node) = makeNode(ListTypVar);
+                                        NodeId i = makeNode(Type);
+                                        addAttributKeyWord(i, (yyvsp[-1].prim_type));
+                                        NodeId j = makeNode(Ident);
+                                        addAttributIdent(j, (yyvsp[0].ident));
+                                        addChild(i, j);
+                                        addChild((yyval.node), i);}
+#line 1391 "obj/tpc.tab.c"
+    break;
+
+  case 24: /* ListTypVar: DeclFonctArray  */
+#line 147 "src/tpc.y"
+                                        {(yyval.node) = makeNode(ListTypVar);
+                                        addChild((yyval.node), (yyvsp[0].node));}
+#line 1398 "obj/tpc.tab.c"
+    break;
+
+  case 25: /* Corps: '{' DeclVars SuiteInstr '}'  */
+#line 150 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Corps);
+                                        addChild((yyval.node),(yyvsp[-2].node));
+                                        addChild((yyval.node),(yyvsp[-1].node));}
+#line 1406 "obj/tpc.tab.c"
+    break;
+
+  case 26: /* SuiteInstr: SuiteInstr Instr  */
+#line 155 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-1].node);
+                                        addChild((yyval.node),(yyvsp[0].node));}
+#line 1413 "obj/tpc.tab.c"
+    break;
+
+  case 27: /* SuiteInstr: %empty  */
+#line 157 "src/tpc.y"
+                                        {(yyval.node) = makeNode(SuiteInstr);}
+#line 1419 "obj/tpc.tab.c"
+    break;
+
+  case 28: /* Instr: LValue '=' Exp ';'  */
+#line 160 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Assignation);
+                                        addChild((yyval.node), (yyvsp[-3].node));
+                                        addChild((yyval.node), (yyvsp[-1].node));}
+#line 1427 "obj/tpc.tab.c"
+    break;
+
+  case 29: /* Instr: IF '(' Exp ')' Instr  */
+#line 163 "src/tpc.y"
+                                        {(yyval.node) = makeNode(If);
+                                        addChild((yyval.node),(yyvsp[-2].node));
+                                        addChild((yyval.node),(yyvsp[0].node));}
+#line 1435 "obj/tpc.tab.c"
+    break;
+
+  case 30: /* Instr: IF '(' Exp ')' Instr ELSE Instr  */
+#line 166 "src/tpc.y"
+                                        {(yyval.node) = makeNode(If);
+                                        addChild((yyval.node),(yyvsp[-4].node));
+                                        addChild((yyval.node),(yyvsp[-2].node));
+                                        addChild((yyval.node),(yyvsp[0].node));}
+#line 1444 "obj/tpc.tab.c"
+    break;
+
+  case 31: /* Instr: WHILE '(' Exp ')' Instr  */
+#line 170 "src/tpc.y"
+                                        {(yyval.node) = makeNode(While);
+                                        addChild((yyval.node),(yyvsp[-2].node));
+                                        addChild((yyval.node),(yyvsp[0].node));}
+#line 1452 "obj/tpc.tab.c"
+    break;
+
+  case 32: /* Instr: IDENT '(' Arguments ')' ';'  */
+#line 173 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Ident);
+                                        addAttributIdent((yyval.node), (yyvsp[-4].ident));
+                                        addChild((yyval.node),(yyvsp[-2].node));}
+#line 1460 "obj/tpc.tab.c"
+    break;
+
+  case 33: /* Instr: RETURN Exp ';'  */
+#line 176 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Return);
+                                        addChild((yyval.node),(yyvsp[-1].node));}
+#line 1467 "obj/tpc.tab.c"
+    break;
+
+  case 34: /* Instr: RETURN ';'  */
+#line 178 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Return);}
+#line 1473 "obj/tpc.tab.c"
+    break;
+
+  case 35: /* Instr: '{' SuiteInstr '}'  */
+#line 179 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-1].node);}
+#line 1479 "obj/tpc.tab.c"
+    break;
+
+  case 36: /* Instr: ';'  */
+#line 180 "src/tpc.y"
+                                        {(yyval.node) = makeNode(EmptyInstr);}
+#line 1485 "obj/tpc.tab.c"
+    break;
+
+  case 37: /* Exp: Exp OR TB  */
+#line 182 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Or);
+                                        addChild((yyval.node), (yyvsp[-2].node));
+                                        addChild((yyval.node), (yyvsp[0].node));}
+#line 1493 "obj/tpc.tab.c"
+    break;
+
+  case 38: /* Exp: TB  */
+#line 185 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1499 "obj/tpc.tab.c"
+    break;
+
+  case 39: /* TB: TB AND FB  */
+#line 187 "src/tpc.y"
+                                        {(yyval.node) = makeNode(And);
+                                        addChild((yyval.node), (yyvsp[-2].node));
+                                        addChild((yyval.node), (yyvsp[0].node));}
+#line 1507 "obj/tpc.tab.c"
+    break;
+
+  case 40: /* TB: FB  */
+#line 190 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1513 "obj/tpc.tab.c"
+    break;
+
+  case 41: /* FB: FB EQ M  */
+#line 192 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Eq);
+                                        addAttributOperator((yyval.node), (yyvsp[-1].op));
+                                        addChild((yyval.node), (yyvsp[-2].node));
+                                        addChild((yyval.node), (yyvsp[0].node));}
+#line 1522 "obj/tpc.tab.c"
+    break;
+
+  case 42: /* FB: M  */
+#line 196 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1528 "obj/tpc.tab.c"
+    break;
+
+  case 43: /* M: M ORDER E  */
+#line 198 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Order);
+                                        addAttributOperator((yyval.node), (yyvsp[-1].op));
+                                        addChild((yyval.node), (yyvsp[-2].node));
+                                        addChild((yyval.node), (yyvsp[0].node));}
+#line 1537 "obj/tpc.tab.c"
+    break;
+
+  case 44: /* M: E  */
+#line 202 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1543 "obj/tpc.tab.c"
+    break;
+
+  case 45: /* E: E ADDSUB T  */
+#line 204 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Addsub);
+                                        addAttributOperator((yyval.node), (yyvsp[-1].op));
+                                        addChild((yyval.node), (yyvsp[-2].node));
+                                        addChild((yyval.node), (yyvsp[0].node));}
+#line 1552 "obj/tpc.tab.c"
+    break;
+
+  case 46: /* E: T  */
+#line 208 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1558 "obj/tpc.tab.c"
+    break;
+
+  case 47: /* T: T DIVSTAR F  */
+#line 210 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Divstar);
+                                        addAttributOperator((yyval.node), (yyvsp[-1].op));
+                                        addChild((yyval.node), (yyvsp[-2].node));
+                                        addChild((yyval.node), (yyvsp[0].node));}
+#line 1567 "obj/tpc.tab.c"
+    break;
+
+  case 48: /* T: F  */
+#line 214 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1573 "obj/tpc.tab.c"
+    break;
+
+  case 49: /* F: ADDSUB F  */
+#line 216 "src/tpc.y"
+                                        {(yyval.node) = makeNode(AddsubU);
+                                        addAttributOperator((yyval.node), (yyvsp[-1].op));
+                                        addChild((yyval.node),(yyvsp[0].node));}
+#line 1581 "obj/tpc.tab.c"
+    break;
+
+  case 50: /* F: '!' F  */
+#line 219 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Not);
+                                        addChild((yyval.node),(yyvsp[0].node));}
+#line 1588 "obj/tpc.tab.c"
+    break;
+
+  case 51: /* F: '(' Exp ')'  */
+#line 221 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-1].node);}
+#line 1594 "obj/tpc.tab.c"
+    break;
+
+  case 52: /* F: NUM  */
+#line 222 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Num);
+                                        addAttributNum((yyval.node), (yyvsp[0].num));}
+#line 1601 "obj/tpc.tab.c"
+    break;
+
+  case 53: /* F: CHARACTER  */
+#line 224 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Character);
+                                        addAttributByte((yyval.node), (yyvsp[0].byte));}
+#line 1608 "obj/tpc.tab.c"
+    break;
+
+  case 54: /* F: LValue  */
+#line 226 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1614 "obj/tpc.tab.c"
+    break;
+
+  case 55: /* F: IDENT '(' Arguments ')'  */
+#line 227 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Ident);
+                                        addAttributIdent((yyval.node), (yyvsp[-3].ident));
+                                        addChild((yyval.node),(yyvsp[-1].node));}
+#line 1622 "obj/tpc.tab.c"
+    break;
+
+  case 56: /* LValue: IDENT  */
+#line 232 "src/tpc.y"
+                                        {(yyval.node) = makeNode(Ident);
+                                        addAttributIdent((yyval.node), (yyvsp[0].ident));}
+#line 1629 "obj/tpc.tab.c"
+    break;
+
+  case 57: /* LValue: ArrayLR  */
+#line 234 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1635 "obj/tpc.tab.c"
+    break;
+
+  case 58: /* Arguments: ListExp  */
+#line 237 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[0].node);}
+#line 1641 "obj/tpc.tab.c"
+    break;
+
+  case 59: /* Arguments: %empty  */
+#line 238 "src/tpc.y"
+                                        {(yyval.node) = makeNode(EmptyArgs);}
+#line 1647 "obj/tpc.tab.c"
+    break;
+
+  case 60: /* ListExp: ListExp ',' Exp  */
+#line 241 "src/tpc.y"
+                                        {(yyval.node) = (yyvsp[-2].node);
+                                        addChild((yyval.node),(yyvsp[0].node));}
+#line 1654 "obj/tpc.tab.c"
+    break;
+
+  case 61: /* ListExp: Exp  */
+#line 243 "src/tpc.y"
+                                        {(yyval.node) = makeNode(ListExp);
+                                        addChild((yyval.node),(yyvsp[0].node));}
+#line 1661 "obj/tpc.tab.c"
+    break;
+
+
+#line 1665 "obj/tpc.tab.c"
+
+      default: break;
+    }
+  /* User semantic actions sometimes alter yychar, and that requires
+     that yytoken be updated with the new translation.  We take the
+     approach of translating immediately before every use of yytoken.
+     One alternative is translating here after every semantic action,
+     but that translation would be missed if the semantic action invokes
+     YYABORT, YYACCEPT, or YYERROR immediately after altering yychar or
+     if it invokes YYBACKUP.  In the case of YYABORT or YYACCEPT, an
+     incorrect destructor might then be invoked immediately.  In the
+     case of YYERROR or YYBACKUP, subsequent parser actions might lead
+     to an incorrect destructor call or verbose syntax error message
+     before the lookahead is translated.  */
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
+
+  YYPOPSTACK (yylen);
+  yylen = 0;
+
+  *++yyvsp = yyval;
+
+  /* Now 'shift' the result of the reduction.  Determine what state
+     that goes to, based on the state we popped back to and the rule
+     number reduced by.  */
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
+
+  goto yynewstate;
+
+
+/*--------------------------------------.
+| yyerrlab -- here on detecting error.  |
+`--------------------------------------*/
+yyerrlab:
+  /* Make sure we have latest lookahead translation.  See comments at
+     user semantic actions for why this is necessary.  */
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
+  /* If not already recovering from an error, report this error.  */
+  if (!yyerrstatus)
+    {
+      ++yynerrs;
+      yyerror (abr, YY_("syntax error"));
+    }
+
+  if (yyerrstatus == 3)
+    {
+      /* If just tried and failed to reuse lookahead token after an
+         error, discard it.  */
+
+      if (yychar <= YYEOF)
+        {
+          /* Return failure if at end of input.  */
+          if (yychar == YYEOF)
+            YYABORT;
+        }
+      else
+        {
+          yydestruct ("Error: discarding",
+                      yytoken, &yylval, abr);
+          yychar = YYEMPTY;
+        }
+    }
+
+  /* Else will try to reuse lookahead token after shifting the error
+     token.  */
+  goto yyerrlab1;
+
+
+/*---------------------------------------------------.
+| yyerrorlab -- error raised explicitly by YYERROR.  |
+`---------------------------------------------------*/
+yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
+
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYERROR.  */
+  YYPOPSTACK (yylen);
+  yylen = 0;
+  YY_STACK_PRINT (yyss, yyssp);
+  yystate = *yyssp;
+  goto yyerrlab1;
+
+
+/*-------------------------------------------------------------.
+| yyerrlab1 -- common code for both syntax error and YYERROR.  |
+`-------------------------------------------------------------*/
+yyerrlab1:
+  yyerrstatus = 3;      /* Each real token shifted decrements this.  */
+
+  /* Pop stack until we find a state that shifts the error token.  */
+  for (;;)
+    {
+      yyn = yypact[yystate];
+      if (!yypact_value_is_default (yyn))
+        {
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
+            {
+              yyn = yytable[yyn];
+              if (0 < yyn)
+                break;
+            }
+        }
+
+      /* Pop the current state because it cannot handle the error token.  */
+      if (yyssp == yyss)
+        YYABORT;
+
+
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, abr);
+      YYPOPSTACK (1);
+      yystate = *yyssp;
+      YY_STACK_PRINT (yyss, yyssp);
+    }
+
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+
+
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
+
+  yystate = yyn;
+  goto yynewstate;
+
+
+/*-------------------------------------.
+| yyacceptlab -- YYACCEPT comes here.  |
+`-------------------------------------*/
+yyacceptlab:
+  yyresult = 0;
+  goto yyreturnlab;
+
+
+/*-----------------------------------.
+| yyabortlab -- YYABORT comes here.  |
+`-----------------------------------*/
+yyabortlab:
+  yyresult = 1;
+  goto yyreturnlab;
+
+
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
+yyexhaustedlab:
+  yyerror (abr, YY_("memory exhausted"));
+  yyresult = 2;
+  goto yyreturnlab;
+
+
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
+  if (yychar != YYEMPTY)
+    {
+      /* Make sure we have latest lookahead translation.  See comments at
+         user semantic actions for why this is necessary.  */
+      yytoken = YYTRANSLATE (yychar);
+      yydestruct ("Cleanup: discarding lookahead",
+                  yytoken, &yylval, abr);
+    }
+  /* Do not reclaim the symbols of the rule whose action triggered
+     this YYABORT or YYACCEPT.  */
+  YYPOPSTACK (yylen);
+  YY_STACK_PRINT (yyss, yyssp);
+  while (yyssp != yyss)
+    {
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, abr);
+      YYPOPSTACK (1);
+    }
+#ifndef yyoverflow
+  if (yyss != yyssa)
+    YYSTACK_FREE (yyss);
+#endif
+
+  return yyresult;
+}
+
+#line 246 "src/tpc.y"
+
+void yyerror(NodeId* abr, char* msg) {
+    fprintf(stderr, "%s: line %u column %u\n", msg, nbline, nbchar);
+}
+
+/**
+ * @brief Called once the parser knows a function begins,
+ * before any node of the function is created
+ *
+ * @param previous Node below the function on the parser stack :
+ * DeclVars of the globals for the first function, DeclFoncts else
+ */
+static void stream_function_start(NodeId previous) {
+    if (!STREAM_HANDLER) {
+        return;
+    }
+    if (Node_get(previous)->label == DeclVars) {
+        // First function, the global declarations are complete
+        STREAM_HANDLER(Node_get(previous), STREAM_DATA);
+    }
+    FUNCTION_START = countNodes();
+}
+
+/**
+ * @brief Give a parsed function to the streaming handler, and release it
+ *
+ * @param fonct DeclFonct node
+ * @return NodeId fonct, or NODE_NONE if it was released
+ */
+static NodeId stream_function(NodeId fonct) {
+    if (!STREAM_HANDLER) {
+        return fonct;
+    }
+    STREAM_HANDLER(Node_get(fonct), STREAM_DATA);
+    truncateNodes(FUNCTION_START);
+    return NODE_NONE;
+}
+
+ErrorType parser_bison(Source* source, Node** abr) {
+    NodeId root = NODE_NONE;
+    Scanner_start(source);
+    int retcode = yyparse(&root);
+    Scanner_stop();
+    *abr = Node_get(root);
+    return (
+        retcode == 1 ? ERR_PARSE_SYNTAX
+        : retcode == 2 ? ERR_NO_MEMORY
+        : ERR_NONE
+    );
+}
+
+ErrorType parser_bison_stream(Source* source,
+                              ParserHandler handler, void* data) {
+    Node* root;
+
+    STREAM_HANDLER = handler;
+    STREAM_DATA = data;
+    ErrorType err = parser_bison(source, &root);
+    STREAM_HANDLER = NULL;
+    STREAM_DATA = NULL;
+
+    return err;
+}
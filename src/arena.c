@@ -0,0 +1,63 @@
+#include "arena.h"
+
+#include <stdlib.h>
+
+#define ALIGN_UP(n, a) (((n) + (a) - 1) / (a) * (a))
+
+void Arena_init(Arena* self, size_t chunk_size) {
+    *self = (Arena){
+        .head = NULL,
+        .chunk_size = chunk_size,
+    };
+}
+
+/**
+ * @brief Push a new chunk able to hold at least size bytes
+ *
+ * @param self
+ * @param size Minimal capacity of the chunk
+ * @return ArenaChunk* New head of the arena, NULL if out of memory
+ */
+static ArenaChunk* _Arena_new_chunk(Arena* self, size_t size) {
+    size_t capacity = size > self->chunk_size ? size : self->chunk_size;
+    ArenaChunk* chunk = malloc(sizeof(ArenaChunk) + capacity);
+
+    if (chunk == NULL)
+        return NULL;
+
+    *chunk = (ArenaChunk){
+        .next = self->head,
+        .used = 0,
+        .capacity = capacity,
+    };
+    self->head = chunk;
+
+    return chunk;
+}
+
+void* Arena_alloc(Arena* self, size_t size) {
+    size = ALIGN_UP(size, sizeof(max_align_t));
+    ArenaChunk* chunk = self->head;
+
+    if (chunk == NULL || chunk->capacity - chunk->used < size) {
+        chunk = _Arena_new_chunk(self, size);
+        if (chunk == NULL)
+            return NULL;
+    }
+
+    void* ptr = (char*)chunk->data + chunk->used;
+    chunk->used += size;
+
+    return ptr;
+}
+
+void Arena_free(Arena* self) {
+    ArenaChunk* chunk = self->head;
+
+    while (chunk != NULL) {
+        ArenaChunk* next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+    self->head = NULL;
+}
@@ -0,0 +1,48 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+typedef struct ArenaChunk {
+    struct ArenaChunk* next;
+    size_t used;
+    size_t capacity;
+    max_align_t data[];
+} ArenaChunk;
+
+typedef struct Arena {
+    ArenaChunk* head;  // Chunk currently being filled
+    size_t chunk_size;
+} Arena;
+
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+/**
+ * @brief Initialize an empty arena. No memory is allocated
+ * until the first call to Arena_alloc.
+ *
+ * @param self Arena to initialize
+ * @param chunk_size Size in bytes of each chunk
+ */
+void Arena_init(Arena* self, size_t chunk_size);
+
+/**
+ * @brief Allocate size bytes from the arena (bump pointer).
+ * The returned memory is aligned for any type, and lives until
+ * Arena_free is called.
+ *
+ * @param self Arena object
+ * @param size Size in bytes
+ * @return void* Allocated memory, NULL if out of memory
+ */
+void* Arena_alloc(Arena* self, size_t size);
+
+/**
+ * @brief Release every chunk of the arena at once
+ * (allocated objects are not visited).
+ *
+ * @param self Arena object
+ */
+void Arena_free(Arena* self);
+
+#endif
@@ -13,6 +13,9 @@ ArrayListError ArrayList_init(ArrayList *self, size_t element_size,
         .cmp = cmp,
     };
 
+    if (initial_capacity == 0)
+        return ARRAYLIST_ERR_NONE;
+
     self->arr = malloc(element_size * initial_capacity);
 
     if (self->arr == NULL)
@@ -22,6 +25,13 @@ ArrayListError ArrayList_init(ArrayList *self, size_t element_size,
 }
 
 static ArrayListError _ArrayList_realloc(ArrayList *self, size_t new_capacity) {
+    if (new_capacity == 0) {
+        free(self->arr);
+        self->arr = NULL;
+        self->capacity = 0;
+        return ARRAYLIST_ERR_NONE;
+    }
+
     uint8_t *new_arr = realloc(self->arr, new_capacity * self->element_size);
 
     if (new_arr == NULL)
@@ -43,8 +53,10 @@ static ArrayListError _ArrayList_realloc_extend(ArrayList *self) {
     if (self->len < self->capacity) {
         return ARRAYLIST_ERR_NONE;
     }
-    return _ArrayList_realloc(self,
-                              self->capacity * ARRAYLIST_REALLOC_MULTIPLIER);
+    size_t new_capacity = self->capacity
+                              ? self->capacity * ARRAYLIST_REALLOC_MULTIPLIER
+                              : ARRAYLIST_MIN_CAPACITY;
+    return _ArrayList_realloc(self, new_capacity);
 }
 
 ArrayListError ArrayList_append(ArrayList *self, void *elem) {
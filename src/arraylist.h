@@ -19,6 +19,7 @@ typedef struct ArrayList {
 } ArrayList;
 
 #define ARRAYLIST_REALLOC_MULTIPLIER 2
+#define ARRAYLIST_MIN_CAPACITY 4  // First allocation of an empty ArrayList
 
 #define ARRAYLIST_DECLARE_ARRAY(self, typename, array_name) \
     typename* array_name = (typename*)(self).arr
@@ -28,7 +29,8 @@ typedef struct ArrayList {
  *
  * @param self ArrayList to initialize
  * @param element_size Size of one element
- * @param initial_capacity Preallocation size
+ * @param initial_capacity Preallocation size,
+ * 0 to allocate on the first insertion
  * @param cmp Comparison function used to sort array if needed,
  * if sorting is not used, set to NULL
  * @return ArrayListError
@@ -144,7 +146,7 @@ void ArrayList_resize(ArrayList* self, size_t new_size);
 
 /**
  * @brief Reduce memory usage by reducing capacity
- * to vector's length
+ * to vector's length (an empty vector releases its buffer)
  *
  * @param self
  */
@@ -0,0 +1,459 @@
+#include "astCache.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <linux/limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "intern.h"
+
+static const char AST_CACHE_MAGIC[8] = "TPCAST\0";
+
+#define AST_CACHE_MULTIPLIER 0x9E3779B97F4A7C15ULL
+#define AST_CACHE_CHUNK 1024  // Nodes converted per write
+
+#define AST_CACHE_COUNT(ENUM) +1
+enum { AST_CACHE_NB_LABELS = 0 FOREACH_NODE(AST_CACHE_COUNT) };
+
+static inline uint64_t _AstCache_mix(uint64_t hash, uint64_t word) {
+    hash = (hash ^ word) * AST_CACHE_MULTIPLIER;
+    return hash ^ (hash >> 29);
+}
+
+uint64_t AstCache_hash(const Source* source) {
+    uint64_t hash = _AstCache_mix(0, source->len);
+    uint64_t word;
+    size_t i;
+
+    for (i = 0; i + sizeof(word) <= source->len; i += sizeof(word)) {
+        memcpy(&word, source->text + i, sizeof(word));
+        hash = _AstCache_mix(hash, word);
+    }
+    word = 0;
+    memcpy(&word, source->text + i, source->len - i);
+
+    return _AstCache_mix(hash, word);
+}
+
+/**
+ * @brief Mix a section of a cache file into its checksum, 8 bytes per
+ * step, the last one padded with zeros : a section summed in several
+ * parts gives the same checksum only if the sizes of the parts but the
+ * last one are multiples of 8
+ *
+ * @param sum Checksum of the previous sections
+ * @param data
+ * @param size
+ * @return uint64_t
+ */
+static uint64_t _AstCache_sum(uint64_t sum, const void* data, size_t size) {
+    const char* bytes = data;
+    uint64_t word;
+    size_t i;
+
+    for (i = 0; i + sizeof(word) <= size; i += sizeof(word)) {
+        memcpy(&word, bytes + i, sizeof(word));
+        sum = _AstCache_mix(sum, word);
+    }
+    if (i < size) {
+        word = 0;
+        memcpy(&word, bytes + i, size - i);
+        sum = _AstCache_mix(sum, word);
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Get the path of the cache file of a source
+ *
+ * @param path Buffer of PATH_MAX bytes
+ * @param dir Cache directory
+ * @param hash
+ */
+static void _AstCache_path(char* path, const char* dir, uint64_t hash) {
+    snprintf(path, PATH_MAX, "%s/%016" PRIx64 ".ast", dir, hash);
+}
+
+/**
+ * @brief Convert every node to an AstCacheNode record
+ *
+ * @param out Receives the records, NULL to only sum them
+ * @param nb_nodes countNodes()
+ * @param sum Checksum of the previous sections
+ * @return uint64_t Checksum, with the records
+ */
+static uint64_t _AstCache_write_nodes(Emitter* out, NodeId nb_nodes,
+                                      uint64_t sum) {
+    AstCacheNode chunk[AST_CACHE_CHUNK] = {0};  // chunk[0] is NODE_NONE
+    NodeId len = 1;
+
+    for (NodeId i = 1; i < nb_nodes; ++i) {
+        const Node* node = &NODES[i];
+        chunk[len++] = (AstCacheNode){
+            .firstChild = node->firstChild,
+            .nextSibling = node->nextSibling,
+            .att = node->att,
+            .lineno = node->lineno,
+            .column = node->column,
+            .label = node->label,
+            .type = node->type,
+        };
+        if (len == AST_CACHE_CHUNK) {
+            sum = _AstCache_sum(sum, chunk, sizeof(chunk));
+            if (out) {
+                Emitter_write(out, (const char*)chunk, sizeof(chunk));
+            }
+            len = 0;
+        }
+    }
+    sum = _AstCache_sum(sum, chunk, len * sizeof(AstCacheNode));
+    if (out) {
+        Emitter_write(out, (const char*)chunk, len * sizeof(AstCacheNode));
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Write the strings of the atoms, from atom 1
+ *
+ * @param out Receives the strings, NULL to only sum them
+ * @param nb_atoms Intern_count()
+ * @param sum Checksum of the previous sections
+ * @return uint64_t Checksum, with the strings
+ */
+static uint64_t _AstCache_write_strings(Emitter* out, Atom nb_atoms,
+                                        uint64_t sum) {
+    char chunk[AST_CACHE_CHUNK * sizeof(uint64_t)];
+    size_t len = 0;
+
+    for (Atom atom = 1; atom < nb_atoms; ++atom) {
+        const char* str = Intern_str(atom);
+        size_t left = strlen(str) + 1;
+        while (left) {
+            size_t part = left < sizeof(chunk) - len ? left
+                                                     : sizeof(chunk) - len;
+            memcpy(chunk + len, str, part);
+            str += part;
+            left -= part;
+            len += part;
+            if (len == sizeof(chunk)) {
+                sum = _AstCache_sum(sum, chunk, len);
+                if (out) {
+                    Emitter_write(out, chunk, len);
+                }
+                len = 0;
+            }
+        }
+    }
+    sum = _AstCache_sum(sum, chunk, len);
+    if (out) {
+        Emitter_write(out, chunk, len);
+    }
+
+    return sum;
+}
+
+/**
+ * @brief Check the header of a cache file against the source,
+ * and the size of its sections against the size of the file
+ *
+ * @param header
+ * @param size Size of the file
+ * @param hash
+ * @param source
+ * @return bool
+ */
+static bool _AstCache_check_header(const AstCacheHeader* header, size_t size,
+                                   uint64_t hash, const Source* source) {
+    if (memcmp(header->magic, AST_CACHE_MAGIC, sizeof(AST_CACHE_MAGIC)) ||
+        header->version != AST_CACHE_VERSION ||
+        header->node_size != sizeof(AstCacheNode) ||
+        header->hash != hash ||
+        header->source_len != source->len ||
+        !header->nb_nodes || header->root >= header->nb_nodes ||
+        !header->nb_lines || !header->nb_atoms) {
+        return false;
+    }
+
+    // Cannot overflow (32-bit counts), unlike a sum with strings_size
+    uint64_t fixed = sizeof(AstCacheHeader) +
+                     (uint64_t)header->nb_nodes * sizeof(AstCacheNode) +
+                     (uint64_t)header->nb_lines * sizeof(uint32_t);
+
+    return size >= fixed && header->strings_size == size - fixed;
+}
+
+/**
+ * @brief Check that every field of the saved nodes is in range,
+ * so a damaged file is not followed out of the node array, nor out
+ * of the values the semantic checks expect (label, type, line)
+ *
+ * @param header
+ * @param nodes
+ * @return bool
+ */
+static bool _AstCache_check_nodes(const AstCacheHeader* header,
+                                  const AstCacheNode* nodes) {
+    for (NodeId i = 1; i < header->nb_nodes; ++i) {
+        const AstCacheNode* node = &nodes[i];
+        if (node->firstChild >= header->nb_nodes ||
+            node->nextSibling >= header->nb_nodes ||
+            node->label >= AST_CACHE_NB_LABELS || node->type > type_op ||
+            node->lineno < 0 || (uint32_t)node->lineno > header->nb_lines ||
+            node->column < 0 ||
+            (node->type == type_ident &&
+             node->att.ident >= header->nb_atoms) ||
+            (node->type == type_op && node->att.op > OP_GE) ||
+            (node->type == type_key_word &&
+             node->att.prim_type > type_op)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Check that the saved links make a tree : every node is
+ * reached at most once from the root, so a damaged link can neither
+ * loop nor share a subtree
+ *
+ * @param header
+ * @param nodes
+ * @return bool
+ */
+static bool _AstCache_check_tree(const AstCacheHeader* header,
+                                 const AstCacheNode* nodes) {
+    bool* seen = calloc(header->nb_nodes, sizeof(bool));
+    NodeId* stack = malloc(header->nb_nodes * sizeof(NodeId));
+    uint32_t len = 0;
+    bool tree = seen && stack;
+
+    if (tree && header->root != NODE_NONE) {
+        stack[len++] = header->root;
+        seen[header->root] = true;
+    }
+    while (tree && len) {
+        const AstCacheNode* node = &nodes[stack[--len]];
+        NodeId links[] = {node->firstChild, node->nextSibling};
+        for (int k = 0; k < 2; ++k) {
+            if (links[k] == NODE_NONE) {
+                continue;
+            }
+            if (seen[links[k]]) {
+                tree = false;
+                break;
+            }
+            seen[links[k]] = true;
+            stack[len++] = links[k];
+        }
+    }
+    free(stack);
+    free(seen);
+
+    return tree;
+}
+
+/**
+ * @brief Check that the saved line index fits the source
+ *
+ * @param header
+ * @param lines
+ * @param source
+ * @return bool
+ */
+static bool _AstCache_check_lines(const AstCacheHeader* header,
+                                  const uint32_t* lines,
+                                  const Source* source) {
+    if (lines[0] != 0) {
+        return false;
+    }
+    for (uint32_t i = 1; i < header->nb_lines; ++i) {
+        if (lines[i] <= lines[i - 1] || lines[i] > source->len) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Intern the saved strings again
+ *
+ * @param header
+ * @param strings
+ * @param remap Filled with the atom of each saved atom
+ * @return bool false if the strings do not match their count
+ */
+static bool _AstCache_intern(const AstCacheHeader* header,
+                             const char* strings, Atom* remap) {
+    const char* end = strings + header->strings_size;
+
+    remap[ATOM_NONE] = ATOM_NONE;
+    for (uint32_t i = 1; i < header->nb_atoms; ++i) {
+        size_t len = strnlen(strings, end - strings);
+        if (strings + len == end) {
+            return false;
+        }
+        remap[i] = Intern_add(strings, len);
+        strings += len + 1;
+    }
+
+    return strings == end;
+}
+
+/**
+ * @brief Restore the tree of a mapped cache file
+ *
+ * @param data Content of the file
+ * @param size Size of the file
+ * @param hash
+ * @param source
+ * @param abr
+ * @return bool false if the file does not hold the tree of source
+ */
+static bool _AstCache_restore(const char* data, size_t size, uint64_t hash,
+                              Source* source, Node** abr) {
+    const AstCacheHeader* header = (const AstCacheHeader*)data;
+
+    if (size < sizeof(AstCacheHeader) ||
+        !_AstCache_check_header(header, size, hash, source)) {
+        return false;
+    }
+
+    const AstCacheNode* nodes =
+        (const AstCacheNode*)(data + sizeof(AstCacheHeader));
+    const uint32_t* lines = (const uint32_t*)(nodes + header->nb_nodes);
+    const char* strings = (const char*)(lines + header->nb_lines);
+    uint64_t sum = _AstCache_sum(
+        0, nodes, (size_t)header->nb_nodes * sizeof(AstCacheNode));
+    sum = _AstCache_sum(sum, lines, header->nb_lines * sizeof(uint32_t));
+    sum = _AstCache_sum(sum, strings, header->strings_size);
+
+    if (sum != header->checksum || !_AstCache_check_nodes(header, nodes) ||
+        !_AstCache_check_tree(header, nodes) ||
+        !_AstCache_check_lines(header, lines, source)) {
+        return false;
+    }
+
+    Atom* remap = malloc(header->nb_atoms * sizeof(Atom));
+    if (!remap || !_AstCache_intern(header, strings, remap)) {
+        free(remap);
+        return false;
+    }
+
+    Node* restored = resetNodes(header->nb_nodes);
+    for (NodeId i = 1; i < header->nb_nodes; ++i) {
+        const AstCacheNode* node = &nodes[i];
+        restored[i] = (Node){
+            .firstChild = node->firstChild,
+            .nextSibling = node->nextSibling,
+            .att = node->att,
+            .lineno = node->lineno,
+            .column = node->column,
+            .label = node->label,
+            .type = node->type,
+        };
+        if (node->type == type_ident) {
+            restored[i].att.ident = remap[node->att.ident];
+        }
+    }
+    free(remap);
+
+    // The first line is indexed by Source_load
+    for (uint32_t i = 1; i < header->nb_lines; ++i) {
+        Source_new_line(source, lines[i]);
+    }
+
+    *abr = Node_get(header->root);
+
+    return true;
+}
+
+bool AstCache_load(const char* dir, uint64_t hash,
+                   Source* source, Node** abr) {
+    char path[PATH_MAX];
+    struct stat st;
+    void* data = MAP_FAILED;
+
+    _AstCache_path(path, dir, hash);
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);  // A mapping stays valid after closing its file
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    bool found = _AstCache_restore(data, st.st_size, hash, source, abr);
+    munmap(data, st.st_size);
+
+    return found;
+}
+
+void AstCache_write(Emitter* out, uint64_t hash,
+                    const Source* source, const Node* abr) {
+    AstCacheHeader header = {
+        .version = AST_CACHE_VERSION,
+        .node_size = sizeof(AstCacheNode),
+        .hash = hash,
+        .source_len = source->len,
+        .nb_nodes = countNodes(),
+        .root = Node_id(abr),
+        .nb_lines = ArrayList_get_length(&source->lines),
+        .nb_atoms = Intern_count(),
+    };
+    memcpy(header.magic, AST_CACHE_MAGIC, sizeof(AST_CACHE_MAGIC));
+    for (Atom atom = 1; atom < header.nb_atoms; ++atom) {
+        header.strings_size += strlen(Intern_str(atom)) + 1;
+    }
+    // Summed before writing, as the header comes first
+    uint64_t sum = _AstCache_write_nodes(NULL, header.nb_nodes, 0);
+    sum = _AstCache_sum(sum, source->lines.arr,
+                        header.nb_lines * sizeof(uint32_t));
+    header.checksum = _AstCache_write_strings(NULL, header.nb_atoms, sum);
+
+    Emitter_write(out, (const char*)&header, sizeof(header));
+    _AstCache_write_nodes(out, header.nb_nodes, 0);
+    Emitter_write(out, (const char*)source->lines.arr,
+                  header.nb_lines * sizeof(uint32_t));
+    _AstCache_write_strings(out, header.nb_atoms, 0);
+}
+
+ErrorType AstCache_store(const char* dir, uint64_t hash,
+                         const Source* source, const Node* abr) {
+    char path[PATH_MAX], tmp_path[PATH_MAX + 24];  // path.pid
+    Emitter out;
+
+    // Written aside then renamed, so a concurrent compilation
+    // never reads a partial file
+    _AstCache_path(path, dir, hash);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.%ld", path, (long)getpid());
+    FILE* f = fopen(tmp_path, "wb");
+    if (!f) {
+        return ERR_FILE_OPEN;
+    }
+
+    Emitter_init(&out, f, ASM_COMMENTS_NONE);
+    AstCache_write(&out, hash, source, abr);
+    ErrorType err = Emitter_flush(&out);
+    Emitter_free(&out);
+
+    if (fclose(f) || err || rename(tmp_path, path)) {
+        remove(tmp_path);
+        return ERR_FILE_OPEN;
+    }
+
+    return ERR_NONE;
+}
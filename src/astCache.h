@@ -0,0 +1,110 @@
+/**
+ * @file astCache.h
+ * @brief On-disk cache of syntax trees, so an unchanged source
+ * is neither scanned nor parsed again
+ *
+ */
+
+#ifndef AST_CACHE_H
+#define AST_CACHE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "emitter.h"
+#include "error.h"
+#include "source.h"
+#include "tree.h"
+
+// Bump it whenever the tree built by the parser changes
+#define AST_CACHE_VERSION 2
+
+/**
+ * @brief Saved node : a Node without the fields only used while
+ * parsing (lastSibling) or after it (symbol, expr_type, expr_flags,
+ * reg_need)
+ */
+typedef struct AstCacheNode {
+    NodeId firstChild, nextSibling;
+    Attribut att;
+    int32_t lineno;
+    int32_t column;
+    uint8_t label;
+    uint8_t type;
+    uint16_t unused;  // Always 0
+} AstCacheNode;
+
+/**
+ * @brief Header of a cache file, which is followed by :
+ * - the nodes (nb_nodes AstCacheNode, NODE_NONE included),
+ * - the line index of the source (nb_lines uint32_t),
+ * - the strings of the atoms (nb_atoms - 1 NUL-terminated strings,
+ *   from atom 1), as atoms are only valid in the process that made them.
+ * Sections are fixed-size records in native byte order, read in place
+ * from a mapping of the file (the cache is only valid on the same
+ * machine). A file whose sections do not match their checksum is
+ * ignored, as if it was missing.
+ */
+typedef struct AstCacheHeader {
+    char magic[8];
+    uint32_t version;    // AST_CACHE_VERSION
+    uint32_t node_size;  // sizeof(AstCacheNode)
+    uint64_t hash;       // AstCache_hash of the source
+    uint64_t source_len;
+    uint32_t nb_nodes;
+    NodeId root;
+    uint32_t nb_lines;
+    uint32_t nb_atoms;
+    uint64_t strings_size;
+    uint64_t checksum;  // Of the nodes, lines and strings, in this order
+} AstCacheHeader;
+
+/**
+ * @brief Hash the content of a source, before it is scanned
+ * (not cryptographic, 8 bytes per step)
+ *
+ * @param source
+ * @return uint64_t Key of the source in the cache
+ */
+uint64_t AstCache_hash(const Source* source);
+
+/**
+ * @brief Load the tree of a source from the cache, if it holds it.
+ * On success, the nodes replace the node array, the line index of
+ * source is filled as if it was scanned, and the identifiers are
+ * interned again.
+ *
+ * @param dir Cache directory
+ * @param hash AstCache_hash of source
+ * @param source Loaded, not yet scanned source
+ * @param abr Loaded tree
+ * @return true if the tree was found, false if the source must be parsed
+ */
+bool AstCache_load(const char* dir, uint64_t hash,
+                   Source* source, Node** abr);
+
+/**
+ * @brief Write the tree of a source in the format of a cache file
+ *
+ * @param out
+ * @param hash AstCache_hash of source
+ * @param source Scanned source
+ * @param abr Tree of source
+ */
+void AstCache_write(Emitter* out, uint64_t hash,
+                    const Source* source, const Node* abr);
+
+/**
+ * @brief Save the tree of a source, right after parsing it
+ * (before the symbols are bound to the nodes)
+ *
+ * @param dir Cache directory, must exist
+ * @param hash AstCache_hash of source
+ * @param source Scanned source
+ * @param abr Tree of source
+ * @return ErrorType ERR_FILE_OPEN if the cache file cannot be written
+ */
+ErrorType AstCache_store(const char* dir, uint64_t hash,
+                         const Source* source, const Node* abr);
+
+#endif
@@ -0,0 +1,94 @@
+#include "atommap.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define ATOMMAP_INITIAL_CAPACITY 16
+
+void AtomMap_init(AtomMap* self) {
+    *self = (AtomMap){0};
+}
+
+/**
+ * @brief Index of the first slot to probe for a key
+ * Atoms are consecutive integers, Fibonacci hashing spreads them
+ *
+ * @param self
+ * @param key
+ * @return size_t
+ */
+static size_t _AtomMap_home(const AtomMap* self, Atom key) {
+    return (size_t)((uint32_t)(key * 2654435769u)) & (self->capacity - 1);
+}
+
+/**
+ * @brief Find the slot of a key, or the empty slot where it should be added
+ *
+ * @param self Map with at least one empty slot
+ * @param key
+ * @return AtomMapSlot*
+ */
+static AtomMapSlot* _AtomMap_find(const AtomMap* self, Atom key) {
+    size_t i = _AtomMap_home(self, key);
+
+    while (self->slots[i].key != ATOM_NONE && self->slots[i].key != key) {
+        i = (i + 1) & (self->capacity - 1);
+    }
+
+    return &self->slots[i];
+}
+
+static AtomMapError _AtomMap_realloc(AtomMap* self, size_t new_capacity) {
+    AtomMap old = *self;
+    AtomMapSlot* slots = calloc(new_capacity, sizeof(AtomMapSlot));
+
+    if (slots == NULL)
+        return ATOMMAP_ERR_ALLOC;
+
+    self->slots = slots;
+    self->capacity = new_capacity;
+
+    for (size_t i = 0; i < old.capacity; ++i) {
+        if (old.slots[i].key != ATOM_NONE) {
+            *_AtomMap_find(self, old.slots[i].key) = old.slots[i];
+        }
+    }
+    free(old.slots);
+
+    return ATOMMAP_ERR_NONE;
+}
+
+int AtomMap_get(const AtomMap* self, Atom key) {
+    if (self->len == 0)
+        return -1;
+
+    const AtomMapSlot* slot = _AtomMap_find(self, key);
+
+    return slot->key == ATOM_NONE ? -1 : slot->value;
+}
+
+AtomMapError AtomMap_put(AtomMap* self, Atom key, int value) {
+    assert(key != ATOM_NONE);
+
+    // Keep the load factor under 3/4
+    if ((self->len + 1) * 4 > self->capacity * 3) {
+        size_t new_capacity = self->capacity ? self->capacity * 2
+                                             : ATOMMAP_INITIAL_CAPACITY;
+        if (_AtomMap_realloc(self, new_capacity) < 0)
+            return ATOMMAP_ERR_ALLOC;
+    }
+
+    AtomMapSlot* slot = _AtomMap_find(self, key);
+    if (slot->key == ATOM_NONE) {
+        self->len++;
+    }
+    *slot = (AtomMapSlot){.key = key, .value = value};
+
+    return ATOMMAP_ERR_NONE;
+}
+
+void AtomMap_free(AtomMap* self) {
+    free(self->slots);
+    *self = (AtomMap){0};
+}
@@ -0,0 +1,63 @@
+#ifndef ATOMMAP_H
+#define ATOMMAP_H
+
+#include <stddef.h>
+
+#include "intern.h"
+
+typedef enum AtomMapError {
+    ATOMMAP_ERR_NONE = 0,
+    ATOMMAP_ERR_ALLOC = -1,
+} AtomMapError;
+
+typedef struct AtomMapSlot {
+    Atom key;  // ATOM_NONE if the slot is empty
+    int value;
+} AtomMapSlot;
+
+/**
+ * @brief Open addressing hash table (linear probing)
+ * associating an Atom to an integer, usually an index in an ArrayList
+ */
+typedef struct AtomMap {
+    size_t len;
+    size_t capacity;  // Number of slots, a power of two (or 0)
+    AtomMapSlot* slots;
+} AtomMap;
+
+/**
+ * @brief Initialize an empty map. No memory is allocated
+ * until the first insertion.
+ *
+ * @param self AtomMap to initialize
+ */
+void AtomMap_init(AtomMap* self);
+
+/**
+ * @brief Get the value associated to a key
+ *
+ * @param self AtomMap object
+ * @param key Atom to search
+ * @return int Value associated to key, -1 if the key is absent
+ */
+int AtomMap_get(const AtomMap* self, Atom key);
+
+/**
+ * @brief Associate a value to a key, replacing the previous value if any
+ *
+ * @param self AtomMap object
+ * @param key Atom, must not be ATOM_NONE
+ * @param value Value to associate, must be positive
+ * @return AtomMapError
+ * if error while allocation : ATOMMAP_ERR_ALLOC
+ */
+AtomMapError AtomMap_put(AtomMap* self, Atom key, int value);
+
+/**
+ * @brief Free AtomMap object
+ *
+ * @param self
+ */
+void AtomMap_free(AtomMap* self);
+
+#endif
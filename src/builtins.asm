@@ -56,7 +56,10 @@ getchar:
 putint:
     push rbp
     mov rbp, rsp
-    
+    ; rbx, r12 et r13 appartiennent à l'appelant
+    push rbx
+    push r12
+    push r13
 
     mov r12, 20  ; i
     mov r13, rdi ; number
@@ -96,6 +99,9 @@ putint:
         cmp r12, 20 ; jusqu'a que l'on retourne à la valeur par default
         jne my_putint_2loop
         
+    pop r13
+    pop r12
+    pop rbx
     pop rbp
 
     ret
@@ -103,6 +109,11 @@ putint:
 getint:
     push rbp
     mov rbp, rsp
+    ; r12 à r15 appartiennent à l'appelant
+    push r12
+    push r13
+    push r14
+    push r15
 
     mov r12, 20  ; i    
     mov r13, 0   ; number
@@ -171,6 +182,11 @@ getint:
 
     my_get_int_end:
 
+    lea rsp, [rbp - 32] ; les chiffres lus peuvent rester sur la pile
+    pop r15
+    pop r14
+    pop r13
+    pop r12
     pop rbp
     ret
 
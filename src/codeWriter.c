@@ -11,19 +11,311 @@
 #include "codeWriter.h"
 
 #include <assert.h>
+#include <stdint.h>
 #include <stdio.h>
-#include <string.h>
 
+#include "arraylist.h"
+#include "ir.h"
 #include "registers.h"
 #include "symbol.h"
 #include "symbolTable.h"
 #include "tree.h"
-#include "treeReader.h"
 
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 
-static void CodeWriter_entrypoint(FILE* nasm) {
-    fprintf(
+#define REG_BIT(reg) (1U << (reg))
+
+// rax and rdx are left out of the scratch registers : idiv, returned
+// values and array addresses use them as temporaries
+static const Register SCRATCH[CODEWRITER_NB_SCRATCH] = {
+    RCX, RSI, RDI, R8, R9, R10, R11};
+
+/**
+ * @brief Operands of the expression being evaluated, in registers mode.
+ * The bottom operands are spilled on the stack (in order) when there are
+ * more operands than scratch registers, and loaded back when they are used.
+ */
+static struct {
+    CodegenMode mode;
+    ArrayList operands;  // [Register] Register of each operand, bottom first
+    size_t in_memory;    // Number of bottom operands spilled on the stack
+    unsigned busy;       // REG_BIT of each register holding an operand
+    ArrayList temps;     // [IrTemp] Temp of each operand, bottom first
+} CODEGEN = {.mode = CODEGEN_STACK};
+
+void CodeWriter_select(CodegenMode mode) {
+    CODEGEN.mode = mode;
+    if (!CODEGEN.operands.element_size) {
+        ArrayList_init(&CODEGEN.operands, sizeof(Register), 0, NULL);
+        ArrayList_init(&CODEGEN.temps, sizeof(IrTemp), 0, NULL);
+    }
+}
+
+CodegenMode CodeWriter_get_mode(void) {
+    return CODEGEN.mode;
+}
+
+void CodeWriter_free(void) {
+    ArrayList_free(&CODEGEN.operands);
+    ArrayList_free(&CODEGEN.temps);
+}
+
+static inline bool _CodeWriter_registers(void) {
+    return CODEGEN.mode == CODEGEN_REGISTERS;
+}
+
+/**
+ * @brief Spill the bottom operand held in a register on the stack
+ *
+ * @param nasm
+ */
+static void _CodeWriter_spill(Emitter* nasm) {
+    Register reg = ArrayList_get_v(&CODEGEN.operands, CODEGEN.in_memory,
+                                   Register);
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Plus de registre libre : sauvegarde sur la pile");
+    Emitter_push(nasm, reg);
+    CODEGEN.busy &= ~REG_BIT(reg);
+    CODEGEN.in_memory++;
+}
+
+/**
+ * @brief Spill every operand held in a register on the stack,
+ * before code that does not preserve them (calls, branches)
+ *
+ * @param nasm
+ */
+static void _CodeWriter_spill_all(Emitter* nasm) {
+    while (CODEGEN.in_memory < ArrayList_get_length(&CODEGEN.operands)) {
+        _CodeWriter_spill(nasm);
+    }
+}
+
+/**
+ * @brief Get a free scratch register, spilling an operand if needed
+ *
+ * @param nasm
+ * @return Register
+ */
+static Register _CodeWriter_free_register(Emitter* nasm) {
+    for (;;) {
+        for (int i = 0; i < CODEWRITER_NB_SCRATCH; ++i) {
+            if (!(CODEGEN.busy & REG_BIT(SCRATCH[i]))) {
+                return SCRATCH[i];
+            }
+        }
+        _CodeWriter_spill(nasm);
+    }
+}
+
+/**
+ * @brief Load the top operands back in registers, if they were spilled
+ *
+ * @param nasm
+ * @param count Number of top operands (at most 2)
+ */
+static void _CodeWriter_reload(Emitter* nasm, size_t count) {
+    size_t depth = ArrayList_get_length(&CODEGEN.operands);
+
+    assert(depth >= count && "Missing operand");
+    // At most count - 1 operands are in registers : no spill
+    while (depth - CODEGEN.in_memory < count) {
+        Register reg = _CodeWriter_free_register(nasm);
+        CODEGEN.in_memory--;
+        Emitter_pop(nasm, reg);
+        *(Register*)ArrayList_get(&CODEGEN.operands, CODEGEN.in_memory) = reg;
+        CODEGEN.busy |= REG_BIT(reg);
+    }
+}
+
+/**
+ * @brief Push a value held in a register as the top operand.
+ * In stack mode, the value is pushed on the stack.
+ *
+ * @param nasm
+ * @param reg A free scratch register in registers mode
+ */
+static void _CodeWriter_push_operand(Emitter* nasm, Register reg) {
+    if (!_CodeWriter_registers()) {
+        Emitter_push(nasm, reg);
+        return;
+    }
+    assert(!(CODEGEN.busy & REG_BIT(reg)));
+    ArrayList_append(&CODEGEN.operands, &reg);
+    CODEGEN.busy |= REG_BIT(reg);
+}
+
+/**
+ * @brief Get a register for a new top operand, in registers mode
+ *
+ * @param nasm
+ * @return Register
+ */
+static Register _CodeWriter_new_operand(Emitter* nasm) {
+    Register reg = _CodeWriter_free_register(nasm);
+    _CodeWriter_push_operand(nasm, reg);
+    return reg;
+}
+
+/**
+ * @brief Pop the top operand. The register holding it stays valid until
+ * the next operand is pushed.
+ *
+ * @param nasm
+ * @param scratch Register the operand is popped into in stack mode
+ * @return Register Register holding the operand
+ */
+static Register _CodeWriter_pop_operand(Emitter* nasm, Register scratch) {
+    if (!_CodeWriter_registers()) {
+        Emitter_pop(nasm, scratch);
+        return scratch;
+    }
+    _CodeWriter_reload(nasm, 1);
+    Register reg = ArrayList_pop_v(&CODEGEN.operands, Register);
+    CODEGEN.busy &= ~REG_BIT(reg);
+    return reg;
+}
+
+/**
+ * @brief Pop the two top operands of a binary operation,
+ * in rax (left) and rcx (right) in stack mode
+ *
+ * @param nasm
+ * @param swapped The right operand was evaluated first
+ * @param left
+ * @param right
+ */
+static void _CodeWriter_pop_operands(Emitter* nasm, bool swapped,
+                                     Register* left, Register* right) {
+    if (_CodeWriter_registers()) {
+        _CodeWriter_reload(nasm, 2);
+    }
+    Register top = _CodeWriter_pop_operand(nasm, RCX);
+    Register below = _CodeWriter_pop_operand(nasm, RAX);
+
+    *left = swapped ? top : below;
+    *right = swapped ? below : top;
+}
+
+/**
+ * @brief Pop the top operand into a given register
+ *
+ * @param nasm
+ * @param dst
+ */
+static void _CodeWriter_pop_to(Emitter* nasm, Register dst) {
+    if (!_CodeWriter_registers() ||
+        CODEGEN.in_memory == ArrayList_get_length(&CODEGEN.operands)) {
+        Emitter_pop(nasm, dst);
+        if (_CodeWriter_registers()) {
+            ArrayList_pop(&CODEGEN.operands);
+            CODEGEN.in_memory--;
+        }
+        return;
+    }
+    Register reg = _CodeWriter_pop_operand(nasm, dst);
+    assert(!(CODEGEN.busy & REG_BIT(dst)) && "dst holds an operand");
+    if (reg != dst) {
+        Emitter_mov(nasm, dst, reg);
+    }
+}
+
+/**
+ * @brief Operands at a label, saved by the jumps to it : every path
+ * reaching a label holds the same operands, in the same registers
+ */
+typedef struct LabelState {
+    bool saved;
+    size_t depth;      // Number of operands (temps)
+    size_t in_memory;  // Registers mode
+    Register regs[CODEWRITER_NB_SCRATCH];  // Of the operands above in_memory
+} LabelState;
+
+/**
+ * @brief Save the operands reaching a label from a jump
+ *
+ * @param states [LabelState] of the function
+ * @param label
+ */
+static void _CodeWriter_save_state(ArrayList* states, int label) {
+    LabelState* state = ArrayList_get(states, label);
+    size_t depth = ArrayList_get_length(&CODEGEN.temps);
+
+    if (state->saved) {
+        assert(state->depth == depth && "Operands differ at a label");
+        return;
+    }
+    state->saved = true;
+    state->depth = depth;
+    if (!_CodeWriter_registers()) {
+        return;
+    }
+    state->in_memory = CODEGEN.in_memory;
+    for (size_t i = CODEGEN.in_memory; i < depth; ++i) {
+        state->regs[i - CODEGEN.in_memory] =
+            ArrayList_get_v(&CODEGEN.operands, i, Register);
+    }
+}
+
+/**
+ * @brief Restore the operands saved at a label, when it is only reached
+ * by jumps. The operands of the code before are dropped.
+ *
+ * @param states [LabelState] of the function
+ * @param label
+ */
+static void _CodeWriter_restore_state(const ArrayList* states, int label) {
+    const LabelState* state = ArrayList_get(states, label);
+
+    if (!state->saved) {
+        return;
+    }
+    assert(state->depth <= ArrayList_get_length(&CODEGEN.temps));
+    ArrayList_resize(&CODEGEN.temps, state->depth);
+    if (!_CodeWriter_registers()) {
+        return;
+    }
+    ArrayList_resize(&CODEGEN.operands, state->depth);
+    CODEGEN.in_memory = state->in_memory;
+    CODEGEN.busy = 0;
+    for (size_t i = state->in_memory; i < state->depth; ++i) {
+        Register reg = state->regs[i - state->in_memory];
+        *(Register*)ArrayList_get(&CODEGEN.operands, i) = reg;
+        CODEGEN.busy |= REG_BIT(reg);
+    }
+}
+
+/**
+ * @brief Pop the temp of the top operand
+ *
+ * @param temp Expected temp
+ */
+static void _CodeWriter_use(IrTemp temp) {
+    IrTemp top = ArrayList_pop_v(&CODEGEN.temps, IrTemp);
+    assert(top == temp && "Temps are not used in stack order");
+    (void)top;
+    (void)temp;
+}
+
+/**
+ * @brief Pop the temps of the operands of a binary operation
+ *
+ * @param instr
+ * @return bool The right operand is on top, above the left one
+ */
+static bool _CodeWriter_use_operands(const IrInstr* instr) {
+    if (instr->flags & IR_IMM_B) {
+        _CodeWriter_use(instr->a);
+        return false;
+    }
+    bool swapped = ArrayList_get_v(&CODEGEN.temps, -1, IrTemp) == instr->a;
+    _CodeWriter_use(swapped ? instr->a : instr->b);
+    _CodeWriter_use(swapped ? instr->b : instr->a);
+    return swapped;
+}
+
+static void CodeWriter_entrypoint(Emitter* nasm) {
+    Emitter_puts(
         nasm,
         "_start:\n"
         "call main\n"
@@ -32,12 +324,12 @@ static void CodeWriter_entrypoint(FILE* nasm) {
         "syscall\n\n");
 }
 
-void CodeWriter_Init_File(FILE* nasm, const SymbolTable* globals) {
+void CodeWriter_Init_File(Emitter* nasm, const SymbolTable* globals) {
     assert(
         globals->type == SYMBOL_TABLE_GLOBAL &&
         "SymbolTable should be the program's global");
 
-    fprintf(
+    Emitter_printf(
         nasm,
         "global _start\n"
         "section .bss\n"
@@ -47,13 +339,13 @@ void CodeWriter_Init_File(FILE* nasm, const SymbolTable* globals) {
     CodeWriter_entrypoint(nasm);
 }
 
-static const char* _CodeWriter_Node_To_Ope(const Node* node) {
-    switch (node->att.byte) {
-        case '+':
+static const char* _CodeWriter_Operator_To_Ope(Operator op) {
+    switch (op) {
+        case OP_ADD:
             return "add";
-        case '-':
+        case OP_SUB:
             return "sub";
-        case '*':
+        case OP_MUL:
             return "imul";
         default:
             assert(0 && "We shoudn't be there");
@@ -61,285 +353,344 @@ static const char* _CodeWriter_Node_To_Ope(const Node* node) {
 }
 
 /**
- * @brief Generate a unique label for boolean expressions operations
+ * @brief Logical not operation.
+ * Expects the value to negate to be on the top of the stack.
  *
- * @return int
+ * @param nasm Emitter to write into
  */
-static int _CodeWriter_get_bool_label(void) {
-    static int label = 0;
-    return label++;
+static void _CodeWriter_Ope_Bool_Not(Emitter* nasm) {
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Négation logique de la dernière valeur de la pile");
+    Register reg = _CodeWriter_pop_operand(nasm, RDI);
+    Register result = _CodeWriter_registers() ? reg : RAX;
+    Emitter_printf(
+        nasm,
+        "cmp %s, 0\n"
+        "sete al\n"       // (Set if Equals) al = 1 if reg == 0, 0 otherwise
+        "movzx %s, al\n",  // Adds 0s to the left of the register
+        Register_to_str(reg), Register_to_str(result));
+    _CodeWriter_push_operand(nasm, result);
+    Emitter_puts(nasm, "\n");
 }
 
 /**
- * @brief Write code for a boolean logical AND operation
- * Subexpressions are evaluated recursively, while
- * jumping to the end if the first subexpression is false.
- * (lazy evaluation)
- * Childs of the node shouldn't be already evaluated, as they
- * will be evaluated in this function.
+ * @brief Write a division or a modulo of two operands in registers
+ * (registers mode) : idiv divides rdx:rax
  *
  * @param nasm
- * @param node And node
- * @param prog
- * @param func
+ * @param op OP_DIV or OP_MOD
+ * @param swapped
  */
-static void _CodeWriter_BooleanAnd(FILE* nasm,
-                                   const Tree node,
-                                   const ProgramST* prog,
-                                   const FunctionST* func) {
-    assert(node->label == And);
+static void _CodeWriter_Ope_Div(Emitter* nasm, Operator op, bool swapped) {
+    Register left, right;
 
-    int label = _CodeWriter_get_bool_label();
-
-    TreeReader_Expr(prog, FIRSTCHILD(node), nasm, func);
-    fprintf(
-        nasm,
-        "; Evaluation de l'expression booléenne gauche \n"
-        "pop rax\n"
-        "cmp rax, 0\n"
-        "je .bool_false_%d\n",
-        label);
-    TreeReader_Expr(prog, SECONDCHILD(node), nasm, func);
-    fprintf(
-        nasm,
-        "; Evaluation de l'expression booléenne droite \n"
-        "pop rax\n"
-        "cmp rax, 0\n"
-        "je .bool_false_%d\n",
-        label);
-    fprintf(
+    _CodeWriter_pop_operands(nasm, swapped, &left, &right);
+    Emitter_mov(nasm, RAX, left);
+    Emitter_printf(
         nasm,
-        "push 1\n"
-        "jmp .bool_end_%d\n"
-        ".bool_false_%d:\n"
-        "push 0\n"
-        ".bool_end_%d:\n\n",
-        label, label, label);
+        "cqo\n"
+        "idiv %s\n",
+        Register_to_str(right));
+    Emitter_mov(nasm, left, (op == OP_MOD) ? RDX : RAX);
+    _CodeWriter_push_operand(nasm, left);
+    Emitter_puts(nasm, "\n");
 }
 
 /**
- * @brief Write code for a boolean logical OR operation
- * Subexpressions are evaluated recursively, while
- * jumping to the end if the first subexpression is true.
- * (lazy evaluation)
- * Childs of the node shouldn't be already evaluated, as they
- * will be evaluated in this function.
+ * @brief Write an operation of the top operand and an immediate
  *
  * @param nasm
- * @param node
- * @param prog
- * @param func
+ * @param op OP_ADD, OP_SUB or OP_MUL
+ * @param imm
  */
-static void _CodeWriter_BooleanOr(FILE* nasm,
-                                  const Tree node,
-                                  const ProgramST* prog,
-                                  const FunctionST* func) {
-    assert(node->label == Or);
+static void _CodeWriter_Ope_Imm(Emitter* nasm, Operator op, long imm) {
+    Register reg = _CodeWriter_pop_operand(nasm, RAX);
+    const char* name = Register_to_str(reg);
 
-    int label = _CodeWriter_get_bool_label();
+    if (op == OP_MUL) {
+        Emitter_printf(nasm, "imul %s, %s, %ld\n", name, name, imm);
+    } else {
+        Emitter_printf(nasm, "%s %s, %ld\n", _CodeWriter_Operator_To_Ope(op),
+                       name, imm);
+    }
+    _CodeWriter_push_operand(nasm, reg);
+    Emitter_puts(nasm, "\n");
+}
 
-    TreeReader_Expr(prog, FIRSTCHILD(node), nasm, func);
-    fprintf(
-        nasm,
-        "; Evaluation de l'expression booléenne gauche \n"
-        "pop rax\n"
-        "cmp rax, 0\n"
-        "jne .bool_true_%d\n",
-        label);
-    TreeReader_Expr(prog, SECONDCHILD(node), nasm, func);
-    fprintf(
-        nasm,
-        "; Evaluation de l'expression booléenne droite \n"
-        "pop rax\n"
-        "cmp rax, 0\n"
-        "jne .bool_true_%d\n",
-        label);
-    fprintf(
-        nasm,
-        "push 0\n"
-        "jmp .bool_end_%d\n"
-        ".bool_true_%d:\n"
-        "push 1\n"
-        ".bool_end_%d:\n\n",
-        label, label, label);
+/**
+ * @brief Compute the magic number of a signed division by a constant
+ * (Hacker's Delight, 10-1) : n / divisor is the high half of
+ * n * multiplier, shifted right by shift, plus one if it is negative
+ *
+ * @param divisor |divisor| >= 2, not a power of two
+ * @param multiplier
+ * @param shift
+ */
+static void _CodeWriter_magic(long divisor, long* multiplier, int* shift) {
+    const uint64_t two63 = UINT64_C(1) << 63;
+    uint64_t ad = divisor < 0 ? -(uint64_t)divisor : (uint64_t)divisor;
+    uint64_t t = two63 + ((uint64_t)divisor >> 63);
+    uint64_t anc = t - 1 - t % ad;  // |nc|
+    uint64_t q1 = two63 / anc, r1 = two63 - q1 * anc;
+    uint64_t q2 = two63 / ad, r2 = two63 - q2 * ad;
+    uint64_t delta;
+    int p = 63;
+
+    do {
+        ++p;
+        q1 *= 2;
+        r1 *= 2;
+        if (r1 >= anc) {
+            ++q1;
+            r1 -= anc;
+        }
+        q2 *= 2;
+        r2 *= 2;
+        if (r2 >= ad) {
+            ++q2;
+            r2 -= ad;
+        }
+        delta = ad - r2;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+    *multiplier = (long)(divisor < 0 ? -(q2 + 1) : q2 + 1);
+    *shift = p - 64;
 }
 
-void CodeWriter_Ope_Bool_Not(FILE* nasm) {
-    fprintf(
-        nasm,
-        "; Négation logique de la dernière valeur de la pile\n"
-        "pop rdi\n"
-        "cmp rdi, 0\n"
-        "sete al\n"        // (Set if Equals) al = 1 if rdi == 0, 0 otherwise
-        "movzx rax, al\n"  // Adds 0s to the left of the register
-        "push rax\n\n");
-}
-
-void CodeWriter_Ope_Bool(FILE* nasm,
-                         const Tree node,
-                         const ProgramST* prog,
-                         const FunctionST* func) {
-    switch (node->label) {
-        case And:
-            _CodeWriter_BooleanAnd(nasm, node, prog, func);
-            break;
-        case Or:
-            _CodeWriter_BooleanOr(nasm, node, prog, func);
-            break;
-        default:
-            assert(0 && "We shoudn't be there\n");
+/**
+ * @brief Write a division or a modulo of the top operand by a constant
+ * without idiv. A power of two is a shift (or a mask) of the operand
+ * biased by divisor - 1 when it is negative, so that it rounds toward
+ * zero; another divisor is a multiplication by its magic number.
+ * rax and rdx are the temporaries.
+ *
+ * @param nasm
+ * @param op OP_DIV or OP_MOD
+ * @param divisor |divisor| >= 2
+ */
+static void _CodeWriter_Ope_Div_Imm(Emitter* nasm, Operator op,
+                                    long divisor) {
+    Register reg = _CodeWriter_pop_operand(nasm, RCX);
+    const char* name = Register_to_str(reg);
+    uint64_t abs = divisor < 0 ? -(uint64_t)divisor : (uint64_t)divisor;
+
+    if (!(abs & (abs - 1))) {
+        int k = __builtin_ctzl(abs);
+        Emitter_mov(nasm, RAX, reg);
+        Emitter_printf(nasm,
+                       "sar rax, 63\n"
+                       "shr rax, %d\n"
+                       "add rax, %s\n",
+                       64 - k, name);
+        if (op == OP_MOD) {
+            Emitter_printf(nasm, "and rax, %ld\nsub %s, rax\n",
+                           -(long)abs, name);
+        } else {
+            Emitter_printf(nasm, "sar rax, %d\n", k);
+            if (divisor < 0) {
+                Emitter_puts(nasm, "neg rax\n");
+            }
+            Emitter_mov(nasm, reg, RAX);
+        }
+    } else {
+        long multiplier;
+        int shift;
+        _CodeWriter_magic(divisor, &multiplier, &shift);
+        Emitter_mov_imm(nasm, RAX, multiplier);
+        Emitter_printf(nasm, "imul %s\n", name);
+        if (divisor > 0 && multiplier < 0) {
+            Emitter_printf(nasm, "add rdx, %s\n", name);
+        } else if (divisor < 0 && multiplier > 0) {
+            Emitter_printf(nasm, "sub rdx, %s\n", name);
+        }
+        if (shift) {
+            Emitter_printf(nasm, "sar rdx, %d\n", shift);
+        }
+        Emitter_puts(nasm,
+                     "mov rax, rdx\n"
+                     "shr rax, 63\n"
+                     "add rdx, rax\n");
+        if (op == OP_MOD) {
+            Emitter_printf(nasm, "imul rdx, rdx, %ld\nsub %s, rdx\n",
+                           divisor, name);
+        } else {
+            Emitter_mov(nasm, reg, RDX);
+        }
     }
+    _CodeWriter_push_operand(nasm, reg);
+    Emitter_puts(nasm, "\n");
 }
 
-void CodeWriter_Ope_Arith(FILE* nasm, const Node* node) {
-    if (node->att.byte == '/' || node->att.byte == '%') {
-        fprintf(
-            nasm,
-            "; Operation basique sur les 2 dernieres valeurs de la pile\n"
-            "mov rdx, 0\n"
-            "pop rcx\n"
-            "pop rax\n"
-            "cqo\n"
-            "idiv rcx\n"
-            "push %s\n\n",
-            (node->att.byte == '%') ? "rdx" : "rax");
+/**
+ * @brief Evaluate an arithmetic binary operation
+ * Its operands should be evaluated before :
+ * pop two values from the stack, apply the operation and push the result.
+ *
+ * @param nasm
+ * @param instr IR_BINARY
+ * @param swapped The right operand was evaluated first (registers mode)
+ */
+static void _CodeWriter_Ope_Arith(Emitter* nasm, const IrInstr* instr,
+                                  bool swapped) {
+    Operator op = instr->oper;
+
+    Emitter_comment(
+        nasm, ASM_COMMENTS_FULL,
+        "; Operation basique sur les 2 dernieres valeurs de la pile");
+    if ((instr->flags & IR_IMM_B) && (op == OP_DIV || op == OP_MOD)) {
+        _CodeWriter_Ope_Div_Imm(nasm, op, instr->imm);
         return;
     }
-    const char* ope = _CodeWriter_Node_To_Ope(node);
-    fprintf(
-        nasm,
-        "; Operation basique sur les 2 dernieres valeurs de la pile\n"
-        "pop rcx\n"
-        "pop rax\n"
-        "%s rax, rcx\n"
-        "push rax\n\n",
-        ope);
-}
-
-void CodeWriter_Ope_Unaire(FILE* nasm, const Node* node) {
-    if (node->att.byte == '-') {
-        fprintf(
+    if (instr->flags & IR_IMM_B) {
+        _CodeWriter_Ope_Imm(nasm, op, instr->imm);
+        return;
+    }
+    if ((op == OP_DIV || op == OP_MOD) && _CodeWriter_registers()) {
+        _CodeWriter_Ope_Div(nasm, op, swapped);
+        return;
+    }
+    if (op == OP_DIV || op == OP_MOD) {
+        Emitter_puts(nasm, "mov rdx, 0\n");
+        Emitter_pop(nasm, RCX);
+        Emitter_pop(nasm, RAX);
+        Emitter_puts(
             nasm,
-            "; Operation oposé la derniere valeur de la pile\n"
-            "pop rax\n"
-            "neg rax\n"
-            "push rax\n\n");
+            "cqo\n"
+            "idiv rcx\n");
+        Emitter_push(nasm, (op == OP_MOD) ? RDX : RAX);
+        Emitter_puts(nasm, "\n");
+        return;
     }
+    const char* ope = _CodeWriter_Operator_To_Ope(op);
+    Register left, right;
+    _CodeWriter_pop_operands(nasm, swapped, &left, &right);
+    Emitter_printf(nasm, "%s %s, %s\n", ope, Register_to_str(left),
+                   Register_to_str(right));
+    _CodeWriter_push_operand(nasm, left);
+    Emitter_puts(nasm, "\n");
 }
 
-void CodeWriter_ConstantNumber(FILE* nasm, const Node* node) {
-    fprintf(
-        nasm,
-        "; Ajout d'une constante numérique sur la pile\n"
-        "push %d\n",
-        node->att.num);
+static void _CodeWriter_Ope_Unaire(Emitter* nasm) {
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Operation oposé la derniere valeur de la pile");
+    Register reg = _CodeWriter_pop_operand(nasm, RAX);
+    Emitter_printf(nasm, "neg %s\n", Register_to_str(reg));
+    _CodeWriter_push_operand(nasm, reg);
+    Emitter_puts(nasm, "\n");
 }
 
-void CodeWriter_ConstantCharacter(FILE* nasm, const Node* node) {
-    fprintf(
-        nasm,
-        "; Ajout d'un caractère litéral sur la pile\n"
-        "push %d\n\n",
-        node->att.byte);
+/**
+ * @brief Write a constant to the nasm file.
+ * Push the constant value to the stack.
+ *
+ * @param nasm Emitter to write into
+ * @param instr IR_CONST
+ */
+static void _CodeWriter_Constant(Emitter* nasm, const IrInstr* instr) {
+    if (instr->type == type_byte) {
+        Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                        "; Ajout d'un caractère litéral sur la pile");
+    } else {
+        Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                        "; Ajout d'une constante numérique sur la pile");
+    }
+    if (_CodeWriter_registers()) {
+        Emitter_mov_imm(nasm, _CodeWriter_new_operand(nasm), instr->imm);
+    } else {
+        Emitter_push_imm(nasm, instr->imm);
+    }
+    if (instr->type == type_byte) {
+        Emitter_puts(nasm, "\n");
+    }
 }
 
 /**
- * @brief Auxilliary function to call a function with its arguments,
- * in the opposite order.
- * Recursively go to the last argument, and while going back, evaluate
- * the arguments and push them on the stack.
+ * @brief Write code to call a function with its arguments.
+ * The arguments are evaluated before, from the last one to the first one
+ * (the first one is on the top of the stack). Its result is pushed
+ * if it is used.
  *
- * @param nasm
- * @param node
- * @param symtable
- * @param func
- * @param symbol
+ * @param nasm Emitter to write to
+ * @param instr IR_CALL
  */
-static void _CodeWriter_CallFunction_aux(FILE* nasm,
-                                         Node* node,
-                                         const ProgramST* symtable,
-                                         const FunctionST* func) {
-    if (node == NULL) {
-        return;
-    }
+static void _CodeWriter_CallFunction(Emitter* nasm, const IrInstr* instr) {
+    const char* name = Intern_str(instr->callee);
+    int nb_args = instr->number;
 
-    _CodeWriter_CallFunction_aux(nasm, node->nextSibling, symtable, func);
+    Emitter_comment(nasm, ASM_COMMENTS_BRIEF,
+                    ";;; Appel de la fonction %s ;;;", name);
 
-    TreeReader_Expr(symtable, node, nasm, func);
-}
+    // The called function does not preserve the scratch registers
+    _CodeWriter_spill_all(nasm);
 
-void CodeWriter_CallFunction(
-    FILE* nasm,
-    Node* node,
-    const ProgramST* symtable,
-    const FunctionST* caller) {
-    const Symbol* symbol = ST_resolve_from_node(symtable, caller, node);
+    // compare to 6 beacause after 6 parameters
+    // we need to keep them on the stack
+    int nb_params = MIN(nb_args, 6);
 
-    assert(
-        node->label == Ident &&
-        "Node should be an Ident node (function call)");
-    assert(
-        symbol->symbol_type == SYMBOL_FUNCTION &&
-        "Symbol should be a function");
-    assert(node->firstChild != NULL);
-
-    fprintf(nasm, ";;; Appel de la fonction %s ;;;\n", symbol->identifier);
-
-    const FunctionST* callee = FunctionST_get_from_name(symtable,
-                                                        symbol->identifier);
-
-    if (node->firstChild->label != EmptyArgs) {
-        // Call function with arguments
-        _CodeWriter_CallFunction_aux(nasm, node->firstChild->firstChild,
-                                     symtable, caller);
-
-        // compare to 6 beacause after 6 parameters
-        // we need to keep them on the stack
-        int nb_params = MIN(FunctionST_get_param_count(callee), 6);
-
-        for (int i = 0; i < nb_params; ++i) {
-            // const Symbol* param = FunctionST_get_param(callee, i);
-            fprintf(
-                nasm,
-                "pop %s\n",
-                Register_to_str(Register_param_to_reg(i)));
-        }
+    for (int i = 0; i < nb_params; ++i) {
+        _CodeWriter_pop_to(nasm, Register_param_to_reg(i));
     }
 
-    fprintf(
+    Emitter_printf(
         nasm,
         //"and rsp, -16\n"
-        "call %s\n", symbol->identifier);
+        "call %s\n", name);
 
-    if (FunctionST_get_param_count(callee) > 6) {
+    if (nb_args > 6) {
         // Pop arguments if they are more than 6
-        fprintf(
+        Emitter_printf(
             nasm,
             "add rsp, %d\n",
             // ! 8 bytes per parameter hardcoded
-            (FunctionST_get_param_count(callee) - 6) * 8);
+            (nb_args - 6) * 8);
+        if (_CodeWriter_registers()) {
+            ArrayList_resize(&CODEGEN.operands,
+                             ArrayList_get_length(&CODEGEN.operands) -
+                                 (nb_args - 6));
+            CODEGEN.in_memory -= nb_args - 6;
+        }
     }
-    fprintf(
-        nasm, ";;; Fin de l'appel de la fonction %s ;;;\n\n",
-        symbol->identifier);
-}
-
-void CodeWriter_CallFunctionAsExpression(
-    FILE* nasm,
-    Node* callee_node,
-    const ProgramST* symtable,
-    const FunctionST* caller) {
-    const FunctionST* callee = FunctionST_get_from_name(symtable,
-                                                        callee_node->att.ident);
-
-    CodeWriter_CallFunction(nasm, callee_node, symtable, caller);
+    Emitter_comment(
+        nasm, ASM_COMMENTS_BRIEF, ";;; Fin de l'appel de la fonction %s ;;;",
+        name);
+    Emitter_puts(nasm, "\n");
 
+    if (!IrInstr_has_dst(instr)) {
+        return;
+    }
     // Push result on stack
-    assert(callee->ret_type != type_void);
-    fprintf(
-        nasm,
-        "; Push valeur de retour sur la pile\n"
-        "push rax\n");
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Push valeur de retour sur la pile");
+    if (_CodeWriter_registers()) {
+        Emitter_mov(nasm, _CodeWriter_new_operand(nasm), RAX);
+    } else {
+        Emitter_push(nasm, RAX);
+    }
+}
+
+/**
+ * @brief Push the value of a variable on the stack.
+ * Only the low byte of a char is written (see CodeWriter_WriteValue),
+ * so it is sign-extended while loaded.
+ *
+ * @param nasm
+ * @param address
+ * @param type Type of the variable
+ */
+static void _CodeWriter_push_var(Emitter* nasm, Address address,
+                                 type_t type) {
+    if (_CodeWriter_registers()) {
+        Register reg = _CodeWriter_new_operand(nasm);
+        if (type == type_byte) {
+            Emitter_load_byte(nasm, reg, address);
+        } else {
+            Emitter_load(nasm, reg, address);
+        }
+    } else if (type == type_byte) {
+        Emitter_load_byte(nasm, RAX, address);
+        Emitter_push(nasm, RAX);
+    } else {
+        Emitter_push_mem(nasm, address);
+    }
 }
 
 /**
@@ -348,58 +699,45 @@ void CodeWriter_CallFunctionAsExpression(
  * Otherwise it is on the stack already, and we need to push it again
  *
  * @param nasm
- * @param node
- * @param symtable
- * @param func
+ * @param symbol Parameter
+ * @param type Type of the value (an int for the address of an array)
  */
-static void _CodeWriter_loadFunctionParam(
-    FILE* nasm, Node* node, const ProgramST* symtable,
-    const FunctionST* func) {
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
-
-    fprintf(
-        nasm,
-        "; Chargement de l'argument '%s' sur la tête de pile\n"
-        "push qword [rbp %+d]\n",
-        symbol->identifier,
-        symbol->addr);
+static void _CodeWriter_loadFunctionParam(Emitter* nasm,
+                                          const Symbol* symbol,
+                                          type_t type) {
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Chargement de l'argument '%s' sur la tête de pile",
+                    Intern_str(symbol->identifier));
+    _CodeWriter_push_var(nasm, (Address){RBP, symbol->addr}, type);
 }
 
 /**
  * @brief Compute the address of an array and save it in ``rdx`` register
  *
  * @param nasm
- * @param node Ident node of the array
- * @param symtable
- * @param func
+ * @param symbol Array
  */
-static void _CodeWriter_ComputeArrayAddress(FILE* nasm,
-                                            Node* node,
-                                            const ProgramST* symtable,
-                                            const FunctionST* func) {
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
-
-    fprintf(
-        nasm,
-        "; Chargement de l'adresse du tableau '%s' dans rdx\n",
-        symbol->identifier);
+static void _CodeWriter_ComputeArrayAddress(Emitter* nasm,
+                                            const Symbol* symbol) {
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Chargement de l'adresse du tableau '%s' dans rdx",
+                    Intern_str(symbol->identifier));
     // rdx = Array address
     if (symbol->is_static) {
-        fprintf(
+        Emitter_printf(
             nasm,
             "mov rdx, global_vars + %d\n",
             symbol->addr);
+    } else if (symbol->is_param && _CodeWriter_registers()) {
+        Emitter_load(nasm, RDX, (Address){RBP, symbol->addr});
     } else if (symbol->is_param) {
-        _CodeWriter_loadFunctionParam(nasm, node, symtable, func);
-        fprintf(
-            nasm,
-            "pop rdx\n");
+        _CodeWriter_loadFunctionParam(nasm, symbol, type_num);
+        Emitter_pop(nasm, RDX);
     } else /* symbol is local */ {
-        fprintf(
-            nasm,
-            "lea rdx, [rbp %+d]; Calcul de l'adresse de %s[0] dans la pile\n",
-            symbol->addr,
-            symbol->identifier);
+        Emitter_printf(nasm, "lea rdx, [rbp %+d]", symbol->addr);
+        Emitter_end_line(nasm, ASM_COMMENTS_FULL,
+                         "; Calcul de l'adresse de %s[0] dans la pile",
+                         Intern_str(symbol->identifier));
     }
 }
 
@@ -408,414 +746,645 @@ static void _CodeWriter_ComputeArrayAddress(FILE* nasm,
  * pass it as an argument to a function.
  *
  * @param nasm
- * @param node
- * @param symtable
- * @param func
+ * @param symbol Array
  */
-static void _CodeWriter_LoadArrayAddress(FILE* nasm,
-                                         Node* node,
-                                         const ProgramST* symtable,
-                                         const FunctionST* func) {
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
-
-    _CodeWriter_ComputeArrayAddress(nasm, node, symtable, func);
+static void _CodeWriter_LoadArrayAddress(Emitter* nasm,
+                                         const Symbol* symbol) {
+    _CodeWriter_ComputeArrayAddress(nasm, symbol);
 
-    fprintf(
-        nasm,
-        "; Chargement de l'adresse du tableau '%s' sur la tête de pile\n",
-        symbol->identifier);
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Chargement de l'adresse du tableau '%s' "
+                    "sur la tête de pile",
+                    Intern_str(symbol->identifier));
 
-    fprintf(
-        nasm,
-        "push rdx\n\n");
+    if (_CodeWriter_registers()) {
+        Emitter_mov(nasm, _CodeWriter_new_operand(nasm), RDX);
+    } else {
+        Emitter_push(nasm, RDX);
+    }
+    Emitter_puts(nasm, "\n");
 }
 
 /**
- * @brief Compute the address of an indexed element of an array,
- * and push it on the stack.
+ * @brief Compute the address of an indexed element of an array from
+ * the index on the stack, and push it on the stack instead.
  * Should be used before loading or writing an element of an array
  *
  * @param nasm
- * @param node ArrayLR node
- * @param symtable
- * @param func
- */
-static void _CodeWriter_ComputeArrayElementAddress(FILE* nasm,
-                                                   Node* node,
-                                                   const ProgramST* symtable,
-                                                   const FunctionST* func) {
-    assert(node->label == ArrayLR && node->firstChild != NULL);
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
-
-    fprintf(
-        nasm,
-        "; Calcul de l'expression d'indexation du tableau '%s'\n",
-        symbol->identifier);
-
-    TreeReader_Expr(symtable, node->firstChild, nasm, func);
-
-    fprintf(
-        nasm,
-        "pop rax\n"  // rax = Index
-    );
+ * @param symbol Array
+ */
+static void _CodeWriter_ComputeArrayElementAddress(Emitter* nasm,
+                                                   const Symbol* symbol) {
+    Register index = _CodeWriter_pop_operand(nasm, RAX);
 
-    _CodeWriter_ComputeArrayAddress(nasm, node, symtable, func);
+    _CodeWriter_ComputeArrayAddress(nasm, symbol);
 
-    fprintf(
-        nasm,
-        "; Calcul de l'adresse d'un élément du tableau (%s) '%s'\n",
+    Emitter_comment(
+        nasm, ASM_COMMENTS_FULL,
+        "; Calcul de l'adresse d'un élément du tableau (%s) '%s'",
         symbol->is_static ? "global" : symbol->is_param ? "paramétré"
                                                         : "local",
-        symbol->identifier);
-
-    fprintf(
-        nasm,
-        // lea : Compute effective address, without dereferencing
-        // (mov with operations)
-        "lea rax, [rdx + rax * %d]; Calcul de l'adresse de l'élément indexé\n"
-        "push rax\n",
-        symbol->type_size);
+        Intern_str(symbol->identifier));
+
+    // lea : Compute effective address, without dereferencing
+    // (mov with operations)
+    Emitter_printf(nasm, "lea %s, [rdx + %s * %d]", Register_to_str(index),
+                   Register_to_str(index), symbol->type_size);
+    Emitter_end_line(nasm, ASM_COMMENTS_FULL,
+                     "; Calcul de l'adresse de l'élément indexé");
+    _CodeWriter_push_operand(nasm, index);
 }
 
 /**
  * @brief Load an element of an indexed array on the stack
  *
  * @param nasm
- * @param node ArrayLR node
- * @param symtable
- * @param func
+ * @param instr IR_LOAD_ELEM
  */
-static void _CodeWriter_LoadArray(FILE* nasm,
-                                  Node* node,
-                                  const ProgramST* symtable,
-                                  const FunctionST* func) {
-    assert(node->label == ArrayLR);
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
-
-    _CodeWriter_ComputeArrayElementAddress(nasm, node, symtable, func);
-
-    fprintf(
-        nasm,
-        "; Chargement d'un élément du tableau '%s' sur la tête de pile\n"
-        "pop rax\n"
-        "push qword [rax]\n\n",
-        symbol->identifier);
+static void _CodeWriter_LoadArray(Emitter* nasm, const IrInstr* instr) {
+    const Symbol* symbol = instr->symbol;
+
+    _CodeWriter_ComputeArrayElementAddress(nasm, symbol);
+
+    Emitter_comment(
+        nasm, ASM_COMMENTS_FULL,
+        "; Chargement d'un élément du tableau '%s' sur la tête de pile",
+        Intern_str(symbol->identifier));
+    Register address = _CodeWriter_pop_operand(nasm, RAX);
+    _CodeWriter_push_var(nasm, (Address){address, 0}, instr->type);
+    Emitter_puts(nasm, "\n");
 }
 
 /**
- * @brief Load a value on the stack
+ * @brief Load a value on the stack.
+ * If the variable is kept in a register, copy it.
+ * If the variable is a global variable, use bss section.
+ * If the variable is a local variable, use the stack.
+ * If the variable is a parameter, use registers.
+ * A char is accessed as a single byte.
  *
  * @param nasm
- * @param node Ident node, but not an array
- * @param symtable
- * @param func
- */
-static void _CodeWriter_LoadValue(FILE* nasm, Node* node,
-                                  const ProgramST* symtable,
-                                  const FunctionST* func) {
-    assert(node->label == Ident && node->firstChild == NULL);
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
-
-    if (symbol->is_param) {
-        _CodeWriter_loadFunctionParam(nasm, node, symtable, func);
+ * @param instr IR_LOAD
+ */
+static void _CodeWriter_LoadValue(Emitter* nasm, const IrInstr* instr) {
+    const Symbol* symbol = instr->symbol;
+
+    if (instr->number) {
+        Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                        "; Chargement de '%s' (%s) sur la tête de pile",
+                        Intern_str(symbol->identifier),
+                        Register_to_str(instr->number));
+        if (_CodeWriter_registers()) {
+            Emitter_mov(nasm, _CodeWriter_new_operand(nasm), instr->number);
+        } else {
+            Emitter_push(nasm, instr->number);
+        }
+    } else if (symbol->is_param) {
+        _CodeWriter_loadFunctionParam(nasm, symbol, instr->type);
     } else if (symbol->is_static) {
-        fprintf(
-            nasm,
-            "; Chargement de la variable globale '%s' sur la tête de pile\n"
-            "push qword [global_vars + %d]\n",
-            symbol->identifier,
-            symbol->addr);
+        Emitter_comment(
+            nasm, ASM_COMMENTS_FULL,
+            "; Chargement de la variable globale '%s' sur la tête de pile",
+            Intern_str(symbol->identifier));
+        _CodeWriter_push_var(nasm, (Address){REG_GLOBALS, symbol->addr},
+                             instr->type);
     } else /* local */ {
-        fprintf(
-            nasm,
-            "; Chargement de la variable locale '%s' sur la tête de pile\n"
-            "push qword [rbp %+d]\n",
-            symbol->identifier,
-            symbol->addr);
-    }
-}
-
-void CodeWriter_LoadVar(FILE* nasm,
-                        Node* node,
-                        const ProgramST* symtable,
-                        const FunctionST* func) {
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
-
-    switch (symbol->symbol_type) {
-        case SYMBOL_FUNCTION:
-            CodeWriter_CallFunctionAsExpression(nasm, node, symtable, func);
-            break;
-        case SYMBOL_VALUE:
-            _CodeWriter_LoadValue(nasm, node, symtable, func);
-            break;
-        case SYMBOL_ARRAY:
-            // If the array is not indexed,
-            // we just need to load the array address
-            if (node->firstChild == NULL) {
-                _CodeWriter_LoadArrayAddress(nasm, node, symtable, func);
-                break;
-            }
-            // Else the array is indexed, we need to load the indexed element
-            _CodeWriter_LoadArray(nasm, node, symtable, func);
-            break;
-
-        default:
-            assert(0 && "We shouldn't be there (LoadVar)");
+        Emitter_comment(
+            nasm, ASM_COMMENTS_FULL,
+            "; Chargement de la variable locale '%s' sur la tête de pile",
+            Intern_str(symbol->identifier));
+        _CodeWriter_push_var(nasm, (Address){RBP, symbol->addr},
+                             instr->type);
     }
 }
 
 /**
  * @brief Write a stacked value to a variable (local, global or parameter)
+ * Only the low byte is written to a char : the int to char conversion
+ * is done by the store, and the load sign-extends it back.
+ * A char kept in a register is sign-extended by the store instead.
  *
  * @param nasm
- * @param node
- * @param symtable
- * @param func
+ * @param instr IR_STORE
  */
-static void CodeWriter_WriteValue(FILE* nasm, Node* node,
-                                  const ProgramST* symtable,
-                                  const FunctionST* func) {
-    assert(node->label == Ident);
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
-
-    if (symbol->is_static) {
-        fprintf(
-            nasm,
-            "; Assignation de la dernière valeur de la pile "
-            "dans la variable globale '%s'\n"
-            "pop rax\n"
-            "mov [global_vars + %d], rax\n",
-            symbol->identifier,
-            symbol->addr);
-    } else if (symbol->is_param) {
-        fprintf(
-            nasm,
-            "; Assignation de la dernière valeur de la pile "
-            "dans l'argument '%s'\n"
-            "pop rax\n"
-            "mov [rbp %+d], rax\n",
-            symbol->identifier,
-            symbol->addr);
-    } else /* local */ {
-        fprintf(
-            nasm,
-            "; Assignation de la dernière valeur de la pile "
-            "dans la variable locale '%s'\n"
-            "pop rax\n"
-            "mov [rbp %+d], rax\n",
-            symbol->identifier,
-            symbol->addr);
+static void _CodeWriter_WriteValue(Emitter* nasm, const IrInstr* instr) {
+    const Symbol* symbol = instr->symbol;
+
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Assignation de la dernière valeur de la pile "
+                    "dans %s '%s'",
+                    symbol->is_static  ? "la variable globale"
+                    : symbol->is_param ? "l'argument"
+                                       : "la variable locale",
+                    Intern_str(symbol->identifier));
+    Address address = {symbol->is_static ? REG_GLOBALS : RBP, symbol->addr};
+
+    Register value = _CodeWriter_pop_operand(nasm, RAX);
+    if (instr->number && instr->type == type_byte) {
+        Emitter_printf(nasm, "movsx %s, %s\n", Register_to_str(instr->number),
+                       Register_to_byte_str(value));
+    } else if (instr->number) {
+        Emitter_mov(nasm, instr->number, value);
+    } else if (instr->type == type_byte) {
+        Emitter_store_byte(nasm, address, value);
+    } else {
+        Emitter_store(nasm, address, value);
     }
 }
 
 /**
- * @brief Write a stacked value to an indexed element of an array
+ * @brief Write a stacked value to an indexed element of an array,
+ * its index being above it
  *
  * @param nasm
- * @param node
- * @param symtable
- * @param func
+ * @param instr IR_STORE_ELEM
  */
-static void CodeWriter_WriteArray(FILE* nasm, Node* node,
-                                  const ProgramST* symtable,
-                                  const FunctionST* func) {
-    assert(node->label == ArrayLR);
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
-
-    _CodeWriter_ComputeArrayElementAddress(nasm, node, symtable, func);
-
-    fprintf(
-        nasm,
-        "; Assignation de la dernière valeur de la pile "
-        "dans l'élément du tableau '%s'\n",
-        symbol->identifier);
-
-    fprintf(
-        nasm,
-        "pop rax\n"
-        "pop qword [rax]\n\n");
+static void _CodeWriter_WriteArray(Emitter* nasm, const IrInstr* instr) {
+    const Symbol* symbol = instr->symbol;
+
+    _CodeWriter_ComputeArrayElementAddress(nasm, symbol);
+
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Assignation de la dernière valeur de la pile "
+                    "dans l'élément du tableau '%s'",
+                    Intern_str(symbol->identifier));
+
+    if (_CodeWriter_registers()) {
+        Register address, value;
+        _CodeWriter_pop_operands(nasm, false, &value, &address);
+        if (instr->type == type_byte) {
+            Emitter_store_byte(nasm, (Address){address, 0}, value);
+        } else {
+            Emitter_store(nasm, (Address){address, 0}, value);
+        }
+    } else if (instr->type == type_byte) {
+        Emitter_pop(nasm, RAX);
+        Emitter_pop(nasm, RCX);
+        Emitter_store_byte(nasm, (Address){RAX, 0}, RCX);
+    } else {
+        Emitter_pop(nasm, RAX);
+        Emitter_pop_mem(nasm, (Address){RAX, 0});
+    }
+    Emitter_puts(nasm, "\n");
 }
 
-void CodeWriter_WriteVar(FILE* nasm, Node* node,
-                         const ProgramST* symtable,
-                         const FunctionST* func) {
-    assert(node->label == Ident || node->label == ArrayLR);
-
-    const Symbol* symbol = ST_resolve_from_node(symtable, func, node);
+/**
+ * @brief Get the callee-saved registers holding variables of a function
+ *
+ * @param ir
+ * @return unsigned REG_BIT of each register
+ */
+static unsigned _CodeWriter_saved_registers(const IrFunction* ir) {
+    unsigned saved = 0;
 
-    switch (symbol->symbol_type) {
-        case SYMBOL_ARRAY:
-            CodeWriter_WriteArray(nasm, node, symtable, func);
-            break;
-        case SYMBOL_VALUE:
-            CodeWriter_WriteValue(nasm, node, symtable, func);
-            break;
-        default:
-            assert(0 && "We shouldn't be there (WriteVar)");
+    for (size_t i = 0; i < ArrayList_get_length(&ir->homes); ++i) {
+        saved |= REG_BIT(ArrayList_get_v(&ir->homes, i, IrHome).reg);
     }
+    return saved;
 }
 
-void CodeWriter_stackFrame_start(FILE* nasm, const FunctionST* func) {
-    fprintf(
-        nasm,
-        "; Init stack frame (save base pointer)\n"
-        "push rbp\n"
-        "mov rbp, rsp\n"
-        "; Allocates %ld bytes on the the stack\n"
-        "sub rsp, %ld\n",
-        func->locals.next_addr,
-        func->locals.next_addr);
-
-    // Move parameters to the callee's stack frame
-    int nb_params_to_save = MIN(FunctionST_get_param_count(func), 6);
-
-    for (int i = 0; i < nb_params_to_save; ++i) {
-        const Symbol* param = FunctionST_get_param(func, i);
-        fprintf(
-            nasm,
-            "; Move parameter '%s' to the stack frame\n"
-            "mov [rbp %+d], %s\n",
-            param->identifier,
-            param->addr,
-            Register_to_str(Register_param_to_reg(i)));
+/**
+ * @brief Save the callee-saved registers holding variables in the stack
+ * frame, below the locals, or restore them
+ *
+ * @param nasm
+ * @param ir
+ * @param restore
+ */
+static void _CodeWriter_save_registers(Emitter* nasm, const IrFunction* ir,
+                                       bool restore) {
+    unsigned saved = _CodeWriter_saved_registers(ir);
+    int addr = -(int)ir->frame_size;
+
+    for (Register reg = RAX; reg <= R15; ++reg) {
+        if (!(saved & REG_BIT(reg))) {
+            continue;
+        }
+        addr -= 8;
+        if (restore) {
+            Emitter_load(nasm, reg, (Address){RBP, addr});
+        } else {
+            Emitter_store(nasm, (Address){RBP, addr}, reg);
+        }
     }
-    fputc('\n', nasm);
 }
 
-void CodeWriter_stackFrame_end(FILE* nasm, const FunctionST* func) {
-    fprintf(
-        nasm,
-        "; Frees stack frame, (reset stack pointer to caller's state)\n"
-        "mov rsp, rbp\n"
-        "pop rbp\n\n");
+/**
+ * @brief Get the register holding a variable
+ *
+ * @param ir
+ * @param symbol
+ * @return Register 0 if the variable is in memory
+ */
+static Register _CodeWriter_home(const IrFunction* ir, const Symbol* symbol) {
+    for (size_t i = 0; i < ArrayList_get_length(&ir->homes); ++i) {
+        const IrHome* home = ArrayList_get(&ir->homes, i);
+        if (home->symbol == symbol) {
+            return home->reg;
+        }
+    }
+    return 0;
 }
 
-void CodeWriter_FunctionLabel(FILE* nasm, const FunctionST* func) {
-    fprintf(nasm, "%s:\n\n", func->identifier);
+/**
+ * @brief Move a parameter to the register holding it. A char is
+ * sign-extended, as when loaded from memory.
+ *
+ * @param nasm
+ * @param param
+ * @param reg
+ * @param position Position of the parameter
+ */
+static void _CodeWriter_move_param(Emitter* nasm, const Symbol* param,
+                                   Register reg, int position) {
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Move parameter '%s' to %s",
+                    Intern_str(param->identifier), Register_to_str(reg));
+    if (position >= 6 && param->type == type_byte) {
+        Emitter_load_byte(nasm, reg, (Address){RBP, param->addr});
+    } else if (position >= 6) {
+        Emitter_load(nasm, reg, (Address){RBP, param->addr});
+    } else if (param->type == type_byte) {
+        Emitter_printf(nasm, "movsx %s, %s\n", Register_to_str(reg),
+                       Register_to_byte_str(Register_param_to_reg(position)));
+    } else {
+        Emitter_mov(nasm, reg, Register_param_to_reg(position));
+    }
 }
 
-void CodeWriter_Return(FILE* nasm) {
-    fprintf(nasm, "ret\n\n");
+/**
+ * @brief Write the start of a stack frame. The callee-saved registers
+ * holding variables are saved below the locals.
+ *
+ * @param nasm Emitter to write into
+ * @param ir Function
+ */
+static void _CodeWriter_stackFrame_start(Emitter* nasm,
+                                         const IrFunction* ir) {
+    const FunctionST* func = ir->func;
+    size_t size = ir->frame_size +
+                  8 * __builtin_popcount(_CodeWriter_saved_registers(ir));
+
+    Emitter_comment(nasm, ASM_COMMENTS_BRIEF,
+                    "; Init stack frame (save base pointer)");
+    Emitter_push(nasm, RBP);
+    Emitter_mov(nasm, RBP, RSP);
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Allocates %ld bytes on the the stack", size);
+    Emitter_printf(nasm, "sub rsp, %ld\n", size);
+    _CodeWriter_save_registers(nasm, ir, false);
+
+    // Move parameters to the callee's stack frame, or to their register
+    int nb_params = FunctionST_get_param_count(func);
+
+    for (int i = 0; i < nb_params; ++i) {
+        const Symbol* param = FunctionST_get_param(func, i);
+        Register reg = _CodeWriter_home(ir, param);
+        if (reg) {
+            _CodeWriter_move_param(nasm, param, reg, i);
+        } else if (i < 6) {
+            Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                            "; Move parameter '%s' to the stack frame",
+                            Intern_str(param->identifier));
+            Emitter_store(nasm, (Address){RBP, param->addr},
+                          Register_param_to_reg(i));
+        }
+    }
+    Emitter_puts(nasm, "\n");
 }
 
-void CodeWriter_Return_Expr(FILE* nasm) {
-    fprintf(nasm, "pop rax\n");
+/**
+ * @brief Write the end of a stack frame, restoring the callee-saved
+ * registers
+ *
+ * @param nasm Emitter to write into
+ * @param ir Function
+ */
+static void _CodeWriter_stackFrame_end(Emitter* nasm, const IrFunction* ir) {
+    assert(ArrayList_get_length(&CODEGEN.operands) == 0 &&
+           "Operands left by an instruction");
+    Emitter_comment(
+        nasm, ASM_COMMENTS_BRIEF,
+        "; Frees stack frame, (reset stack pointer to caller's state)");
+    _CodeWriter_save_registers(nasm, ir, true);
+    Emitter_mov(nasm, RSP, RBP);
+    Emitter_pop(nasm, RBP);
+    Emitter_puts(nasm, "\n");
 }
 
-static char* _CodeWriter_Node_To_Eq(const Node* node) {
-    if (!strcmp(node->att.key_word, "==")) {
-        return "je";
-    }
-    if (!strcmp(node->att.key_word, "!=")) {
-        return "jne";
+/**
+ * @brief Return from a function : move the returned value, if any,
+ * to `rax` (converted to the return type of the function), free the
+ * stack frame and write `ret`
+ *
+ * @param nasm Emitter to write into
+ * @param ir Function returning
+ * @param instr IR_RETURN
+ */
+static void _CodeWriter_Return(Emitter* nasm, const IrFunction* ir,
+                               const IrInstr* instr) {
+    const FunctionST* func = ir->func;
+
+    if (instr->a != IR_NO_TEMP) {
+        _CodeWriter_pop_to(nasm, RAX);
+        // Callers use a returned char as is : convert an int,
+        // a char expression is already sign-extended
+        if (func->ret_type == type_byte && instr->type != type_byte) {
+            Emitter_puts(nasm, "movsx rax, al\n");
+        }
     }
-    assert(0 && "We shoudn't be there (_CodeWriter_Node_To_Eq) (Unkonw cmp)");
+    _CodeWriter_stackFrame_end(nasm, ir);
+    Emitter_puts(nasm, "ret\n\n");
 }
 
-static char* _CodeWriter_Node_to_Order(const Node* node) {
-    switch (node->att.key_word[0]) {
-        case '>':
-            if (node->att.key_word[1] == '=') {
-                return "jge";
-            }
-            return "jg";
-        case '<':
-            if (node->att.key_word[1] == '=') {
-                return "jle";
-            }
-            return "jl";
+/**
+ * @brief Get the conditional jump taken when a comparison is true
+ *
+ * @param op OP_EQ to OP_GE
+ * @return const char*
+ */
+static const char* _CodeWriter_Operator_To_Jump(Operator op) {
+    static const char* jumps[] = {
+        [OP_EQ] = "je",
+        [OP_NE] = "jne",
+        [OP_LT] = "jl",
+        [OP_LE] = "jle",
+        [OP_GT] = "jg",
+        [OP_GE] = "jge",
+    };
+
+    assert(op >= OP_EQ && op <= OP_GE &&
+           "Comparaison symbol unknown (CodeWriter_Cmp)");
+
+    return jumps[op];
+}
 
-        default:
-            assert(0 &&
-                   "We shouldn't be there (CodeWriter_Node_to_Order) "
-                   "(Wrong comparator)");
-            break;
+/**
+ * @brief Write the right operand of a comparison : a register,
+ * or its immediate
+ *
+ * @param instr IR_CMP or IR_JUMP_CMP
+ * @param right
+ * @param buffer Receives the operand
+ * @param size
+ * @return const char* buffer
+ */
+static const char* _CodeWriter_right_operand(const IrInstr* instr,
+                                             Register right,
+                                             char* buffer, size_t size) {
+    if (instr->flags & IR_IMM_B) {
+        snprintf(buffer, size, "%ld", instr->imm);
+    } else {
+        snprintf(buffer, size, "%s", Register_to_str(right));
     }
+    return buffer;
 }
 
-void CodeWriter_Cmp(FILE* nasm, Node* node, int cmp_number) {
-    char* cmp = NULL;
-    if (node->label == Eq) {
-        cmp = _CodeWriter_Node_To_Eq(node);
-    } else if (node->label == Order) {
-        cmp = _CodeWriter_Node_to_Order(node);
+/**
+ * @brief Pop the operands of a comparison, and compare them
+ *
+ * @param nasm
+ * @param instr IR_CMP or IR_JUMP_CMP
+ * @param swapped The right operand was evaluated first (registers mode)
+ * @return Register Register of the left operand
+ */
+static Register _CodeWriter_compare(Emitter* nasm, const IrInstr* instr,
+                                    bool swapped) {
+    Register left, right = RAX;
+    char operand[24];
+
+    if (instr->flags & IR_IMM_B) {
+        left = _CodeWriter_pop_operand(nasm, RAX);
     } else {
-        assert(cmp && "Comparaison symbol unknown (CodeWriter_Cmp)");
+        _CodeWriter_pop_operands(nasm, swapped, &left, &right);
     }
-
-    fprintf(
-        nasm,
-        "; Comparaison sur les 2 dernieres valeurs de la pile\n"
-        "pop rax\n"
-        "pop rcx\n"
-        "cmp rcx, rax\n"
-        "%s .cmp_%d ; comparateur si vrai va dans 2e cas\n"
-        "push 0\n"
-        "jmp .cmp_end%d\n"
-        ".cmp_%d :\n"
-        "push 1\n"
-        "jmp .cmp_end%d\n"
-        ".cmp_end%d : \n\n",
-        cmp, cmp_number, cmp_number, cmp_number, cmp_number, cmp_number);
-}
-
-void CodeWriter_If_Init(FILE* nasm, int if_number) {
-    fprintf(
-        nasm,
-        "; Condition if_%d\n"
-        "pop rax\n"
-        "cmp rax, 0\n"
-        "je .else_%d\n; if case\n",
-        if_number, if_number);
+    Emitter_printf(
+        nasm, "cmp %s, %s\n", Register_to_str(left),
+        _CodeWriter_right_operand(instr, right, operand, sizeof(operand)));
+    return left;
 }
 
-void CodeWriter_If_Else(FILE* nasm, int if_number) {
-    fprintf(
+/**
+ * @brief Write a boolean comparator between two values, without jumps :
+ * the flags of the comparison set its result (setcc)
+ *
+ * @param nasm Emitter to write into
+ * @param instr IR_CMP
+ * @param swapped The right operand was evaluated first (registers mode)
+ */
+static void _CodeWriter_Cmp(Emitter* nasm, const IrInstr* instr,
+                            bool swapped) {
+    // setcc of the jcc taken when the comparison is true
+    const char* cc = _CodeWriter_Operator_To_Jump(instr->oper) + 1;
+
+    Emitter_comment(nasm, ASM_COMMENTS_FULL,
+                    "; Comparaison des 2 derniers opérandes");
+    Register left = _CodeWriter_compare(nasm, instr, swapped);
+    Emitter_printf(
         nasm,
-        "jmp .end_if_%d\n"
-        ".else_%d :\n; else case\n",
-        if_number, if_number);
+        "set%s al\n"
+        "movzx %s, al\n\n",
+        cc, Register_to_str(left));
+    _CodeWriter_push_operand(nasm, left);
 }
 
-void CodeWriter_If_End(FILE* nasm, int if_number) {
-    fprintf(
-        nasm,
-        ".end_if_%d :\n",
-        if_number);
+/**
+ * @brief Write a label, and the comments of the structure it starts
+ *
+ * @param nasm
+ * @param ir Function of the label
+ * @param label
+ */
+static void _CodeWriter_Label(Emitter* nasm, const IrFunction* ir,
+                              int label) {
+    const IrLabel* info = ArrayList_get(&ir->labels, label);
+    char name[32];
+
+    if (info->kind == IR_LABEL_WHILE_START) {
+        Emitter_comment(nasm, ASM_COMMENTS_BRIEF,
+                        "; Condition while_%d", info->number);
+    }
+    Emitter_printf(nasm, ".%s:\n",
+                   IrFunction_label_name(ir, label, name, sizeof(name)));
+    if (info->kind == IR_LABEL_ELSE) {
+        Emitter_comment(nasm, ASM_COMMENTS_BRIEF, "; else case");
+    }
 }
 
-void CodeWriter_While_Init(FILE* nasm, int while_number) {
-    fprintf(
-        nasm,
-        "; Condition while_%d\n"
-        ".while_start_%d :\n"
-        "; Evaluation de l'expression du while %d\n",
-        // TreeReader_Expr is called after
-        while_number, while_number, while_number);
+/**
+ * @brief Write a jump, popping its condition if it is conditional.
+ * Operands in registers are spilled before a conditional jump, so
+ * that both paths have the same operands in registers.
+ *
+ * @param nasm
+ * @param ir Function of the jump
+ * @param instr IR_JUMP, IR_JUMP_ZERO, IR_JUMP_NONZERO or IR_JUMP_CMP
+ * @param swapped The right operand of IR_JUMP_CMP was evaluated first
+ */
+static void _CodeWriter_Jump(Emitter* nasm, const IrFunction* ir,
+                             const IrInstr* instr, bool swapped) {
+    const IrLabel* info = ArrayList_get(&ir->labels, instr->number);
+    char name[32];
+
+    IrFunction_label_name(ir, instr->number, name, sizeof(name));
+    if (instr->op == IR_JUMP) {
+        Emitter_printf(nasm, "jmp .%s\n", name);
+        return;
+    }
+    if (info->kind == IR_LABEL_ELSE) {
+        Emitter_comment(nasm, ASM_COMMENTS_BRIEF,
+                        "; Condition if_%d", info->number);
+    }
+    if (instr->op == IR_JUMP_CMP) {
+        // Spilling keeps the flags
+        _CodeWriter_compare(nasm, instr, swapped);
+        _CodeWriter_spill_all(nasm);
+        Emitter_printf(nasm, "%s .%s\n",
+                       _CodeWriter_Operator_To_Jump(instr->oper), name);
+    } else {
+        const char* reg =
+            Register_to_str(_CodeWriter_pop_operand(nasm, RAX));
+        _CodeWriter_spill_all(nasm);
+        Emitter_printf(
+            nasm,
+            "cmp %s, 0\n"
+            "%s .%s\n",
+            reg, instr->op == IR_JUMP_ZERO ? "je" : "jne", name);
+    }
+    if (info->kind == IR_LABEL_ELSE) {
+        Emitter_comment(nasm, ASM_COMMENTS_BRIEF, "; if case");
+    }
 }
 
-void CodeWriter_While_Eval(FILE* nasm, int while_number) {
-    fprintf(
-        nasm,
-        "; Evaluation de la condition du while %d\n"
-        "pop rax\n"
-        "cmp rax, 0\n"
-        "je .end_while_%d\n ; while expr\n",
-        while_number, while_number);
+/**
+ * @brief Write an instruction, except a label
+ *
+ * @param nasm
+ * @param ir Function of the instruction
+ * @param instr
+ * @param states [LabelState] of the function
+ */
+static void _CodeWriter_Instr(Emitter* nasm, const IrFunction* ir,
+                              const IrInstr* instr, ArrayList* states) {
+    switch ((IrOp)instr->op) {
+        case IR_CONST:
+            _CodeWriter_Constant(nasm, instr);
+            break;
+        case IR_LOAD:
+            _CodeWriter_LoadValue(nasm, instr);
+            break;
+        case IR_LOAD_ELEM:
+            _CodeWriter_use(instr->a);
+            _CodeWriter_LoadArray(nasm, instr);
+            break;
+        case IR_ADDR:
+            _CodeWriter_LoadArrayAddress(nasm, instr->symbol);
+            break;
+        case IR_STORE:
+            _CodeWriter_use(instr->a);
+            _CodeWriter_WriteValue(nasm, instr);
+            break;
+        case IR_STORE_ELEM:
+            _CodeWriter_use(instr->a);
+            _CodeWriter_use(instr->b);
+            _CodeWriter_WriteArray(nasm, instr);
+            break;
+        case IR_BINARY:
+            _CodeWriter_Ope_Arith(nasm, instr,
+                                  _CodeWriter_use_operands(instr));
+            break;
+        case IR_CMP:
+            _CodeWriter_Cmp(nasm, instr, _CodeWriter_use_operands(instr));
+            break;
+        case IR_NEG:
+            _CodeWriter_use(instr->a);
+            _CodeWriter_Ope_Unaire(nasm);
+            break;
+        case IR_NOT:
+            _CodeWriter_use(instr->a);
+            _CodeWriter_Ope_Bool_Not(nasm);
+            break;
+        case IR_JUMP:
+            _CodeWriter_Jump(nasm, ir, instr, false);
+            _CodeWriter_save_state(states, instr->number);
+            break;
+        case IR_JUMP_ZERO:
+        case IR_JUMP_NONZERO:
+            _CodeWriter_use(instr->a);
+            _CodeWriter_Jump(nasm, ir, instr, false);
+            _CodeWriter_save_state(states, instr->number);
+            break;
+        case IR_JUMP_CMP:
+            _CodeWriter_Jump(nasm, ir, instr,
+                             _CodeWriter_use_operands(instr));
+            _CodeWriter_save_state(states, instr->number);
+            break;
+        case IR_ARG:
+            // The arguments stay on the operands stack until the call
+            break;
+        case IR_CALL:
+            assert(ArrayList_get_length(&CODEGEN.temps) >=
+                   (size_t)instr->number);
+            ArrayList_resize(&CODEGEN.temps,
+                             ArrayList_get_length(&CODEGEN.temps) -
+                                 instr->number);
+            _CodeWriter_CallFunction(nasm, instr);
+            break;
+        case IR_RETURN:
+            if (instr->a != IR_NO_TEMP) {
+                _CodeWriter_use(instr->a);
+            }
+            _CodeWriter_Return(nasm, ir, instr);
+            break;
+        case IR_NOP:
+        case IR_LABEL:
+            break;
+    }
+    if (IrInstr_has_dst(instr)) {
+        IrTemp dst = instr->dst;
+        ArrayList_append(&CODEGEN.temps, &dst);
+    }
 }
 
-void CodeWriter_While_End(FILE* nasm, int while_number) {
-    fprintf(
-        nasm,
-        "jmp .while_start_%d\n"
-        ".end_while_%d :\n",
-        while_number, while_number);
+void CodeWriter_Function(Emitter* nasm, const IrFunction* ir) {
+    ArrayList states;
+    LabelState empty = {0};
+    bool reached = true;
+
+    ArrayList_init(&states, sizeof(LabelState),
+                   ArrayList_get_length(&ir->labels), NULL);
+    for (size_t i = 0; i < ArrayList_get_length(&ir->labels); ++i) {
+        ArrayList_append(&states, &empty);
+    }
+
+    Emitter_printf(nasm, "%s:\n\n", Intern_str(ir->func->identifier));
+    _CodeWriter_stackFrame_start(nasm, ir);
+    for (size_t i = 0; i < ArrayList_get_length(&ir->instrs); ++i) {
+        const IrInstr* instr = ArrayList_get(&ir->instrs, i);
+        if (instr->op == IR_NOP) {
+            continue;
+        }
+        if (instr->op == IR_LABEL) {
+            if (!reached) {
+                _CodeWriter_restore_state(&states, instr->number);
+            }
+            _CodeWriter_save_state(&states, instr->number);
+            _CodeWriter_Label(nasm, ir, instr->number);
+            reached = true;
+            continue;
+        }
+        _CodeWriter_Instr(nasm, ir, instr, &states);
+        reached = !IrInstr_ends_block(instr);
+    }
+    assert(!ArrayList_get_length(&CODEGEN.temps) &&
+           "Temps left at the end of a function");
+    ArrayList_free(&states);
 }
 
-void CodeWriter_load_builtins(FILE* nasm) {
+void CodeWriter_load_builtins(Emitter* nasm) {
     // paste builtin.asm in nasm file
     // clang-format off
-    fprintf(
+    Emitter_puts(
         nasm,
         #include "../obj/builtins.asm.inc"
     );
@@ -8,239 +8,69 @@
  *
  */
 
+#ifndef CODE_WRITER_H
+#define CODE_WRITER_H
+
+#include <stdbool.h>
 #include <stdio.h>
 #define PATH_BUILTINS "./src/builtins.asm"
 
+#include "emitter.h"
+#include "ir.h"
 #include "symbolTable.h"
 #include "tree.h"
 
-/**
- * @brief Write the header of the nasm file,
- * including the BSS section and the extern declaration
- * of utils.asm functions.
- *
- * @param nasm File to write into
- * @param globals Symbol table of the global variables
- */
-void CodeWriter_Init_File(FILE* nasm, const SymbolTable* globals);
-
-/**
- * @brief
- *
- * @param nasm
- */
-void CodeWriter_load_builtins(FILE* nasm);
-
-/**
- * @brief Write code to call a function with its arguments
- *
- * @param nasm File to write to
- * @param node Function node (Ident node with EmptyArgs or ListExp node)
- * @param symtable
- * @param caller
- */
-void CodeWriter_CallFunction(
-    FILE* nasm,
-    Node* node,
-    const ProgramST* symtable,
-    const FunctionST* caller);
-
-/**
- * @brief Call a function, and push the result on the stack.
- * Called function should be non-void.
- *
- * @param nasm
- * @param node
- * @param symtable
- * @param caller
- */
-void CodeWriter_CallFunctionAsExpression(
-    FILE* nasm,
-    Node* callee_node,
-    const ProgramST* symtable,
-    const FunctionST* caller);
-
-/**
- * @brief Evaluate an arithmetic binary operation
- * Childs of the function should be evaluated before calling this function :
- * Pop two values from the stack, apply the operation and push the result.
- *
- * @param nasm
- * @param node
- */
-void CodeWriter_Ope_Arith(FILE* nasm, const Node* node);
-
-/**
- * @brief Write a unary operation to the nasm file.
- *
- * @param nasm File to write into
- * @param node Node to write
- */
-void CodeWriter_Ope_Unaire(FILE* nasm, const Node* node);
-
-/**
- * @brief Write a constant number to the nasm file.
- * Push the constant value to the stack.
- *
- * @param nasm File to write into
- * @param node Node to write
- */
-void CodeWriter_ConstantNumber(FILE* nasm, const Node* node);
-
-/**
- * @brief Write a constant character to the nasm file.
- *
- * @param nasm File to write into
- * @param node Node to write
- */
-void CodeWriter_ConstantCharacter(FILE* nasm, const Node* node);
-
-/**
- * @brief Push the variable value to the stack.
- * If the variable is a global variable, use bss section.
- * If the variable is a local variable, use the stack.
- * If the variable is a parameter, use registers.
- *
- * @param nasm File to write into
- * @param node Node to write
- * @param symtable Program symbol table
- * @param func Function symbol table
- */
-void CodeWriter_LoadVar(FILE* nasm, Node* node,
-                        const ProgramST* symtable,
-                        const FunctionST* func);
+typedef enum CodegenMode {
+    CODEGEN_STACK,      // Every operand goes through the stack
+    CODEGEN_REGISTERS,  // Operands are kept in scratch registers
+} CodegenMode;
 
-/**
- * @brief Change the value of a variable from the last value on the stack.
- * If the variable is a global variable, use bss section.
- * If the variable is a local variable, use the stack.
- * If the variable is a parameter, use registers.
- *
- * @param nasm File to write into
- * @param node Node to write
- * @param symtable Program symbol table
- * @param func Function symbol table
- */
-void CodeWriter_WriteVar(FILE* nasm, Node* node,
-                         const ProgramST* symtable,
-                         const FunctionST* func);
+// Scratch registers holding the operands in registers mode
+#define CODEWRITER_NB_SCRATCH 7
 
 /**
- * @brief Write the start of a stack frame.
+ * @brief Select how the next expressions are evaluated
  *
- * @param nasm File to write into
- * @param func Function symbol table
+ * @param mode
  */
-void CodeWriter_stackFrame_start(FILE* nasm, const FunctionST* func);
+void CodeWriter_select(CodegenMode mode);
 
 /**
- * @brief Write the end of a stack frame.
+ * @brief Get the mode selected by CodeWriter_select
  *
- * @param nasm File to write into
- * @param func Function symbol table
+ * @return CodegenMode
  */
-void CodeWriter_stackFrame_end(FILE* nasm, const FunctionST* func);
+CodegenMode CodeWriter_get_mode(void);
 
 /**
- * @brief Write the label of a function.
- *
- * @param nasm File to write into
- * @param func Function symbol table
+ * @brief Release the operands stacks
  */
-void CodeWriter_FunctionLabel(FILE* nasm, const FunctionST* func);
+void CodeWriter_free(void);
 
 /**
- * @brief Write `ret` instruction.
+ * @brief Write the header of the nasm file,
+ * including the BSS section and the extern declaration
+ * of utils.asm functions.
  *
- * @param nasm File to write into
+ * @param nasm Emitter to write into
+ * @param globals Symbol table of the global variables
  */
-void CodeWriter_Return(FILE* nasm);
+void CodeWriter_Init_File(Emitter* nasm, const SymbolTable* globals);
 
 /**
- * @brief Move computed expression present on stack's head
- * to `rax` register.
+ * @brief
  *
- * @param nasm File to write into
- */
-void CodeWriter_Return_Expr(FILE* nasm);
-
-/**
- * @brief Write a boolean coparator between two values.
- * 
- * @param nasm File to write into
- * @param Node Node to write
- * @param cmp_number Global number for the jump.
- */
-void CodeWriter_Cmp(FILE* nasm, Node* Node, int cmp_number);
-
-/**
- * @brief Write the first part of the If segment (cmp).
- * 
- * @param nasm File to write into
- * @param if_number Global number for the jump.
- */
-void CodeWriter_If_Init(FILE* nasm, int if_number);
-
-/**
- * @brief Write the second part of the If segment 
-    (end 1st part + start 2nd part).
- * 
- * @param nasm File to write into
- * @param if_number Global number for the jump.
- */
-void CodeWriter_If_Else(FILE* nasm, int if_number);
-
-/**
- * @brief Write the last part of the If segment (end_if :)
- * 
- * @param nasm File to write into
- * @param if_number Global number for the jump. 
- */
-void CodeWriter_If_End(FILE* nasm, int if_number);
-
-/**
- * @brief Write the first part of the While segment (jmp start)
- * 
- * @param nasm File to write into
- * @param while_number Global number for the jump.
- */
-void CodeWriter_While_Init(FILE* nasm, int while_number);
-
-/**
- * @brief Write the 2nd part of the While segment (cmp + jmp if false)
- * 
- * @param nasm File to write into
- * @param while_number Global number for the jump.
- */
-void CodeWriter_While_Eval(FILE* nasm, int while_number);
-
-/**
- * @brief Write the last part of the While segment (jmp start + end_while bal)
- * 
- * @param nasm File to write into
- * @param while_number Global number for the jump.
+ * @param nasm
  */
-void CodeWriter_While_End(FILE* nasm, int while_number);
+void CodeWriter_load_builtins(Emitter* nasm);
 
 /**
- * @brief Write code for a boolean operation
- * Childs of the node shouldn't be already evaluated, as they
- * will be evaluated in this function.
+ * @brief Write the code of a function from its IR : its label,
+ * its stack frame and its instructions
  *
- * @param nasm File to write into
- * @param node Node to write
- * @param symtable Program symbol table
- * @param func Function symbol table
+ * @param nasm Emitter to write into
+ * @param ir Lowered function, see treeReader
  */
-void CodeWriter_Ope_Bool(FILE* nasm,
-                         const Tree node,
-                         const ProgramST* prog,
-                         const FunctionST* func);
+void CodeWriter_Function(Emitter* nasm, const IrFunction* ir);
 
-/**
- * @brief Logical not operation.
- * Expects the value to negate to be on the top of the stack.
- *
- * @param nasm File to write into
- */
-void CodeWriter_Ope_Bool_Not(FILE* nasm);
+#endif
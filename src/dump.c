@@ -0,0 +1,440 @@
+#include "dump.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arraylist.h"
+#include "astCache.h"
+
+static const char DUMP_SYMTABS_MAGIC[8] = "TPCSYMS";
+
+/**
+ * @brief Children of a node still to dump
+ */
+typedef struct DumpFrame {
+    NodeId first;  // First child
+    NodeId next;   // Next child to dump, NODE_NONE when done
+} DumpFrame;
+
+static void _Dump_push(ArrayList* stack, NodeId first) {
+    DumpFrame frame = {.first = first, .next = first};
+
+    if (ArrayList_append(stack, &frame) < 0) {
+        fprintf(stderr, "Run out of memory\n");
+        exit(EXIT_CODE(ERR_NO_MEMORY));
+    }
+}
+
+/**
+ * @brief Get the next child to dump, and move past it
+ *
+ * @param stack [DumpFrame]
+ * @param first Set to true if the child is the first of its parent
+ * @return const Node* NULL if the top frame is done (then it is popped)
+ */
+static const Node* _Dump_next(ArrayList* stack, bool* first) {
+    DumpFrame* frame = ArrayList_get(stack, stack->len - 1);
+    const Node* node = Node_get(frame->next);
+
+    if (!node) {
+        ArrayList_pop(stack);
+        return NULL;
+    }
+    *first = frame->next == frame->first;
+    frame->next = node->nextSibling;
+
+    return node;
+}
+
+/**
+ * @brief Write "Label : value" and a line feed
+ *
+ * @param out
+ * @param node
+ */
+static void _Dump_text_node(Emitter* out, const Node* node) {
+    static const char* unprintable_char[32] = {
+        [0] = "Null character",
+        [1] = "Start of Heading",
+        [2] = "Start of Text",
+        [3] = "End of Text",
+        [4] = "End of Transmission",
+        [5] = "Enquiry",
+        [6] = "Acknowledge",
+        [7] = "Bell, Alert",
+        [8] = "Backspace",
+        [9] = "Horizontal Tab",
+        [10] = "Line Feed",
+        [11] = "Vertical Tabulation",
+        [12] = "Form Feed",
+        [13] = "Carriage Return",
+        [14] = "Shift Out",
+        [15] = "Shift In",
+        [16] = "Data Link Escape",
+        [17] = "Device Control One (XON)",
+        [18] = "Device Control Two",
+        [19] = "Device Control Three (XOFF)",
+        [20] = "Device Control Four",
+        [21] = "Negative Acknowledge",
+        [22] = "Synchronous Idle",
+        [23] = "End of Transmission Block",
+        [24] = "Cancel",
+        [25] = "End of medium",
+        [26] = "Substitute",
+        [27] = "Escape",
+        [28] = "File Separator",
+        [29] = "Group Separator",
+        [30] = "Record Separator",
+        [31] = "Unit Separator",
+    };
+
+    Emitter_puts(out, Label_to_str(node->label));
+    Emitter_write(out, " : ", 3);
+
+    switch (node->type) {
+        case type_byte:
+            if (node->label != Character) {
+                Emitter_write(out, &node->att.byte, 1);
+            } else if (node->att.byte >= 0 && node->att.byte < 32) {
+                Emitter_printf(out, "'%s'",
+                               unprintable_char[(int)node->att.byte]);
+            } else if (node->att.byte < 0 || node->att.byte > 126) {
+                Emitter_int(out, node->att.byte);
+            } else {
+                Emitter_printf(out, "'%c'", node->att.byte);
+            }
+            break;
+        case type_op:
+            Emitter_puts(out, Operator_to_str(node->att.op));
+            break;
+        case type_num:
+            Emitter_int(out, node->att.num);
+            break;
+        case type_ident:
+            Emitter_puts(out, Intern_str(node->att.ident));
+            break;
+        case type_key_word:
+            Emitter_puts(out,
+                         node->att.prim_type == type_byte ? "char" : "int");
+            break;
+        case type_void:
+        default:
+            break;
+    }
+    Emitter_write(out, "\n", 1);
+}
+
+/**
+ * @brief Dump a tree as text, one node per line,
+ * linked to its parent by box-drawing characters
+ *
+ * @param out
+ * @param tree
+ */
+static void _Dump_tree_text(Emitter* out, const Node* tree) {
+    ArrayList stack;  // [DumpFrame] of each ancestor of the next node
+    const Node* node;
+    bool first;
+
+    ArrayList_init(&stack, sizeof(DumpFrame), 0, NULL);
+    _Dump_text_node(out, tree);
+    if (tree->firstChild) {
+        _Dump_push(&stack, tree->firstChild);
+    }
+
+    while (ArrayList_get_length(&stack)) {
+        if (!(node = _Dump_next(&stack, &first))) {
+            continue;
+        }
+
+        // An ancestor with siblings left continues its vertical line
+        // (2502 = vertical line, 251c = vertical line and right horiz,
+        // 2514 = L form, 2500 = horizontal line)
+        ARRAYLIST_DECLARE_ARRAY(stack, DumpFrame, frames);
+        size_t depth = stack.len;
+        for (size_t i = 0; i + 1 < depth; ++i) {
+            Emitter_puts(out, frames[i].next ? "\u2502   " : "    ");
+        }
+        Emitter_puts(out, frames[depth - 1].next ? "\u251c\u2500\u2500 "
+                                                 : "\u2514\u2500\u2500 ");
+        _Dump_text_node(out, node);
+
+        if (node->firstChild) {
+            _Dump_push(&stack, node->firstChild);
+        }
+    }
+    ArrayList_free(&stack);
+}
+
+/**
+ * @brief Write the members of the JSON object of a node,
+ * and open its children array (or close the object if it has no child)
+ *
+ * @param out
+ * @param node
+ */
+static void _Dump_json_node(Emitter* out, const Node* node) {
+    Emitter_puts(out, "{\"label\":\"");
+    Emitter_puts(out, Label_to_str(node->label));
+    Emitter_puts(out, "\",\"line\":");
+    Emitter_int(out, node->lineno);
+    Emitter_puts(out, ",\"column\":");
+    Emitter_int(out, node->column);
+
+    // Identifiers and operators never need to be escaped
+    switch (node->type) {
+        case type_byte:
+            Emitter_puts(out, ",\"value\":");
+            Emitter_int(out, node->att.byte);
+            break;
+        case type_num:
+            Emitter_puts(out, ",\"value\":");
+            Emitter_int(out, node->att.num);
+            break;
+        case type_ident:
+            Emitter_puts(out, ",\"value\":\"");
+            Emitter_puts(out, Intern_str(node->att.ident));
+            Emitter_write(out, "\"", 1);
+            break;
+        case type_key_word:
+            Emitter_puts(out, node->att.prim_type == type_byte
+                                  ? ",\"value\":\"char\""
+                                  : ",\"value\":\"int\"");
+            break;
+        case type_op:
+            Emitter_puts(out, ",\"value\":\"");
+            Emitter_puts(out, Operator_to_str(node->att.op));
+            Emitter_write(out, "\"", 1);
+            break;
+        case type_void:
+        default:
+            break;
+    }
+
+    if (node->firstChild) {
+        Emitter_puts(out, ",\"children\":[");
+    } else {
+        Emitter_write(out, "}", 1);
+    }
+}
+
+/**
+ * @brief Dump a tree as a JSON object per node :
+ * {"label", "line", "column", "value" (if any), "children" (if any)}
+ *
+ * @param out
+ * @param tree
+ */
+static void _Dump_tree_json(Emitter* out, const Node* tree) {
+    ArrayList stack;  // [DumpFrame] of each node with an open children array
+    bool first;
+
+    ArrayList_init(&stack, sizeof(DumpFrame), 0, NULL);
+    _Dump_json_node(out, tree);
+    if (tree->firstChild) {
+        _Dump_push(&stack, tree->firstChild);
+    }
+
+    while (ArrayList_get_length(&stack)) {
+        const Node* node = _Dump_next(&stack, &first);
+        if (!node) {
+            Emitter_write(out, "]}", 2);
+            continue;
+        }
+
+        if (!first) {
+            Emitter_write(out, ",", 1);
+        }
+        _Dump_json_node(out, node);
+        if (node->firstChild) {
+            _Dump_push(&stack, node->firstChild);
+        }
+    }
+    Emitter_write(out, "\n", 1);
+    ArrayList_free(&stack);
+}
+
+void Dump_tree(Emitter* out, const Source* source, const Node* tree,
+               DumpFormat format) {
+    switch (format) {
+        case DUMP_TEXT:
+            _Dump_tree_text(out, tree);
+            break;
+        case DUMP_JSON:
+            _Dump_tree_json(out, tree);
+            break;
+        case DUMP_BINARY:
+            AstCache_write(out, AstCache_hash(source), source, tree);
+            break;
+    }
+}
+
+/**
+ * @brief Write the JSON object of a symbol
+ *
+ * @param out
+ * @param symbol
+ */
+static void _Dump_json_symbol(Emitter* out, const Symbol* symbol) {
+    Emitter_puts(out, "{\"name\":\"");
+    Emitter_puts(out, Intern_str(symbol->identifier));
+    Emitter_puts(out, "\",\"symbol_type\":\"");
+    Emitter_puts(out, SymbolType_to_str(symbol->symbol_type));
+    Emitter_puts(out, "\",\"type\":\"");
+    Emitter_puts(out, Symbol_get_type_str(symbol->type));
+    Emitter_puts(out, "\",\"line\":");
+    Emitter_int(out, symbol->lineno);
+    Emitter_puts(out, ",\"column\":");
+    Emitter_int(out, symbol->column);
+    Emitter_puts(out, ",\"index\":");
+    Emitter_int(out, symbol->index);
+    Emitter_puts(out, ",\"total_size\":");
+    Emitter_int(out, symbol->total_size);
+    Emitter_puts(out, ",\"addr\":");
+    Emitter_int(out, symbol->addr);
+    if (symbol->symbol_type == SYMBOL_ARRAY && symbol->array.have_length) {
+        Emitter_puts(out, ",\"length\":");
+        Emitter_int(out, symbol->array.length);
+    }
+    Emitter_puts(out, symbol->is_static ? ",\"static\":true"
+                                        : ",\"static\":false");
+    Emitter_puts(out, symbol->is_param ? ",\"param\":true"
+                                       : ",\"param\":false");
+    Emitter_puts(out, symbol->is_default_function
+                          ? ",\"default_function\":true}"
+                          : ",\"default_function\":false}");
+}
+
+/**
+ * @brief Write the JSON array of the symbols of a table,
+ * in insertion order
+ *
+ * @param out
+ * @param table
+ */
+static void _Dump_json_table(Emitter* out, const SymbolTable* table) {
+    Emitter_write(out, "[", 1);
+    for (size_t i = 0; i < ArrayList_get_length(&table->symbols); ++i) {
+        if (i) {
+            Emitter_write(out, ",", 1);
+        }
+        _Dump_json_symbol(out, ArrayList_get(&table->symbols, i));
+    }
+    Emitter_write(out, "]", 1);
+}
+
+/**
+ * @brief Dump the symbol tables as JSON :
+ * {"globals": [symbol], "functions": [{"name", "type",
+ * "parameters": [symbol], "locals": [symbol]}]}
+ *
+ * @param out
+ * @param symtable
+ */
+static void _Dump_symtabs_json(Emitter* out, const ProgramST* symtable) {
+    Emitter_puts(out, "{\"globals\":");
+    _Dump_json_table(out, &symtable->globals);
+    Emitter_puts(out, ",\"functions\":[");
+    for (size_t i = 0; i < ArrayList_get_length(&symtable->functions); ++i) {
+        const FunctionST* function = ArrayList_get(&symtable->functions, i);
+        if (i) {
+            Emitter_write(out, ",", 1);
+        }
+        Emitter_puts(out, "{\"name\":\"");
+        Emitter_puts(out, Intern_str(function->identifier));
+        Emitter_puts(out, "\",\"type\":\"");
+        Emitter_puts(out, Symbol_get_type_str(function->ret_type));
+        Emitter_puts(out, "\",\"parameters\":");
+        _Dump_json_table(out, &function->parameters);
+        Emitter_puts(out, ",\"locals\":");
+        _Dump_json_table(out, &function->locals);
+        Emitter_write(out, "}", 1);
+    }
+    Emitter_puts(out, "]}\n");
+}
+
+/**
+ * @brief Write the DumpSymbol of every symbol of a table
+ *
+ * @param out
+ * @param table
+ */
+static void _Dump_binary_table(Emitter* out, const SymbolTable* table) {
+    for (size_t i = 0; i < ArrayList_get_length(&table->symbols); ++i) {
+        const Symbol* symbol = ArrayList_get(&table->symbols, i);
+        DumpSymbol record = {
+            .identifier = symbol->identifier,
+            .lineno = symbol->lineno,
+            .column = symbol->column,
+            .index = symbol->index,
+            .length = symbol->array.length,
+            .total_size = symbol->total_size,
+            .addr = symbol->addr,
+            .symbol_type = symbol->symbol_type,
+            .type = symbol->type,
+            .flags = (symbol->is_static ? DUMP_SYMBOL_STATIC : 0) |
+                     (symbol->is_param ? DUMP_SYMBOL_PARAM : 0) |
+                     (symbol->is_default_function
+                          ? DUMP_SYMBOL_DEFAULT_FUNCTION
+                          : 0) |
+                     (symbol->array.have_length ? DUMP_SYMBOL_HAVE_LENGTH
+                                                : 0),
+        };
+        Emitter_write(out, (const char*)&record, sizeof(record));
+    }
+}
+
+static void _Dump_symtabs_binary(Emitter* out, const ProgramST* symtable) {
+    size_t nb_functions = ArrayList_get_length(&symtable->functions);
+    DumpSymtabsHeader header = {
+        .version = DUMP_VERSION,
+        .nb_globals = ArrayList_get_length(&symtable->globals.symbols),
+        .nb_functions = nb_functions,
+        .nb_atoms = Intern_count(),
+    };
+    memcpy(header.magic, DUMP_SYMTABS_MAGIC, sizeof(DUMP_SYMTABS_MAGIC));
+    for (Atom atom = 1; atom < header.nb_atoms; ++atom) {
+        header.strings_size += strlen(Intern_str(atom)) + 1;
+    }
+    Emitter_write(out, (const char*)&header, sizeof(header));
+
+    for (size_t i = 0; i < nb_functions; ++i) {
+        const FunctionST* function = ArrayList_get(&symtable->functions, i);
+        DumpFunction record = {
+            .identifier = function->identifier,
+            .nb_parameters = ArrayList_get_length(
+                &function->parameters.symbols),
+            .nb_locals = ArrayList_get_length(&function->locals.symbols),
+            .ret_type = function->ret_type,
+        };
+        Emitter_write(out, (const char*)&record, sizeof(record));
+    }
+
+    _Dump_binary_table(out, &symtable->globals);
+    for (size_t i = 0; i < nb_functions; ++i) {
+        const FunctionST* function = ArrayList_get(&symtable->functions, i);
+        _Dump_binary_table(out, &function->parameters);
+        _Dump_binary_table(out, &function->locals);
+    }
+
+    for (Atom atom = 1; atom < header.nb_atoms; ++atom) {
+        const char* str = Intern_str(atom);
+        Emitter_write(out, str, strlen(str) + 1);
+    }
+}
+
+void Dump_symtabs(Emitter* out, const ProgramST* symtable,
+                  DumpFormat format) {
+    switch (format) {
+        case DUMP_TEXT:
+            ProgramST_print(symtable, out);
+            break;
+        case DUMP_JSON:
+            _Dump_symtabs_json(out, symtable);
+            break;
+        case DUMP_BINARY:
+            _Dump_symtabs_binary(out, symtable);
+            break;
+    }
+}
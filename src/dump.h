@@ -0,0 +1,94 @@
+/**
+ * @file dump.h
+ * @brief Dumps of the syntax tree (-t) and of the symbol tables (-s),
+ * as text for humans, or as JSON or binary for tools
+ *
+ */
+
+#ifndef DUMP_H
+#define DUMP_H
+
+#include <stdint.h>
+
+#include "emitter.h"
+#include "intern.h"
+#include "source.h"
+#include "symbolTable.h"
+#include "tree.h"
+
+#define DUMP_VERSION 1
+
+typedef enum DumpFormat {
+    DUMP_TEXT,    // Box-drawing tree, symbols sorted by name
+    DUMP_JSON,    // One JSON document per dump
+    DUMP_BINARY,  // Tree : see astCache.h, symbol tables : see below
+} DumpFormat;
+
+/*
+ * Binary symbol tables : a DumpSymtabsHeader, then nb_functions
+ * DumpFunction, then the DumpSymbol of the globals, then of the
+ * parameters and of the locals of each function in order, then the
+ * strings of the atoms (nb_atoms - 1 NUL-terminated strings, from atom 1).
+ * Symbols of a table are in insertion order, records are in native
+ * byte order.
+ */
+
+typedef struct DumpSymtabsHeader {
+    char magic[8];
+    uint32_t version;  // DUMP_VERSION
+    uint32_t nb_globals;
+    uint32_t nb_functions;
+    uint32_t nb_atoms;
+    uint64_t strings_size;
+} DumpSymtabsHeader;
+
+typedef struct DumpFunction {
+    Atom identifier;
+    uint32_t nb_parameters;
+    uint32_t nb_locals;
+    uint8_t ret_type;  // type_t
+    uint8_t unused[3];
+} DumpFunction;
+
+#define DUMP_SYMBOL_STATIC 0x1
+#define DUMP_SYMBOL_PARAM 0x2
+#define DUMP_SYMBOL_DEFAULT_FUNCTION 0x4
+#define DUMP_SYMBOL_HAVE_LENGTH 0x8
+
+typedef struct DumpSymbol {
+    Atom identifier;
+    int32_t lineno;
+    int32_t column;
+    int32_t index;
+    int32_t length;  // Array length, if DUMP_SYMBOL_HAVE_LENGTH
+    int32_t total_size;
+    int32_t addr;
+    uint8_t symbol_type;  // SymbolType
+    uint8_t type;         // type_t
+    uint8_t flags;        // DUMP_SYMBOL_*
+    uint8_t unused;
+} DumpSymbol;
+
+/**
+ * @brief Dump a syntax tree. The tree is walked without recursion,
+ * so its depth is not limited by the call stack.
+ *
+ * @param out
+ * @param source Source of the tree (line index of the binary format)
+ * @param tree
+ * @param format
+ */
+void Dump_tree(Emitter* out, const Source* source, const Node* tree,
+               DumpFormat format);
+
+/**
+ * @brief Dump the symbol tables of a program
+ *
+ * @param out
+ * @param symtable
+ * @param format
+ */
+void Dump_symtabs(Emitter* out, const ProgramST* symtable,
+                  DumpFormat format);
+
+#endif
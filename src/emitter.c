@@ -0,0 +1,348 @@
+#include "emitter.h"
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "peephole.h"
+
+#define EMITTER_LINE_MAX 128  // Room reserved for one formatted line
+
+void Emitter_init(Emitter* self, FILE* out, AsmComments comments) {
+    *self = (Emitter){
+        .out = out,
+        .comments = comments,
+    };
+}
+
+/**
+ * @brief Ensure room for size more bytes in the buffer
+ *
+ * @param self
+ * @param size
+ */
+static void _Emitter_reserve(Emitter* self, size_t size) {
+    if (self->len + size <= self->capacity) {
+        return;
+    }
+
+    size_t capacity = self->capacity ? self->capacity
+                                     : EMITTER_FLUSH_SIZE + EMITTER_LINE_MAX;
+    while (capacity < self->len + size) {
+        capacity *= 2;
+    }
+
+    char* buffer = realloc(self->buffer, capacity);
+    if (!buffer) {
+        fprintf(stderr, "Run out of memory\n");
+        exit(EXIT_CODE(ERR_NO_MEMORY));
+    }
+    self->buffer = buffer;
+    self->capacity = capacity;
+}
+
+/**
+ * @brief Write the first bytes of the buffer, and remove them from it
+ *
+ * @param self
+ * @param size
+ */
+static void _Emitter_write_out(Emitter* self, size_t size) {
+    if (size && fwrite(self->buffer, 1, size, self->out) != size) {
+        self->err = ERR_FILE_OPEN;
+    }
+    self->flushed += size;
+    self->len -= size;
+    if (self->len) {
+        memmove(self->buffer, self->buffer + size, self->len);
+    }
+    if (self->peephole) {
+        Peephole_shift(self->peephole, size);
+    }
+}
+
+/**
+ * @brief Write the buffer if enough bytes are pending
+ * (only the lines the peephole optimizer is done with)
+ *
+ * @param self
+ */
+static inline void _Emitter_maybe_flush(Emitter* self) {
+    if (self->peephole) {
+        Peephole_scan(self->peephole, self);
+        if (self->len >= EMITTER_FLUSH_SIZE) {
+            _Emitter_write_out(self, Peephole_pending(self->peephole));
+        }
+    } else if (self->len >= EMITTER_FLUSH_SIZE) {
+        Emitter_flush(self);
+    }
+}
+
+static inline void _Emitter_append(Emitter* self,
+                                   const char* text, size_t len) {
+    memcpy(self->buffer + self->len, text, len);
+    self->len += len;
+}
+
+#define _Emitter_append_lit(self, lit) \
+    _Emitter_append(self, lit, sizeof(lit) - 1)
+
+/**
+ * @brief Append a decimal integer
+ *
+ * @param self Emitter with at least 21 bytes available
+ * @param value
+ * @param plus Also write the sign of positive numbers (%+d)
+ */
+static void _Emitter_append_int(Emitter* self, long value, int plus) {
+    char digits[24];
+    char* p = digits + sizeof(digits);
+    unsigned long abs = value < 0 ? -(unsigned long)value
+                                  : (unsigned long)value;
+
+    do {
+        *--p = '0' + abs % 10;
+        abs /= 10;
+    } while (abs);
+
+    if (value < 0) {
+        *--p = '-';
+    } else if (plus) {
+        *--p = '+';
+    }
+
+    _Emitter_append(self, p, digits + sizeof(digits) - p);
+}
+
+static void _Emitter_append_reg(Emitter* self, Register reg) {
+    const char* name = Register_to_str(reg);
+    _Emitter_append(self, name, strlen(name));
+}
+
+static void _Emitter_append_address(Emitter* self, Address address) {
+    if (address.base == REG_GLOBALS) {
+        _Emitter_append_lit(self, "[global_vars + ");
+        _Emitter_append_int(self, address.disp, 0);
+    } else {
+        _Emitter_append_lit(self, "[");
+        _Emitter_append_reg(self, address.base);
+        if (address.disp || address.base == RBP) {
+            _Emitter_append_lit(self, " ");
+            _Emitter_append_int(self, address.disp, 1);
+        }
+    }
+    _Emitter_append_lit(self, "]");
+}
+
+void Emitter_write(Emitter* self, const char* text, size_t len) {
+    _Emitter_reserve(self, len);
+    _Emitter_append(self, text, len);
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_puts(Emitter* self, const char* text) {
+    Emitter_write(self, text, strlen(text));
+}
+
+static void _Emitter_vprintf(Emitter* self,
+                             const char* format, va_list arguments) {
+    va_list copy;
+    va_copy(copy, arguments);
+
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    int len = vsnprintf(self->buffer + self->len, self->capacity - self->len,
+                        format, arguments);
+
+    if (len >= 0 && (size_t)len >= self->capacity - self->len) {
+        _Emitter_reserve(self, len + 1);
+        vsnprintf(self->buffer + self->len, self->capacity - self->len,
+                  format, copy);
+    }
+    va_end(copy);
+
+    if (len > 0) {
+        self->len += len;
+    }
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_printf(Emitter* self, const char* format, ...) {
+    va_list arguments;
+    va_start(arguments, format);
+    _Emitter_vprintf(self, format, arguments);
+    va_end(arguments);
+}
+
+void Emitter_comment(Emitter* self, AsmComments level,
+                     const char* format, ...) {
+    if (!Emitter_has_comments(self, level)) {
+        return;
+    }
+
+    va_list arguments;
+    va_start(arguments, format);
+    _Emitter_vprintf(self, format, arguments);
+    va_end(arguments);
+    Emitter_write(self, "\n", 1);
+}
+
+void Emitter_end_line(Emitter* self, AsmComments level,
+                      const char* format, ...) {
+    if (Emitter_has_comments(self, level)) {
+        va_list arguments;
+        va_start(arguments, format);
+        _Emitter_vprintf(self, format, arguments);
+        va_end(arguments);
+    }
+    Emitter_write(self, "\n", 1);
+}
+
+void Emitter_push(Emitter* self, Register reg) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "push ");
+    _Emitter_append_reg(self, reg);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_pop(Emitter* self, Register reg) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "pop ");
+    _Emitter_append_reg(self, reg);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_push_imm(Emitter* self, long value) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "push ");
+    _Emitter_append_int(self, value, 0);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_mov(Emitter* self, Register dst, Register src) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "mov ");
+    _Emitter_append_reg(self, dst);
+    _Emitter_append_lit(self, ", ");
+    _Emitter_append_reg(self, src);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_mov_imm(Emitter* self, Register dst, long value) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "mov ");
+    _Emitter_append_reg(self, dst);
+    _Emitter_append_lit(self, ", ");
+    _Emitter_append_int(self, value, 0);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_int(Emitter* self, long value) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_int(self, value, 0);
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_push_mem(Emitter* self, Address address) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "push qword ");
+    _Emitter_append_address(self, address);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_pop_mem(Emitter* self, Address address) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "pop qword ");
+    _Emitter_append_address(self, address);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_store(Emitter* self, Address address, Register src) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "mov ");
+    _Emitter_append_address(self, address);
+    _Emitter_append_lit(self, ", ");
+    _Emitter_append_reg(self, src);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_load(Emitter* self, Register dst, Address address) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "mov ");
+    _Emitter_append_reg(self, dst);
+    _Emitter_append_lit(self, ", qword ");
+    _Emitter_append_address(self, address);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_load_byte(Emitter* self, Register dst, Address address) {
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "movsx ");
+    _Emitter_append_reg(self, dst);
+    _Emitter_append_lit(self, ", byte ");
+    _Emitter_append_address(self, address);
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_store_byte(Emitter* self, Address address, Register src) {
+    const char* name = Register_to_byte_str(src);
+
+    _Emitter_reserve(self, EMITTER_LINE_MAX);
+    _Emitter_append_lit(self, "mov byte ");
+    _Emitter_append_address(self, address);
+    _Emitter_append_lit(self, ", ");
+    _Emitter_append(self, name, strlen(name));
+    _Emitter_append_lit(self, "\n");
+    _Emitter_maybe_flush(self);
+}
+
+void Emitter_end_phase(Emitter* self, const char* name) {
+    if (self->peephole) {
+        Peephole_drain(self->peephole, self);
+    }
+
+    size_t end = Emitter_tell(self);
+
+    if (self->nb_phases < EMITTER_MAX_PHASES) {
+        self->phases[self->nb_phases++] = (EmitterPhase){
+            .name = name,
+            .bytes = end - self->phase_start,
+        };
+    }
+    self->phase_start = end;
+}
+
+void Emitter_print_stats(const Emitter* self, FILE* out) {
+    for (int i = 0; i < self->nb_phases; ++i) {
+        fprintf(out, "asm %-12s %10zu bytes\n",
+                self->phases[i].name, self->phases[i].bytes);
+    }
+    fprintf(out, "asm %-12s %10zu bytes\n", "total", Emitter_tell(self));
+}
+
+ErrorType Emitter_flush(Emitter* self) {
+    if (self->peephole) {
+        Peephole_drain(self->peephole, self);
+    }
+    _Emitter_write_out(self, self->len);
+
+    if (fflush(self->out) == EOF) {
+        self->err = ERR_FILE_OPEN;
+    }
+
+    return self->err;
+}
+
+void Emitter_free(Emitter* self) {
+    free(self->buffer);
+    *self = (Emitter){0};
+}
@@ -0,0 +1,219 @@
+/**
+ * @file emitter.h
+ * @brief Buffered writer of the generated assembly
+ *
+ */
+
+#ifndef EMITTER_H
+#define EMITTER_H
+
+#include <stdio.h>
+
+#include "error.h"
+#include "registers.h"
+
+#define EMITTER_FLUSH_SIZE (1 << 20)  // Buffered bytes before a write
+#define EMITTER_MAX_PHASES 8
+
+// Pseudo-register used as a base : address relative to global_vars
+#define REG_GLOBALS ((Register)0)
+
+typedef enum AsmComments {
+    ASM_COMMENTS_NONE,   // No comment at all
+    ASM_COMMENTS_BRIEF,  // Functions, calls and control flow structure
+    ASM_COMMENTS_FULL,   // Every generated sequence is explained
+} AsmComments;
+
+/**
+ * @brief Memory operand `[base +/- disp]`
+ */
+typedef struct Address {
+    Register base;  // REG_GLOBALS for a global variable
+    int disp;
+} Address;
+
+struct Peephole;
+
+typedef struct EmitterPhase {
+    const char* name;
+    size_t bytes;
+} EmitterPhase;
+
+typedef struct Emitter {
+    FILE* out;
+    char* buffer;
+    size_t len;       // Pending bytes in buffer
+    size_t capacity;  // Grows when a single line does not fit
+    size_t flushed;   // Bytes already written to out
+    AsmComments comments;
+    ErrorType err;  // First write error
+    size_t phase_start;
+    int nb_phases;
+    EmitterPhase phases[EMITTER_MAX_PHASES];
+    struct Peephole* peephole;  // Rewrites the lines, NULL if disabled
+} Emitter;
+
+/**
+ * @brief Initialize an emitter
+ *
+ * @param self
+ * @param out Output stream, written to once EMITTER_FLUSH_SIZE bytes
+ * are pending, and by Emitter_flush
+ * @param comments Comments to keep
+ */
+void Emitter_init(Emitter* self, FILE* out, AsmComments comments);
+
+/**
+ * @brief Append raw text
+ *
+ * @param self
+ * @param text
+ * @param len
+ */
+void Emitter_write(Emitter* self, const char* text, size_t len);
+
+/**
+ * @brief Append a NUL-terminated string
+ *
+ * @param self
+ * @param text
+ */
+void Emitter_puts(Emitter* self, const char* text);
+
+/**
+ * @brief Append formatted text (slow path, see the instructions below)
+ *
+ * @param self
+ * @param format printf format
+ */
+__attribute__((format(printf, 2, 3))) void Emitter_printf(Emitter* self,
+                                                          const char* format,
+                                                          ...);
+
+/**
+ * @brief Append a comment line, if its level is kept
+ *
+ * @param self
+ * @param level Least verbose mode showing the comment
+ * @param format printf format of the line (starting with ';'),
+ * without the line feed
+ */
+__attribute__((format(printf, 3, 4))) void Emitter_comment(Emitter* self,
+                                                           AsmComments level,
+                                                           const char* format,
+                                                           ...);
+
+/**
+ * @brief End the current line with a comment, if its level is kept
+ *
+ * @param self
+ * @param level Least verbose mode showing the comment
+ * @param format printf format of the comment (starting with ';')
+ */
+__attribute__((format(printf, 3, 4))) void Emitter_end_line(Emitter* self,
+                                                            AsmComments level,
+                                                            const char* format,
+                                                            ...);
+
+/**
+ * @brief Does the emitter keep comments of this level ?
+ * Allows skipping the computation of a comment's arguments.
+ *
+ * @param self
+ * @param level
+ * @return int
+ */
+static inline int Emitter_has_comments(const Emitter* self,
+                                       AsmComments level) {
+    return self->comments >= level;
+}
+
+/* Fast paths of the most frequent instructions (no format parsing) */
+
+void Emitter_push(Emitter* self, Register reg);
+void Emitter_pop(Emitter* self, Register reg);
+void Emitter_push_imm(Emitter* self, long value);
+void Emitter_mov(Emitter* self, Register dst, Register src);
+void Emitter_mov_imm(Emitter* self, Register dst, long value);
+
+/**
+ * @brief Append a decimal integer
+ *
+ * @param self
+ * @param value
+ */
+void Emitter_int(Emitter* self, long value);
+
+/**
+ * @brief `push qword [address]`
+ */
+void Emitter_push_mem(Emitter* self, Address address);
+
+/**
+ * @brief `pop qword [address]`
+ */
+void Emitter_pop_mem(Emitter* self, Address address);
+
+/**
+ * @brief `mov [address], src`
+ */
+void Emitter_store(Emitter* self, Address address, Register src);
+
+/**
+ * @brief `mov dst, qword [address]`
+ */
+void Emitter_load(Emitter* self, Register dst, Address address);
+
+/**
+ * @brief `movsx dst, byte [address]`
+ */
+void Emitter_load_byte(Emitter* self, Register dst, Address address);
+
+/**
+ * @brief `mov byte [address], src` (low byte of src)
+ */
+void Emitter_store_byte(Emitter* self, Address address, Register src);
+
+/**
+ * @brief Get the number of bytes emitted so far (written or pending)
+ *
+ * @param self
+ * @return size_t
+ */
+static inline size_t Emitter_tell(const Emitter* self) {
+    return self->flushed + self->len;
+}
+
+/**
+ * @brief Close the current phase, which gets every byte emitted
+ * since the end of the previous one
+ *
+ * @param self
+ * @param name Statically allocated name of the phase
+ */
+void Emitter_end_phase(Emitter* self, const char* name);
+
+/**
+ * @brief Print the number of bytes of each phase
+ *
+ * @param self
+ * @param out
+ */
+void Emitter_print_stats(const Emitter* self, FILE* out);
+
+/**
+ * @brief Write every pending byte to the output stream
+ *
+ * @param self
+ * @return ErrorType ERR_FILE_OPEN if a write failed
+ */
+ErrorType Emitter_flush(Emitter* self);
+
+/**
+ * @brief Free the buffer, pending bytes are lost
+ *
+ * @param self
+ */
+void Emitter_free(Emitter* self);
+
+#endif
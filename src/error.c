@@ -1,7 +1,9 @@
 #include "error.h"
 
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
 
 #include "program.h"
@@ -13,6 +15,38 @@ extern Program PROGRAM;
 #define COLOR_RESET "\033[0m"
 #define BOLD "\033[1m"
 
+/**
+ * @brief Diagnostics are written in memory, and sent to stderr
+ * in a single write by CodeError_flush
+ */
+static struct {
+    FILE* stream;  // Memory stream, NULL if nothing is pending
+    char* text;
+    size_t len;
+    int colors;  // -1 until stderr is checked to be a terminal
+} DIAGNOSTICS = {.colors = -1};
+
+/**
+ * @brief Get the stream diagnostics are written to
+ *
+ * @return FILE*
+ */
+static FILE* _diagnostics(void) {
+    if (!DIAGNOSTICS.stream) {
+        DIAGNOSTICS.stream = open_memstream(&DIAGNOSTICS.text,
+                                            &DIAGNOSTICS.len);
+    }
+    // Unbuffered fallback if the memory stream cannot be created
+    return DIAGNOSTICS.stream ? DIAGNOSTICS.stream : stderr;
+}
+
+static bool _use_colors(void) {
+    if (DIAGNOSTICS.colors < 0) {
+        DIAGNOSTICS.colors = isatty(STDERR_FILENO);
+    }
+    return DIAGNOSTICS.colors;
+}
+
 /**
  * @brief Get the error level as a string.
  *
@@ -49,68 +83,71 @@ static const char* get_level_color(ErrorType err) {
     }
 }
 
-static void _go_to_line(FILE* f, int line) {
-    fseek(f, 0, SEEK_SET);
-    int current_line = 1;
-    while (current_line < line) {
-        if (fgetc(f) == '\n') {
-            current_line++;
-        }
-    }
-}
-
-static void print_one_line_from_file(FILE* f) {
-    int c;
-    while ((c = fgetc(f)) != EOF && c != '\n') {
-        putc(c, stderr);
-    }
-    putc('\n', stderr);
-}
-
-static void safe_color_print(const char* color, const char* format, ...) {
-    if (isatty(STDERR_FILENO)) {
-        fprintf(stderr, "%s", color);
+static void safe_color_print(FILE* out, const char* color,
+                             const char* format, ...) {
+    if (_use_colors()) {
+        fprintf(out, "%s", color);
     }
 
     va_list arguments;
     va_start(arguments, format);
-    vfprintf(stderr, format, arguments);
+    vfprintf(out, format, arguments);
     va_end(arguments);
 
-    if (isatty(STDERR_FILENO)) {
-        fprintf(stderr, "%s", COLOR_RESET);
+    if (_use_colors()) {
+        fprintf(out, "%s", COLOR_RESET);
     }
 }
 
-static void CodeError_print_file_line(FILE* f, CodeError err) {
-    _go_to_line(f, err.line);
-    const int offset = fprintf(stderr, "%5d | ", err.line);
-    print_one_line_from_file(f);
+static void CodeError_print_source_line(FILE* out, const Source* source,
+                                        CodeError err) {
+    size_t len = 0;
+    // Line -1 (unknown) shows the first line, without a caret
+    const char* line = Source_get_line(source, err.line < 1 ? 1 : err.line,
+                                       &len);
+    const int offset = fprintf(out, "%5d | ", err.line);
+
+    fprintf(out, "%.*s\n", line ? (int)len : 0, line ? line : "");
 
     if (err.line == -1) {
         return;
     }
 
-    fprintf(stderr, "%*s|%*s^\n", offset - 2, "", err.column - 1, "");
+    fprintf(out, "%*s|%*s^\n", offset - 2, "", err.column - 1, "");
 }
 
 void CodeError_print(CodeError err, const char* format, ...) {
+    FILE* out = _diagnostics();
     va_list arguments;
     va_start(arguments, format);
 
-    safe_color_print(BOLD, "%s:%d:%d: ",
+    safe_color_print(out, BOLD, "%s:%d:%d: ",
                      PROGRAM.opt.path ? PROGRAM.opt.path : "stdin",
                      err.line, err.column);
 
-    safe_color_print(get_level_color(err.err), "%s: ",
+    safe_color_print(out, get_level_color(err.err), "%s: ",
                      get_str_error_level(err.err));
 
-    vfprintf(stderr, format, arguments);
-    putc('\n', stderr);
+    vfprintf(out, format, arguments);
+    putc('\n', out);
 
-    if (PROGRAM.opt.path) {
-        CodeError_print_file_line(PROGRAM.file_in, err);
+    if (PROGRAM.source.text) {
+        CodeError_print_source_line(out, &PROGRAM.source, err);
     }
 
     va_end(arguments);
 }
+
+void CodeError_flush(void) {
+    if (!DIAGNOSTICS.stream) {
+        return;
+    }
+
+    fclose(DIAGNOSTICS.stream);
+    fwrite(DIAGNOSTICS.text, 1, DIAGNOSTICS.len, stderr);
+    fflush(stderr);
+    free(DIAGNOSTICS.text);
+    DIAGNOSTICS.stream = NULL;
+    DIAGNOSTICS.text = NULL;
+    DIAGNOSTICS.len = 0;
+}
@@ -84,8 +84,17 @@ typedef struct CodeError {
 #define COLOR_WARN_YELLOW "\e[1;33m"
 #define RESET_COLOR "\e[0m"
 
+/**
+ * @brief Print a diagnostic, followed by the source line it refers to.
+ * Diagnostics are buffered until CodeError_flush is called.
+ */
 __attribute__((format(printf, 2, 3))) void CodeError_print(CodeError err,
                                                            const char *msg,
                                                            ...);
 
+/**
+ * @brief Write every buffered diagnostic to stderr at once
+ */
+void CodeError_flush(void);
+
 #endif
@@ -0,0 +1,450 @@
+/**
+ * @file fold.c
+ * @brief Constant folding and algebraic simplification on the syntax tree
+ *
+ */
+
+#include "fold.h"
+
+#include <limits.h>
+
+#include "arraylist.h"
+
+static const char* FOLD_RULE_NAMES[FOLD_NB_RULES] = {
+    [FOLD_CONSTANT] = "constant",
+    [FOLD_IDENTITY] = "identity",
+    [FOLD_BOOLEAN] = "boolean",
+};
+
+static struct {
+    bool enabled;
+    size_t folded[FOLD_NB_RULES];
+} FOLD = {.enabled = true};
+
+/**
+ * @brief Node waiting on the stack of Fold_DeclFonct
+ */
+typedef struct FoldTask {
+    Node* node;
+    bool visited;    // Its children are pushed
+    bool condition;  // Its value is only compared with zero
+} FoldTask;
+
+void Fold_select(bool enabled) {
+    FOLD.enabled = enabled;
+}
+
+/**
+ * @brief Get the value of a literal
+ *
+ * @param node
+ * @param value Set to the value of a Num or Character node
+ * @return bool false if the node is not a literal
+ */
+static bool _Fold_value(const Node* node, long* value) {
+    switch (node->label) {
+        case Num:
+            *value = node->att.num;
+            return true;
+        case Character:
+            *value = node->att.byte;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Tell whether a node is a literal of a value
+ *
+ * @param node
+ * @param value
+ * @return bool
+ */
+static bool _Fold_is(const Node* node, long value) {
+    long literal;
+
+    return _Fold_value(node, &literal) && literal == value;
+}
+
+/**
+ * @brief Tell whether two operands read the same variable
+ *
+ * @param left
+ * @param right
+ * @return bool
+ */
+static bool _Fold_same_variable(const Node* left, const Node* right) {
+    return left->label == Ident && right->label == Ident &&
+           !FIRSTCHILD(left) && !FIRSTCHILD(right) &&
+           left->symbol && left->symbol == right->symbol;
+}
+
+/**
+ * @brief Compute an operation between two literals as the generated
+ * code does (64 bits registers)
+ *
+ * @param op
+ * @param a
+ * @param b
+ * @param result
+ * @return bool false if the operation faults at run time (division
+ * by zero), or if its result does not fit in a Num
+ */
+static bool _Fold_eval(Operator op, long a, long b, long* result) {
+    switch (op) {
+        case OP_ADD:
+            *result = a + b;
+            break;
+        case OP_SUB:
+            *result = a - b;
+            break;
+        case OP_MUL:
+            *result = a * b;
+            break;
+        case OP_DIV:
+        case OP_MOD:
+            if (!b) {
+                return false;
+            }
+            *result = op == OP_DIV ? a / b : a % b;
+            break;
+        case OP_EQ:
+            *result = a == b;
+            break;
+        case OP_NE:
+            *result = a != b;
+            break;
+        case OP_LT:
+            *result = a < b;
+            break;
+        case OP_LE:
+            *result = a <= b;
+            break;
+        case OP_GT:
+            *result = a > b;
+            break;
+        case OP_GE:
+            *result = a >= b;
+            break;
+    }
+    return *result >= INT_MIN && *result <= INT_MAX;
+}
+
+/**
+ * @brief Turn a node into a Num
+ *
+ * @param node
+ * @param value
+ * @param rule Rule folding the node
+ */
+static void _Fold_to_num(Node* node, long value, FoldRuleId rule) {
+    node->label = Num;
+    node->type = type_num;
+    node->att.num = (int)value;
+    node->firstChild = NODE_NONE;
+    node->symbol = NULL;
+    node->expr_type = type_num;
+    node->expr_flags = EXPR_CONSTANT;
+    FOLD.folded[rule]++;
+}
+
+/**
+ * @brief Replace a node by one of its operands, in the list of its
+ * siblings
+ *
+ * @param node
+ * @param operand Child or grandchild of node
+ * @param rule Rule folding the node
+ */
+static void _Fold_to_operand(Node* node, const Node* operand,
+                             FoldRuleId rule) {
+    NodeId next = node->nextSibling;
+    NodeId last = node->lastSibling;
+
+    *node = *operand;
+    node->nextSibling = next;
+    node->lastSibling = last;
+    FOLD.folded[rule]++;
+}
+
+/**
+ * @brief Fold an arithmetic operation or a comparison
+ *
+ * @param node Addsub, Divstar, Eq or Order node
+ * @param condition
+ * @param left_effects The left operand has side effects, or can fault
+ * @param right_effects Idem for the right operand
+ * @return bool The folded node has side effects, or can fault
+ */
+static bool _Fold_binary(Node* node, bool condition,
+                         bool left_effects, bool right_effects) {
+    Node* left = FIRSTCHILD(node);
+    Node* right = SECONDCHILD(node);
+    Operator op = node->att.op;
+    long a, b, result;
+    // A division faults unless its divisor is a non-zero literal
+    bool effects = left_effects || right_effects ||
+                   ((op == OP_DIV || op == OP_MOD) &&
+                    (!_Fold_value(right, &b) || !b));
+
+    if (_Fold_value(left, &a) && _Fold_value(right, &b)) {
+        if (!_Fold_eval(op, a, b, &result)) {
+            return effects;
+        }
+        _Fold_to_num(node, result, FOLD_CONSTANT);
+        return false;
+    }
+
+    Node* kept = NULL;  // Operand the node simplifies to
+    bool zero = false;  // The node is 0, if no operand has side effects
+    switch (op) {
+        case OP_ADD:
+            kept = _Fold_is(right, 0) ? left
+                   : _Fold_is(left, 0) ? right
+                                       : NULL;
+            break;
+        case OP_SUB:
+            kept = _Fold_is(right, 0) ? left : NULL;
+            zero = _Fold_same_variable(left, right);
+            break;
+        case OP_MUL:
+            kept = _Fold_is(right, 1) ? left
+                   : _Fold_is(left, 1) ? right
+                                       : NULL;
+            zero = _Fold_is(left, 0) || _Fold_is(right, 0);
+            break;
+        case OP_DIV:
+            kept = _Fold_is(right, 1) ? left : NULL;
+            break;
+        case OP_MOD:
+            zero = _Fold_is(right, 1);
+            break;
+        default:
+            break;
+    }
+    if (zero && !effects) {
+        _Fold_to_num(node, 0, FOLD_IDENTITY);
+        return false;
+    }
+    // A char operand of an int operation is not converted in a condition
+    if (kept && (condition || kept->expr_type == node->expr_type)) {
+        bool kept_effects = kept == left ? left_effects : right_effects;
+        _Fold_to_operand(node, kept, FOLD_IDENTITY);
+        return kept_effects;
+    }
+    return effects;
+}
+
+/**
+ * @brief Fold a unary minus or plus
+ *
+ * @param node AddsubU node
+ * @param condition
+ * @param effects The operand has side effects, or can fault
+ * @return bool The folded node has side effects, or can fault
+ */
+static bool _Fold_sign(Node* node, bool condition, bool effects) {
+    Node* operand = FIRSTCHILD(node);
+    long a, result;
+
+    if (_Fold_value(operand, &a)) {
+        if (_Fold_eval(node->att.op, 0, a, &result)) {
+            _Fold_to_num(node, result, FOLD_CONSTANT);
+            return false;
+        }
+        return effects;
+    }
+    if (node->att.op == OP_SUB) {
+        // -(-x) -> x
+        if (operand->label != AddsubU || operand->att.op != OP_SUB) {
+            return effects;
+        }
+        operand = FIRSTCHILD(operand);
+    }
+    if (condition || operand->expr_type == node->expr_type) {
+        _Fold_to_operand(node, operand, FOLD_IDENTITY);
+    }
+    return effects;
+}
+
+/**
+ * @brief Fold a logical not
+ *
+ * @param node Not node
+ * @param condition
+ * @param effects The operand has side effects, or can fault
+ * @return bool The folded node has side effects, or can fault
+ */
+static bool _Fold_not(Node* node, bool condition, bool effects) {
+    Node* operand = FIRSTCHILD(node);
+    long a;
+
+    if (_Fold_value(operand, &a)) {
+        _Fold_to_num(node, !a, FOLD_CONSTANT);
+        return false;
+    }
+    // !!x is 0 or 1, but x is as good in a condition
+    if (condition && operand->label == Not) {
+        _Fold_to_operand(node, FIRSTCHILD(operand), FOLD_BOOLEAN);
+    }
+    return effects;
+}
+
+/**
+ * @brief Fold a lazy logical operation with a literal operand :
+ * a literal deciding the result (0 for &&, non-zero for ||) makes it
+ * a Num (if the right operand it skips has no side effects, as the
+ * left one is always evaluated), another literal makes it its other
+ * operand in a condition
+ *
+ * @param node And or Or node
+ * @param condition
+ * @param left_effects The left operand has side effects, or can fault
+ * @param right_effects Idem for the right operand
+ * @return bool The folded node has side effects, or can fault
+ */
+static bool _Fold_logical(Node* node, bool condition,
+                          bool left_effects, bool right_effects) {
+    Node* left = FIRSTCHILD(node);
+    Node* right = SECONDCHILD(node);
+    bool is_and = node->label == And;
+    long a, b;
+
+    if (_Fold_value(left, &a) && _Fold_value(right, &b)) {
+        _Fold_to_num(node, is_and ? a && b : a || b, FOLD_CONSTANT);
+        return false;
+    }
+    if (_Fold_value(left, &a)) {
+        if (!a == is_and) {
+            // The right operand is never evaluated
+            _Fold_to_num(node, !is_and, FOLD_BOOLEAN);
+            return false;
+        }
+        if (condition) {
+            _Fold_to_operand(node, right, FOLD_BOOLEAN);
+            return right_effects;
+        }
+    } else if (_Fold_value(right, &b)) {
+        if (!b == is_and) {
+            if (!left_effects) {
+                _Fold_to_num(node, !is_and, FOLD_BOOLEAN);
+                return false;
+            }
+        } else if (condition) {
+            _Fold_to_operand(node, left, FOLD_BOOLEAN);
+            return left_effects;
+        }
+    }
+    return left_effects || right_effects;
+}
+
+/**
+ * @brief Tell whether the value of a child is only compared with zero
+ *
+ * @param parent
+ * @param child
+ * @return bool
+ */
+static bool _Fold_is_condition(const Node* parent, const Node* child) {
+    switch (parent->label) {
+        case If:
+        case While:
+            return child == FIRSTCHILD(parent);
+        case Not:
+        case And:
+        case Or:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Fold a node whose children are folded
+ *
+ * @param task Popped task
+ * @param effects [bool] Side effects of the children, the first child
+ * on top, replaced by the ones of the node
+ */
+static void _Fold_leave(FoldTask task, ArrayList* effects) {
+    Node* node = task.node;
+    bool result;
+
+    switch (node->label) {
+        case Addsub:
+        case Divstar:
+        case Eq:
+        case Order:
+        case And:
+        case Or: {
+            bool left = ArrayList_pop_v(effects, bool);
+            bool right = ArrayList_pop_v(effects, bool);
+            result = node->label == And || node->label == Or
+                         ? _Fold_logical(node, task.condition, left, right)
+                         : _Fold_binary(node, task.condition, left, right);
+            break;
+        }
+        case AddsubU:
+            result = _Fold_sign(node, task.condition,
+                                ArrayList_pop_v(effects, bool));
+            break;
+        case Not:
+            result = _Fold_not(node, task.condition,
+                               ArrayList_pop_v(effects, bool));
+            break;
+        default:
+            // A function call has side effects
+            result = node->label == Ident && FIRSTCHILD(node);
+            for (Node* child = FIRSTCHILD(node); child;
+                 child = NEXTSIBLING(child)) {
+                result |= ArrayList_pop_v(effects, bool);
+            }
+    }
+    ArrayList_append(effects, &result);
+}
+
+void Fold_DeclFonct(Tree tree) {
+    ArrayList tasks, effects;
+    // DeclFonct->Corps->SuiteInstr
+    FoldTask task = {.node = SECONDCHILD(SECONDCHILD(tree))};
+
+    if (!FOLD.enabled) {
+        return;
+    }
+    ArrayList_init(&tasks, sizeof(FoldTask), 64, NULL);
+    ArrayList_init(&effects, sizeof(bool), 64, NULL);
+    ArrayList_append(&tasks, &task);
+    // Iterative post-order traversal, expressions can be deeply nested.
+    // The children are pushed first to last : the last one is folded
+    // first, and the effects of the first one end on top.
+    while (ArrayList_get_length(&tasks)) {
+        task = ArrayList_pop_v(&tasks, FoldTask);
+        if (task.visited) {
+            _Fold_leave(task, &effects);
+            continue;
+        }
+        task.visited = true;
+        ArrayList_append(&tasks, &task);
+        for (Node* child = FIRSTCHILD(task.node); child;
+             child = NEXTSIBLING(child)) {
+            FoldTask next = {
+                .node = child,
+                .condition = _Fold_is_condition(task.node, child),
+            };
+            ArrayList_append(&tasks, &next);
+        }
+    }
+    ArrayList_free(&effects);
+    ArrayList_free(&tasks);
+}
+
+void Fold_print_stats(FILE* out) {
+    if (!FOLD.enabled) {
+        return;
+    }
+    for (FoldRuleId rule = 0; rule < FOLD_NB_RULES; ++rule) {
+        fprintf(out, "fold %-15s %10zu nodes\n", FOLD_RULE_NAMES[rule],
+                FOLD.folded[rule]);
+    }
+}
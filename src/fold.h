@@ -0,0 +1,49 @@
+/**
+ * @file fold.h
+ * @brief Constant folding and algebraic simplification of the
+ * expressions of a function, on its syntax tree, before it is lowered
+ *
+ */
+
+#ifndef FOLD_H
+#define FOLD_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "tree.h"
+
+typedef enum FoldRuleId {
+    FOLD_CONSTANT,  // 3 * 4 + 1 -> 13, 'a' == 97 -> 1
+    FOLD_IDENTITY,  // x + 0, x * 1 -> x, x * 0, x - x -> 0
+    FOLD_BOOLEAN,   // !!x, 1 && x -> x in a condition, 0 && x -> 0
+    FOLD_NB_RULES,
+} FoldRuleId;
+
+/**
+ * @brief Enable or disable the folding of the next functions
+ * (disabled by --no-fold)
+ *
+ * @param enabled
+ */
+void Fold_select(bool enabled);
+
+/**
+ * @brief Fold the expressions of a checked function in place.
+ * A folded node becomes a Num, or the operand it simplifies to.
+ * Operations which can fault (division by a constant zero) and
+ * operands with side effects (calls) are never removed.
+ *
+ * @param tree DeclFonct node, checked by Semantic_check
+ */
+void Fold_DeclFonct(Tree tree);
+
+/**
+ * @brief Print the number of nodes folded by each rule,
+ * over every function
+ *
+ * @param out
+ */
+void Fold_print_stats(FILE* out);
+
+#endif
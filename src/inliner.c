@@ -0,0 +1,491 @@
+/**
+ * @file inliner.c
+ * @brief Inlining of the calls to small non-recursive functions
+ *
+ */
+
+#include "inliner.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "arraylist.h"
+#include "atommap.h"
+
+/**
+ * @brief Why the calls to a function are kept, or not
+ */
+typedef enum InlineVerdict {
+    INLINE_OK,
+    INLINE_RECURSIVE,   // Calls itself
+    INLINE_CALLS_NEXT,  // Calls a function defined after it, maybe itself
+    INLINE_TOO_BIG,     // More instructions than the budget
+    INLINE_FORWARD,     // Defined after the caller, not lowered yet
+    INLINE_LOOP,        // Loops, called with operands pending
+} InlineVerdict;
+
+static const char* VERDICTS[] = {
+    [INLINE_RECURSIVE] = "recursive",
+    [INLINE_CALLS_NEXT] = "calls a function defined after it",
+    [INLINE_FORWARD] = "defined after the caller",
+    [INLINE_LOOP] = "loop inside an expression",
+};
+
+/**
+ * @brief Copy of a lowered function, before its other passes.
+ * Its variables are copied too : the symbol tables of the locals are
+ * released after each function in streaming mode, and the global one
+ * grows with each function.
+ */
+typedef struct InlineBody {
+    Atom name;
+    type_t ret_type;
+    InlineVerdict verdict;
+    size_t size;        // Number of instructions
+    size_t nb_params;
+    bool has_loop;      // Jumps back to a label
+    Symbol* vars;       // Parameters, locals, then inlined variables
+    size_t nb_vars;
+    Symbol* globals;    // Global variables, one per access
+    ArrayList instrs;   // [IrInstr] of a function INLINE_OK, on vars
+    ArrayList labels;   // [IrLabel]
+    IrTemp nb_temps;
+} InlineBody;
+
+static struct {
+    int budget;
+    FILE* report;      // --inline-report, NULL if disabled
+    ArrayList bodies;  // [InlineBody] of the lowered functions
+    AtomMap index;     // Function name -> position in bodies
+    int next_label;    // Number of the next label of an inlined call
+    size_t inlined;
+    size_t kept;
+} INLINER = {.budget = INLINER_DEFAULT_BUDGET};
+
+void Inliner_select(int budget, FILE* report) {
+    INLINER.budget = budget;
+    INLINER.report = report;
+    ArrayList_init(&INLINER.bodies, sizeof(InlineBody), 0, NULL);
+    AtomMap_init(&INLINER.index);
+}
+
+/**
+ * @brief Tell whether an instruction accesses a variable
+ *
+ * @param instr
+ * @return bool
+ */
+static bool _Inliner_has_symbol(const IrInstr* instr) {
+    switch (instr->op) {
+        case IR_LOAD:
+        case IR_LOAD_ELEM:
+        case IR_ADDR:
+        case IR_STORE:
+        case IR_STORE_ELEM:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Get the position of a variable of a function in
+ * InlineBody.vars : the parameters, then the locals, then the
+ * variables of the calls inlined in it
+ *
+ * @param ir
+ * @param symbol Variable of ir, not static
+ * @return size_t
+ */
+static size_t _Inliner_var(const IrFunction* ir, const Symbol* symbol) {
+    size_t nb_params = ArrayList_get_length(&ir->func->parameters.symbols);
+    size_t nb_locals = ArrayList_get_length(&ir->func->locals.symbols);
+
+    if ((size_t)symbol->index < nb_locals &&
+        ArrayList_get(&ir->func->locals.symbols, symbol->index) == symbol) {
+        return nb_params + symbol->index;
+    }
+    if ((size_t)symbol->index < nb_params &&
+        FunctionST_get_param(ir->func, symbol->index) == symbol) {
+        return symbol->index;
+    }
+    return nb_params + symbol->index;  // Inlined, numbered after the locals
+}
+
+/**
+ * @brief Copy the variables of a function, and its instructions
+ * on the copies
+ *
+ * @param body
+ * @param ir
+ * @return bool false if out of memory
+ */
+static bool _Inliner_copy(InlineBody* body, const IrFunction* ir) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&ir->instrs);
+    size_t nb_locals = ArrayList_get_length(&ir->func->locals.symbols);
+    size_t nb_inlined = ArrayList_get_length(&ir->inlined);
+    size_t nb_globals = 0;
+
+    for (size_t i = 0; i < len; ++i) {
+        nb_globals += _Inliner_has_symbol(&instrs[i]) &&
+                      instrs[i].symbol->is_static;
+    }
+    body->nb_vars = body->nb_params + nb_locals + nb_inlined;
+    body->vars = malloc((body->nb_vars + 1) * sizeof(Symbol));
+    body->globals = malloc((nb_globals + 1) * sizeof(Symbol));
+    if (!body->vars || !body->globals) {
+        free(body->vars);
+        free(body->globals);
+        return false;
+    }
+    for (size_t i = 0; i < body->nb_params; ++i) {
+        body->vars[i] = *FunctionST_get_param(ir->func, i);
+    }
+    for (size_t i = 0; i < nb_locals; ++i) {
+        body->vars[body->nb_params + i] =
+            ArrayList_get_v(&ir->func->locals.symbols, i, Symbol);
+    }
+    for (size_t i = 0; i < nb_inlined; ++i) {
+        body->vars[body->nb_params + nb_locals + i] =
+            *ArrayList_get_v(&ir->inlined, i, Symbol*);
+    }
+
+    ArrayList_init(&body->instrs, sizeof(IrInstr), len, NULL);
+    nb_globals = 0;
+    for (size_t i = 0; i < len; ++i) {
+        IrInstr instr = instrs[i];
+        if (_Inliner_has_symbol(&instr) && instr.symbol->is_static) {
+            body->globals[nb_globals] = *instr.symbol;
+            instr.symbol = &body->globals[nb_globals++];
+        } else if (_Inliner_has_symbol(&instr)) {
+            instr.symbol = &body->vars[_Inliner_var(ir, instr.symbol)];
+        }
+        ArrayList_append(&body->instrs, &instr);
+    }
+    ArrayList_init(&body->labels, sizeof(IrLabel),
+                   ArrayList_get_length(&ir->labels), NULL);
+    for (size_t i = 0; i < ArrayList_get_length(&ir->labels); ++i) {
+        ArrayList_append(&body->labels, ArrayList_get(&ir->labels, i));
+    }
+    return true;
+}
+
+/**
+ * @brief Tell whether a function jumps back to a label
+ *
+ * @param ir
+ * @return bool
+ */
+static bool _Inliner_has_loop(const IrFunction* ir) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&ir->instrs);
+    bool* placed = calloc(ArrayList_get_length(&ir->labels) + 1,
+                          sizeof(bool));
+    bool loop = !placed;
+
+    for (size_t i = 0; !loop && i < len; ++i) {
+        if (instrs[i].op == IR_LABEL) {
+            placed[instrs[i].number] = true;
+        } else if (IrInstr_is_jump(&instrs[i])) {
+            loop = placed[instrs[i].number];
+        }
+    }
+    free(placed);
+    return loop;
+}
+
+/**
+ * @brief Keep a copy of a function, if it can be inlined,
+ * or why it cannot
+ *
+ * @param ir Function after its calls are inlined
+ */
+static void _Inliner_record(const IrFunction* ir) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    InlineBody body = {
+        .name = ir->func->identifier,
+        .ret_type = ir->func->ret_type,
+        .verdict = INLINE_OK,
+        .size = ArrayList_get_length(&ir->instrs),
+        .nb_params = FunctionST_get_param_count(ir->func),
+        .nb_temps = ir->nb_temps,
+    };
+
+    for (size_t i = 0; i < body.size; ++i) {
+        if (instrs[i].op != IR_CALL) {
+            continue;
+        }
+        if (instrs[i].callee == body.name) {
+            body.verdict = INLINE_RECURSIVE;
+            break;
+        }
+        if (instrs[i].flags & IR_FORWARD) {
+            body.verdict = INLINE_CALLS_NEXT;
+        }
+    }
+    if (body.verdict == INLINE_OK && body.size > (size_t)INLINER.budget) {
+        body.verdict = INLINE_TOO_BIG;
+    }
+    if (body.verdict == INLINE_OK) {
+        body.has_loop = _Inliner_has_loop(ir);
+    }
+    if (body.verdict == INLINE_OK && !_Inliner_copy(&body, ir)) {
+        body.verdict = INLINE_TOO_BIG;
+    }
+    AtomMap_put(&INLINER.index, body.name,
+                (int)ArrayList_get_length(&INLINER.bodies));
+    ArrayList_append(&INLINER.bodies, &body);
+}
+
+/**
+ * @brief Find the body replacing a call, and report the call.
+ * A loop is not inlined in an expression : the code generator keeps
+ * the operands pending in the same registers only over forward jumps,
+ * and the code after an endless loop, using them, would be removed.
+ *
+ * @param ir Caller
+ * @param call IR_CALL
+ * @param pending Operands of the caller pending over the call
+ * @return const InlineBody* NULL if the call is kept
+ */
+static const InlineBody* _Inliner_callee(const IrFunction* ir,
+                                         const IrInstr* call,
+                                         bool pending) {
+    int i = AtomMap_get(&INLINER.index, call->callee);
+    const InlineBody* body = i < 0 ? NULL : ArrayList_get(&INLINER.bodies, i);
+    InlineVerdict verdict;
+
+    if (body) {
+        verdict = body->verdict == INLINE_OK && pending && body->has_loop
+                      ? INLINE_LOOP
+                      : body->verdict;
+    } else if (call->callee == ir->func->identifier) {
+        verdict = INLINE_RECURSIVE;
+    } else if (call->flags & IR_FORWARD) {
+        verdict = INLINE_FORWARD;
+    } else {
+        return NULL;  // Builtin
+    }
+
+    if (verdict == INLINE_OK) {
+        INLINER.inlined++;
+    } else {
+        INLINER.kept++;
+    }
+    if (INLINER.report) {
+        fprintf(INLINER.report, "%s '%s' %s '%s' (",
+                verdict == INLINE_OK ? "inlined" : "kept call to",
+                Intern_str(call->callee),
+                verdict == INLINE_OK ? "into" : "in",
+                Intern_str(ir->func->identifier));
+        if (verdict == INLINE_OK) {
+            fprintf(INLINER.report, "%zu instrs)\n", body->size);
+        } else if (verdict == INLINE_TOO_BIG) {
+            fprintf(INLINER.report, "%zu instrs, budget %d)\n", body->size,
+                    INLINER.budget);
+        } else {
+            fprintf(INLINER.report, "%s)\n", VERDICTS[verdict]);
+        }
+    }
+    return verdict == INLINE_OK ? body : NULL;
+}
+
+/**
+ * @brief Add a variable of an inlined call to the frame of the caller.
+ * An array parameter stays a parameter : its address is in the frame.
+ *
+ * @param ir Caller
+ * @param var Variable of the callee
+ * @return Symbol* Copy of var, NULL if out of memory
+ */
+static Symbol* _Inliner_rename(IrFunction* ir, const Symbol* var) {
+    Symbol* copy = malloc(sizeof(Symbol));
+
+    if (!copy) {
+        return NULL;
+    }
+    *copy = *var;
+    copy->is_param = var->is_param && var->symbol_type == SYMBOL_ARRAY;
+    copy->index = ArrayList_get_length(&ir->func->locals.symbols) +
+                  ArrayList_get_length(&ir->inlined);
+    ir->frame_size += var->total_size;
+    copy->addr = -(int)ir->frame_size;
+    ArrayList_append(&ir->inlined, &copy);
+    return copy;
+}
+
+/**
+ * @brief Replace a call by the body of its callee : the arguments are
+ * stored in the renamed parameters, each return stores its value in
+ * a result variable and jumps to the end of the body, where the result
+ * is loaded in the temp of the call.
+ *
+ * @param ir Caller
+ * @param out Instructions of the caller before the call, after its
+ * arguments, which are removed
+ * @param call IR_CALL
+ * @param body Callee
+ */
+static void _Inliner_call(IrFunction* ir, ArrayList* out,
+                          const IrInstr* call, const InlineBody* body) {
+    ARRAYLIST_DECLARE_ARRAY(body->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&body->instrs);
+    size_t first_arg = ArrayList_get_length(out) - body->nb_params;
+    IrTemp temps = ir->nb_temps;
+    int labels = (int)ArrayList_get_length(&ir->labels);
+    Symbol** vars = malloc((body->nb_vars + 1) * sizeof(Symbol*));
+    Symbol result = {
+        .identifier = body->name,
+        .type = body->ret_type,
+        .type_size = 8,
+        .symbol_type = SYMBOL_VALUE,
+        .total_size = 8,
+    };
+    Symbol* ret = vars ? _Inliner_rename(ir, &result) : NULL;
+
+    for (size_t i = 0; ret && i < body->nb_vars; ++i) {
+        if (!(vars[i] = _Inliner_rename(ir, &body->vars[i]))) {
+            ret = NULL;
+        }
+    }
+    if (!ret) {
+        // Out of memory, the call is kept
+        ArrayList_append(out, (void*)call);
+        free(vars);
+        return;
+    }
+    for (size_t i = 0; i < ArrayList_get_length(&body->labels); ++i) {
+        IrFunction_new_label(ir, IR_LABEL_INLINE, INLINER.next_label++);
+    }
+    int end = IrFunction_new_label(ir, IR_LABEL_INLINE,
+                                   INLINER.next_label++);
+    ir->nb_temps += body->nb_temps;
+
+    // The arguments, in the order of their IR_ARG
+    for (size_t k = 0; k < body->nb_params; ++k) {
+        const IrInstr* arg = ArrayList_get(out, first_arg + k);
+        const Symbol* param = vars[k];
+        IrInstr store = {
+            .op = IR_STORE,
+            .type = param->symbol_type == SYMBOL_ARRAY ? type_num
+                                                       : param->type,
+            .a = arg->a,
+            .symbol = param,
+        };
+        *(IrInstr*)ArrayList_get(out, first_arg + k) = store;
+    }
+
+    for (size_t i = 0; i < len; ++i) {
+        IrInstr instr = instrs[i];
+
+        if (instr.dst) {
+            instr.dst += temps;
+        }
+        if (instr.a) {
+            instr.a += temps;
+        }
+        if (instr.b && !(instr.flags & IR_IMM_B)) {
+            instr.b += temps;
+        }
+        if (instr.op == IR_LABEL || IrInstr_is_jump(&instr)) {
+            instr.number += labels;
+        }
+        if (_Inliner_has_symbol(&instr) && !instr.symbol->is_static) {
+            instr.symbol = vars[instr.symbol - body->vars];
+        }
+        if (instr.op == IR_RETURN) {
+            if (instr.a) {
+                ArrayList_append(out, &(IrInstr){.op = IR_STORE,
+                                                 .type = body->ret_type,
+                                                 .a = instr.a,
+                                                 .symbol = ret});
+            }
+            if (i + 1 < len) {
+                ArrayList_append(out,
+                                 &(IrInstr){.op = IR_JUMP, .number = end});
+            }
+            continue;
+        }
+        ArrayList_append(out, &instr);
+    }
+    ArrayList_append(out, &(IrInstr){.op = IR_LABEL, .number = end});
+    if (call->dst) {
+        ArrayList_append(out, &(IrInstr){.op = IR_LOAD,
+                                         .type = call->type,
+                                         .dst = call->dst,
+                                         .symbol = ret});
+    }
+    free(vars);
+}
+
+/**
+ * @brief Update the temps not used yet after an instruction of the caller
+ *
+ * @param values [IrTemp] Temps not used yet, the last on top
+ * @param instr
+ */
+static void _Inliner_track(ArrayList* values, const IrInstr* instr) {
+    size_t used = (instr->a != IR_NO_TEMP) +
+                  (instr->b != IR_NO_TEMP && !(instr->flags & IR_IMM_B));
+    size_t len = ArrayList_get_length(values);
+
+    ArrayList_resize(values, len - used);
+    // A logical result is defined once on each path to its end label
+    if (IrInstr_has_dst(instr) &&
+        (len == used ||
+         ArrayList_get_v(values, len - used - 1, IrTemp) != instr->dst)) {
+        IrTemp dst = instr->dst;
+        ArrayList_append(values, &dst);
+    }
+}
+
+void Inliner_function(IrFunction* ir) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&ir->instrs);
+    ArrayList out;     // [IrInstr]
+    ArrayList values;  // [IrTemp] Temps not used yet, the last on top
+
+    if (INLINER.budget <= 0) {
+        return;
+    }
+    ArrayList_init(&out, sizeof(IrInstr), len, NULL);
+    ArrayList_init(&values, sizeof(IrTemp), 0, NULL);
+    for (size_t i = 0; i < len; ++i) {
+        const InlineBody* body;
+        if (instrs[i].op == IR_CALL &&
+            (body = _Inliner_callee(ir, &instrs[i],
+                                    ArrayList_get_length(&values)))) {
+            _Inliner_call(ir, &out, &instrs[i], body);
+        } else {
+            ArrayList_append(&out, &instrs[i]);
+        }
+        _Inliner_track(&values, &instrs[i]);
+    }
+    ArrayList_free(&values);
+    ArrayList_free(&ir->instrs);
+    ir->instrs = out;
+    _Inliner_record(ir);
+}
+
+void Inliner_print_stats(FILE* out) {
+    if (INLINER.inlined || INLINER.kept) {
+        fprintf(out, "inline %-13s %10zu calls\n", "inlined",
+                INLINER.inlined);
+        fprintf(out, "inline %-13s %10zu calls\n", "kept", INLINER.kept);
+    }
+}
+
+void Inliner_free(void) {
+    for (size_t i = 0; i < ArrayList_get_length(&INLINER.bodies); ++i) {
+        InlineBody* body = ArrayList_get(&INLINER.bodies, i);
+        if (body->verdict == INLINE_OK) {
+            free(body->vars);
+            free(body->globals);
+            ArrayList_free(&body->instrs);
+            ArrayList_free(&body->labels);
+        }
+    }
+    ArrayList_free(&INLINER.bodies);
+    AtomMap_free(&INLINER.index);
+}
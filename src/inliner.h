@@ -0,0 +1,52 @@
+/**
+ * @file inliner.h
+ * @brief Inlining of the calls to small functions, on the IR : the body
+ * of the callee replaces the call, with its parameters and locals renamed
+ * in the stack frame of the caller
+ *
+ */
+
+#ifndef INLINER_H
+#define INLINER_H
+
+#include <stdio.h>
+
+#include "ir.h"
+
+#define INLINER_DEFAULT_BUDGET 32  // IR instructions
+
+/**
+ * @brief Set the largest function inlined, and where to report the calls
+ *
+ * @param budget Largest inlined function, in IR instructions after its
+ * own calls are inlined, 0 disables inlining
+ * @param report Receives a line for each call to a user function,
+ * inlined or not (--inline-report), NULL to print nothing
+ */
+void Inliner_select(int budget, FILE* report);
+
+/**
+ * @brief Inline the calls to the functions already lowered which fit in
+ * the budget, and are not recursive. Then keep a copy of the function,
+ * for the calls of the next ones (the functions are lowered in the order
+ * of their definition, and a function is never inlined in a function
+ * defined before it).
+ *
+ * @param ir Function just lowered
+ */
+void Inliner_function(IrFunction* ir);
+
+/**
+ * @brief Print the number of calls inlined, and kept, over every function
+ *
+ * @param out
+ */
+void Inliner_print_stats(FILE* out);
+
+/**
+ * @brief Free the copies of the lowered functions
+ *
+ */
+void Inliner_free(void);
+
+#endif
@@ -0,0 +1,136 @@
+#include "intern.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arena.h"
+#include "arraylist.h"
+#include "error.h"
+
+typedef struct InternEntry {
+    const char* str;  // NUL-terminated, allocated in the strings arena
+    uint32_t len;
+    uint32_t hash;
+} InternEntry;
+
+static struct {
+    Arena strings;
+    ArrayList entries;  // [InternEntry], indexed by atom
+    Atom* slots;        // Open addressing table (linear probing) of atoms
+    size_t nb_slots;    // Power of two, ATOM_NONE marks an empty slot
+} INTERN = {0};
+
+#define INTERN_INITIAL_SLOTS 1024
+
+static uint32_t _Intern_hash(const char* str, size_t len) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ (uint8_t)str[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void _Intern_out_of_memory(void) {
+    fprintf(stderr, "Run out of memory\n");
+    exit(EXIT_CODE(ERR_NO_MEMORY));
+}
+
+static void _Intern_init(void) {
+    InternEntry none = {.str = "", .len = 0};
+
+    Arena_init(&INTERN.strings, ARENA_DEFAULT_CHUNK_SIZE);
+    if (ArrayList_init(&INTERN.entries, sizeof(InternEntry),
+                       INTERN_INITIAL_SLOTS / 2, NULL) < 0 ||
+        !(INTERN.slots = calloc(INTERN_INITIAL_SLOTS, sizeof(Atom)))) {
+        _Intern_out_of_memory();
+    }
+    INTERN.nb_slots = INTERN_INITIAL_SLOTS;
+    // Atom 0 is reserved for ATOM_NONE
+    ArrayList_append(&INTERN.entries, &none);
+}
+
+/**
+ * @brief Double the number of slots, and re-insert every atom
+ */
+static void _Intern_grow(void) {
+    size_t nb_slots = INTERN.nb_slots * 2;
+    Atom* slots = calloc(nb_slots, sizeof(Atom));
+    if (!slots) {
+        _Intern_out_of_memory();
+    }
+
+    ARRAYLIST_DECLARE_ARRAY(INTERN.entries, InternEntry, entries);
+    for (Atom atom = 1; atom < INTERN.entries.len; ++atom) {
+        size_t i = entries[atom].hash & (nb_slots - 1);
+        while (slots[i] != ATOM_NONE) {
+            i = (i + 1) & (nb_slots - 1);
+        }
+        slots[i] = atom;
+    }
+
+    free(INTERN.slots);
+    INTERN.slots = slots;
+    INTERN.nb_slots = nb_slots;
+}
+
+Atom Intern_add(const char* str, size_t len) {
+    if (INTERN.slots == NULL) {
+        _Intern_init();
+    }
+
+    uint32_t hash = _Intern_hash(str, len);
+    size_t i = hash & (INTERN.nb_slots - 1);
+
+    for (Atom atom; (atom = INTERN.slots[i]) != ATOM_NONE;
+         i = (i + 1) & (INTERN.nb_slots - 1)) {
+        const InternEntry* entry = ArrayList_get(&INTERN.entries, atom);
+        if (entry->hash == hash && entry->len == len &&
+            !memcmp(entry->str, str, len)) {
+            return atom;
+        }
+    }
+
+    char* copy = Arena_alloc(&INTERN.strings, len + 1);
+    if (!copy) {
+        _Intern_out_of_memory();
+    }
+    memcpy(copy, str, len);
+    copy[len] = '\0';
+
+    Atom atom = INTERN.entries.len;
+    InternEntry entry = {.str = copy, .len = len, .hash = hash};
+    if (ArrayList_append(&INTERN.entries, &entry) < 0) {
+        _Intern_out_of_memory();
+    }
+    INTERN.slots[i] = atom;
+
+    // Keep the load factor under 1/2
+    if (INTERN.entries.len * 2 > INTERN.nb_slots) {
+        _Intern_grow();
+    }
+
+    return atom;
+}
+
+Atom Intern_cstr(const char* str) {
+    return Intern_add(str, strlen(str));
+}
+
+const char* Intern_str(Atom atom) {
+    const InternEntry* entry = ArrayList_get(&INTERN.entries, atom);
+    return entry ? entry->str : NULL;
+}
+
+Atom Intern_count(void) {
+    return INTERN.entries.len ? (Atom)INTERN.entries.len : 1;
+}
+
+void Intern_free(void) {
+    Arena_free(&INTERN.strings);
+    ArrayList_free(&INTERN.entries);
+    free(INTERN.slots);
+    INTERN.slots = NULL;
+    INTERN.nb_slots = 0;
+}
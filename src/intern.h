@@ -0,0 +1,55 @@
+#ifndef INTERN_H
+#define INTERN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Identifier of an interned string.
+ * Two equal strings always get the same atom, so comparing
+ * identifiers is an integer comparison.
+ */
+typedef uint32_t Atom;
+
+#define ATOM_NONE ((Atom)0)  // Never returned by Intern_add
+
+/**
+ * @brief Intern a string of len bytes (not necessarily NUL-terminated)
+ *
+ * @param str String to intern
+ * @param len Length of the string
+ * @return Atom Atom of the string, the same for every equal string
+ */
+Atom Intern_add(const char* str, size_t len);
+
+/**
+ * @brief Intern a NUL-terminated string
+ *
+ * @param str String to intern
+ * @return Atom
+ */
+Atom Intern_cstr(const char* str);
+
+/**
+ * @brief Get the string of an atom
+ *
+ * @param atom Atom returned by Intern_add
+ * @return const char* NUL-terminated string,
+ * valid until Intern_free is called
+ */
+const char* Intern_str(Atom atom);
+
+/**
+ * @brief Get the number of atoms, ATOM_NONE included :
+ * every atom returned so far is lower than this count
+ *
+ * @return Atom
+ */
+Atom Intern_count(void);
+
+/**
+ * @brief Free every interned string
+ */
+void Intern_free(void);
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * @file ir.c
+ * @brief Linear intermediate representation of a function
+ *
+ */
+
+#include "ir.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static const char* LABEL_NAMES[] = {
+    [IR_LABEL_BOOL_TRUE] = "bool_true_",
+    [IR_LABEL_BOOL_FALSE] = "bool_false_",
+    [IR_LABEL_BOOL_END] = "bool_end_",
+    [IR_LABEL_ELSE] = "else_",
+    [IR_LABEL_END_IF] = "end_if_",
+    [IR_LABEL_WHILE_START] = "while_start_",
+    [IR_LABEL_WHILE_BODY] = "while_body_",
+    [IR_LABEL_INLINE] = "inline_",
+};
+
+void IrFunction_init(IrFunction* self, const FunctionST* func) {
+    self->func = func;
+    self->frame_size = func->locals.next_addr;
+    self->nb_temps = 0;
+    ArrayList_init(&self->instrs, sizeof(IrInstr), 64, NULL);
+    ArrayList_init(&self->labels, sizeof(IrLabel), 0, NULL);
+    ArrayList_init(&self->homes, sizeof(IrHome), 0, NULL);
+    ArrayList_init(&self->inlined, sizeof(Symbol*), 0, NULL);
+}
+
+int IrFunction_new_label(IrFunction* self, IrLabelKind kind, int number) {
+    IrLabel label = {.kind = kind, .number = number};
+    ArrayList_append(&self->labels, &label);
+    return (int)ArrayList_get_length(&self->labels) - 1;
+}
+
+void IrFunction_append(IrFunction* self, IrInstr instr) {
+    ArrayList_append(&self->instrs, &instr);
+}
+
+const char* IrFunction_label_name(const IrFunction* self, int label,
+                                  char* buffer, size_t size) {
+    const IrLabel* name = ArrayList_get(&self->labels, label);
+    snprintf(buffer, size, "%s%d", LABEL_NAMES[name->kind], name->number);
+    return buffer;
+}
+
+void IrFunction_compact(IrFunction* self) {
+    ARRAYLIST_DECLARE_ARRAY(self->instrs, IrInstr, instrs);
+    size_t len = 0;
+
+    for (size_t i = 0; i < ArrayList_get_length(&self->instrs); ++i) {
+        if (instrs[i].op != IR_NOP) {
+            instrs[len++] = instrs[i];
+        }
+    }
+    ArrayList_resize(&self->instrs, len);
+}
+
+/**
+ * @brief Print the b operand of an instruction, a temp or an immediate
+ *
+ * @param instr
+ * @param out
+ */
+static void _IrInstr_print_b(const IrInstr* instr, Emitter* out) {
+    if (instr->flags & IR_IMM_B) {
+        Emitter_printf(out, "%ld", instr->imm);
+    } else {
+        Emitter_printf(out, "t%u", instr->b);
+    }
+}
+
+/**
+ * @brief Print the variable of a load or a store
+ *
+ * @param instr
+ * @param out
+ */
+static void _IrInstr_print_var(const IrInstr* instr, Emitter* out) {
+    const char* name = Intern_str(instr->symbol->identifier);
+
+    if (instr->op == IR_LOAD_ELEM || instr->op == IR_STORE_ELEM) {
+        Emitter_printf(out, "%s%s[t%u]",
+                       instr->type == type_byte ? "byte " : "", name,
+                       instr->a);
+    } else {
+        Emitter_printf(out, "%s%s", instr->type == type_byte ? "byte " : "",
+                       name);
+    }
+    if (instr->number) {
+        Emitter_printf(out, " (%s)", Register_to_str(instr->number));
+    }
+}
+
+/**
+ * @brief Print an instruction on a line
+ *
+ * @param self Function of the instruction
+ * @param instr
+ * @param out
+ */
+static void _IrInstr_print(const IrFunction* self, const IrInstr* instr,
+                           Emitter* out) {
+    char label[32];
+
+    if (instr->op == IR_NOP) {
+        return;
+    }
+    if (instr->op == IR_LABEL) {
+        Emitter_printf(out, ".%s:\n",
+                       IrFunction_label_name(self, instr->number, label,
+                                             sizeof(label)));
+        return;
+    }
+    Emitter_puts(out, "    ");
+    if (IrInstr_has_dst(instr)) {
+        Emitter_printf(out, "t%u = ", instr->dst);
+    }
+    switch ((IrOp)instr->op) {
+        case IR_CONST:
+            Emitter_printf(out, "%ld", instr->imm);
+            break;
+        case IR_LOAD:
+        case IR_LOAD_ELEM:
+            Emitter_puts(out, "load ");
+            _IrInstr_print_var(instr, out);
+            break;
+        case IR_ADDR:
+            Emitter_printf(out, "addr %s",
+                           Intern_str(instr->symbol->identifier));
+            break;
+        case IR_STORE:
+            Emitter_puts(out, "store ");
+            _IrInstr_print_var(instr, out);
+            Emitter_printf(out, ", t%u", instr->a);
+            break;
+        case IR_STORE_ELEM:
+            Emitter_puts(out, "store ");
+            _IrInstr_print_var(instr, out);
+            Emitter_printf(out, ", t%u", instr->b);
+            break;
+        case IR_BINARY:
+        case IR_CMP:
+            Emitter_printf(out, "t%u %s ", instr->a,
+                           Operator_to_str(instr->oper));
+            _IrInstr_print_b(instr, out);
+            break;
+        case IR_NEG:
+            Emitter_printf(out, "-t%u", instr->a);
+            break;
+        case IR_NOT:
+            Emitter_printf(out, "!t%u", instr->a);
+            break;
+        case IR_JUMP:
+            Emitter_printf(out, "jmp .%s",
+                           IrFunction_label_name(self, instr->number, label,
+                                                 sizeof(label)));
+            break;
+        case IR_JUMP_ZERO:
+        case IR_JUMP_NONZERO:
+            Emitter_printf(out, "%s t%u, .%s",
+                           instr->op == IR_JUMP_ZERO ? "jz" : "jnz",
+                           instr->a,
+                           IrFunction_label_name(self, instr->number, label,
+                                                 sizeof(label)));
+            break;
+        case IR_JUMP_CMP:
+            Emitter_printf(out, "jcmp t%u %s ", instr->a,
+                           Operator_to_str(instr->oper));
+            _IrInstr_print_b(instr, out);
+            Emitter_printf(out, ", .%s",
+                           IrFunction_label_name(self, instr->number, label,
+                                                 sizeof(label)));
+            break;
+        case IR_ARG:
+            Emitter_printf(out, "arg %d, t%u", instr->number, instr->a);
+            break;
+        case IR_CALL:
+            Emitter_printf(out, "call %s, %d", Intern_str(instr->callee),
+                           instr->number);
+            break;
+        case IR_RETURN:
+            Emitter_puts(out, "ret");
+            if (instr->a != IR_NO_TEMP) {
+                Emitter_printf(out, " t%u", instr->a);
+            }
+            break;
+        default:
+            assert(0 && "Unknown IR instruction");
+    }
+    Emitter_puts(out, "\n");
+}
+
+void IrFunction_print(const IrFunction* self, Emitter* out) {
+    Emitter_printf(out, "function %s:\n",
+                   Intern_str(self->func->identifier));
+    for (size_t i = 0; i < ArrayList_get_length(&self->instrs); ++i) {
+        _IrInstr_print(self, ArrayList_get(&self->instrs, i), out);
+    }
+    Emitter_puts(out, "\n");
+}
+
+void IrFunction_free(IrFunction* self) {
+    ArrayList_free(&self->instrs);
+    ArrayList_free(&self->labels);
+    ArrayList_free(&self->homes);
+    for (size_t i = 0; i < ArrayList_get_length(&self->inlined); ++i) {
+        free(ArrayList_get_v(&self->inlined, i, Symbol*));
+    }
+    ArrayList_free(&self->inlined);
+}
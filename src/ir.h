@@ -0,0 +1,221 @@
+/**
+ * @file ir.h
+ * @brief Linear intermediate representation of a function : three-address
+ * instructions on virtual registers (temps), between the syntax tree
+ * (lowered by treeReader) and the assembly (written by codeWriter)
+ *
+ */
+
+#ifndef IR_H
+#define IR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "arraylist.h"
+#include "emitter.h"
+#include "intern.h"
+#include "symbol.h"
+#include "symbolTable.h"
+#include "tree.h"
+
+/**
+ * @brief Virtual register holding the value of an expression.
+ * Temps are used in the order of a stack : an instruction uses the last
+ * defined temps not used yet (the last one on top), each exactly once.
+ * Passes keep this order, the code generator relies on it.
+ * A temp is defined once, but the result of a logical operation, defined
+ * on each path reaching its end label.
+ */
+typedef uint32_t IrTemp;
+
+#define IR_NO_TEMP ((IrTemp)0)
+
+typedef enum IrOp {
+    IR_NOP,         // Removed by a pass, skipped
+    IR_CONST,       // dst = imm
+    IR_LOAD,        // dst = symbol
+    IR_LOAD_ELEM,   // dst = symbol[a]
+    IR_ADDR,        // dst = address of the array symbol
+    IR_STORE,       // symbol = a
+    IR_STORE_ELEM,  // symbol[a] = b, the index a is on top
+    IR_BINARY,      // dst = a oper b, OP_ADD to OP_MOD
+    IR_CMP,         // dst = a oper b, OP_EQ to OP_GE, 0 or 1
+    IR_NEG,         // dst = -a
+    IR_NOT,         // dst = !a
+    IR_LABEL,       // Start of a basic block
+    IR_JUMP,        // goto label
+    IR_JUMP_ZERO,   // if a == 0 goto label
+    IR_JUMP_NONZERO,  // if a != 0 goto label
+    IR_JUMP_CMP,    // if a oper b goto label, OP_EQ to OP_GE
+    IR_ARG,         // Argument number of the next call is a
+    IR_CALL,        // dst = callee(arguments), dst is IR_NO_TEMP if unused
+    IR_RETURN,      // Return a (IR_NO_TEMP if none), leaving the frame
+} IrOp;
+
+// IrInstr.flags
+#define IR_IMM_B 1    // b is the immediate imm, not a temp
+#define IR_FORWARD 2  // IR_CALL of a function defined after the caller
+
+typedef struct IrInstr {
+    uint8_t op;     // IrOp
+    uint8_t type;   // type_t of the value loaded, stored or returned
+    uint8_t oper;   // Operator of IR_BINARY, IR_CMP and IR_JUMP_CMP
+    uint8_t flags;  // IR_IMM_B, IR_FORWARD
+    IrTemp dst;
+    IrTemp a, b;
+    int number; /*<
+        Label of IR_LABEL and jumps, position of IR_ARG, number of
+        arguments of IR_CALL, Register holding the variable of IR_LOAD
+        and IR_STORE (0 if it is in memory, see RegAlloc_function) */
+    union {
+        long imm;               // IR_CONST, b with IR_IMM_B
+        const Symbol* symbol;   // Variable of loads and stores
+        Atom callee;            // IR_CALL
+    };
+} IrInstr;
+
+typedef enum IrLabelKind {
+    IR_LABEL_BOOL_TRUE,
+    IR_LABEL_BOOL_FALSE,
+    IR_LABEL_BOOL_END,
+    IR_LABEL_ELSE,
+    IR_LABEL_END_IF,
+    IR_LABEL_WHILE_START,  // Condition of a loop, after its body
+    IR_LABEL_WHILE_BODY,
+    IR_LABEL_INLINE,  // Of the body of an inlined call, and its end
+} IrLabelKind;
+
+/**
+ * @brief Label of a function, named from its kind and a number
+ * unique in the program (`.else_3`)
+ */
+typedef struct IrLabel {
+    IrLabelKind kind;
+    int number;
+} IrLabel;
+
+/**
+ * @brief Register holding a local variable or a parameter
+ * during the whole function
+ */
+typedef struct IrHome {
+    const Symbol* symbol;
+    Register reg;
+} IrHome;
+
+typedef struct IrFunction {
+    const FunctionST* func;
+    ArrayList instrs;  // [IrInstr]
+    ArrayList labels;  // [IrLabel] indexed by IrInstr.number
+    ArrayList homes;   // [IrHome] Variables kept in a register
+    ArrayList inlined; /*<
+        [Symbol*] Variables of the inlined calls, renamed in the frame :
+        numbered (Symbol.index) after the locals */
+    size_t frame_size;  // Of the locals and of the inlined variables
+    IrTemp nb_temps;    // Temps are numbered from 1
+} IrFunction;
+
+/**
+ * @brief Initialize an empty function
+ *
+ * @param self
+ * @param func Symbol table of the function
+ */
+void IrFunction_init(IrFunction* self, const FunctionST* func);
+
+/**
+ * @brief Get a new temp
+ *
+ * @param self
+ * @return IrTemp
+ */
+static inline IrTemp IrFunction_new_temp(IrFunction* self) {
+    return ++self->nb_temps;
+}
+
+/**
+ * @brief Get a new label
+ *
+ * @param self
+ * @param kind
+ * @param number Number of the label in its name
+ * @return int Label of IrInstr.number
+ */
+int IrFunction_new_label(IrFunction* self, IrLabelKind kind, int number);
+
+/**
+ * @brief Append an instruction
+ *
+ * @param self
+ * @param instr
+ */
+void IrFunction_append(IrFunction* self, IrInstr instr);
+
+/**
+ * @brief Get the name of a label, without its leading dot
+ *
+ * @param self
+ * @param label Label of IrInstr.number
+ * @param buffer Receives the name
+ * @param size Size of buffer
+ * @return const char* buffer
+ */
+const char* IrFunction_label_name(const IrFunction* self, int label,
+                                  char* buffer, size_t size);
+
+/**
+ * @brief Remove the IR_NOP instructions left by a pass
+ *
+ * @param self
+ */
+void IrFunction_compact(IrFunction* self);
+
+/**
+ * @brief Tell whether an instruction defines its dst temp
+ *
+ * @param instr
+ * @return bool
+ */
+static inline bool IrInstr_has_dst(const IrInstr* instr) {
+    return instr->dst != IR_NO_TEMP;
+}
+
+/**
+ * @brief Tell whether the next instruction is never reached
+ * from an instruction
+ *
+ * @param instr
+ * @return bool
+ */
+static inline bool IrInstr_ends_block(const IrInstr* instr) {
+    return instr->op == IR_JUMP || instr->op == IR_RETURN;
+}
+
+/**
+ * @brief Tell whether an instruction jumps to IrInstr.number
+ *
+ * @param instr
+ * @return bool
+ */
+static inline bool IrInstr_is_jump(const IrInstr* instr) {
+    return instr->op == IR_JUMP || instr->op == IR_JUMP_ZERO ||
+           instr->op == IR_JUMP_NONZERO || instr->op == IR_JUMP_CMP;
+}
+
+/**
+ * @brief Print a function in text (--emit-ir)
+ *
+ * @param self
+ * @param out
+ */
+void IrFunction_print(const IrFunction* self, Emitter* out);
+
+/**
+ * @brief Free the instructions of a function
+ *
+ * @param self
+ */
+void IrFunction_free(IrFunction* self);
+
+#endif
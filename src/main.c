@@ -6,13 +6,32 @@
  *
  */
 
+#include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 
+#include "astCache.h"
 #include "codeWriter.h"
+#include "dump.h"
+#include "emitter.h"
+#include "fold.h"
+#include "inliner.h"
+#include "intern.h"
 #include "parser.h"
+#include "passes.h"
+#include "peephole.h"
 #include "program.h"
+#include "regAlloc.h"
+#include "scanner.h"
 #include "semantic.h"
+#include "source.h"
+#include "stream.h"
 #include "symbolTable.h"
 #include "tpc_bison.h"
 #include "tree.h"
@@ -20,68 +39,322 @@
 
 Program PROGRAM = {0};
 
+/**
+ * @brief Print the statistics asked by --stats :
+ * the size of the generated assembly, if any, the time of each pass,
+ * the folded nodes, the inlined calls, the variables kept in registers,
+ * and the peak memory usage of the whole compilation
+ *
+ * @param out
+ */
+static void print_stats(FILE* out) {
+    struct rusage usage;
+
+    if (PROGRAM.emitter.out) {
+        Emitter_print_stats(&PROGRAM.emitter, out);
+    }
+    if (PROGRAM.emitter.peephole) {
+        Peephole_print_stats(&PROGRAM.peephole, out);
+    }
+    Passes_print_stats(out);
+    Fold_print_stats(out);
+    Inliner_print_stats(out);
+    RegAlloc_print_stats(out);
+    if (PROGRAM.opt.ast_cache) {
+        fprintf(out, "ast cache %15s\n",
+                PROGRAM.ast_cache_hit ? "hit" : "miss");
+    }
+    if (!getrusage(RUSAGE_SELF, &usage)) {
+        // ru_maxrss is in kilobytes on Linux
+        fprintf(out, "peak RSS %16ld KiB\n", usage.ru_maxrss);
+    }
+}
+
 void atexit_function(void) {
-    if (PROGRAM.abr) {
-        deleteTree(PROGRAM.abr);
+    CodeError_flush();
+    if (PROGRAM.opt.flag_stats) {
+        print_stats(stderr);
     }
+    deleteNodes();
+    Emitter_free(&PROGRAM.dump);
+    Emitter_free(&PROGRAM.emitter);
     if (PROGRAM.file_out &&
         PROGRAM.file_out != stdout &&
         PROGRAM.file_out != stderr) {
         fclose(PROGRAM.file_out);
     }
+    if (PROGRAM.temp_output) {
+        remove(PROGRAM.temp_output);
+        free(PROGRAM.temp_output);
+    }
     ProgramST_free(&PROGRAM.symtable);
+    CodeWriter_free();
+    Inliner_free();
+    Peephole_free(&PROGRAM.peephole);
+    Source_free(&PROGRAM.source);
+    Intern_free();
+}
+
+/**
+ * @brief Scan the whole source without parsing it,
+ * and print the scanner throughput, and a digest of the tokens
+ * (to compare the scanners)
+ *
+ * @param source
+ */
+static void lexer_benchmark(Source* source) {
+    struct timespec start, end;
+    uint64_t digest;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    size_t nb_tokens = Scanner_scan_all(source, &digest);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (end.tv_sec - start.tv_sec) +
+                     (end.tv_nsec - start.tv_nsec) * 1e-9;
+    printf("%zu tokens (digest %016" PRIx64 "), "
+           "%zu bytes in %.6f s (%.1f MB/s)\n",
+           nb_tokens, digest, source->len, elapsed,
+           elapsed > 0 ? source->len / elapsed * 1e-6 : 0.);
+}
+
+/**
+ * @brief Create a temporary file in the directory of the output file,
+ * with the permissions fopen would give to the output file
+ *
+ * @return FILE* NULL if it cannot be created
+ */
+static FILE* open_temp_output(void) {
+    size_t len = strlen(PROGRAM.opt.output);
+    char* path = malloc(len + sizeof(".XXXXXX"));
+    mode_t mask = umask(0);
+    FILE* file = NULL;
+    int fd = -1;
+
+    umask(mask);
+    if (path) {
+        memcpy(path, PROGRAM.opt.output, len);
+        strcpy(path + len, ".XXXXXX");
+        fd = mkstemp(path);
+    }
+    if (fd >= 0 && !fchmod(fd, 0666 & ~mask)) {
+        file = fdopen(fd, "w");
+    }
+    if (!file) {
+        if (fd >= 0) {
+            close(fd);
+            remove(path);
+        }
+        free(path);
+        return NULL;
+    }
+    PROGRAM.temp_output = path;
+    return file;
+}
+
+/**
+ * @brief Open the assembly output file, and start writing into it
+ *
+ * @param temporary Write a temporary file instead, renamed to the
+ * output file by commit_output, if the output file is a regular file
+ * (not a device like /dev/null)
+ * @return ErrorType ERR_FILE_OPEN if the file cannot be opened
+ */
+static ErrorType open_output(bool temporary) {
+    struct stat st;
+
+    if (!strcmp(PROGRAM.opt.output, "-")) {
+        PROGRAM.file_out = stdout;
+    } else if (temporary && (stat(PROGRAM.opt.output, &st)
+                                 ? errno == ENOENT
+                                 : S_ISREG(st.st_mode))) {
+        if (!(PROGRAM.file_out = open_temp_output())) {
+            perror("mkstemp");
+            return ERR_FILE_OPEN;
+        }
+    } else if (!(PROGRAM.file_out = fopen(PROGRAM.opt.output, "w"))) {
+        perror("fopen");
+        return ERR_FILE_OPEN;
+    }
+
+    Emitter_init(&PROGRAM.emitter, PROGRAM.file_out, PROGRAM.opt.asm_comments);
+    if (PROGRAM.opt.opt_level >= 1) {
+        Peephole_init(&PROGRAM.peephole, &PROGRAM.emitter);
+    }
+    return ERR_NONE;
+}
+
+/**
+ * @brief Replace the output file by the temporary file written,
+ * if any
+ *
+ * @return ErrorType ERR_FILE_OPEN if it cannot be renamed
+ */
+static ErrorType commit_output(void) {
+    if (!PROGRAM.temp_output) {
+        return ERR_NONE;
+    }
+    if (rename(PROGRAM.temp_output, PROGRAM.opt.output)) {
+        perror("rename");
+        return ERR_FILE_OPEN;
+    }
+    free(PROGRAM.temp_output);
+    PROGRAM.temp_output = NULL;
+    return ERR_NONE;
+}
+
+/**
+ * @brief Compile the program one function at a time (--stream).
+ * The assembly is written during the compilation in a temporary file,
+ * which replaces the output file only if the program is valid : an
+ * invalid program leaves the output file as it was.
+ *
+ * @return int Exit code
+ */
+static int compile_stream(void) {
+    Emitter* nasm = NULL;
+
+    if (!PROGRAM.opt.flag_semantic) {
+        if (open_output(true)) {
+            return EXIT_CODE(ERR_FILE_OPEN);
+        }
+        nasm = &PROGRAM.emitter;
+    }
+
+    ErrorType err = Stream_compile(&PROGRAM.source, &PROGRAM.symtable, nasm);
+    Emitter_flush(&PROGRAM.dump);  // --emit-ir
+
+    if (IS_PARSE_ERROR(err) || IS_SEMANTIC(err) || IS_CRITICAL(err)) {
+        return EXIT_CODE(err);
+    }
+
+    if (nasm && Emitter_flush(nasm)) {
+        perror("write");
+        return EXIT_CODE(ERR_FILE_OPEN);
+    }
+    if (commit_output()) {
+        return EXIT_CODE(ERR_FILE_OPEN);
+    }
+
+    return EXIT_CODE(err);
+}
+
+/**
+ * @brief Build the syntax tree of the source : load it from the cache
+ * (--ast-cache) if the cache holds it, else parse the source,
+ * and keep the new tree in the cache
+ *
+ * @return ErrorType Same as parser_bison
+ */
+static ErrorType parse_source(void) {
+    const char* cache = PROGRAM.opt.ast_cache;
+
+    if (!cache) {
+        return parser_bison(&PROGRAM.source, &PROGRAM.abr);
+    }
+
+    uint64_t hash = AstCache_hash(&PROGRAM.source);
+    if (AstCache_load(cache, hash, &PROGRAM.source, &PROGRAM.abr)) {
+        PROGRAM.ast_cache_hit = true;
+        return ERR_NONE;
+    }
+
+    ErrorType err = parser_bison(&PROGRAM.source, &PROGRAM.abr);
+    if (err == ERR_NONE &&
+        AstCache_store(cache, hash, &PROGRAM.source, PROGRAM.abr)) {
+        // The compilation goes on, only the next one parses again
+        fprintf(stderr, "Cannot write the syntax tree in %s\n", cache);
+    }
+
+    return err;
 }
 
 int main(int argc, char* argv[]) {
     atexit(atexit_function);
-    extern FILE* yyin;
+    FILE* file_in = stdin;
     PROGRAM.opt = parser(argc, argv);
+    Scanner_select(PROGRAM.opt.scanner);
+    CodeWriter_select(PROGRAM.opt.codegen);
+    Fold_select(PROGRAM.opt.flag_fold);
+    Inliner_select(PROGRAM.opt.inline_budget,
+                   PROGRAM.opt.flag_inline_report ? stderr : NULL);
+    Passes_select(PROGRAM.opt.opt_level,
+                  PROGRAM.opt.flag_emit_ir ? &PROGRAM.dump : NULL);
+    Emitter_init(&PROGRAM.dump, stdout, ASM_COMMENTS_NONE);
 
     if (PROGRAM.opt.path) {
-        yyin = (PROGRAM.file_in = fopen(PROGRAM.opt.path, "r"));
-        if (!yyin) {
+        file_in = fopen(PROGRAM.opt.path, "r");
+        if (!file_in) {
             perror("fopen");
             fprintf(stderr, "End of execution.\n");
             return EXIT_CODE(ERR_FILE_OPEN);
         }
     }
 
-    ErrorType err = parser_bison(yyin, &PROGRAM.abr);
-    // fclose(yyin);
+    ErrorType err = Source_load(&PROGRAM.source, file_in);
+    if (file_in != stdin) {
+        fclose(file_in);  // A mapping stays valid after closing its file
+    }
+    if (err) {
+        fprintf(stderr, "Cannot load %s\n",
+                PROGRAM.opt.path ? PROGRAM.opt.path : "stdin");
+        return EXIT_CODE(err);
+    }
+
+    if (PROGRAM.opt.flag_only_lex) {
+        lexer_benchmark(&PROGRAM.source);
+        return EXIT_SUCCESS;
+    }
 
-    if (IS_PARSE_ERROR(err)) {
+    if (PROGRAM.opt.flag_stream) {
+        return compile_stream();
+    }
+
+    err = parse_source();
+
+    if (IS_PARSE_ERROR(err) || IS_CRITICAL(err)) {
         return EXIT_CODE(err);
     }
 
     if (PROGRAM.opt.flag_show_tree) {
-        printTree(PROGRAM.abr);
+        Dump_tree(&PROGRAM.dump, &PROGRAM.source, PROGRAM.abr,
+                  PROGRAM.opt.dump_format);
+        Emitter_flush(&PROGRAM.dump);
     }
 
     if (PROGRAM.opt.flag_only_tree) {
         return EXIT_SUCCESS;
     }
 
-    ProgramST symtable;
-    err = ProgramST_from_Prog(&symtable, PROGRAM.abr);
+    ProgramST* symtable = &PROGRAM.symtable;
+    err = ProgramST_from_Prog(symtable, PROGRAM.abr);
+    CodeError_flush();
     if (PROGRAM.opt.flag_symtabs) {
-        ProgramST_print(&symtable);
+        Dump_symtabs(&PROGRAM.dump, symtable, PROGRAM.opt.dump_format);
+        Emitter_flush(&PROGRAM.dump);
     }
     if (IS_SEMANTIC(err) || IS_CRITICAL(err)) {
         return EXIT_CODE(err);
     }
 
-    err |= Semantic_check(PROGRAM.abr, &symtable);
+    ProgramST_bind(symtable, PROGRAM.abr);
+    err |= Semantic_check(PROGRAM.abr, symtable);
+    CodeError_flush();
     if (PROGRAM.opt.flag_semantic || IS_SEMANTIC(err) || IS_CRITICAL(err)) {
         return EXIT_CODE(err);
     }
 
-    PROGRAM.file_out = fopen(PROGRAM.opt.output, "w");
-    if (!PROGRAM.file_out) {
-        perror("fopen");
+    if (open_output(false)) {
         return EXIT_CODE(ERR_FILE_OPEN);
     }
 
-    TreeReader_Prog(&symtable, PROGRAM.abr, PROGRAM.file_out);
+    TreeReader_Prog(symtable, PROGRAM.abr, &PROGRAM.emitter);
+    Emitter_flush(&PROGRAM.dump);  // --emit-ir
+    err = Emitter_flush(&PROGRAM.emitter);
+    if (err) {
+        perror("write");
+        return EXIT_CODE(err);
+    }
 
     return EXIT_SUCCESS;
 }
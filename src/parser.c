@@ -9,6 +9,7 @@
 #include "parser.h"
 
 #include <getopt.h>
+#include <limits.h>
 #include <linux/limits.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -24,7 +25,7 @@
 static void print_help(char* path, int exitcode) {
     printf(
         "\nTPCC helper :\n\n"
-        "%s [-t] [-h] file\n\n"
+        "%s [-t] [-h] [-o output] file\n\n"
         "file :\n"
         "\t Path to the file to read.\n\n"
         "-t / --tree :\n"
@@ -37,8 +38,62 @@ static void print_help(char* path, int exitcode) {
         "\t Only generate the syntax tree, and stop the execution.\n\n"
         "-w / --only-semantic :\n"
         "\t Only generate the semantics errors/warnings,"
-        "and stop the execution.\n\n",
-        path);
+        "and stop the execution.\n\n"
+        "-l / --only-lex :\n"
+        "\t Only scan the file, print the number of tokens and the scanner "
+        "throughput, and stop the execution.\n\n"
+        "-O0 / -O1 / -O2 :\n"
+        "\t Optimization level : -O1 removes useless jumps and unreachable "
+        "code from the IR, and rewrites redundant instructions of the "
+        "assembly (peephole optimizer) ; -O2 also makes constant operands "
+        "immediates, divides by constants without idiv, inlines the calls "
+        "to small functions, and keeps the scalar variables in the "
+        "callee-saved registers. See --stats for the time of each pass, "
+        "and the number of rewrites.\n\n"
+        "-o / --output file :\n"
+        "\t Write the assembly to file ('-' for stdout), instead of the "
+        "input file name with a .asm extension.\n\n"
+        "--dump-format=text|json|binary :\n"
+        "\t Format of the tree (-t) and symbol tables (-s) printed on "
+        "stdout (default: text). The binary tree has the format of the "
+        "--ast-cache files.\n\n"
+        "--scanner=flex|simd :\n"
+        "\t Scanner of the file : the flex one, or the hand-written one "
+        "skipping blanks, comments and identifiers 16 bytes at a time "
+        "(same tokens).\n\n"
+        "--codegen=stack|registers :\n"
+        "\t Code of the expressions : every operand on the stack "
+        "(default), or operands in scratch registers, spilled on the stack "
+        "only when they run out.\n\n"
+        "--emit-ir :\n"
+        "\t Print the IR of each function on stdout, after the passes of "
+        "the optimization level.\n\n"
+        "--inline-budget=n :\n"
+        "\t Largest function inlined at -O2, in IR instructions "
+        "(default: %d, 0 disables inlining). Recursive functions, and "
+        "functions defined after the caller, are never inlined.\n\n"
+        "--inline-report :\n"
+        "\t Print on stderr each call to a user function at -O2, "
+        "inlined or not, and why.\n\n"
+        "--no-fold :\n"
+        "\t Do not fold the constant expressions (3 * 4 + 1) and the "
+        "algebraic identities (x + 0, x * 1, !!x in a condition) of the "
+        "syntax tree, done at every optimization level.\n\n"
+        "--asm-comments=none|brief|full :\n"
+        "\t Comments written in the assembly (default: full).\n\n"
+        "--stream :\n"
+        "\t Check and compile each function as soon as it is parsed, "
+        "and release it : memory does not grow with the size of the "
+        "program. Cannot be combined with -t, -s, -a and --ast-cache.\n\n"
+        "--ast-cache=dir :\n"
+        "\t Keep the syntax tree of the file in dir (which must exist), "
+        "and load it instead of parsing the file again while its content "
+        "does not change.\n\n"
+        "--stats :\n"
+        "\t Print statistics about the compilation on stderr "
+        "(assembly size, time of each pass, folded nodes, peak memory "
+        "usage).\n\n",
+        path, INLINER_DEFAULT_BUDGET);
     exit(exitcode);
 }
 
@@ -54,7 +109,20 @@ static Option init_option(void) {
         .flag_only_tree = false,
         .flag_symtabs = false,
         .flag_semantic = false,
-        .output = "_anonymous.asm",
+        .flag_only_lex = false,
+        .flag_stats = false,
+        .flag_stream = false,
+        .flag_emit_ir = false,
+        .flag_fold = true,
+        .ast_cache = NULL,
+        .scanner = SCANNER_DEFAULT,
+        .codegen = CODEGEN_STACK,
+        .opt_level = 0,
+        .inline_budget = INLINER_DEFAULT_BUDGET,
+        .flag_inline_report = false,
+        .dump_format = DUMP_TEXT,
+        .asm_comments = ASM_COMMENTS_FULL,
+        .output = NULL,
     };
 }
 
@@ -87,6 +155,152 @@ static char* default_output_name(char* path) {
     return result;
 }
 
+/**
+ * @brief Parse the value of --asm-comments
+ *
+ * @param path path to the executable (for the help menu)
+ * @param value
+ * @return AsmComments
+ */
+static AsmComments parse_asm_comments(char* path, const char* value) {
+    static const char* names[] = {
+        [ASM_COMMENTS_NONE] = "none",
+        [ASM_COMMENTS_BRIEF] = "brief",
+        [ASM_COMMENTS_FULL] = "full",
+    };
+
+    for (AsmComments level = ASM_COMMENTS_NONE; level <= ASM_COMMENTS_FULL;
+         ++level) {
+        if (!strcmp(value, names[level])) {
+            return level;
+        }
+    }
+    fprintf(stderr, "Invalid --asm-comments value '%s'\n", value);
+    print_help(path, EXIT_FAILURE);
+    return ASM_COMMENTS_FULL;
+}
+
+/**
+ * @brief Parse the value of --dump-format
+ *
+ * @param path path to the executable (for the help menu)
+ * @param value
+ * @return DumpFormat
+ */
+static DumpFormat parse_dump_format(char* path, const char* value) {
+    static const char* names[] = {
+        [DUMP_TEXT] = "text",
+        [DUMP_JSON] = "json",
+        [DUMP_BINARY] = "binary",
+    };
+
+    for (DumpFormat format = DUMP_TEXT; format <= DUMP_BINARY; ++format) {
+        if (!strcmp(value, names[format])) {
+            return format;
+        }
+    }
+    fprintf(stderr, "Invalid --dump-format value '%s'\n", value);
+    print_help(path, EXIT_FAILURE);
+    return DUMP_TEXT;
+}
+
+/**
+ * @brief Parse the value of --scanner
+ *
+ * @param path path to the executable (for the help menu)
+ * @param value
+ * @return ScannerKind
+ */
+static ScannerKind parse_scanner(char* path, const char* value) {
+    static const char* names[] = {
+        [SCANNER_FLEX] = "flex",
+        [SCANNER_SIMD] = "simd",
+    };
+
+    for (ScannerKind kind = SCANNER_FLEX; kind <= SCANNER_SIMD; ++kind) {
+        if (!strcmp(value, names[kind])) {
+            return kind;
+        }
+    }
+    fprintf(stderr, "Invalid --scanner value '%s'\n", value);
+    print_help(path, EXIT_FAILURE);
+    return SCANNER_DEFAULT;
+}
+
+/**
+ * @brief Parse the value of --codegen
+ *
+ * @param path path to the executable (for the help menu)
+ * @param value
+ * @return CodegenMode
+ */
+static CodegenMode parse_codegen(char* path, const char* value) {
+    if (!strcmp(value, "stack")) {
+        return CODEGEN_STACK;
+    }
+    if (!strcmp(value, "registers")) {
+        return CODEGEN_REGISTERS;
+    }
+    fprintf(stderr, "Invalid --codegen value '%s'\n", value);
+    print_help(path, EXIT_FAILURE);
+    return CODEGEN_STACK;
+}
+
+/**
+ * @brief Parse the value of -O
+ *
+ * @param path path to the executable (for the help menu)
+ * @param value
+ * @return int
+ */
+static int parse_opt_level(char* path, const char* value) {
+    if (!strcmp(value, "0")) {
+        return 0;
+    }
+    if (!strcmp(value, "1")) {
+        return 1;
+    }
+    if (!strcmp(value, "2")) {
+        return 2;
+    }
+    fprintf(stderr, "Invalid optimization level '-O%s'\n", value);
+    print_help(path, EXIT_FAILURE);
+    return 0;
+}
+
+/**
+ * @brief Parse the value of --inline-budget
+ *
+ * @param path path to the executable (for the help menu)
+ * @param value
+ * @return int
+ */
+static int parse_inline_budget(char* path, const char* value) {
+    char* end;
+    long budget = strtol(value, &end, 10);
+
+    if (end == value || *end || budget < 0 || budget > INT_MAX) {
+        fprintf(stderr, "Invalid --inline-budget value '%s'\n", value);
+        print_help(path, EXIT_FAILURE);
+    }
+    return (int)budget;
+}
+
+// Values of options without a short version
+enum {
+    OPT_ASM_COMMENTS = 256,
+    OPT_STATS,
+    OPT_STREAM,
+    OPT_AST_CACHE,
+    OPT_DUMP_FORMAT,
+    OPT_SCANNER,
+    OPT_CODEGEN,
+    OPT_EMIT_IR,
+    OPT_NO_FOLD,
+    OPT_INLINE_BUDGET,
+    OPT_INLINE_REPORT,
+};
+
 Option parser(int argc, char** argv) {
     Option option = init_option();
     int option_index = 0, opt;
@@ -96,9 +310,22 @@ Option parser(int argc, char** argv) {
         {"symtabs", no_argument, 0, 's'},
         {"only-tree", no_argument, 0, 'a'},
         {"only-semantic", no_argument, 0, 'w'},
+        {"only-lex", no_argument, 0, 'l'},
+        {"output", required_argument, 0, 'o'},
+        {"asm-comments", required_argument, 0, OPT_ASM_COMMENTS},
+        {"stats", no_argument, 0, OPT_STATS},
+        {"stream", no_argument, 0, OPT_STREAM},
+        {"ast-cache", required_argument, 0, OPT_AST_CACHE},
+        {"dump-format", required_argument, 0, OPT_DUMP_FORMAT},
+        {"scanner", required_argument, 0, OPT_SCANNER},
+        {"codegen", required_argument, 0, OPT_CODEGEN},
+        {"emit-ir", no_argument, 0, OPT_EMIT_IR},
+        {"no-fold", no_argument, 0, OPT_NO_FOLD},
+        {"inline-budget", required_argument, 0, OPT_INLINE_BUDGET},
+        {"inline-report", no_argument, 0, OPT_INLINE_REPORT},
         {0, 0, 0, 0}};
 
-    while ((opt = getopt_long(argc, argv, "asht",
+    while ((opt = getopt_long(argc, argv, "ashtwlo:O:",
                               long_options, &option_index)) != -1) {
         switch (opt) {
             case 't':
@@ -121,6 +348,62 @@ Option parser(int argc, char** argv) {
                 option.flag_semantic = true;
                 break;
 
+            case 'l':
+                option.flag_only_lex = true;
+                break;
+
+            case 'o':
+                option.output = optarg;
+                break;
+
+            case 'O':
+                option.opt_level = parse_opt_level(argv[0], optarg);
+                break;
+
+            case OPT_ASM_COMMENTS:
+                option.asm_comments = parse_asm_comments(argv[0], optarg);
+                break;
+
+            case OPT_STATS:
+                option.flag_stats = true;
+                break;
+
+            case OPT_STREAM:
+                option.flag_stream = true;
+                break;
+
+            case OPT_AST_CACHE:
+                option.ast_cache = optarg;
+                break;
+
+            case OPT_DUMP_FORMAT:
+                option.dump_format = parse_dump_format(argv[0], optarg);
+                break;
+
+            case OPT_SCANNER:
+                option.scanner = parse_scanner(argv[0], optarg);
+                break;
+
+            case OPT_CODEGEN:
+                option.codegen = parse_codegen(argv[0], optarg);
+                break;
+
+            case OPT_EMIT_IR:
+                option.flag_emit_ir = true;
+                break;
+
+            case OPT_NO_FOLD:
+                option.flag_fold = false;
+                break;
+
+            case OPT_INLINE_BUDGET:
+                option.inline_budget = parse_inline_budget(argv[0], optarg);
+                break;
+
+            case OPT_INLINE_REPORT:
+                option.flag_inline_report = true;
+                break;
+
             case '?':
             default:
                 print_help(argv[0], EXIT_FAILURE);
@@ -130,7 +413,6 @@ Option parser(int argc, char** argv) {
     if (optind < argc) {
         if (optind == argc - 1) {
             option.path = argv[optind];
-            option.output = default_output_name(option.path);
         } else {
             printf(
                 "Too much arguments %s (1 for path) (no file loaded)\n",
@@ -138,5 +420,20 @@ Option parser(int argc, char** argv) {
         }
     }
 
+    if (option.flag_stream && (option.flag_show_tree ||
+                               option.flag_only_tree ||
+                               option.flag_symtabs ||
+                               option.ast_cache)) {
+        // The whole tree and symbol tables never exist in streaming mode
+        fprintf(stderr,
+                "--stream cannot be combined with -t, -s, -a or --ast-cache\n");
+        print_help(argv[0], EXIT_FAILURE);
+    }
+
+    if (!option.output) {
+        option.output = option.path ? default_output_name(option.path)
+                                    : "_anonymous.asm";
+    }
+
     return option;
 }
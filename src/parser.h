@@ -9,9 +9,16 @@
 #ifndef PARSER_H
 #define PARSER_H
 
+#include "codeWriter.h"
+#include "dump.h"
+#include "emitter.h"
+#include "inliner.h"
+#include "scanner.h"
+
 typedef struct Option {
     char* path;
-    char* output;
+    char* output; /*<
+        Assembly output file, "-" for stdout */
     int flag_show_tree; /*<
         if true, only show the AST, and exit
     */
@@ -23,6 +30,49 @@ typedef struct Option {
     int flag_semantic; /*<
         Show only semantic errors, and exit.
     */
+    int flag_only_lex; /*<
+        Only scan the source code, report the scanner throughput, and exit.
+    */
+    int flag_stats; /*<
+        Print statistics about the compilation on stderr
+    */
+    int flag_stream; /*<
+        Compile each function as soon as it is parsed
+    */
+    int flag_emit_ir; /*<
+        Print the IR of each function on stdout
+    */
+    int flag_fold; /*<
+        Fold the constant expressions and the algebraic identities
+        of the syntax tree (disabled by --no-fold)
+    */
+    char* ast_cache; /*<
+        Directory of the syntax trees cache, NULL if disabled
+    */
+    ScannerKind scanner; /*<
+        Scanner of the source code
+    */
+    CodegenMode codegen; /*<
+        Code generated for the expressions
+    */
+    int opt_level; /*<
+        Optimization level (-O) : 1 runs the IR passes removing jumps
+        and unreachable code, and the peephole optimizer, 2 adds the
+        inlining, immediates and register allocation passes
+    */
+    int inline_budget; /*<
+        Largest function inlined at -O2, in IR instructions, 0 disables
+        inlining
+    */
+    int flag_inline_report; /*<
+        Print each call to a user function at -O2, inlined or not
+    */
+    DumpFormat dump_format; /*<
+        Format of the tree (-t) and symbol tables (-s) dumps
+    */
+    AsmComments asm_comments; /*<
+        Comments written in the assembly output
+    */
 } Option;
 
 /**
@@ -0,0 +1,301 @@
+/**
+ * @file passes.c
+ * @brief Pass manager and optimization passes on the IR
+ *
+ */
+
+#include "passes.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "inliner.h"
+#include "regAlloc.h"
+#include "tree.h"
+
+typedef struct Pass {
+    PassId id;
+    int min_level;  // Lowest optimization level running the pass
+    void (*run)(IrFunction* ir);
+} Pass;
+
+static const char* PASS_NAMES[PASS_NB] = {
+    [PASS_LOWER] = "lower",
+    [PASS_INLINE] = "inline",
+    [PASS_IMMEDIATES] = "immediates",
+    [PASS_JUMPS] = "jumps",
+    [PASS_UNREACHABLE] = "unreachable",
+    [PASS_REGALLOC] = "regalloc",
+    [PASS_CODEGEN] = "codegen",
+};
+
+static struct {
+    int opt_level;
+    Emitter* ir_dump;  // --emit-ir, NULL if disabled
+    double seconds[PASS_NB];
+    size_t instrs[PASS_NB];  // Instructions left after each step
+    size_t runs[PASS_NB];
+} PASSES;
+
+void Passes_select(int opt_level, Emitter* ir_dump) {
+    PASSES.opt_level = opt_level;
+    PASSES.ir_dump = ir_dump;
+}
+
+PassTimer Passes_start(PassId pass) {
+    PassTimer timer = {.pass = pass};
+    clock_gettime(CLOCK_MONOTONIC, &timer.start);
+    return timer;
+}
+
+void Passes_stop(const PassTimer* timer, const IrFunction* ir) {
+    struct timespec end;
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    PASSES.seconds[timer->pass] += (end.tv_sec - timer->start.tv_sec) +
+                                   (end.tv_nsec - timer->start.tv_nsec) * 1e-9;
+    PASSES.instrs[timer->pass] += ArrayList_get_length(&ir->instrs);
+    PASSES.runs[timer->pass]++;
+}
+
+/**
+ * @brief Get the operator giving the same result with swapped operands
+ *
+ * @param oper
+ * @return Operator
+ */
+static Operator _Passes_mirror(Operator oper) {
+    switch (oper) {
+        case OP_LT:
+            return OP_GT;
+        case OP_LE:
+            return OP_GE;
+        case OP_GT:
+            return OP_LT;
+        case OP_GE:
+            return OP_LE;
+        default:
+            return oper;  // Commutative
+    }
+}
+
+/**
+ * @brief Constant operands of additions, subtractions, multiplications
+ * and comparisons (jumping or not) become immediates of the instruction
+ * (the constant left operand of a commutative one too), so they are
+ * neither pushed nor held in a register. So do the constant divisors
+ * of divisions and modulos, written without idiv, except 0 and -1 / 1
+ * which keep idiv (and its faults).
+ *
+ * @param ir
+ */
+static void _Passes_immediates(IrFunction* ir) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&ir->instrs);
+    // Position of the only IR_CONST defining each temp, len if none
+    size_t* consts = malloc((ir->nb_temps + 1) * sizeof(size_t));
+
+    if (!consts) {
+        return;
+    }
+    for (IrTemp t = 0; t <= ir->nb_temps; ++t) {
+        consts[t] = len;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (!IrInstr_has_dst(&instrs[i])) {
+            continue;
+        }
+        // A logical operation defines its result twice
+        bool first = consts[instrs[i].dst] == len;
+        consts[instrs[i].dst] = first && instrs[i].op == IR_CONST ? i : len + 1;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        IrInstr* instr = &instrs[i];
+        if (instr->op != IR_BINARY && instr->op != IR_CMP &&
+            instr->op != IR_JUMP_CMP) {
+            continue;
+        }
+        bool division = instr->oper == OP_DIV || instr->oper == OP_MOD;
+        if (division && (consts[instr->b] >= len ||
+                         labs(instrs[consts[instr->b]].imm) < 2)) {
+            continue;
+        }
+        if (consts[instr->a] < len && consts[instr->b] >= len &&
+            instr->oper != OP_SUB) {
+            IrTemp left = instr->a;
+            instr->a = instr->b;
+            instr->b = left;
+            instr->oper = _Passes_mirror(instr->oper);
+        }
+        if (consts[instr->b] < len) {
+            IrInstr* constant = &instrs[consts[instr->b]];
+            instr->flags |= IR_IMM_B;
+            instr->imm = constant->imm;
+            constant->op = IR_NOP;
+        }
+    }
+    free(consts);
+}
+
+/**
+ * @brief Get the position of each label
+ *
+ * @param ir
+ * @return size_t* Position of each label, NULL if out of memory
+ */
+static size_t* _Passes_labels(const IrFunction* ir) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t* labels = malloc((ArrayList_get_length(&ir->labels) + 1) *
+                            sizeof(size_t));
+
+    if (!labels) {
+        return NULL;
+    }
+    for (size_t i = 0; i < ArrayList_get_length(&ir->instrs); ++i) {
+        if (instrs[i].op == IR_LABEL) {
+            labels[instrs[i].number] = i;
+        }
+    }
+    return labels;
+}
+
+/**
+ * @brief Get the first instruction from a position, which is not a label
+ *
+ * @param ir
+ * @param i
+ * @return size_t Its position, the number of instructions if none
+ */
+static size_t _Passes_skip_labels(const IrFunction* ir, size_t i) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&ir->instrs);
+
+    while (i < len && (instrs[i].op == IR_LABEL || instrs[i].op == IR_NOP)) {
+        ++i;
+    }
+    return i;
+}
+
+/**
+ * @brief A jump to a jump goes to the target of the second one,
+ * and a jump to one of the labels right after it is removed
+ *
+ * @param ir
+ */
+static void _Passes_jumps(IrFunction* ir) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&ir->instrs);
+    size_t nb_labels = ArrayList_get_length(&ir->labels);
+    size_t* labels = _Passes_labels(ir);
+
+    if (!labels) {
+        return;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (!IrInstr_is_jump(&instrs[i])) {
+            continue;
+        }
+        // Bounded, jumps may loop on each other
+        for (size_t hop = 0; hop < nb_labels; ++hop) {
+            size_t next = _Passes_skip_labels(ir, labels[instrs[i].number]);
+            if (next == len || instrs[next].op != IR_JUMP ||
+                instrs[next].number == instrs[i].number) {
+                break;
+            }
+            instrs[i].number = instrs[next].number;
+        }
+        if (instrs[i].op != IR_JUMP) {
+            continue;
+        }
+        for (size_t j = i + 1; j < len && (instrs[j].op == IR_LABEL ||
+                                           instrs[j].op == IR_NOP);
+             ++j) {
+            if (instrs[j].op == IR_LABEL &&
+                instrs[j].number == instrs[i].number) {
+                instrs[i].op = IR_NOP;
+                break;
+            }
+        }
+    }
+    free(labels);
+}
+
+/**
+ * @brief Remove the labels no jump goes to, and the instructions after
+ * a jump or a return, up to the next label a jump goes to.
+ * Removed jumps may make other labels unused : repeated until nothing
+ * is removed.
+ *
+ * @param ir
+ */
+static void _Passes_unreachable(IrFunction* ir) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&ir->instrs);
+    size_t nb_labels = ArrayList_get_length(&ir->labels);
+    size_t* jumps = malloc((nb_labels + 1) * sizeof(size_t));
+    bool removed = true;
+
+    if (!jumps) {
+        return;
+    }
+    while (removed) {
+        removed = false;
+        for (size_t label = 0; label < nb_labels; ++label) {
+            jumps[label] = 0;
+        }
+        for (size_t i = 0; i < len; ++i) {
+            if (IrInstr_is_jump(&instrs[i])) {
+                jumps[instrs[i].number]++;
+            }
+        }
+        bool reached = true;
+        for (size_t i = 0; i < len; ++i) {
+            if (instrs[i].op == IR_NOP) {
+                continue;
+            }
+            if (instrs[i].op == IR_LABEL && jumps[instrs[i].number]) {
+                reached = true;
+            } else if (instrs[i].op == IR_LABEL || !reached) {
+                instrs[i].op = IR_NOP;
+                removed = true;
+            } else if (IrInstr_ends_block(&instrs[i])) {
+                reached = false;
+            }
+        }
+    }
+    free(jumps);
+}
+
+// In order of execution
+static const Pass PIPELINE[] = {
+    {PASS_INLINE, 2, Inliner_function},
+    {PASS_IMMEDIATES, 2, _Passes_immediates},
+    {PASS_JUMPS, 1, _Passes_jumps},
+    {PASS_UNREACHABLE, 1, _Passes_unreachable},
+    {PASS_REGALLOC, 2, RegAlloc_function},
+};
+
+void Passes_run(IrFunction* ir) {
+    for (size_t i = 0; i < sizeof(PIPELINE) / sizeof(*PIPELINE); ++i) {
+        if (PIPELINE[i].min_level > PASSES.opt_level) {
+            continue;
+        }
+        PassTimer timer = Passes_start(PIPELINE[i].id);
+        PIPELINE[i].run(ir);
+        IrFunction_compact(ir);
+        Passes_stop(&timer, ir);
+    }
+    if (PASSES.ir_dump) {
+        IrFunction_print(ir, PASSES.ir_dump);
+    }
+}
+
+void Passes_print_stats(FILE* out) {
+    for (PassId pass = 0; pass < PASS_NB; ++pass) {
+        if (PASSES.runs[pass]) {
+            fprintf(out, "pass %-15s %10.3f ms %10zu instrs\n",
+                    PASS_NAMES[pass], PASSES.seconds[pass] * 1e3,
+                    PASSES.instrs[pass]);
+        }
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * @file passes.h
+ * @brief Pass manager : runs the optimization passes of the
+ * optimization level on the IR of each function, and times every step
+ * of its compilation
+ *
+ */
+
+#ifndef PASSES_H
+#define PASSES_H
+
+#include <stdio.h>
+#include <time.h>
+
+#include "emitter.h"
+#include "ir.h"
+
+typedef enum PassId {
+    PASS_LOWER,        // Syntax tree to IR (treeReader)
+    PASS_INLINE,       // -O2 : calls to small functions inlined
+    PASS_IMMEDIATES,   // -O2 : constant operands become immediates
+    PASS_JUMPS,        // -O1 : jumps to the next label, jumps to jumps
+    PASS_UNREACHABLE,  // -O1 : code after a jump or a return
+    PASS_REGALLOC,     // -O2 : scalar variables kept in registers
+    PASS_CODEGEN,      // IR to assembly (codeWriter)
+    PASS_NB,
+} PassId;
+
+/**
+ * @brief Running step of the compilation of a function
+ */
+typedef struct PassTimer {
+    PassId pass;
+    struct timespec start;
+} PassTimer;
+
+/**
+ * @brief Select the pipeline run by Passes_run
+ *
+ * @param opt_level Optimization level (-O), 0 runs no pass
+ * @param ir_dump Emitter printing the IR after the pipeline (--emit-ir),
+ * NULL to print nothing
+ */
+void Passes_select(int opt_level, Emitter* ir_dump);
+
+/**
+ * @brief Start timing a step
+ *
+ * @param pass
+ * @return PassTimer
+ */
+PassTimer Passes_start(PassId pass);
+
+/**
+ * @brief Add the time elapsed since Passes_start to its step
+ *
+ * @param timer
+ * @param ir Function after the step, to count its instructions
+ */
+void Passes_stop(const PassTimer* timer, const IrFunction* ir);
+
+/**
+ * @brief Run the passes of the pipeline on a lowered function,
+ * and print it if asked
+ *
+ * @param ir
+ */
+void Passes_run(IrFunction* ir);
+
+/**
+ * @brief Print the time spent in each step, and the number of
+ * instructions left after it, over every function
+ *
+ * @param out
+ */
+void Passes_print_stats(FILE* out);
+
+#endif
@@ -0,0 +1,480 @@
+#include "peephole.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+#define PEEPHOLE_LINE_MAX 128  // Room for a rewritten instruction
+
+/**
+ * @brief Instruction replacing two consecutive lines (instructions
+ * or labels) matched by a rule
+ */
+typedef struct PeepholeRewrite {
+    char text[PEEPHOLE_LINE_MAX];  // Replaces the first line, "" removes it
+    bool keep_second;              // Else the second line is removed
+} PeepholeRewrite;
+
+/**
+ * @brief Rule of the table : checks a pair of lines,
+ * and fills the rewrite if they match
+ */
+typedef bool (*PeepholeMatch)(const char* buffer, const AsmLine* first,
+                              const AsmLine* second,
+                              PeepholeRewrite* rewrite);
+
+typedef struct PeepholeRule {
+    const char* name;
+    PeepholeMatch match;
+} PeepholeRule;
+
+static const char* ASM_OP_NAMES[] = {
+    [ASM_OP_PUSH] = "push",
+    [ASM_OP_POP] = "pop",
+    [ASM_OP_JMP] = "jmp",
+};
+
+static inline bool _Peephole_is_blank(char c) {
+    return c == ' ' || c == '\t';
+}
+
+/**
+ * @brief Get the text of an operand
+ *
+ * @param buffer Buffer of the emitter
+ * @param line
+ * @param i Index of the operand
+ * @return const char* Not NUL-terminated, see AsmOperand.len
+ */
+static inline const char* _Peephole_operand(const char* buffer,
+                                            const AsmLine* line, int i) {
+    return buffer + line->start + line->operands[i].start;
+}
+
+/**
+ * @brief Does the operand use rsp, which push and pop move ?
+ *
+ * @param buffer
+ * @param line
+ * @param i
+ * @return bool
+ */
+static bool _Peephole_uses_rsp(const char* buffer, const AsmLine* line,
+                               int i) {
+    const char* text = _Peephole_operand(buffer, line, i);
+
+    for (int j = 0; j + 3 <= line->operands[i].len; ++j) {
+        if (!memcmp(text + j, "rsp", 3)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Are two operands written the same way ?
+ *
+ * @param buffer
+ * @param first
+ * @param second
+ * @return bool
+ */
+static bool _Peephole_same_operand(const char* buffer,
+                                   const AsmLine* first,
+                                   const AsmLine* second) {
+    return first->operands[0].len == second->operands[0].len &&
+           !memcmp(_Peephole_operand(buffer, first, 0),
+                   _Peephole_operand(buffer, second, 0),
+                   first->operands[0].len);
+}
+
+/**
+ * @brief Classify an operand from its text
+ *
+ * @param text
+ * @param len
+ * @param operand Filled kind and reg
+ */
+static void _Peephole_parse_operand(const char* text, size_t len,
+                                    AsmOperand* operand) {
+    if (memchr(text, '[', len)) {
+        operand->kind = ASM_OPERAND_MEM;
+        return;
+    }
+    if ((text[0] >= '0' && text[0] <= '9') ||
+        (len > 1 && text[0] == '-' && text[1] >= '0' && text[1] <= '9')) {
+        operand->kind = ASM_OPERAND_IMM;
+        return;
+    }
+    for (Register reg = RAX; reg <= R15; ++reg) {
+        const char* name = Register_to_str(reg);
+        if (strlen(name) == len && !memcmp(text, name, len)) {
+            operand->kind = ASM_OPERAND_REG;
+            operand->reg = reg;
+            return;
+        }
+    }
+    operand->kind = ASM_OPERAND_SYMBOL;
+}
+
+/**
+ * @brief Parse the operands of an instruction, separated by commas
+ *
+ * @param text Line
+ * @param i Offset of the first operand
+ * @param end Offset of the end of the instruction (comment excluded)
+ * @param line Filled operands, op is set to ASM_OP_OTHER if there
+ * are too many of them
+ */
+static void _Peephole_parse_operands(const char* text, size_t i, size_t end,
+                                     AsmLine* line) {
+    while (i < end) {
+        const char* comma = memchr(text + i, ',', end - i);
+        size_t stop = comma ? (size_t)(comma - text) : end;
+        size_t last = stop;
+
+        while (_Peephole_is_blank(text[i])) {
+            ++i;
+        }
+        while (last > i && _Peephole_is_blank(text[last - 1])) {
+            --last;
+        }
+        if (line->nb_operands == 2 || last == i) {
+            line->op = ASM_OP_OTHER;
+            return;
+        }
+
+        AsmOperand* operand = &line->operands[line->nb_operands++];
+        operand->start = i;
+        operand->len = last - i;
+        _Peephole_parse_operand(text + i, last - i, operand);
+        i = stop + 1;
+    }
+}
+
+/**
+ * @brief Parse a line of the buffer
+ *
+ * @param text First byte of the line
+ * @param line Line with its start and len, filled
+ */
+static void _Peephole_parse(const char* text, AsmLine* line) {
+    size_t end = line->len - 1;  // Line feed
+    size_t i = 0, word;
+
+    const char* comment = memchr(text, ';', end);
+    if (comment) {
+        end = comment - text;
+    }
+    while (i < end && _Peephole_is_blank(text[i])) {
+        ++i;
+    }
+    while (end > i && _Peephole_is_blank(text[end - 1])) {
+        --end;
+    }
+
+    line->kind = ASM_LINE_NOTE;
+    line->op = ASM_OP_OTHER;
+    line->nb_operands = 0;
+    if (i == end) {
+        return;
+    }
+
+    line->kind = ASM_LINE_INSTR;
+    if (memchr(text + i, '"', end - i) || memchr(text + i, '\'', end - i) ||
+        end > UINT16_MAX) {
+        return;  // Opaque : strings may hold commas and semicolons
+    }
+
+    for (word = i; word < end && !_Peephole_is_blank(text[word]) &&
+                   text[word] != ':';
+         ++word) {
+    }
+
+    // Label, `name:` or `name :`
+    if (text[end - 1] == ':') {
+        size_t colon = word;
+        while (_Peephole_is_blank(text[colon])) {
+            ++colon;
+        }
+        if (colon == end - 1 && word > i) {
+            line->kind = ASM_LINE_LABEL;
+            line->nb_operands = 1;
+            line->operands[0] = (AsmOperand){
+                .kind = ASM_OPERAND_SYMBOL, .start = i, .len = word - i};
+        }
+        return;
+    }
+
+    for (AsmOp op = ASM_OP_PUSH; op <= ASM_OP_JMP; ++op) {
+        if (strlen(ASM_OP_NAMES[op]) == word - i &&
+            !memcmp(text + i, ASM_OP_NAMES[op], word - i)) {
+            line->op = op;
+        }
+    }
+    if (line->op == ASM_OP_OTHER) {
+        return;
+    }
+    _Peephole_parse_operands(text, word, end, line);
+    if (line->nb_operands != 1) {
+        line->op = ASM_OP_OTHER;
+    }
+}
+
+/* Rules */
+
+static bool _Peephole_push_pop(const char* buffer, const AsmLine* first,
+                               const AsmLine* second,
+                               PeepholeRewrite* rewrite) {
+    (void)rewrite;  // The pair is removed
+    return first->op == ASM_OP_PUSH && second->op == ASM_OP_POP &&
+           first->operands[0].kind == ASM_OPERAND_REG &&
+           _Peephole_same_operand(buffer, first, second);
+}
+
+static bool _Peephole_push_pop_mov(const char* buffer, const AsmLine* first,
+                                   const AsmLine* second,
+                                   PeepholeRewrite* rewrite) {
+    const AsmOperand* src = &first->operands[0];
+    const AsmOperand* dst = &second->operands[0];
+
+    if (first->op != ASM_OP_PUSH || second->op != ASM_OP_POP ||
+        (src->kind == ASM_OPERAND_MEM && dst->kind == ASM_OPERAND_MEM) ||
+        _Peephole_uses_rsp(buffer, first, 0) ||
+        _Peephole_uses_rsp(buffer, second, 0)) {
+        return false;
+    }
+    int len = snprintf(rewrite->text, sizeof(rewrite->text),
+                       "mov %.*s, %.*s\n",
+                       dst->len, _Peephole_operand(buffer, second, 0),
+                       src->len, _Peephole_operand(buffer, first, 0));
+
+    return len < (int)sizeof(rewrite->text);
+}
+
+static bool _Peephole_pop_push(const char* buffer, const AsmLine* first,
+                               const AsmLine* second,
+                               PeepholeRewrite* rewrite) {
+    const AsmOperand* reg = &first->operands[0];
+
+    if (first->op != ASM_OP_POP || second->op != ASM_OP_PUSH ||
+        reg->kind != ASM_OPERAND_REG || reg->reg == RSP ||
+        !_Peephole_same_operand(buffer, first, second)) {
+        return false;
+    }
+    snprintf(rewrite->text, sizeof(rewrite->text), "mov %s, [rsp]\n",
+             Register_to_str(reg->reg));
+
+    return true;
+}
+
+static bool _Peephole_jmp_next(const char* buffer, const AsmLine* first,
+                               const AsmLine* second,
+                               PeepholeRewrite* rewrite) {
+    rewrite->keep_second = true;
+    return first->op == ASM_OP_JMP && second->kind == ASM_LINE_LABEL &&
+           first->operands[0].kind == ASM_OPERAND_SYMBOL &&
+           _Peephole_same_operand(buffer, first, second);
+}
+
+// First matching rule wins
+static const PeepholeRule PEEPHOLE_RULES[PEEPHOLE_NB_RULES] = {
+    [PEEPHOLE_PUSH_POP] = {"push/pop", _Peephole_push_pop},
+    [PEEPHOLE_PUSH_POP_MOV] = {"push/pop mov", _Peephole_push_pop_mov},
+    [PEEPHOLE_POP_PUSH] = {"pop/push", _Peephole_pop_push},
+    [PEEPHOLE_JMP_NEXT] = {"jmp next", _Peephole_jmp_next},
+};
+
+/* Window */
+
+void Peephole_init(Peephole* self, Emitter* emitter) {
+    assert(emitter->len == 0);
+    *self = (Peephole){0};
+    ArrayList_init(&self->lines, sizeof(AsmLine), 4 * PEEPHOLE_WINDOW, NULL);
+    emitter->peephole = self;
+}
+
+/**
+ * @brief Remove lines from the window (not their text)
+ *
+ * @param self
+ * @param index Index of the first line
+ * @param count Number of lines
+ */
+static void _Peephole_remove(Peephole* self, size_t index, size_t count) {
+    AsmLine* lines = (AsmLine*)self->lines.arr;
+    size_t len = ArrayList_get_length(&self->lines);
+
+    for (size_t i = index; i < index + count; ++i) {
+        if (lines[i].kind != ASM_LINE_NOTE) {
+            self->nb_items--;
+        }
+    }
+    memmove(lines + index, lines + index + count,
+            (len - index - count) * sizeof(AsmLine));
+    ArrayList_resize(&self->lines, len - count);
+}
+
+/**
+ * @brief Replace a line of the window by text, moving the next bytes
+ *
+ * @param self
+ * @param emitter
+ * @param index Index of the line in the window
+ * @param text New line, "" removes it from the window
+ */
+static void _Peephole_splice(Peephole* self, Emitter* emitter,
+                             size_t index, const char* text) {
+    AsmLine* lines = (AsmLine*)self->lines.arr;
+    AsmLine* line = &lines[index];
+    size_t len = strlen(text);
+    size_t end = line->start + line->len;
+    ptrdiff_t delta = (ptrdiff_t)len - (ptrdiff_t)line->len;
+
+    // Rewrites are never longer than the lines they replace
+    assert(emitter->len + delta <= emitter->capacity);
+    memmove(emitter->buffer + end + delta, emitter->buffer + end,
+            emitter->len - end);
+    memcpy(emitter->buffer + line->start, text, len);
+    emitter->len += delta;
+    self->scanned += delta;
+    for (size_t i = index + 1; i < ArrayList_get_length(&self->lines); ++i) {
+        lines[i].start += delta;
+    }
+
+    if (len) {
+        line->len = len;
+        _Peephole_parse(emitter->buffer + line->start, line);
+    } else {
+        _Peephole_remove(self, index, 1);
+    }
+}
+
+/**
+ * @brief Find the last instruction or label of the window before a line
+ *
+ * @param self
+ * @param index Index of the line
+ * @return int64_t Index of the item, -1 if none
+ */
+static int64_t _Peephole_previous(const Peephole* self, int64_t index) {
+    const AsmLine* lines = (const AsmLine*)self->lines.arr;
+
+    while (--index >= 0 && lines[index].kind == ASM_LINE_NOTE) {
+    }
+
+    return index;
+}
+
+/**
+ * @brief Apply the first rule matching the last two items of the window
+ *
+ * @param self
+ * @param emitter
+ * @return bool A rule was applied
+ */
+static bool _Peephole_rewrite(Peephole* self, Emitter* emitter) {
+    int64_t second = _Peephole_previous(self,
+                                        ArrayList_get_length(&self->lines));
+    int64_t first = second >= 0 ? _Peephole_previous(self, second) : -1;
+
+    if (first < 0) {
+        return false;
+    }
+
+    const AsmLine* lines = (const AsmLine*)self->lines.arr;
+    for (int id = 0; id < PEEPHOLE_NB_RULES; ++id) {
+        PeepholeRewrite rewrite = {.text = ""};
+        if (PEEPHOLE_RULES[id].match(emitter->buffer, &lines[first],
+                                     &lines[second], &rewrite)) {
+            self->fired[id]++;
+            // The second line first, as the rewrite may be longer
+            // than the first one
+            if (!rewrite.keep_second) {
+                _Peephole_splice(self, emitter, second, "");
+            }
+            _Peephole_splice(self, emitter, first, rewrite.text);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Make the oldest lines final, so the window holds at most
+ * PEEPHOLE_WINDOW instructions and labels
+ *
+ * @param self
+ */
+static void _Peephole_commit(Peephole* self) {
+    const AsmLine* lines = (const AsmLine*)self->lines.arr;
+    size_t nb = 0;
+
+    for (int items = self->nb_items; items > PEEPHOLE_WINDOW; ++nb) {
+        if (lines[nb].kind != ASM_LINE_NOTE) {
+            items--;
+        }
+    }
+    _Peephole_remove(self, 0, nb);
+}
+
+void Peephole_scan(Peephole* self, Emitter* emitter) {
+    const char* feed;
+
+    while ((feed = memchr(emitter->buffer + self->scanned, '\n',
+                          emitter->len - self->scanned))) {
+        AsmLine line = {
+            .start = self->scanned,
+            .len = feed - (emitter->buffer + self->scanned) + 1,
+        };
+        _Peephole_parse(emitter->buffer + line.start, &line);
+        if (self->opaque) {
+            line.kind = ASM_LINE_INSTR;
+            line.op = ASM_OP_OTHER;
+            self->opaque = false;
+        }
+        self->scanned += line.len;
+        ArrayList_append(&self->lines, &line);
+        if (line.kind == ASM_LINE_NOTE) {
+            continue;
+        }
+        self->nb_items++;
+        while (_Peephole_rewrite(self, emitter)) {
+        }
+        _Peephole_commit(self);
+    }
+}
+
+void Peephole_shift(Peephole* self, size_t size) {
+    AsmLine* lines = (AsmLine*)self->lines.arr;
+
+    for (size_t i = 0; i < ArrayList_get_length(&self->lines); ++i) {
+        lines[i].start -= size;
+    }
+    if (self->scanned < size) {
+        // The line being written is not parsed
+        self->opaque = true;
+        self->scanned = 0;
+    } else {
+        self->scanned -= size;
+    }
+}
+
+void Peephole_drain(Peephole* self, Emitter* emitter) {
+    Peephole_scan(self, emitter);
+    ArrayList_clear(&self->lines);
+    self->nb_items = 0;
+}
+
+void Peephole_print_stats(const Peephole* self, FILE* out) {
+    for (int id = 0; id < PEEPHOLE_NB_RULES; ++id) {
+        fprintf(out, "peephole %-15s %10zu\n",
+                PEEPHOLE_RULES[id].name, self->fired[id]);
+    }
+}
+
+void Peephole_free(Peephole* self) {
+    ArrayList_free(&self->lines);
+}
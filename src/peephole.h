@@ -0,0 +1,145 @@
+/**
+ * @file peephole.h
+ * @brief Peephole optimizer (-O1) : the lines written by an emitter
+ * are parsed into instructions, and kept in a window at the end of its
+ * buffer, where a table of rules rewrites consecutive instructions
+ * before they are written
+ *
+ */
+
+#ifndef PEEPHOLE_H
+#define PEEPHOLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arraylist.h"
+#include "emitter.h"
+#include "registers.h"
+
+// Instructions and labels kept in the window, older lines are final
+#define PEEPHOLE_WINDOW 8
+
+typedef enum AsmLineKind {
+    ASM_LINE_NOTE,   // Blank line or comment only
+    ASM_LINE_LABEL,  // operands[0] is the name of the label
+    ASM_LINE_INSTR,
+} AsmLineKind;
+
+typedef enum AsmOp {
+    ASM_OP_OTHER,  // Never rewritten
+    ASM_OP_PUSH,
+    ASM_OP_POP,
+    ASM_OP_JMP,
+} AsmOp;
+
+typedef enum AsmOperandKind {
+    ASM_OPERAND_REG,
+    ASM_OPERAND_IMM,
+    ASM_OPERAND_MEM,     // With its size, `qword [rbp -8]`
+    ASM_OPERAND_SYMBOL,  // Label or variable name
+} AsmOperandKind;
+
+/**
+ * @brief Operand of a parsed line, as a span of its text
+ */
+typedef struct AsmOperand {
+    uint8_t kind;  // AsmOperandKind
+    uint8_t reg;   // Register of ASM_OPERAND_REG
+    uint16_t start;  // Offset in the line
+    uint16_t len;
+} AsmOperand;
+
+/**
+ * @brief Line parsed from the buffer of the emitter
+ */
+typedef struct AsmLine {
+    size_t start;  // Offset in the buffer of the emitter
+    uint32_t len;  // Line feed included
+    uint8_t kind;  // AsmLineKind
+    uint8_t op;    // AsmOp
+    uint8_t nb_operands;
+    AsmOperand operands[2];
+} AsmLine;
+
+typedef enum PeepholeRuleId {
+    PEEPHOLE_PUSH_POP,      // push x / pop x -> (nothing)
+    PEEPHOLE_PUSH_POP_MOV,  // push x / pop y -> mov y, x
+    PEEPHOLE_POP_PUSH,      // pop x / push x -> mov x, [rsp]
+    PEEPHOLE_JMP_NEXT,      // jmp l / l: -> l:
+    PEEPHOLE_NB_RULES,
+} PeepholeRuleId;
+
+typedef struct Peephole {
+    ArrayList lines;  // [AsmLine] not written yet, in the buffer tail
+    size_t scanned;   // Offset of the first line not parsed yet
+    int nb_items;     // Instructions and labels of lines
+    bool opaque;      // The line at scanned was partly written
+    size_t fired[PEEPHOLE_NB_RULES];
+} Peephole;
+
+/**
+ * @brief Initialize a peephole optimizer, and make an emitter
+ * write its lines through it (every line, from now on)
+ *
+ * @param self
+ * @param emitter Emitter with an empty buffer
+ */
+void Peephole_init(Peephole* self, Emitter* emitter);
+
+/**
+ * @brief Parse the lines completed since the last call, and rewrite them
+ * (called by the emitter after each append)
+ *
+ * @param self
+ * @param emitter
+ */
+void Peephole_scan(Peephole* self, Emitter* emitter);
+
+/**
+ * @brief Get the offset of the first byte of the buffer which may still
+ * be rewritten : the bytes before it can be written
+ *
+ * @param self
+ * @return size_t
+ */
+static inline size_t Peephole_pending(const Peephole* self) {
+    return !ArrayList_get_length(&self->lines)
+               ? self->scanned
+               : ((const AsmLine*)self->lines.arr)->start;
+}
+
+/**
+ * @brief Tell that the first bytes of the buffer were written and removed
+ *
+ * @param self
+ * @param size Number of bytes removed from the buffer
+ */
+void Peephole_shift(Peephole* self, size_t size);
+
+/**
+ * @brief Make every line of the window final, at the end of a phase
+ * or before writing the whole buffer
+ *
+ * @param self
+ * @param emitter
+ */
+void Peephole_drain(Peephole* self, Emitter* emitter);
+
+/**
+ * @brief Print the number of rewrites of each rule
+ *
+ * @param self
+ * @param out
+ */
+void Peephole_print_stats(const Peephole* self, FILE* out);
+
+/**
+ * @brief Free the window
+ *
+ * @param self
+ */
+void Peephole_free(Peephole* self);
+
+#endif
@@ -1,9 +1,13 @@
 #ifndef PROGRAM_H
 #define PROGRAM_H
 
+#include <stdbool.h>
 #include <stdio.h>
 
+#include "emitter.h"
 #include "parser.h"
+#include "peephole.h"
+#include "source.h"
 #include "symbolTable.h"
 #include "tree.h"
 
@@ -11,8 +15,19 @@ typedef struct {
     ProgramST symtable;
     Node* abr;
     Option opt;
-    FILE* file_in;
+    Source source;
     FILE* file_out;
+    char* temp_output; /*<
+        Temporary file written instead of the output file in streaming
+        mode, renamed to it once the whole program is compiled, and
+        removed at exit if it is not (NULL if none) */
+    bool ast_cache_hit; /*<
+        The tree was loaded from the cache (--ast-cache) */
+    Emitter emitter;
+    Peephole peephole; /*<
+        Optimizer of the assembly written by emitter (-O1) */
+    Emitter dump; /*<
+        Writer of the -t and -s dumps, on stdout */
 } Program;
 
 #endif
@@ -0,0 +1,244 @@
+/**
+ * @file regAlloc.c
+ * @brief Linear scan register allocation of the scalar variables
+ * of a function
+ *
+ */
+
+#include "regAlloc.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "arraylist.h"
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+// Preserved by the called functions (and the builtins)
+static const Register CALLEE_SAVED[REGALLOC_NB_REGISTERS] = {
+    RBX, R12, R13, R14, R15};
+
+static struct {
+    size_t in_registers;
+    size_t in_frame;
+} REGALLOC;
+
+/**
+ * @brief Positions of the instructions of a function where a variable
+ * may be live : from its first load or store (the start of the function
+ * for a parameter) to its last one, and over every loop it is used in
+ */
+typedef struct LiveInterval {
+    const Symbol* symbol;  // NULL if the variable is not used
+    size_t start, end;
+    Register reg;  // 0 if it stays in the stack frame
+} LiveInterval;
+
+/**
+ * @brief Tell whether an instruction loads or stores a variable
+ * which may be kept in a register
+ *
+ * @param instr
+ * @return bool
+ */
+static bool _RegAlloc_candidate(const IrInstr* instr) {
+    return (instr->op == IR_LOAD || instr->op == IR_STORE) &&
+           instr->symbol->symbol_type == SYMBOL_VALUE &&
+           !instr->symbol->is_static;
+}
+
+/**
+ * @brief Get the position of the interval of a variable :
+ * the parameters first, then the locals and the inlined variables
+ *
+ * @param func
+ * @param symbol Parameter or local variable of func
+ * @return size_t
+ */
+static size_t _RegAlloc_slot(const FunctionST* func, const Symbol* symbol) {
+    if (symbol->is_param) {
+        return symbol->index;
+    }
+    return ArrayList_get_length(&func->parameters.symbols) + symbol->index;
+}
+
+/**
+ * @brief Extend the intervals over the loops they overlap : a variable
+ * used in a loop is live from its head (the label a jump goes back to)
+ * to its last jump. Repeated until no interval grows, for the jumps
+ * to jumps left by the jumps pass.
+ *
+ * @param ir
+ * @param intervals
+ * @param nb_slots
+ * @return bool false if out of memory
+ */
+static bool _RegAlloc_loops(const IrFunction* ir, LiveInterval* intervals,
+                            size_t nb_slots) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&ir->instrs);
+    size_t* labels = malloc((ArrayList_get_length(&ir->labels) + 1) *
+                            sizeof(size_t));
+    bool extended = true;
+
+    if (!labels) {
+        return false;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (instrs[i].op == IR_LABEL) {
+            labels[instrs[i].number] = i;
+        }
+    }
+    while (extended) {
+        extended = false;
+        for (size_t i = 0; i < len; ++i) {
+            if (!IrInstr_is_jump(&instrs[i]) ||
+                labels[instrs[i].number] > i) {
+                continue;
+            }
+            size_t head = labels[instrs[i].number];
+            for (size_t slot = 0; slot < nb_slots; ++slot) {
+                LiveInterval* interval = &intervals[slot];
+                if (!interval->symbol || interval->start > i ||
+                    interval->end < head ||
+                    (interval->start <= head && interval->end >= i)) {
+                    continue;
+                }
+                interval->start = MIN(interval->start, head);
+                interval->end = MAX(interval->end, i);
+                extended = true;
+            }
+        }
+    }
+    free(labels);
+    return true;
+}
+
+/**
+ * @brief Order intervals by their start, then by variable
+ *
+ * @param a Address of a LiveInterval*
+ * @param b Address of a LiveInterval*
+ * @return int
+ */
+static int _RegAlloc_cmp_start(const void* a, const void* b) {
+    const LiveInterval* left = *(const LiveInterval* const*)a;
+    const LiveInterval* right = *(const LiveInterval* const*)b;
+
+    if (left->start != right->start) {
+        return left->start < right->start ? -1 : 1;
+    }
+    return (left > right) - (left < right);
+}
+
+/**
+ * @brief Assign the registers to the intervals, in the order of their
+ * start. When every register is taken, the interval ending the last
+ * (the new one or an active one) is left in the stack frame.
+ *
+ * @param sorted Intervals of the used variables, by start
+ * @param nb
+ */
+static void _RegAlloc_scan(LiveInterval** sorted, size_t nb) {
+    // Intervals holding a register, by end
+    LiveInterval* active[REGALLOC_NB_REGISTERS];
+    size_t nb_active = 0;
+
+    for (size_t i = 0; i < nb; ++i) {
+        LiveInterval* interval = sorted[i];
+        size_t kept = 0;
+
+        for (size_t j = 0; j < nb_active; ++j) {
+            if (active[j]->end >= interval->start) {
+                active[kept++] = active[j];
+            }
+        }
+        nb_active = kept;
+        if (nb_active == REGALLOC_NB_REGISTERS) {
+            LiveInterval* last = active[nb_active - 1];
+            if (last->end <= interval->end) {
+                continue;
+            }
+            interval->reg = last->reg;
+            last->reg = 0;
+            nb_active--;
+        } else {
+            unsigned taken = 0;
+            for (size_t j = 0; j < nb_active; ++j) {
+                taken |= 1U << active[j]->reg;
+            }
+            for (int r = 0; r < REGALLOC_NB_REGISTERS; ++r) {
+                if (!(taken & (1U << CALLEE_SAVED[r]))) {
+                    interval->reg = CALLEE_SAVED[r];
+                    break;
+                }
+            }
+        }
+        size_t j = nb_active++;
+        for (; j > 0 && active[j - 1]->end > interval->end; --j) {
+            active[j] = active[j - 1];
+        }
+        active[j] = interval;
+    }
+}
+
+void RegAlloc_function(IrFunction* ir) {
+    ARRAYLIST_DECLARE_ARRAY(ir->instrs, IrInstr, instrs);
+    size_t len = ArrayList_get_length(&ir->instrs);
+    size_t nb_slots = ArrayList_get_length(&ir->func->parameters.symbols) +
+                      ArrayList_get_length(&ir->func->locals.symbols) +
+                      ArrayList_get_length(&ir->inlined);
+    LiveInterval* intervals = calloc(nb_slots + 1, sizeof(LiveInterval));
+    LiveInterval** sorted = malloc((nb_slots + 1) * sizeof(LiveInterval*));
+    size_t nb = 0;
+
+    if (!intervals || !sorted) {
+        free(intervals);
+        free(sorted);
+        return;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (!_RegAlloc_candidate(&instrs[i])) {
+            continue;
+        }
+        LiveInterval* interval =
+            &intervals[_RegAlloc_slot(ir->func, instrs[i].symbol)];
+        if (!interval->symbol) {
+            interval->symbol = instrs[i].symbol;
+            interval->start = instrs[i].symbol->is_param ? 0 : i;
+            sorted[nb++] = interval;
+        }
+        interval->end = i;
+    }
+    if (_RegAlloc_loops(ir, intervals, nb_slots)) {
+        qsort(sorted, nb, sizeof(LiveInterval*), _RegAlloc_cmp_start);
+        _RegAlloc_scan(sorted, nb);
+    }
+    for (size_t i = 0; i < len; ++i) {
+        if (_RegAlloc_candidate(&instrs[i])) {
+            instrs[i].number =
+                intervals[_RegAlloc_slot(ir->func, instrs[i].symbol)].reg;
+        }
+    }
+    for (size_t i = 0; i < nb; ++i) {
+        if (sorted[i]->reg) {
+            IrHome home = {.symbol = sorted[i]->symbol, .reg = sorted[i]->reg};
+            ArrayList_append(&ir->homes, &home);
+            REGALLOC.in_registers++;
+        } else {
+            REGALLOC.in_frame++;
+        }
+    }
+    free(intervals);
+    free(sorted);
+}
+
+void RegAlloc_print_stats(FILE* out) {
+    if (REGALLOC.in_registers || REGALLOC.in_frame) {
+        fprintf(out, "regalloc %-11s %10zu variables\n", "registers",
+                REGALLOC.in_registers);
+        fprintf(out, "regalloc %-11s %10zu variables\n", "frame",
+                REGALLOC.in_frame);
+    }
+}
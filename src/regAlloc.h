@@ -0,0 +1,37 @@
+/**
+ * @file regAlloc.h
+ * @brief Register allocation of the scalar local variables and
+ * parameters of a function, in the callee-saved registers
+ *
+ */
+
+#ifndef REGALLOC_H
+#define REGALLOC_H
+
+#include <stdio.h>
+
+#include "ir.h"
+
+#define REGALLOC_NB_REGISTERS 5  // rbx, r12 to r15
+
+/**
+ * @brief Keep the scalar local variables and parameters of a function
+ * in callee-saved registers, by a linear scan over their live intervals.
+ * Variables live at the same time as REGALLOC_NB_REGISTERS others
+ * stay in the stack frame, the ones living the longest first.
+ * Sets the Register of their loads and stores (IrInstr.number),
+ * and fills IrFunction.homes.
+ *
+ * @param ir Function after the other passes
+ */
+void RegAlloc_function(IrFunction* ir);
+
+/**
+ * @brief Print the number of variables kept in a register, and
+ * left in the stack frame, over every function
+ *
+ * @param out
+ */
+void RegAlloc_print_stats(FILE* out);
+
+#endif
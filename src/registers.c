@@ -24,6 +24,28 @@ const char* Register_to_str(Register reg) {
     return registers[reg];
 }
 
+const char* Register_to_byte_str(Register reg) {
+    const char* registers[] = {
+        [RAX] = "al",
+        [RBX] = "bl",
+        [RCX] = "cl",
+        [RSP] = "spl",
+        [RBP] = "bpl",
+        [RDI] = "dil",
+        [RSI] = "sil",
+        [RDX] = "dl",
+        [R8] = "r8b",
+        [R9] = "r9b",
+        [R10] = "r10b",
+        [R11] = "r11b",
+        [R12] = "r12b",
+        [R13] = "r13b",
+        [R14] = "r14b",
+        [R15] = "r15b"};
+
+    return registers[reg];
+}
+
 Register Register_param_to_reg(int param) {
     Register registers[] = {
         [0] = RDI,
@@ -30,6 +30,14 @@ typedef enum Register {
  */
 const char* Register_to_str(Register reg);
 
+/**
+ * @brief Convert a register to the string of its low byte (al, dil...)
+ *
+ * @param reg
+ * @return const char*
+ */
+const char* Register_to_byte_str(Register reg);
+
 /**
  * @brief Returns the register corresponding to the
  * function argument position:
@@ -0,0 +1,471 @@
+#include "scanner.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "intern.h"
+#include "tpc_bison.h"
+#include "tree.h"
+// After tree.h, which declares the types of yylval
+#include "../obj/tpc.tab.h"
+
+extern unsigned int nbline;  // Defined by the flex scanner, see tpc.lex
+extern unsigned int nbchar;
+
+#define SCANNER_BLOCK 16       // Bytes compared at once
+#define SCANNER_IDENT_MAX 64   // Longer identifiers are split, as by flex
+#define SCANNER_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+
+static ScannerKind KIND = SCANNER_DEFAULT;
+static Source* SOURCE = NULL;  // Source read by Scanner_lex
+static size_t POS = 0;         // Offset of the next byte to scan
+
+/**
+ * @brief Keywords, which are identifiers for the longest-match rule
+ */
+static const struct Keyword {
+    const char* text;
+    size_t len;
+    int token;
+    type_t prim_type;  // TYPE only
+} KEYWORDS[] = {
+    {"int", 3, TYPE, type_num},
+    {"char", 4, TYPE, type_byte},
+    {"void", 4, VOID, type_void},
+    {"if", 2, IF, type_void},
+    {"else", 4, ELSE, type_void},
+    {"while", 5, WHILE, type_void},
+    {"return", 6, RETURN, type_void},
+};
+
+void Scanner_select(ScannerKind kind) {
+    KIND = kind;
+}
+
+void Scanner_start(Source* source) {
+    if (KIND == SCANNER_SIMD) {
+        SOURCE = source;
+        POS = 0;
+    } else {
+        lexer_flex(source);
+    }
+}
+
+void Scanner_stop(void) {
+    if (KIND == SCANNER_SIMD) {
+        SOURCE = NULL;
+    } else {
+        yylex_destroy();
+    }
+}
+
+int yylex(void) {
+    return KIND == SCANNER_SIMD ? Scanner_lex() : yylex_flex();
+}
+
+static inline bool _Scanner_is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static inline bool _Scanner_is_ident_start(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static inline bool _Scanner_is_ident(char c) {
+    return _Scanner_is_ident_start(c) || (c >= '0' && c <= '9');
+}
+
+#ifdef __SSE2__
+typedef __m128i Block;
+
+static inline Block _Scanner_load(size_t pos) {
+    return _mm_loadu_si128((const Block*)(SOURCE->text + pos));
+}
+
+/**
+ * @brief Get the mask of the bytes of a block equal to c
+ * (bit i for byte i)
+ */
+static inline uint32_t _Scanner_eq(Block block, char c) {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c)));
+}
+
+/**
+ * @brief Get the mask of the bytes of a block in [low, low + count)
+ */
+static inline uint32_t _Scanner_in_range(Block block, char low, int count) {
+    // Move the range to [-128, -128 + count), as comparisons are signed
+    Block shifted = _mm_add_epi8(block, _mm_set1_epi8((char)(0x80 - low)));
+    return _mm_movemask_epi8(
+        _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(-128 + count))));
+}
+
+/**
+ * @brief Get the mask of the bytes of a block which can be part
+ * of an identifier ([a-zA-Z0-9_])
+ */
+static inline uint32_t _Scanner_ident_mask(Block block) {
+    Block lower = _mm_or_si128(block, _mm_set1_epi8(0x20));
+    return _Scanner_in_range(lower, 'a', 26) |
+           _Scanner_in_range(block, '0', 10) |
+           _Scanner_eq(block, '_');
+}
+#endif
+
+/**
+ * @brief Move over n bytes of blanks or of a comment, as flex does
+ * byte per byte : each line feed is indexed and resets the column
+ *
+ * @param n Number of bytes, at most 32
+ * @param newlines Mask of the line feeds among the n bytes
+ */
+static inline void _Scanner_advance(size_t n, uint32_t newlines) {
+    if (newlines) {
+        for (uint32_t mask = newlines; mask; mask &= mask - 1) {
+            Source_new_line(SOURCE, POS + __builtin_ctz(mask) + 1);
+            nbline++;
+        }
+        nbchar = n - (31 - __builtin_clz(newlines)) - 1;
+    } else {
+        nbchar += n;
+    }
+    POS += n;
+}
+
+/**
+ * @brief Move over a token of n bytes
+ */
+static inline void _Scanner_token(size_t n) {
+    nbchar += n;
+    POS += n;
+}
+
+static void _Scanner_skip_blanks(void) {
+    const char* text = SOURCE->text;
+
+#ifdef __SSE2__
+    while (POS + SCANNER_BLOCK <= SOURCE->len) {
+        Block block = _Scanner_load(POS);
+        uint32_t newlines = _Scanner_eq(block, '\n');
+        uint32_t blanks = newlines | _Scanner_eq(block, ' ') |
+                          _Scanner_eq(block, '\t') | _Scanner_eq(block, '\r');
+
+        if (blanks != 0xFFFF) {
+            size_t n = __builtin_ctz(~blanks);
+            _Scanner_advance(n, newlines & ((1u << n) - 1));
+            return;
+        }
+        _Scanner_advance(SCANNER_BLOCK, newlines);
+    }
+#endif
+    while (POS < SOURCE->len && _Scanner_is_blank(text[POS])) {
+        _Scanner_advance(1, text[POS] == '\n');
+    }
+}
+
+/**
+ * @brief Move over the body of a comment, up to its closing star-slash
+ *
+ * @return bool false if the comment is not closed before the end
+ */
+static bool _Scanner_skip_comment(void) {
+    const char* text = SOURCE->text;
+    uint32_t star = 0;  // 1 if the previous byte is a star
+
+#ifdef __SSE2__
+    while (POS + SCANNER_BLOCK <= SOURCE->len) {
+        Block block = _Scanner_load(POS);
+        uint32_t stars = _Scanner_eq(block, '*');
+        uint32_t ends = _Scanner_eq(block, '/') & ((stars << 1) | star);
+        uint32_t newlines = _Scanner_eq(block, '\n');
+
+        if (ends) {
+            size_t n = __builtin_ctz(ends) + 1;
+            _Scanner_advance(n, newlines & ((1u << n) - 1));
+            return true;
+        }
+        star = stars >> (SCANNER_BLOCK - 1);
+        _Scanner_advance(SCANNER_BLOCK, newlines);
+    }
+#endif
+    while (POS < SOURCE->len) {
+        char c = text[POS];
+        _Scanner_advance(1, c == '\n');
+        if (c == '/' && star) {
+            return true;
+        }
+        star = c == '*';
+    }
+
+    return false;
+}
+
+/**
+ * @brief Move over a line comment, up to its line feed
+ * (memchr is vectorized by the C library)
+ */
+static void _Scanner_skip_line_comment(void) {
+    const char* start = SOURCE->text + POS;
+    const char* end = memchr(start, '\n', SOURCE->len - POS);
+    size_t n = end ? (size_t)(end - start) : SOURCE->len - POS;
+
+    _Scanner_token(n);
+}
+
+/**
+ * @brief Get the length of the identifier starting at a position
+ *
+ * @param start Offset of a letter or underscore
+ * @return size_t At most SCANNER_IDENT_MAX
+ */
+static size_t _Scanner_ident_len(size_t start) {
+    const char* text = SOURCE->text;
+    size_t end = start + 1;
+
+#ifdef __SSE2__
+    for (; end - start < SCANNER_IDENT_MAX &&
+           end + SCANNER_BLOCK <= SOURCE->len;
+         end += SCANNER_BLOCK) {
+        uint32_t others = ~_Scanner_ident_mask(_Scanner_load(end)) & 0xFFFF;
+        if (others) {
+            end += __builtin_ctz(others);
+            return MIN(end - start, SCANNER_IDENT_MAX);
+        }
+    }
+#endif
+    while (end - start < SCANNER_IDENT_MAX && end < SOURCE->len &&
+           _Scanner_is_ident(text[end])) {
+        ++end;
+    }
+
+    return MIN(end - start, SCANNER_IDENT_MAX);
+}
+
+static int _Scanner_ident(const char* text) {
+    size_t len = _Scanner_ident_len(POS);
+
+    _Scanner_token(len);
+    for (size_t i = 0; i < sizeof(KEYWORDS) / sizeof(*KEYWORDS); ++i) {
+        if (KEYWORDS[i].len == len && !memcmp(KEYWORDS[i].text, text, len)) {
+            if (KEYWORDS[i].token == TYPE) {
+                yylval.prim_type = KEYWORDS[i].prim_type;
+            }
+            return KEYWORDS[i].token;
+        }
+    }
+    yylval.ident = Intern_add(text, len);
+
+    return IDENT;
+}
+
+static int _Scanner_number(const char* text) {
+    size_t len = 1;
+
+    // "0" is a number on its own : "01" is scanned as 0 and 1
+    if (text[0] != '0') {
+        while (text[len] >= '0' && text[len] <= '9') {
+            ++len;
+        }
+    }
+    // As atoi, on the digits only (the source is NUL-padded)
+    yylval.num = text[0] == '0' ? 0 : (int)strtol(text, NULL, 10);
+    _Scanner_token(len);
+
+    return NUM;
+}
+
+/**
+ * @brief Get the length of the character literal at text
+ *
+ * @param text Single quote
+ * @return size_t 0 if text is not a valid literal
+ */
+static size_t _Scanner_literal_len(const char* text) {
+    unsigned char c = text[1];
+
+    if (c == '\\') {
+        return text[2] && strchr("'0rnt\\", text[2]) && text[3] == '\''
+                   ? 4 : 0;
+    }
+    // Any printable character but a quote, and a backslash (above)
+    return c != '\'' && c >= ' ' && c != 127 && text[2] == '\'' ? 3 : 0;
+}
+
+static int _Scanner_literal(const char* text, size_t len) {
+    static const char charmap[128] = {
+        ['0'] = '\0',
+        ['r'] = '\r',
+        ['n'] = '\n',
+        ['t'] = '\t',
+        ['\\'] = '\\',
+        ['\''] = '\'',
+    };
+
+    yylval.byte = len == 4 ? charmap[(int)text[2]] : text[1];
+    _Scanner_token(len);
+
+    return CHARACTER;
+}
+
+/**
+ * @brief Get a token of one or two bytes
+ *
+ * @param op Operator of the token
+ * @param len Length of the token
+ * @param token
+ * @return int token
+ */
+static inline int _Scanner_operator(Operator op, size_t len, int token) {
+    yylval.op = op;
+    _Scanner_token(len);
+    return token;
+}
+
+/**
+ * @brief Scan the token starting at the current position
+ * (not a blank, nor a comment)
+ *
+ * @return int
+ */
+static int _Scanner_next_token(void) {
+    const char* text = SOURCE->text + POS;
+    bool equal = text[1] == '=';  // Second byte of <=, >=, == and !=
+    size_t len;
+
+    if (_Scanner_is_ident_start(text[0])) {
+        return _Scanner_ident(text);
+    }
+    if (text[0] >= '0' && text[0] <= '9') {
+        return _Scanner_number(text);
+    }
+    switch (text[0]) {
+        case '*':
+            return _Scanner_operator(OP_MUL, 1, DIVSTAR);
+        case '/':
+            return _Scanner_operator(OP_DIV, 1, DIVSTAR);
+        case '%':
+            return _Scanner_operator(OP_MOD, 1, DIVSTAR);
+        case '+':
+            return _Scanner_operator(OP_ADD, 1, ADDSUB);
+        case '-':
+            return _Scanner_operator(OP_SUB, 1, ADDSUB);
+        case '<':
+            return _Scanner_operator(equal ? OP_LE : OP_LT, 1 + equal, ORDER);
+        case '>':
+            return _Scanner_operator(equal ? OP_GE : OP_GT, 1 + equal, ORDER);
+        case '=':
+            if (equal) {
+                return _Scanner_operator(OP_EQ, 2, EQ);
+            }
+            break;
+        case '!':
+            if (equal) {
+                return _Scanner_operator(OP_NE, 2, EQ);
+            }
+            break;
+        case '|':
+            if (text[1] == '|') {
+                _Scanner_token(2);
+                return OR;
+            }
+            break;
+        case '&':
+            if (text[1] == '&') {
+                _Scanner_token(2);
+                return AND;
+            }
+            break;
+        case '\'':
+            if ((len = _Scanner_literal_len(text))) {
+                return _Scanner_literal(text, len);
+            }
+            break;
+    }
+    // Any other byte is a token on its own
+    yylval.byte = text[0];
+    _Scanner_token(1);
+
+    return text[0];
+}
+
+int Scanner_lex(void) {
+    for (;;) {
+        _Scanner_skip_blanks();
+        if (POS >= SOURCE->len) {
+            return 0;
+        }
+
+        const char* text = SOURCE->text + POS;
+        if (text[0] == '/' && text[1] == '*') {
+            _Scanner_token(2);
+            if (!_Scanner_skip_comment()) {
+                return 0;
+            }
+        } else if (text[0] == '/' && text[1] == '/') {
+            _Scanner_skip_line_comment();
+        } else {
+            return _Scanner_next_token();
+        }
+    }
+}
+
+static inline uint64_t _Scanner_mix(uint64_t hash, uint64_t word) {
+    hash = (hash ^ word) * SCANNER_MULTIPLIER;
+    return hash ^ (hash >> 29);
+}
+
+/**
+ * @brief Get the value of the last token, 0 for tokens without value
+ *
+ * @param token
+ * @return uint32_t
+ */
+static uint32_t _Scanner_token_value(int token) {
+    switch (token) {
+        case IDENT:
+            return yylval.ident;
+        case NUM:
+            return yylval.num;
+        case CHARACTER:
+            return (unsigned char)yylval.byte;
+        case TYPE:
+            return yylval.prim_type;
+        case ADDSUB:
+        case DIVSTAR:
+        case EQ:
+        case ORDER:
+            return yylval.op;
+        default:
+            return 0;
+    }
+}
+
+size_t Scanner_scan_all(Source* source, uint64_t* digest) {
+    uint64_t hash = 0;
+    size_t nb_tokens = 0;
+    int token;
+
+    Scanner_start(source);
+    while ((token = yylex())) {
+        hash = _Scanner_mix(hash, (uint64_t)_Scanner_token_value(token) << 32 |
+                                      (uint32_t)token);
+        hash = _Scanner_mix(hash, (uint64_t)nbline << 32 | nbchar);
+        ++nb_tokens;
+    }
+    Scanner_stop();
+
+    const uint32_t* lines = (const uint32_t*)source->lines.arr;
+    for (size_t i = 0; i < ArrayList_get_length(&source->lines); ++i) {
+        hash = _Scanner_mix(hash, lines[i]);
+    }
+    *digest = hash;
+
+    return nb_tokens;
+}
@@ -0,0 +1,66 @@
+/**
+ * @file scanner.h
+ * @brief Scanners of the parser : the flex one (tpc.lex), or a
+ * hand-written one skipping blanks, comments and identifiers
+ * 16 bytes at a time (SSE2), which produces the same tokens
+ *
+ */
+
+#ifndef SCANNER_H
+#define SCANNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "source.h"
+
+typedef enum ScannerKind {
+    SCANNER_FLEX,
+    SCANNER_SIMD,
+} ScannerKind;
+
+// Scanner used without --scanner, make CFLAGS=-DSCANNER_DEFAULT=SCANNER_SIMD
+#ifndef SCANNER_DEFAULT
+#define SCANNER_DEFAULT SCANNER_FLEX
+#endif
+
+/**
+ * @brief Select the scanner used by the next calls to Scanner_start
+ *
+ * @param kind
+ */
+void Scanner_select(ScannerKind kind);
+
+/**
+ * @brief Make the selected scanner read a source in place :
+ * yylex then returns its tokens
+ *
+ * @param source Loaded source code
+ */
+void Scanner_start(Source* source);
+
+/**
+ * @brief Release the state of the selected scanner
+ * (not the scanned source)
+ */
+void Scanner_stop(void);
+
+/**
+ * @brief Get the next token of the hand-written scanner,
+ * see Scanner_start
+ *
+ * @return int Token, 0 at the end of the source
+ */
+int Scanner_lex(void);
+
+/**
+ * @brief Scan a whole source with the selected scanner, without parsing it
+ *
+ * @param source Loaded source code
+ * @param digest Filled with a hash of every token (kind, value, position)
+ * and of the line index, equal for scanners giving the same tokens
+ * @return size_t Number of tokens
+ */
+size_t Scanner_scan_all(Source* source, uint64_t* digest);
+
+#endif
@@ -14,22 +14,402 @@ static ErrorType _Semantic_SuiteInstr(Tree tree,
                                       const ProgramST* prog,
                                       bool is_root);
 
-#define IS_FUNCTION_CALL_NODE(node) (          \
-    (node)->firstChild != NULL &&              \
-    ((node)->firstChild->label == EmptyArgs || \
-     (node)->firstChild->label == ListExp))
+#define IS_FUNCTION_CALL_NODE(node) (       \
+    FIRSTCHILD(node) != NULL &&              \
+    (FIRSTCHILD(node)->label == EmptyArgs || \
+     FIRSTCHILD(node)->label == ListExp))
 
 #define IS_ONLY_IDENTIFIER(node) ( \
     (node)->label == Ident &&      \
-    (node)->firstChild == NULL)
+    FIRSTCHILD(node) == NULL)
 
-static ErrorType _Semantic_FunctionCall(Tree tree,
+// Deferred calls of the function being checked, NULL if not streaming
+static DeferredCalls* DEFERRED = NULL;
+
+void DeferredCalls_init(DeferredCalls* self) {
+    *self = (DeferredCalls){0};
+    ArrayList_init(&self->calls, sizeof(DeferredCall), 0, NULL);
+    ArrayList_init(&self->args, sizeof(CallArg), 0, NULL);
+    AtomMap_init(&self->pending);
+}
+
+void DeferredCalls_free(DeferredCalls* self) {
+    ArrayList_free(&self->calls);
+    ArrayList_free(&self->args);
+    AtomMap_free(&self->pending);
+    *self = (DeferredCalls){0};
+}
+
+/**
+ * @brief Is the node a call to a function which is not defined yet ?
+ * (only in streaming mode, the whole program is known else)
+ *
+ * @param tree Ident node
+ * @param func
+ * @param prog
+ * @return bool
+ */
+static bool _Semantic_is_deferred_call(Tree tree,
+                                       const FunctionST* func,
+                                       const ProgramST* prog) {
+    return DEFERRED && IS_FUNCTION_CALL_NODE(tree) && !tree->symbol &&
+           !ST_resolve(prog, func, tree->att.ident);
+}
+
+/**
+ * @brief Find the deferred call which gives the value of an expression
+ *
+ * @param value Checked expression
+ * @param func
+ * @param prog
+ * @return int 1 + index in DEFERRED->calls, 0 if the expression is not
+ * a deferred call
+ */
+static int _Semantic_deferred_index(Tree value,
+                                    const FunctionST* func,
+                                    const ProgramST* prog) {
+    if (!_Semantic_is_deferred_call(value, func, prog)) {
+        return 0;
+    }
+
+    // Just deferred, after the calls in its arguments
+    ARRAYLIST_DECLARE_ARRAY(DEFERRED->calls, DeferredCall, calls);
+    for (size_t i = ArrayList_get_length(&DEFERRED->calls); i > 0; --i) {
+        if (calls[i - 1].identifier == value->att.ident &&
+            calls[i - 1].lineno == value->lineno &&
+            calls[i - 1].column == value->column) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Warn about an implicit cast from int to char
+ *
+ * @param site
+ * @return ErrorType WARN_IMPLICIT_INT_TO_CHAR
+ */
+static ErrorType _Semantic_warn_cast(CastSite site) {
+    ErrorType err = ERR_NONE;
+    CodeError error = {
+        .err = ADD_ERR(err, WARN_IMPLICIT_INT_TO_CHAR),
+        .line = site.lineno,
+        .column = site.column,
+    };
+
+    switch (site.kind) {
+        case CAST_ASSIGNATION:
+            CodeError_print(
+                error,
+                "assignation type mismatch in function '%s' to variable '%s' "
+                "(cast from 'int' to 'char')",
+                Intern_str(site.function),
+                Intern_str(site.variable));
+            break;
+        case CAST_RETURN:
+            CodeError_print(error,
+                            "return type mismatch in function '%s' "
+                            "(cast from 'int' to 'char')",
+                            Intern_str(site.function));
+            break;
+        default:
+            CodeError_print(error, "'int' to parameter of type 'char'");
+    }
+
+    return err;
+}
+
+/**
+ * @brief Warn about an implicit cast from int to char of a value.
+ * The value of a deferred call is only an int if the function returns
+ * one : the warning waits for its definition.
+ *
+ * @param deferred Deferred calls, NULL if not streaming
+ * @param deferred_call See _Semantic_deferred_index
+ * @param site
+ * @return ErrorType
+ */
+static ErrorType _Semantic_cast(DeferredCalls* deferred,
+                                int deferred_call,
+                                CastSite site) {
+    if (deferred_call) {
+        DeferredCall* call = ArrayList_get(&deferred->calls,
+                                           deferred_call - 1);
+        if (!call->resolved) {
+            call->cast = site;
+            return ERR_NONE;
+        }
+        if (call->ret_type != type_num) {
+            return ERR_NONE;
+        }
+    }
+
+    return _Semantic_warn_cast(site);
+}
+
+/**
+ * @brief Check an argument against the parameter it is given to
+ *
+ * @param param Parameter of the called function
+ * @param arg
+ * @param call_column Column of the call
+ * @param deferred Deferred calls, NULL if not streaming
+ * @return ErrorType
+ */
+static ErrorType _Semantic_check_arg(const Symbol* param,
+                                     CallArg arg,
+                                     int call_column,
+                                     DeferredCalls* deferred) {
+    ErrorType err = ERR_NONE;
+
+    if (arg.symbol_type == SYMBOL_ARRAY ||
+        param->symbol_type == SYMBOL_ARRAY) {
+        // If one of them is an array,
+        // we need to check that the other is also an array
+        if (param->symbol_type != arg.symbol_type) {
+            CodeError_print(
+                (CodeError){
+                    .err = ADD_ERR(err, ERR_MISMATCH_ARRAY_TYPE),
+                    .line = arg.lineno,
+                    .column = call_column,
+                },
+                "expected %s, got %s",
+                SymbolType_to_str(param->symbol_type),
+                SymbolType_to_str(arg.symbol_type));
+        }
+        // We check if the array types are the same
+        // (int[] to char[] is forbidden)
+        else if (arg.type != param->type) {
+            CodeError_print(
+                (CodeError){
+                    .err = ADD_ERR(err, ERR_INVALID_ARRAY_TYPE),
+                    .line = arg.lineno,
+                    .column = call_column,
+                },
+                "expected array of type '%s', got '%s'",
+                Symbol_get_type_str(param->type),
+                Symbol_get_type_str(arg.type));
+        }
+    }
+    /* We check that the expression type can be implicitly casted
+       to the parameter type (char to int is allowed, not the opposite) */
+    else if (param->symbol_type == SYMBOL_VALUE &&
+             arg.type == type_num &&
+             param->type == type_byte) {
+        err |= _Semantic_cast(deferred, arg.deferred_call,
+                              (CastSite){
+                                  .kind = CAST_ARG,
+                                  .lineno = arg.lineno,
+                                  .column = arg.column,
+                              });
+    }
+
+    return err;
+}
+
+/**
+ * @brief Step of the check of an expression node, see _Semantic_run
+ */
+typedef enum ExprStage {
+    STAGE_ENTER,     // Nothing checked yet
+    STAGE_OPERANDS,  // Operands (or index) checked
+    STAGE_ARGS,      // Call : the arguments before `arg` are checked
+    STAGE_ARG,       // Call : `arg` is checked as an expression
+} ExprStage;
+
+/**
+ * @brief Expression node waiting on the stack of _Semantic_run
+ */
+typedef struct ExprTask {
+    Node* node;
+    Node* arg;  // Call : current argument
+    int index;  // Call : position of arg
+    ExprStage stage;
+    bool used_as_value;  // false for a call instruction
+    bool deferred;       // Call : see _Semantic_is_deferred_call
+} ExprTask;
+
+/**
+ * @brief Get the EXPR_* flags of an expression,
+ * once its operands are checked
+ *
+ * @param tree
+ * @return uint8_t
+ */
+static uint8_t _Semantic_expr_flags(const Node* tree) {
+    switch (tree->label) {
+        case Num:
+        case Character:
+            return EXPR_CONSTANT;
+        case Ident:
+            return IS_ONLY_IDENTIFIER(tree) ? EXPR_LVALUE : 0;
+        case ArrayLR:
+            return EXPR_LVALUE;
+        case AddsubU:
+        case Not:
+            return FIRSTCHILD(tree)->expr_flags & EXPR_CONSTANT;
+        case Addsub:
+        case Divstar:
+        case Eq:
+        case Or:
+        case And:
+        case Order:
+            return FIRSTCHILD(tree)->expr_flags &
+                   SECONDCHILD(tree)->expr_flags & EXPR_CONSTANT;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Push an expression to check before the tasks below it
+ *
+ * @param tasks [ExprTask]
+ * @param tree
+ */
+static void _Semantic_push_expr(ArrayList* tasks, Node* tree) {
+    ExprTask task = {.node = tree, .used_as_value = true};
+    ArrayList_append(tasks, &task);
+}
+
+/**
+ * @brief Record the type of a checked expression (with its EXPR_* flags)
+ * on the node for the code generator
+ *
+ * @param tree
+ * @param type
+ */
+static void _Semantic_record(Node* tree, type_t type) {
+    tree->expr_type = type;
+    tree->expr_flags = _Semantic_expr_flags(tree);
+}
+
+/**
+ * @brief Get the array named by an argument, if any
+ *
+ * @param arg
+ * @param caller
+ * @param prog
+ * @return const Symbol* NULL if the argument is an expression
+ */
+static const Symbol* _Semantic_array_arg(Tree arg,
+                                         const FunctionST* caller,
+                                         const ProgramST* prog) {
+    const Symbol* arg_sym =
+        IS_ONLY_IDENTIFIER(arg) ? ST_resolve_from_node(prog, caller, arg)
+                                : NULL;
+
+    return arg_sym && arg_sym->symbol_type == SYMBOL_ARRAY ? arg_sym : NULL;
+}
+
+/**
+ * @brief Defer the check of the count and types of the arguments
+ * of a call to a function which is not defined yet (and the warning
+ * about the call) until the function is defined.
+ * The arguments which are expressions must be checked already.
+ *
+ * @param tree Ident node of the call
+ * @param caller
+ * @param prog
+ * @param used_as_value
+ */
+static void _Semantic_defer_call(Tree tree,
+                                 const FunctionST* caller,
+                                 const ProgramST* prog,
+                                 bool used_as_value) {
+    DeferredCall call = {
+        .identifier = tree->att.ident,
+        .lineno = tree->lineno,
+        .column = tree->column,
+        .used_as_value = used_as_value,
+        .first_arg = ArrayList_get_length(&DEFERRED->args),
+    };
+
+    for (Node* arg = FIRSTCHILD(FIRSTCHILD(tree)); arg;
+         arg = NEXTSIBLING(arg), ++call.nb_args) {
+        CallArg call_arg = {
+            .symbol_type = SYMBOL_VALUE,
+            .type = arg->expr_type,
+            .lineno = arg->lineno,
+            .column = arg->column,
+            .deferred_call = _Semantic_deferred_index(arg, caller, prog),
+        };
+        const Symbol* arg_sym = _Semantic_array_arg(arg, caller, prog);
+
+        if (arg_sym) {
+            call_arg.symbol_type = SYMBOL_ARRAY;
+            call_arg.type = arg_sym->type;
+        }
+        ArrayList_append(&DEFERRED->args, &call_arg);
+    }
+
+    int nb_calls = AtomMap_get(&DEFERRED->pending, call.identifier);
+    ArrayList_append(&DEFERRED->calls, &call);
+    AtomMap_put(&DEFERRED->pending, call.identifier,
+                nb_calls < 0 ? 1 : nb_calls + 1);
+    DEFERRED->nb_pending++;
+}
+
+/**
+ * @brief Check the arguments of a deferred call which are expressions,
+ * one at a time, then defer the call (an int until the function is known)
+ *
+ * @param tasks [ExprTask]
+ * @param task STAGE_ARGS task of the call
+ * @param caller
+ * @param prog
+ */
+static void _Semantic_deferred_args(ArrayList* tasks, ExprTask task,
+                                    const FunctionST* caller,
+                                    const ProgramST* prog) {
+    for (Node* arg = task.arg; arg; arg = NEXTSIBLING(arg)) {
+        if (!_Semantic_array_arg(arg, caller, prog)) {
+            task.arg = NEXTSIBLING(arg);
+            ArrayList_append(tasks, &task);
+            _Semantic_push_expr(tasks, arg);
+            return;
+        }
+    }
+
+    _Semantic_defer_call(task.node, caller, prog, task.used_as_value);
+    if (task.used_as_value) {
+        _Semantic_record(task.node, type_num);
+    }
+}
+
+/**
+ * @brief Start the check of a function call : check that the function
+ * can be called, then push the check of its arguments
+ *
+ * @param tasks [ExprTask]
+ * @param tree Ident node of the call
+ * @param caller
+ * @param prog
+ * @param used_as_value
+ * @return ErrorType
+ */
+static ErrorType _Semantic_FunctionCall(ArrayList* tasks, Tree tree,
                                         const FunctionST* caller,
-                                        const ProgramST* prog) {
+                                        const ProgramST* prog,
+                                        bool used_as_value) {
     assert(tree->label == Ident);
     assert(IS_FUNCTION_CALL_NODE(tree));
 
     ErrorType err = ERR_NONE;
+    ExprTask task = {
+        .node = tree,
+        .arg = FIRSTCHILD(FIRSTCHILD(tree)),
+        .stage = STAGE_ARGS,
+        .used_as_value = used_as_value,
+    };
+
+    if (_Semantic_is_deferred_call(tree, caller, prog)) {
+        task.deferred = true;
+        ArrayList_append(tasks, &task);
+        return err;
+    }
 
     const Symbol* sym = ST_resolve_from_node(prog, caller, tree);
     if (sym->symbol_type != SYMBOL_FUNCTION) {
@@ -40,12 +420,14 @@ static ErrorType _Semantic_FunctionCall(Tree tree,
                 .column = tree->column,
             },
             "called object '%s' is not a function",
-            sym->identifier);
+            Intern_str(sym->identifier));
+        if (used_as_value) {
+            _Semantic_record(tree, sym->type);
+        }
         return err;
     }
 
-    const FunctionST* calleefst = FunctionST_get_from_name(prog,
-                                                           tree->att.ident);
+    const FunctionST* calleefst = FunctionST_get_from_call(prog, tree);
     if (!FunctionST_is_defined_before_use(caller, calleefst)) {
         CodeError_print(
             (CodeError){
@@ -54,14 +436,52 @@ static ErrorType _Semantic_FunctionCall(Tree tree,
                 .line = tree->lineno,
             },
             "implicit declaration of function '%s'",
-            tree->att.ident);
+            Intern_str(tree->att.ident));
+    }
+
+    ArrayList_append(tasks, &task);
+    return err;
+}
+
+/**
+ * @brief Check the arguments of a call, up to the next one which is
+ * an expression : its check is pushed, and the call task after it.
+ * Once every argument is checked, check their count.
+ *
+ * @param tasks [ExprTask]
+ * @param task STAGE_ARGS or STAGE_ARG task of the call
+ * @param caller
+ * @param prog
+ * @return ErrorType
+ */
+static ErrorType _Semantic_FunctionCall_args(ArrayList* tasks, ExprTask task,
+                                             const FunctionST* caller,
+                                             const ProgramST* prog) {
+    Tree tree = task.node;
+    ErrorType err = ERR_NONE;
+    const FunctionST* calleefst = FunctionST_get_from_call(prog, tree);
+    int nb_params = FunctionST_get_param_count(calleefst);
+
+    if (task.stage == STAGE_ARG) {
+        // The argument was checked as an expression
+        err |= _Semantic_check_arg(
+            FunctionST_get_param(calleefst, task.index),
+            (CallArg){
+                .symbol_type = SYMBOL_VALUE,
+                .type = task.arg->expr_type,
+                .lineno = task.arg->lineno,
+                .column = task.arg->column,
+                .deferred_call =
+                    _Semantic_deferred_index(task.arg, caller, prog),
+            },
+            tree->column, DEFERRED);
+        task.arg = NEXTSIBLING(task.arg);
+        task.index++;
     }
 
-    int i = 0;
-    Node* arg;
     // Check function arguments
-    for (arg = tree->firstChild->firstChild; arg; arg = arg->nextSibling, ++i) {
-        if (i >= FunctionST_get_param_count(calleefst)) {
+    for (Node* arg = task.arg; arg; arg = NEXTSIBLING(arg), ++task.index) {
+        if (task.index >= nb_params) {
             // Check if we have more arguments than expected
             CodeError_print(
                 (CodeError){
@@ -70,69 +490,46 @@ static ErrorType _Semantic_FunctionCall(Tree tree,
                     .column = tree->column,
                 },
                 "too many arguments to function call '%s', expected %d",
-                tree->att.ident,
-                FunctionST_get_param_count(calleefst));
+                Intern_str(tree->att.ident), nb_params);
             break;
         }
         // Get the i-th parameter of the function being called for type checking
-        const Symbol* param_sym = FunctionST_get_param(calleefst, i);
+        const Symbol* param_sym = FunctionST_get_param(calleefst, task.index);
 
         // If we have a node with only an identifier, it could be an array
         if (IS_ONLY_IDENTIFIER(arg) || param_sym->symbol_type == SYMBOL_ARRAY) {
-            const Symbol* arg_sym = ST_resolve_from_node(prog, caller, arg);
+            // Only an identifier can name an array, any other expression
+            // (indexed element, operation, constant...) is a value
+            const Symbol* arg_sym =
+                arg->label == Ident ? ST_resolve_from_node(prog, caller, arg)
+                                    : NULL;
+            SymbolType arg_symbol_type = arg_sym ? arg_sym->symbol_type
+                                                 : SYMBOL_VALUE;
 
-            if (arg_sym->symbol_type == SYMBOL_ARRAY ||
+            if (arg_symbol_type == SYMBOL_ARRAY ||
                 param_sym->symbol_type == SYMBOL_ARRAY) {
-                // If one of them is an array,
-                // we need to check that the other is also an array
-                if (param_sym->symbol_type != arg_sym->symbol_type) {
-                    CodeError_print(
-                        (CodeError){
-                            .err = ADD_ERR(err, ERR_MISMATCH_ARRAY_TYPE),
-                            .line = arg->lineno,
-                            .column = tree->column,
-                        },
-                        "expected %s, got %s",
-                        SymbolType_to_str(param_sym->symbol_type),
-                        SymbolType_to_str(arg_sym->symbol_type));
-                }
-                // We check if the array types are the same
-                // (int[] to char[] is forbidden)
-                else if (arg_sym->type != param_sym->type) {
-                    CodeError_print(
-                        (CodeError){
-                            .err = ADD_ERR(err, ERR_INVALID_ARRAY_TYPE),
-                            .line = arg->lineno,
-                            .column = tree->column,
-                        },
-                        "expected array of type '%s', got '%s'",
-                        Symbol_get_type_str(param_sym->type),
-                        Symbol_get_type_str(arg_sym->type));
-                }
+                err |= _Semantic_check_arg(
+                    param_sym,
+                    (CallArg){
+                        .symbol_type = arg_symbol_type,
+                        .type = arg_sym ? arg_sym->type : type_void,
+                        .lineno = arg->lineno,
+                        .column = arg->column,
+                    },
+                    tree->column, DEFERRED);
                 continue;
             }
         }
         // The argument is not an array, and so an expression
-        ExprReturn ret = _Semantic_Expr(arg, caller, prog);
-
-        /* We check that the expression type can be implicitly casted
-           to the parameter type (char to int is allowed, not the opposite) */
-        if (param_sym->symbol_type == SYMBOL_VALUE &&
-            ret.type == type_num &&
-            param_sym->type == type_byte) {
-            CodeError_print(
-                (CodeError){
-                    .err = ADD_ERR(err, WARN_IMPLICIT_INT_TO_CHAR),
-                    .line = arg->lineno,
-                    .column = arg->column,
-                },
-                "'int' to parameter of type 'char'");
-        }
-        err |= ret.err;
+        task.arg = arg;
+        task.stage = STAGE_ARG;
+        ArrayList_append(tasks, &task);
+        _Semantic_push_expr(tasks, arg);
+        return err;
     }
 
     // Check if we have less arguments than expected
-    if (i < FunctionST_get_param_count(calleefst)) {
+    if (task.index < nb_params) {
         CodeError_print(
             (CodeError){
                 .err = ADD_ERR(err, ERR_INVALID_PARAM_COUNT),
@@ -140,32 +537,37 @@ static ErrorType _Semantic_FunctionCall(Tree tree,
                 .column = tree->column,
             },
             "too few arguments to function call '%s', expected %d, have %d",
-            tree->att.ident,
-            FunctionST_get_param_count(calleefst),
-            i);
+            Intern_str(tree->att.ident), nb_params, task.index);
     }
 
+    if (task.used_as_value) {
+        _Semantic_record(tree,
+                         ST_resolve_from_node(prog, caller, tree)->type);
+    }
     return err;
 }
 
 /**
- * @brief Check if the array is a valid RValue (array or pointer to array,
- * and the indexing expression is valid)
+ * @brief Check if the array is a valid RValue (array or pointer to array),
+ * pushing the check of its indexing expression
  *
+ * @param tasks [ExprTask]
  * @param tree ArrayLR node
  * @param func
  * @param prog
- * @return ExprReturn
+ * @return ErrorType
  */
-static ExprReturn _Semantic_ArrayLR(Tree tree,
-                                    const FunctionST* func,
-                                    const ProgramST* prog) {
+static ErrorType _Semantic_ArrayLR(ArrayList* tasks, Tree tree,
+                                   const FunctionST* func,
+                                   const ProgramST* prog) {
     assert(tree->label == ArrayLR);
     Symbol* sym = ST_resolve_from_node(prog, func, tree);
     if (sym->symbol_type == SYMBOL_ARRAY) {
         // We check if the indexing expression is valid
-        ExprReturn ret = _Semantic_Expr(FIRSTCHILD(tree), func, prog);
-        return (ExprReturn){.err = ret.err, .type = sym->type};
+        ExprTask task = {.node = tree, .stage = STAGE_OPERANDS};
+        ArrayList_append(tasks, &task);
+        _Semantic_push_expr(tasks, FIRSTCHILD(tree));
+        return ERR_NONE;
     } else {
         CodeError_print(
             (CodeError){
@@ -174,8 +576,9 @@ static ExprReturn _Semantic_ArrayLR(Tree tree,
                 .column = tree->column,
             },
             "subscripted value '%s' is not an array or pointer to array",
-            sym->identifier);
-        return (ExprReturn){ERR_SUBSCRIPT_NOT_ARRAY, sym->type};
+            Intern_str(sym->identifier));
+        _Semantic_record(tree, sym->type);
+        return ERR_SUBSCRIPT_NOT_ARRAY;
     }
 }
 
@@ -199,29 +602,34 @@ static type_t _cast_types(type_t t1, type_t t2) {
  * @brief Check if the identifier is a valid RValue
  * Don't use on ArrayLR nodes
  *
+ * @param tasks [ExprTask]
  * @param tree
  * @param func
  * @param prog
- * @return ExprReturn
+ * @return ErrorType
  */
-static ExprReturn _Semantic_IdentRValue(Tree tree,
-                                        const FunctionST* func,
-                                        const ProgramST* prog) {
+static ErrorType _Semantic_IdentRValue(ArrayList* tasks, Tree tree,
+                                       const FunctionST* func,
+                                       const ProgramST* prog) {
     assert(tree->label == Ident);
 
     ErrorType error = ERR_NONE;
+
+    if (_Semantic_is_deferred_call(tree, func, prog)) {
+        return _Semantic_FunctionCall(tasks, tree, func, prog, true);
+    }
+
     const Symbol* sym = ST_resolve_from_node(prog, func, tree);
 
     // The user is trying to call a function
     if (IS_FUNCTION_CALL_NODE(tree)) {
         if (sym->type != type_void) {
-            return (ExprReturn){
-                .err = _Semantic_FunctionCall(tree, func, prog),
-                .type = sym->type};
+            return _Semantic_FunctionCall(tasks, tree, func, prog, true);
         }
         // The function is void, we can't use it as an rvalue
     } else if (sym->symbol_type == SYMBOL_VALUE) {
-        return (ExprReturn){.err = ERR_NONE, .type = sym->type};
+        _Semantic_record(tree, sym->type);
+        return error;
     }
     CodeError_print(
         (CodeError){
@@ -230,68 +638,185 @@ static ExprReturn _Semantic_IdentRValue(Tree tree,
             .column = tree->column - 1,
         },
         "'%s' is not an rvalue",
-        sym->identifier);
-    return (ExprReturn){.err = error, .type = sym->type};
+        Intern_str(sym->identifier));
+    _Semantic_record(tree, sym->type);
+    return error;
 }
 
 /**
- * @brief Calculate the type of an expression
- * Operations between a char and an int will result in an int type
- * (implicit cast)
- * If any of the operands is a void, the result will be a void type. We avoid
- * edges cases where the void type is used in an operation like :
- * void f(void) {return;}
- * int main(void) {int a; a = 2 + f();}
+ * @brief Start the check of an expression node : leaves are checked,
+ * the checks of the operands of an operation are pushed before
+ * the operation itself
  *
- * @param tree
+ * @param tasks [ExprTask]
+ * @param task STAGE_ENTER task
  * @param func
  * @param prog
- * @return ExprReturn
+ * @return ErrorType
  */
-static ExprReturn _Semantic_Expr(Tree tree,
+static ErrorType _Semantic_enter(ArrayList* tasks, ExprTask task,
                                  const FunctionST* func,
                                  const ProgramST* prog) {
-    ErrorType error = ERR_NONE;
-    ExprReturn left, right;
+    Tree tree = task.node;
 
     switch (tree->label) {
         case AddsubU:
-            left = _Semantic_Expr(FIRSTCHILD(tree), func, prog);
-            return (ExprReturn){.err = left.err,
-                                .type = _cast_types(left.type, type_num)};
+        case Not:
+            task.stage = STAGE_OPERANDS;
+            ArrayList_append(tasks, &task);
+            _Semantic_push_expr(tasks, FIRSTCHILD(tree));
+            return ERR_NONE;
         case Addsub:
-        case Divstar:;
-            left = _Semantic_Expr(FIRSTCHILD(tree), func, prog);
-            right = _Semantic_Expr(SECONDCHILD(tree), func, prog);
-            return (ExprReturn){.err = left.err | right.err,
-                                .type = _cast_types(left.type, right.type)};
-        case Ident:;
-            return _Semantic_IdentRValue(tree, func, prog);
-        case EmptyArgs:
-            return (ExprReturn){.err = error, .type = type_void};
-        case Num:
-            return (ExprReturn){.err = error, .type = type_num};
-        case Character:
-            return (ExprReturn){.err = error, .type = type_byte};
+        case Divstar:
         case Eq:
         case Or:
         case And:
         case Order:
-            left = _Semantic_Expr(FIRSTCHILD(tree), func, prog);
-            right = _Semantic_Expr(SECONDCHILD(tree), func, prog);
-            return (ExprReturn){.err = left.err | right.err,
-                                .type = _cast_types(left.type, right.type)};
-        case Not:
-            left = _Semantic_Expr(FIRSTCHILD(tree), func, prog);
-            return (ExprReturn){.err = left.err,
-                                .type = _cast_types(left.type, type_num)};
+            // Popped in the opposite order : left operand first
+            task.stage = STAGE_OPERANDS;
+            ArrayList_append(tasks, &task);
+            _Semantic_push_expr(tasks, SECONDCHILD(tree));
+            _Semantic_push_expr(tasks, FIRSTCHILD(tree));
+            return ERR_NONE;
+        case Ident:
+            return task.used_as_value
+                       ? _Semantic_IdentRValue(tasks, tree, func, prog)
+                       : _Semantic_FunctionCall(tasks, tree, func, prog,
+                                                false);
+        case EmptyArgs:
+            _Semantic_record(tree, type_void);
+            return ERR_NONE;
+        case Num:
+            _Semantic_record(tree, type_num);
+            return ERR_NONE;
+        case Character:
+            _Semantic_record(tree, type_byte);
+            return ERR_NONE;
         case ArrayLR:
-            return _Semantic_ArrayLR(tree, func, prog);
+            return _Semantic_ArrayLR(tasks, tree, func, prog);
         default:
             assert(0 && "We shouldn't be there (_Sematinic_Expr)");
+            return ERR_NONE;
     }
 }
 
+/**
+ * @brief Calculate the type of an expression once its operands
+ * are checked. Operations between a char and an int will result in
+ * an int type (implicit cast)
+ * If any of the operands is a void, the result will be a void type. We avoid
+ * edges cases where the void type is used in an operation like :
+ * void f(void) {return;}
+ * int main(void) {int a; a = 2 + f();}
+ *
+ * @param tree Operation or ArrayLR node
+ * @param func
+ * @param prog
+ */
+static void _Semantic_leave(Tree tree,
+                            const FunctionST* func,
+                            const ProgramST* prog) {
+    switch (tree->label) {
+        case AddsubU:
+        case Not:
+            _Semantic_record(
+                tree, _cast_types(FIRSTCHILD(tree)->expr_type, type_num));
+            break;
+        case ArrayLR:
+            _Semantic_record(tree,
+                             ST_resolve_from_node(prog, func, tree)->type);
+            break;
+        default:
+            _Semantic_record(tree, _cast_types(FIRSTCHILD(tree)->expr_type,
+                                               SECONDCHILD(tree)->expr_type));
+    }
+}
+
+/**
+ * @brief Check expressions until the stack of tasks is empty.
+ * Iterative post-order traversal, expressions can be deeply nested :
+ * each node is checked (and diagnosed) in the same order as by
+ * a recursive descent, left operand and first argument first.
+ *
+ * @param tasks [ExprTask], emptied
+ * @param func
+ * @param prog
+ * @return ErrorType Errors of every checked node
+ */
+static ErrorType _Semantic_run(ArrayList* tasks,
+                               const FunctionST* func,
+                               const ProgramST* prog) {
+    ErrorType err = ERR_NONE;
+
+    while (ArrayList_get_length(tasks)) {
+        ExprTask task = ArrayList_pop_v(tasks, ExprTask);
+
+        switch (task.stage) {
+            case STAGE_ENTER:
+                err |= _Semantic_enter(tasks, task, func, prog);
+                break;
+            case STAGE_OPERANDS:
+                _Semantic_leave(task.node, func, prog);
+                break;
+            case STAGE_ARGS:
+            case STAGE_ARG:
+                if (task.deferred) {
+                    _Semantic_deferred_args(tasks, task, func, prog);
+                } else {
+                    err |= _Semantic_FunctionCall_args(tasks, task,
+                                                       func, prog);
+                }
+                break;
+        }
+    }
+
+    return err;
+}
+
+/**
+ * @brief Calculate the type of an expression, and record it
+ * (with its EXPR_* flags) on each of its nodes for the code generator
+ *
+ * @param tree
+ * @param func
+ * @param prog
+ * @return ExprReturn
+ */
+static ExprReturn _Semantic_Expr(Tree tree,
+                                 const FunctionST* func,
+                                 const ProgramST* prog) {
+    ArrayList tasks;
+
+    ArrayList_init(&tasks, sizeof(ExprTask), 64, NULL);
+    _Semantic_push_expr(&tasks, tree);
+    ErrorType err = _Semantic_run(&tasks, func, prog);
+    ArrayList_free(&tasks);
+
+    return (ExprReturn){.err = err, .type = tree->expr_type};
+}
+
+/**
+ * @brief Check a call instruction (its value is not used)
+ *
+ * @param tree Ident node of the call
+ * @param func
+ * @param prog
+ * @return ErrorType
+ */
+static ErrorType _Semantic_CallInstr(Tree tree,
+                                     const FunctionST* func,
+                                     const ProgramST* prog) {
+    ArrayList tasks;
+    ExprTask task = {.node = tree};
+
+    ArrayList_init(&tasks, sizeof(ExprTask), 64, NULL);
+    ArrayList_append(&tasks, &task);
+    ErrorType err = _Semantic_run(&tasks, func, prog);
+    ArrayList_free(&tasks);
+
+    return err;
+}
+
 /**
  * @brief Check return validity
  * - A function with a return value should have a expression as a child
@@ -306,11 +831,10 @@ static ErrorType _Semantic_Return(Tree tree,
                                   const FunctionST* func,
                                   const ProgramST* prog) {
     assert(tree->label == Return);
-    const Symbol* fsym = ST_get(&prog->globals, func->identifier);
     ErrorType err = ERR_NONE;
 
     // The function returns non-void, but threre is no return value
-    if (FIRSTCHILD(tree) == NULL && fsym->type != type_void) {
+    if (FIRSTCHILD(tree) == NULL && func->ret_type != type_void) {
         CodeError_print(
             (CodeError){
                 .err = ADD_ERR(err, ERR_MUST_RETURN_VALUE),
@@ -318,22 +842,22 @@ static ErrorType _Semantic_Return(Tree tree,
                 .column = tree->column,
             },
             "non-void function '%s' must return a value",
-            func->identifier);
+            Intern_str(func->identifier));
     }
     if (FIRSTCHILD(tree)) {
         ExprReturn ret = _Semantic_Expr(FIRSTCHILD(tree), func, prog);
         err |= ret.err;
-        if (fsym->type == type_byte && ret.type == type_num) {
-            CodeError_print(
-                (CodeError){
-                    .err = ADD_ERR(err, WARN_IMPLICIT_INT_TO_CHAR),
-                    .line = tree->lineno,
+        if (func->ret_type == type_byte && ret.type == type_num) {
+            err |= _Semantic_cast(
+                DEFERRED,
+                _Semantic_deferred_index(FIRSTCHILD(tree), func, prog),
+                (CastSite){
+                    .kind = CAST_RETURN,
+                    .lineno = tree->lineno,
                     .column = tree->column,
-                },
-                "return type mismatch in function '%s' "
-                "(cast from 'int' to 'char')",
-                func->identifier);
-        } else if (fsym->type == type_void && ret.type == type_void) {
+                    .function = func->identifier,
+                });
+        } else if (func->ret_type == type_void && ret.type == type_void) {
             CodeError_print(
                 (CodeError){
                     .err = ADD_ERR(err, ERR_RETURN_VOID_EXPR),
@@ -342,8 +866,8 @@ static ErrorType _Semantic_Return(Tree tree,
                 },
                 "In function '%s', ISO C forbids 'return' with expression, "
                 "even if the expression evaluates to void",
-                func->identifier);
-        } else if (fsym->type == type_void) {
+                Intern_str(func->identifier));
+        } else if (func->ret_type == type_void) {
             CodeError_print(
                 (CodeError){
                     .err = ADD_ERR(err, ERR_RETURN_TYPE_NON_VOID),
@@ -351,7 +875,7 @@ static ErrorType _Semantic_Return(Tree tree,
                     .column = tree->column,
                 },
                 "void function '%s' should not return a value",
-                func->identifier);
+                Intern_str(func->identifier));
         }
     }
 
@@ -366,7 +890,7 @@ static ErrorType _Semantic_Assignation(Tree tree,
     const Symbol* lvalue = ST_resolve_from_node(prog, func, FIRSTCHILD(tree));
 
     if (FIRSTCHILD(tree)->label == ArrayLR) {
-        err |= _Semantic_ArrayLR(FIRSTCHILD(tree), func, prog).err;
+        err |= _Semantic_Expr(FIRSTCHILD(tree), func, prog).err;
     } else if (lvalue->symbol_type != SYMBOL_VALUE) {
         CodeError_print(
             (CodeError){
@@ -375,24 +899,27 @@ static ErrorType _Semantic_Assignation(Tree tree,
                 .column = FIRSTCHILD(tree)->column - 1,
             },
             "'%s' is not an lvalue",
-            lvalue->identifier);
+            Intern_str(lvalue->identifier));
         return err;
     }
 
+    FIRSTCHILD(tree)->expr_type = lvalue->type;
+    FIRSTCHILD(tree)->expr_flags = EXPR_LVALUE;
+
     ExprReturn ret = _Semantic_Expr(SECONDCHILD(tree), func, prog);
     err |= ret.err;
 
     if (lvalue->type == type_byte && ret.type == type_num) {
-        CodeError_print(
-            (CodeError){
-                .err = ADD_ERR(err, WARN_IMPLICIT_INT_TO_CHAR),
-                .line = tree->lineno,
+        err |= _Semantic_cast(
+            DEFERRED,
+            _Semantic_deferred_index(SECONDCHILD(tree), func, prog),
+            (CastSite){
+                .kind = CAST_ASSIGNATION,
+                .lineno = tree->lineno,
                 .column = tree->column,
-            },
-            "assignation type mismatch in function '%s' to variable '%s' "
-            "(cast from 'int' to 'char')",
-            func->identifier,
-            lvalue->identifier);
+                .function = func->identifier,
+                .variable = lvalue->identifier,
+            });
     } else if (ret.type == type_void) {
         CodeError_print(
             (CodeError){
@@ -402,8 +929,8 @@ static ErrorType _Semantic_Assignation(Tree tree,
             },
             "assigning to variable '%s' "
             "from incompatible type 'void' in function '%s'",
-            lvalue->identifier,
-            func->identifier);
+            Intern_str(lvalue->identifier),
+            Intern_str(func->identifier));
     }
 
     return err;
@@ -452,7 +979,7 @@ static ErrorType _Semantic_SuiteInstr(Tree tree,
 
     Node* child = tree->label == SuiteInstr ? FIRSTCHILD(tree) : tree;
 
-    for (; child != NULL; child = child->nextSibling) {
+    for (; child != NULL; child = NEXTSIBLING(child)) {
         switch (child->label) {
             case Return:
                 has_return = true;
@@ -462,7 +989,7 @@ static ErrorType _Semantic_SuiteInstr(Tree tree,
                 err |= _Semantic_Assignation(child, func, prog);
                 break;
             case Ident:
-                err |= _Semantic_FunctionCall(child, func, prog);
+                err |= _Semantic_CallInstr(child, func, prog);
                 break;
             case SuiteInstr:
                 err |= _Semantic_SuiteInstr(child, func, prog, 0);
@@ -491,7 +1018,7 @@ static ErrorType _Semantic_SuiteInstr(Tree tree,
                 .column = 0,
             },
             "missing return statement in function '%s' returning non-void",
-            func->identifier);
+            Intern_str(func->identifier));
     }
 
     return err;
@@ -503,9 +1030,9 @@ static ErrorType _Semantic_DeclFonct(Tree tree,
     FunctionST* func = FunctionST_get_from_name(
         prog,
         // DeclFonct->EnTeteFonct->Ident
-        FIRSTCHILD(tree)->firstChild->nextSibling->att.ident);
+        NEXTSIBLING(FIRSTCHILD(FIRSTCHILD(tree)))->att.ident);
     ErrorType err = ERR_NONE;
-    err |= _Semantic_SuiteInstr(SECONDCHILD(tree)->firstChild->nextSibling,
+    err |= _Semantic_SuiteInstr(NEXTSIBLING(FIRSTCHILD(SECONDCHILD(tree))),
                                 func, prog, true);
     return err;
 }
@@ -516,9 +1043,9 @@ static ErrorType _Semantic_DeclFoncts(Tree tree,
     ErrorType err = ERR_NONE;
 
     // On parcourt les noeux DeclFonct
-    for (Node* child = tree->firstChild;
+    for (Node* child = FIRSTCHILD(tree);
          child != NULL;
-         child = child->nextSibling) {
+         child = NEXTSIBLING(child)) {
         err |= _Semantic_DeclFonct(child, prog);
     }
 
@@ -529,7 +1056,9 @@ ErrorType static Semantic_check_main(const ProgramST* prog) {
     ErrorType err = ERR_NONE;
     FunctionST* fst_main;
 
-    if ((fst_main = FunctionST_get_from_name(prog, "main")) == NULL) {
+    Atom main_ident = Intern_cstr("main");
+
+    if ((fst_main = FunctionST_get_from_name(prog, main_ident)) == NULL) {
         CodeError_print(
             (CodeError){
                 .err = ADD_ERR(err, ERR_MAIN_UNAVAILABLE),
@@ -538,7 +1067,7 @@ ErrorType static Semantic_check_main(const ProgramST* prog) {
             },
             "undefined reference to 'main'");
     } else {
-        const Symbol* sym_main = ST_get(&prog->globals, "main");
+        const Symbol* sym_main = ST_get(&prog->globals, main_ident);
         if (fst_main->ret_type != type_num) {
             CodeError_print(
                 (CodeError){
@@ -568,5 +1097,148 @@ ErrorType Semantic_check(Tree tree, const ProgramST* prog) {
     err |= _Semantic_DeclFoncts(SECONDCHILD(tree), prog);
     err |= Semantic_check_main(prog);
 
+    return err;
+}
+
+ErrorType Semantic_check_DeclFonct(Tree tree,
+                                   const ProgramST* prog,
+                                   DeferredCalls* deferred) {
+    DEFERRED = deferred;
+    ErrorType err = _Semantic_DeclFonct(tree, prog);
+    DEFERRED = NULL;
+
+    return err;
+}
+
+/**
+ * @brief Check a deferred call against the function's definition,
+ * with the same diagnostics as a call to a known function
+ *
+ * @param call
+ * @param args Arguments of the call
+ * @param func Called function
+ * @param deferred
+ * @return ErrorType
+ */
+static ErrorType _Semantic_check_deferred_call(DeferredCall* call,
+                                               const CallArg* args,
+                                               const FunctionST* func,
+                                               DeferredCalls* deferred) {
+    ErrorType err = ERR_NONE;
+    int nb_params = FunctionST_get_param_count(func);
+
+    call->ret_type = func->ret_type;
+    if (call->used_as_value && func->ret_type == type_void) {
+        CodeError_print(
+            (CodeError){
+                .err = ADD_ERR(err, ERR_NOT_AN_RVALUE),
+                .line = call->lineno,
+                .column = call->column - 1,
+            },
+            "'%s' is not an rvalue",
+            Intern_str(call->identifier));
+        return err;
+    }
+
+    CodeError_print(
+        (CodeError){
+            .err = ADD_ERR(err, WARN_USE_UNDEFINED_FUNCTION),
+            .column = call->column,
+            .line = call->lineno,
+        },
+        "implicit declaration of function '%s'",
+        Intern_str(call->identifier));
+
+    for (int i = 0; i < call->nb_args; ++i) {
+        if (i >= nb_params) {
+            CodeError_print(
+                (CodeError){
+                    .err = ADD_ERR(err, ERR_INVALID_PARAM_COUNT),
+                    .line = args[i].lineno,
+                    .column = call->column,
+                },
+                "too many arguments to function call '%s', expected %d",
+                Intern_str(call->identifier),
+                nb_params);
+            break;
+        }
+        err |= _Semantic_check_arg(FunctionST_get_param(func, i), args[i],
+                                   call->column, deferred);
+    }
+
+    if (call->nb_args < nb_params) {
+        CodeError_print(
+            (CodeError){
+                .err = ADD_ERR(err, ERR_INVALID_PARAM_COUNT),
+                .line = call->lineno,
+                .column = call->column,
+            },
+            "too few arguments to function call '%s', expected %d, have %d",
+            Intern_str(call->identifier),
+            nb_params,
+            call->nb_args);
+    }
+
+    if (call->cast.kind != CAST_NONE && call->ret_type == type_num) {
+        err |= _Semantic_warn_cast(call->cast);
+    }
+
+    return err;
+}
+
+ErrorType Semantic_check_deferred(const FunctionST* func,
+                                  DeferredCalls* deferred) {
+    ErrorType err = ERR_NONE;
+
+    if (AtomMap_get(&deferred->pending, func->identifier) <= 0) {
+        return err;
+    }
+
+    ARRAYLIST_DECLARE_ARRAY(deferred->calls, DeferredCall, calls);
+    ARRAYLIST_DECLARE_ARRAY(deferred->args, CallArg, args);
+    for (size_t i = 0; i < ArrayList_get_length(&deferred->calls); ++i) {
+        if (calls[i].resolved || calls[i].identifier != func->identifier) {
+            continue;
+        }
+        err |= _Semantic_check_deferred_call(
+            &calls[i], args + calls[i].first_arg, func, deferred);
+        calls[i].resolved = true;
+        deferred->nb_pending--;
+    }
+    AtomMap_put(&deferred->pending, func->identifier, 0);
+
+    if (deferred->nb_pending == 0) {
+        // Every deferred call is checked, release them
+        DeferredCalls_free(deferred);
+        DeferredCalls_init(deferred);
+    }
+
+    return err;
+}
+
+ErrorType Semantic_check_end(const ProgramST* prog,
+                             DeferredCalls* deferred) {
+    ErrorType err = ERR_NONE;
+
+    ARRAYLIST_DECLARE_ARRAY(deferred->calls, DeferredCall, calls);
+    for (size_t i = 0; i < ArrayList_get_length(&deferred->calls); ++i) {
+        if (calls[i].resolved) {
+            continue;
+        }
+        CodeError_print(
+            (CodeError){
+                .err = ADD_ERR(err, ERR_UNDECLARED_SYMBOL),
+                .line = calls[i].lineno,
+                .column = calls[i].column,
+            },
+            "use of undeclared identifier '%s'",
+            Intern_str(calls[i].identifier));
+    }
+    // Like an undeclared identifier in a whole program check,
+    // which stops the compilation before main is checked
+    if (!err) {
+        err |= Semantic_check_main(prog);
+    }
+
     return err;
 }
\ No newline at end of file
@@ -1,3 +1,10 @@
+#ifndef SEMANTIC_H
+#define SEMANTIC_H
+
+#include <stdbool.h>
+
+#include "arraylist.h"
+#include "atommap.h"
 #include "error.h"
 #include "symbolTable.h"
 #include "tree.h"
@@ -7,6 +14,63 @@ typedef struct ExprReturn {
     type_t type;  // Type of the expression (int / char)
 } ExprReturn;
 
+/**
+ * @brief Argument of a function call, as seen by the caller
+ */
+typedef struct CallArg {
+    SymbolType symbol_type;  // SYMBOL_ARRAY for an array name, else value
+    type_t type;
+    int lineno;
+    int column;
+    int deferred_call;  // 1 + index in DeferredCalls.calls of the deferred
+                        // call giving the value, 0 if none
+} CallArg;
+
+/**
+ * @brief Place of an implicit cast from int to char
+ * (WARN_IMPLICIT_INT_TO_CHAR)
+ */
+typedef enum CastKind {
+    CAST_NONE,
+    CAST_ASSIGNATION,
+    CAST_RETURN,
+    CAST_ARG,
+} CastKind;
+
+typedef struct CastSite {
+    CastKind kind;
+    int lineno;
+    int column;
+    Atom function;  // CAST_ASSIGNATION, CAST_RETURN : function checked
+    Atom variable;  // CAST_ASSIGNATION : variable assigned
+} CastSite;
+
+/**
+ * @brief Call to a function not defined yet (streaming mode),
+ * checked once the function is defined
+ */
+typedef struct DeferredCall {
+    Atom identifier;
+    int lineno;
+    int column;
+    bool used_as_value;  // The return value is used in an expression
+    bool resolved;
+    int first_arg;  // Position of the arguments in DeferredCalls.args
+    int nb_args;
+    CastSite cast;    // Cast of the value to char, checked once resolved
+    type_t ret_type;  // Of the function, once resolved
+} DeferredCall;
+
+typedef struct DeferredCalls {
+    ArrayList calls;  // [DeferredCall] in source order
+    ArrayList args;   // [CallArg]
+    AtomMap pending;  // function name -> number of unresolved calls
+    int nb_pending;
+} DeferredCalls;
+
+void DeferredCalls_init(DeferredCalls* self);
+void DeferredCalls_free(DeferredCalls* self);
+
 /**
  * @brief Check semantic vailidity before producing assembler
  *
@@ -14,4 +78,44 @@ typedef struct ExprReturn {
  * @param prog filled ProgramST
  * @return ErrorType
  */
-ErrorType Semantic_check(Tree tree, const ProgramST* prog);
\ No newline at end of file
+ErrorType Semantic_check(Tree tree, const ProgramST* prog);
+
+/**
+ * @brief Check a single function (streaming mode). A call to a function
+ * which is not defined yet assumes the function returns an int
+ * (like a C implicit declaration), and is deferred until the function
+ * is defined, where it raises WARN_USE_UNDEFINED_FUNCTION, and
+ * WARN_IMPLICIT_INT_TO_CHAR if its value is cast to a char while the
+ * function returns an int.
+ *
+ * @param tree DeclFonct node, bound by ProgramST_bind_DeclFonct
+ * @param prog ProgramST holding the functions defined so far
+ * @param deferred Deferred calls
+ * @return ErrorType
+ */
+ErrorType Semantic_check_DeclFonct(Tree tree,
+                                   const ProgramST* prog,
+                                   DeferredCalls* deferred);
+
+/**
+ * @brief Check the deferred calls to a function which was just defined
+ *
+ * @param func
+ * @param deferred
+ * @return ErrorType
+ */
+ErrorType Semantic_check_deferred(const FunctionST* func,
+                                  DeferredCalls* deferred);
+
+/**
+ * @brief End of the streamed program : report the calls to functions
+ * that were never defined, or else check the main function
+ *
+ * @param prog
+ * @param deferred
+ * @return ErrorType
+ */
+ErrorType Semantic_check_end(const ProgramST* prog,
+                             DeferredCalls* deferred);
+
+#endif
@@ -0,0 +1,148 @@
+#include "source.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SOURCE_READ_CHUNK (64 * 1024)
+
+/**
+ * @brief Map a regular file, followed by SOURCE_PADDING NUL bytes.
+ * An anonymous (zeroed) mapping is reserved first, then the file is
+ * mapped over its beginning, so the padding exists even when the file
+ * size is a multiple of the page size.
+ *
+ * @param self
+ * @param fd File descriptor of a regular file
+ * @param len Size of the file
+ * @return ErrorType ERR_NO_MEMORY if the mapping fails
+ */
+static ErrorType _Source_map(Source* self, int fd, size_t len) {
+    size_t size = len + SOURCE_PADDING;
+    char* text = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if (text == MAP_FAILED) {
+        return ERR_NO_MEMORY;
+    }
+
+    if (len && mmap(text, len, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(text, size);
+        return ERR_NO_MEMORY;
+    }
+
+    *self = (Source){.text = text, .len = len, .mapped = size};
+
+    return ERR_NONE;
+}
+
+/**
+ * @brief Read a stream until its end, for inputs that cannot be mapped
+ *
+ * @param self
+ * @param f
+ * @return ErrorType
+ */
+static ErrorType _Source_read(Source* self, FILE* f) {
+    size_t len = 0, capacity = SOURCE_READ_CHUNK;
+    char* text = malloc(capacity);
+    size_t nb_read;
+
+    if (!text) {
+        return ERR_NO_MEMORY;
+    }
+
+    while ((nb_read = fread(text + len, 1,
+                            capacity - len - SOURCE_PADDING, f)) > 0) {
+        len += nb_read;
+        if (capacity - len == SOURCE_PADDING) {
+            char* bigger = realloc(text, capacity * 2);
+            if (!bigger) {
+                free(text);
+                return ERR_NO_MEMORY;
+            }
+            text = bigger;
+            capacity *= 2;
+        }
+    }
+
+    if (ferror(f)) {
+        free(text);
+        return ERR_FILE_OPEN;
+    }
+
+    memset(text + len, '\0', SOURCE_PADDING);
+    *self = (Source){.text = text, .len = len, .mapped = 0};
+
+    return ERR_NONE;
+}
+
+ErrorType Source_load(Source* self, FILE* f) {
+    struct stat st;
+    ErrorType err;
+    uint32_t first_line = 0;
+
+    if (fstat(fileno(f), &st) == 0 && S_ISREG(st.st_mode) &&
+        _Source_map(self, fileno(f), st.st_size) == ERR_NONE) {
+        err = ERR_NONE;
+    } else {
+        err = _Source_read(self, f);
+    }
+
+    if (err != ERR_NONE) {
+        return err;
+    }
+
+    if (self->len > UINT32_MAX) {
+        Source_free(self);
+        return ERR_FILE_OPEN;
+    }
+
+    if (ArrayList_init(&self->lines, sizeof(uint32_t), 256, NULL) < 0 ||
+        ArrayList_append(&self->lines, &first_line) < 0) {
+        Source_free(self);
+        return ERR_NO_MEMORY;
+    }
+
+    return ERR_NONE;
+}
+
+void Source_new_line(Source* self, uint32_t offset) {
+    // A line without index only loses its display in diagnostics
+    ArrayList_append(&self->lines, &offset);
+}
+
+const char* Source_get_line(const Source* self, int line, size_t* len) {
+    if (line < 1 || (size_t)line > ArrayList_get_length(&self->lines)) {
+        return NULL;
+    }
+
+    ARRAYLIST_DECLARE_ARRAY(self->lines, uint32_t, starts);
+    size_t start = starts[line - 1];
+    size_t end;
+
+    if ((size_t)line < ArrayList_get_length(&self->lines)) {
+        end = starts[line] - 1;  // Line feed
+    } else {
+        // Last line scanned so far, its end may not be indexed yet
+        const char* line_feed = memchr(self->text + start, '\n',
+                                       self->len - start);
+        end = line_feed ? (size_t)(line_feed - self->text) : self->len;
+    }
+
+    *len = end - start;
+
+    return self->text + start;
+}
+
+void Source_free(Source* self) {
+    if (self->mapped) {
+        munmap(self->text, self->mapped);
+    } else {
+        free(self->text);
+    }
+    ArrayList_free(&self->lines);
+    *self = (Source){0};
+}
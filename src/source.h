@@ -0,0 +1,68 @@
+#ifndef SOURCE_H
+#define SOURCE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arraylist.h"
+#include "error.h"
+
+// flex's yy_scan_buffer requires the buffer to end with two NUL bytes
+#define SOURCE_PADDING 2
+
+/**
+ * @brief Source code kept in memory for the whole compilation.
+ * Regular files are memory-mapped (private, writable mapping, as the
+ * scanner temporarily writes NUL bytes after the current token),
+ * other inputs (pipes, terminals) are read once.
+ */
+typedef struct Source {
+    char* text;     // len bytes of source code, then SOURCE_PADDING NUL bytes
+    size_t len;
+    size_t mapped;  // Size of the mapping, 0 if text was allocated by malloc
+    ArrayList lines;  // [uint32_t] Offset of the first character of each
+                      // line, filled by the scanner
+} Source;
+
+/**
+ * @brief Load the whole content of a file
+ *
+ * @param self Source to initialize
+ * @param f Opened file, read from its beginning
+ * @return ErrorType
+ * - ERR_NO_MEMORY if the buffer cannot be allocated
+ * - ERR_FILE_OPEN if the file cannot be read, or is too large for
+ *   32 bits offsets (4 GiB)
+ * - ERR_NONE else
+ */
+ErrorType Source_load(Source* self, FILE* f);
+
+/**
+ * @brief Record the beginning of a new line (called by the scanner
+ * on each line feed, in order)
+ *
+ * @param self
+ * @param offset Offset of the first character of the line
+ */
+void Source_new_line(Source* self, uint32_t offset);
+
+/**
+ * @brief Get a line of the source code, as indexed by the scanner
+ *
+ * @param self
+ * @param line Line number (starting at 1)
+ * @param len Length of the line, without its line feed
+ * @return const char* First character of the line (not NUL-terminated),
+ * NULL if the line has not been scanned
+ */
+const char* Source_get_line(const Source* self, int line, size_t* len);
+
+/**
+ * @brief Unmap or free the source code
+ *
+ * @param self
+ */
+void Source_free(Source* self);
+
+#endif
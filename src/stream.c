@@ -0,0 +1,92 @@
+#include "stream.h"
+
+#include <stdbool.h>
+
+#include "semantic.h"
+#include "tpc_bison.h"
+#include "treeReader.h"
+
+typedef struct Stream {
+    ProgramST* symtable;
+    Emitter* nasm;  // NULL if the program is only checked
+    DeferredCalls deferred;
+    ErrorType err;
+    bool tables_only; /*<
+        Set after an error in the symbol tables : the symbol tables
+        of the following functions are built, but not checked */
+} Stream;
+
+static bool _Stream_has_errors(const Stream* self) {
+    return IS_SEMANTIC(self->err) || IS_CRITICAL(self->err);
+}
+
+static void _Stream_globals(Stream* self, Tree tree) {
+    self->err |= ProgramST_add_globals(self->symtable, tree);
+    CodeError_flush();
+
+    if (_Stream_has_errors(self)) {
+        self->tables_only = true;
+    } else if (self->nasm) {
+        TreeReader_Header(self->symtable, self->nasm);
+    }
+}
+
+static void _Stream_DeclFonct(Stream* self, Tree tree) {
+    FunctionST* func;
+    ErrorType err = ProgramST_add_DeclFonct(self->symtable, tree, &func);
+    self->err |= err;
+
+    if (IS_SEMANTIC(err) || IS_CRITICAL(err)) {
+        self->tables_only = true;
+    }
+    if (!self->tables_only) {
+        ProgramST_bind_DeclFonct(self->symtable, tree);
+        self->err |= Semantic_check_deferred(func, &self->deferred);
+        self->err |= Semantic_check_DeclFonct(tree, self->symtable,
+                                              &self->deferred);
+    }
+    CodeError_flush();
+
+    if (self->nasm && !_Stream_has_errors(self)) {
+        TreeReader_DeclFonct(self->symtable, tree, self->nasm);
+    }
+    FunctionST_free_locals(func);
+}
+
+/**
+ * @brief ParserHandler of the streaming compilation
+ *
+ * @param tree DeclVars of the globals, or DeclFonct
+ * @param data Stream
+ */
+static void _Stream_on_tree(Node* tree, void* data) {
+    Stream* self = data;
+
+    if (tree->label == DeclVars) {
+        _Stream_globals(self, tree);
+    } else {
+        _Stream_DeclFonct(self, tree);
+    }
+}
+
+ErrorType Stream_compile(Source* source, ProgramST* symtable, Emitter* nasm) {
+    Stream stream = {
+        .symtable = symtable,
+        .nasm = nasm,
+    };
+    ProgramST_init(symtable);
+    DeferredCalls_init(&stream.deferred);
+
+    ErrorType err = parser_bison_stream(source, _Stream_on_tree, &stream);
+
+    if (!IS_PARSE_ERROR(err) && !stream.tables_only) {
+        stream.err |= Semantic_check_end(symtable, &stream.deferred);
+        CodeError_flush();
+    }
+    if (nasm && !IS_PARSE_ERROR(err) && !_Stream_has_errors(&stream)) {
+        TreeReader_Builtins(nasm);
+    }
+
+    DeferredCalls_free(&stream.deferred);
+    return err | stream.err;
+}
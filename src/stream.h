@@ -0,0 +1,31 @@
+/**
+ * @file stream.h
+ * @brief Streaming compilation : each function is checked and compiled
+ * as soon as it is parsed, and then released
+ *
+ */
+
+#ifndef STREAM_H
+#define STREAM_H
+
+#include "emitter.h"
+#include "error.h"
+#include "source.h"
+#include "symbolTable.h"
+
+/**
+ * @brief Compile a program one function at a time. Memory does not grow
+ * with the size of the function bodies : only the global variables
+ * and the functions signatures are kept until the end.
+ * Compilation stops at the first error in the symbol tables,
+ * and no code is written after a semantic error.
+ *
+ * @param source Loaded source code
+ * @param symtable Filled with the global variables and the functions
+ * parameters (local variables are released after each function)
+ * @param nasm Output emitter, NULL to only check the program
+ * @return ErrorType Errors of every phase
+ */
+ErrorType Stream_compile(Source* source, ProgramST* symtable, Emitter* nasm);
+
+#endif
@@ -4,7 +4,13 @@
 #include <string.h>
 
 int Symbol_cmp(const void* a, const void* b) {
-    return strcmp(((Symbol*)a)->identifier, ((Symbol*)b)->identifier);
+    Atom atom_a = ((Symbol*)a)->identifier, atom_b = ((Symbol*)b)->identifier;
+    return (atom_a > atom_b) - (atom_a < atom_b);
+}
+
+int Symbol_cmp_name(const void* a, const void* b) {
+    return strcmp(Intern_str((*(Symbol**)a)->identifier),
+                  Intern_str((*(Symbol**)b)->identifier));
 }
 
 const char* Symbol_get_type_str(type_t type) {
@@ -33,55 +39,60 @@ static const char* _Symbol_get_location_str(const Symbol* self) {
     return addr_str;
 }
 
-static void _Symbol_print_Function(const Symbol* self) {
-    printf(
+static void _Symbol_print_Function(const Symbol* self, Emitter* out) {
+    Emitter_printf(
+        out,
         "%-15s : symbol_type=%-16s type=%-5s index=%-2d\n",
-        self->identifier,
+        Intern_str(self->identifier),
         SymbolType_to_str(self->symbol_type),
         Symbol_get_type_str(self->type),
         self->index);
 }
 
-static void _Symbol_print_Array(const Symbol* self) {
-    printf(
+static void _Symbol_print_Array(const Symbol* self, Emitter* out) {
+    Emitter_printf(
+        out,
         "%-15s : symbol_type=%-16s type=%-5s length=%d "
         "total_size=%d index=%-2d have_length=%s",
-        self->identifier,
+        Intern_str(self->identifier),
         SymbolType_to_str(self->symbol_type),
         Symbol_get_type_str(self->type),
         self->array.length,
         self->total_size,
         self->index,
         self->array.have_length ? "true" : "false");
-    printf(
+    Emitter_printf(
+        out,
         " addr=%s",
         _Symbol_get_location_str(self));
     if (self->array.have_length) {
-        printf(" length=%d", self->array.length);
+        Emitter_printf(out, " length=%d", self->array.length);
     }
-    putchar('\n');
+    Emitter_write(out, "\n", 1);
 }
 
-static void _Symbol_print_Value(const Symbol* self) {
-    printf(
+static void _Symbol_print_Value(const Symbol* self, Emitter* out) {
+    Emitter_printf(
+        out,
         "%-15s : symbol_type=%-16s type=%-5s total_size=%d index=%-2d",
-        self->identifier,
+        Intern_str(self->identifier),
         SymbolType_to_str(self->symbol_type),
         Symbol_get_type_str(self->type),
         self->total_size,
         self->index);
-    printf(
+    Emitter_printf(
+        out,
         "addr=%s",
         _Symbol_get_location_str(self));
-    putchar('\n');
+    Emitter_write(out, "\n", 1);
 }
 
-void Symbol_print(const Symbol* self) {
-    const void (*printers[])(const Symbol*) = {
+void Symbol_print(const Symbol* self, Emitter* out) {
+    void (*const printers[])(const Symbol*, Emitter*) = {
         [SYMBOL_VALUE] = _Symbol_print_Value,
         [SYMBOL_ARRAY] = _Symbol_print_Array,
         [SYMBOL_FUNCTION] = _Symbol_print_Function,
     };
 
-    printers[self->symbol_type](self);
+    printers[self->symbol_type](self, out);
 }
@@ -4,6 +4,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "emitter.h"
+#include "intern.h"
 #include "registers.h"
 #include "tree.h"
 
@@ -14,7 +16,7 @@ typedef enum SymbolType {
 } SymbolType;
 
 typedef struct Symbol {
-    const char* identifier;
+    Atom identifier;
     type_t type;
     int type_size;
     int lineno;
@@ -30,6 +32,8 @@ typedef struct Symbol {
 
     int total_size;  // Total size of the object variable or array
 
+    int function_id;  // Position of the FunctionST in ProgramST.functions
+
     bool is_default_function;
     bool is_static;  // Static variables are stored in the bss section
     bool is_param;   // is a parameter of a function
@@ -40,7 +44,8 @@ typedef struct Symbol {
 } Symbol;
 
 /**
- * @brief Compare two symbols by their identifier
+ * @brief Compare two symbols by the atom of their identifier
+ * (integer comparison, not the alphabetical order)
  *
  * @param a First symbol
  * @param b Second symbol
@@ -51,12 +56,23 @@ typedef struct Symbol {
  */
 int Symbol_cmp(const void* a, const void* b);
 
+/**
+ * @brief Compare two pointers to symbols by the alphabetical order
+ * of their identifier (slower than Symbol_cmp, used for printing)
+ *
+ * @param a Address of a Symbol*
+ * @param b Address of a Symbol*
+ * @return int
+ */
+int Symbol_cmp_name(const void* a, const void* b);
+
 /**
  * @brief Print a symbol
  *
  * @param symbol
+ * @param out
  */
-void Symbol_print(const Symbol* symbol);
+void Symbol_print(const Symbol* symbol, Emitter* out);
 
 /**
  * @brief Convert a symbol type to a string
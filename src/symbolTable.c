@@ -3,7 +3,7 @@
 #include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
-#include <string.h>
+#include <stdlib.h>
 
 #include "error.h"
 #include "symbol.h"
@@ -13,20 +13,35 @@
 #define RESET "\x1b[0m"
 
 /**
- * @brief Initialize a symbol table
+ * @brief Initialize an empty symbol table.
+ * Nothing is allocated until the first symbol is added,
+ * most functions have few (or no) parameters and locals.
  *
  * @param self SymbolTable object
- * @return ArrayListError
+ * @param type
  */
-static ArrayListError _ST_init(SymbolTable* self) {
+static void _ST_init(SymbolTable* self, STType type) {
     *self = (SymbolTable){
+        .type = type,
         ._next_addr_param = 16,
     };
-    return ArrayList_init(&self->symbols, sizeof(Symbol), 30, Symbol_cmp);
+    AtomMap_init(&self->index);
+    ArrayList_init(&self->symbols, sizeof(Symbol), 0, NULL);
+}
+
+/**
+ * @brief Release the unused capacity of a table, once all its symbols
+ * are known. Must be called before taking pointers to its symbols.
+ *
+ * @param self
+ */
+static void _ST_shrink(SymbolTable* self) {
+    ArrayList_shrink_to_fit(&self->symbols);
 }
 
 static void _ST_free(SymbolTable* self) {
     ArrayList_free(&self->symbols);
+    AtomMap_free(&self->index);
     *self = (SymbolTable){0};
 }
 
@@ -43,6 +58,7 @@ void ProgramST_free(ProgramST* self) {
         _FunctionST_free(function);
     }
     ArrayList_free(&self->functions);
+    AtomMap_free(&self->function_index);
     *self = (ProgramST){0};
 }
 
@@ -50,21 +66,18 @@ void ProgramST_free(ProgramST* self) {
  * @brief Initialize a FunctionST object
  *
  * @param self FunctionST object
- * @param identifier Function name, should be pre-allocated
+ * @param identifier Function name
  */
 static void _FunctionST_init(FunctionST* self,
-                             const char* identifier,
+                             Atom identifier,
                              type_t ret_type) {
     *self = (FunctionST){
         .identifier = identifier,
         .ret_type = ret_type,
     };
 
-    _ST_init(&self->parameters);
-    self->parameters.type = SYMBOL_TABLE_PARAM;
-
-    _ST_init(&self->locals);
-    self->locals.type = SYMBOL_TABLE_LOCAL;
+    _ST_init(&self->parameters, SYMBOL_TABLE_PARAM);
+    _ST_init(&self->locals, SYMBOL_TABLE_LOCAL);
 }
 
 /**
@@ -76,7 +89,7 @@ static void _FunctionST_init(FunctionST* self,
  * if the symbol is already in the table
  */
 ErrorType _ST_add(SymbolTable* self, Symbol symbol) {
-    if (ArrayList_contains(&self->symbols, &symbol)) {
+    if (ST_get(self, symbol.identifier)) {
         CodeError_print(
             (CodeError){
                 .err = ERR_SEM_REDECLARED_SYMBOL,
@@ -88,7 +101,7 @@ ErrorType _ST_add(SymbolTable* self, Symbol symbol) {
             : symbol.symbol_type == SYMBOL_FUNCTION
                 ? "redefinition of function '%s'"
                 : "redeclaration of '%s'",
-            symbol.identifier);
+            Intern_str(symbol.identifier));
         return ERR_SEM_REDECLARED_SYMBOL;
     }
 
@@ -119,24 +132,47 @@ ErrorType _ST_add(SymbolTable* self, Symbol symbol) {
     }
 
     symbol.index = ArrayList_get_length(&self->symbols);
-    ArrayList_sorted_insert(&self->symbols, &symbol);
+    if (ArrayList_append(&self->symbols, &symbol) < 0) {
+        return ERR_NO_MEMORY;
+    }
+
+    if (symbol.index == ST_INDEX_THRESHOLD) {
+        // The table becomes large : index every symbol
+        for (int i = 0; i <= symbol.index; ++i) {
+            const Symbol* indexed = ArrayList_get(&self->symbols, i);
+            if (AtomMap_put(&self->index, indexed->identifier, i) < 0) {
+                return ERR_NO_MEMORY;
+            }
+        }
+    } else if (symbol.index > ST_INDEX_THRESHOLD &&
+               AtomMap_put(&self->index, symbol.identifier, symbol.index) < 0) {
+        return ERR_NO_MEMORY;
+    }
 
     return ERR_NONE;
 }
 
-Symbol* ST_get(const SymbolTable* self, const char* identifier) {
+Symbol* ST_get(const SymbolTable* self, Atom identifier) {
     /* Returns a symbol associated to an identifier */
+    size_t len = ArrayList_get_length(&self->symbols);
 
-    const Symbol symbol = (Symbol){
-        .identifier = identifier,
-    };
+    if (len > ST_INDEX_THRESHOLD) {
+        int i = AtomMap_get(&self->index, identifier);
+        return i < 0 ? NULL : ArrayList_get(&self->symbols, i);
+    }
 
-    return ArrayList_search(&self->symbols, &symbol);
+    ARRAYLIST_DECLARE_ARRAY(self->symbols, Symbol, symbols);
+    for (size_t i = 0; i < len; ++i) {
+        if (symbols[i].identifier == identifier) {
+            return &symbols[i];
+        }
+    }
+    return NULL;
 }
 
 Symbol* ST_resolve(const ProgramST* table,
                    const FunctionST* func,
-                   const char* identifier) {
+                   Atom identifier) {
     Symbol* symbol = NULL;
 
     if ((symbol = ST_get(&func->locals, identifier))) {
@@ -155,20 +191,17 @@ bool FunctionST_is_defined_before_use(const FunctionST* caller,
 }
 
 const Symbol* FunctionST_get_param(const FunctionST* self, int i) {
-    for (int j = 0; j < ArrayList_get_length(&self->parameters.symbols); ++j) {
-        const Symbol* symbol = ArrayList_get(&self->parameters.symbols, j);
-        if (symbol->index == i) {
-            return symbol;
-        }
-    }
-    return NULL;
+    // Parameters are stored in declaration order
+    return ArrayList_get(&self->parameters.symbols, i);
 }
 
 Symbol* ST_resolve_from_node(const ProgramST* table,
                              const FunctionST* func,
                              const Node* node) {
     Symbol* symbol = NULL;
-    if ((symbol = ST_resolve(table, func, node->att.ident))) {
+    if (node->symbol) {
+        return node->symbol;
+    } else if ((symbol = ST_resolve(table, func, node->att.ident))) {
         return symbol;
     } else {
         // Variable not found
@@ -179,7 +212,7 @@ Symbol* ST_resolve_from_node(const ProgramST* table,
                 .column = node->column,
             },
             "use of undeclared identifier '%s'",
-            node->att.ident);
+            Intern_str(node->att.ident));
         exit(EXIT_CODE(ERR_UNDECLARED_SYMBOL));
     }
     return NULL;
@@ -202,22 +235,6 @@ static size_t _get_type_size(type_t type) {
     return sizes[type];
 }
 
-/**
- * @brief Get the corresponding type from a string
- *
- * @param att Attribut object
- * @return type_t Type if found, -1 otherwise
- */
-static type_t _get_type_from_string(const Attribut* att) {
-    if (strcmp(att->key_word, "char") == 0) {
-        return type_byte;
-    } else if (strcmp(att->key_word, "int") == 0) {
-        return type_num;
-    }
-
-    return -1;
-}
-
 /**
  * @brief Create a SymbolTable from a Type or DeclFonctArray
  * Iterate over all its siblings
@@ -234,8 +251,8 @@ static ErrorType _ST_create_from_Type(SymbolTable* self, Tree tree) {
 
     Tree typeNode = tree;
     FOREACH_SIBLING(typeNode) {
-        Tree identNode = typeNode->firstChild;
-        type_t type = _get_type_from_string(&typeNode->att);
+        Tree identNode = FIRSTCHILD(typeNode);
+        type_t type = typeNode->att.prim_type;
 
         /**
          * We need to iterate a second time, for one-line declarations
@@ -258,7 +275,7 @@ static ErrorType _ST_create_from_Type(SymbolTable* self, Tree tree) {
             }
 
             else if (identNode->label == DeclArray) {
-                int length = identNode->firstChild->att.num;
+                int length = FIRSTCHILD(identNode)->att.num;
 
                 if (length == 0) {
                     CodeError_print(
@@ -268,7 +285,7 @@ static ErrorType _ST_create_from_Type(SymbolTable* self, Tree tree) {
                             .column = identNode->column,
                         },
                         "ISO C forbids zero-size array '%s'",
-                        identNode->att.ident);
+                        Intern_str(identNode->att.ident));
                 }
 
                 symbol = (Symbol){
@@ -322,7 +339,7 @@ static ErrorType ST_create_from_DeclVars(SymbolTable* self,
     assert(tree->label == DeclVars);
     self->next_addr = offset;
 
-    Node* node = tree->firstChild;
+    Node* node = FIRSTCHILD(tree);
     // Empty DeclVars
     if (node == NULL) {
         return ERR_NONE;
@@ -347,7 +364,7 @@ static ErrorType _FunctionST_create_from_ListTypVar(FunctionST* func,
     }
     assert(tree->label == ListTypVar);
     // We go to the the first Type/DeclFontArray
-    tree = tree->firstChild;
+    tree = FIRSTCHILD(tree);
 
     return _ST_create_from_Type(&func->parameters, tree);
 }
@@ -373,7 +390,7 @@ static ErrorType _ST_check_redeclared_params_in_locals(FunctionST* func) {
                     .column = local->column,
                 },
                 "redeclaration of '%s' was already declared in parameters list",
-                local->identifier);
+                Intern_str(local->identifier));
         }
     }
 
@@ -402,14 +419,14 @@ static ErrorType _ST_create_from_DeclFonct(ProgramST* prog,
     ErrorType err = ERR_NONE;
 
     // Go to the EnTeteFonct tree
-    Node* header = tree->firstChild;
+    Node* header = FIRSTCHILD(tree);
 
-    bool is_void = header->firstChild->type == type_void;
+    bool is_void = FIRSTCHILD(header)->label == Void;
 
-    Node* identNode = header->firstChild->nextSibling;
+    Node* identNode = NEXTSIBLING(FIRSTCHILD(header));
 
     type_t ret_type = is_void ? type_void
-                              : _get_type_from_string(&header->firstChild->att);
+                              : FIRSTCHILD(header)->att.prim_type;
     _FunctionST_init(func, identNode->att.ident, ret_type);
 
     // * Add the function to the program's global symbol table
@@ -419,6 +436,8 @@ static ErrorType _ST_create_from_DeclFonct(ProgramST* prog,
             // function name
             .identifier = identNode->att.ident,
             .symbol_type = SYMBOL_FUNCTION,
+            // func will be appended to prog->functions
+            .function_id = ArrayList_get_length(&prog->functions),
             // return type
             .is_static = true,
             .type = func->ret_type,
@@ -429,21 +448,40 @@ static ErrorType _ST_create_from_DeclFonct(ProgramST* prog,
         });
 
     // * Add the function's parameters to the function's symbol table, if any
-    Node* listParams = header->firstChild->nextSibling->nextSibling;
+    Node* listParams = NEXTSIBLING(NEXTSIBLING(FIRSTCHILD(header)));
     err |= _FunctionST_create_from_ListTypVar(func, listParams);
 
     // * Add the function's local variables to the function's symbol table
     // Parameters could be stored on the stack
     int offset = func->parameters.next_addr;
     // DeclFonct->EnTeteFonct->Corps->DeclVars
-    Node* listLocals = tree->firstChild->nextSibling->firstChild;
+    Node* listLocals = FIRSTCHILD(NEXTSIBLING(FIRSTCHILD(tree)));
     err |= ST_create_from_DeclVars(&func->locals, offset, listLocals);
 
     err |= _ST_check_redeclared_params_in_locals(func);
 
+    _ST_shrink(&func->parameters);
+    _ST_shrink(&func->locals);
+
     return err;
 }
 
+/**
+ * @brief Append a FunctionST to the program, and index it by name.
+ * In case of redefinition, the name keeps referring to the first definition.
+ *
+ * @param self
+ * @param function
+ */
+static void _ProgramST_append_function(ProgramST* self, FunctionST* function) {
+    int id = ArrayList_get_length(&self->functions);
+
+    ArrayList_append(&self->functions, function);
+    if (AtomMap_get(&self->function_index, function->identifier) < 0) {
+        AtomMap_put(&self->function_index, function->identifier, id);
+    }
+}
+
 /**
  * @brief Starts tree exploration from a DeclFoncts
  * and creates a symbol table for each function
@@ -457,18 +495,32 @@ static ErrorType _ProgramST_from_DeclFoncts(ProgramST* self, Tree tree) {
     assert(tree->label == DeclFoncts);
     ErrorType err = ERR_NONE;
 
-    Node* funcNode = tree->firstChild;
+    Node* funcNode = FIRSTCHILD(tree);
     FOREACH_SIBLING(funcNode) {
-        FunctionST function;
+        FunctionST* function;
+        err |= ProgramST_add_DeclFonct(self, funcNode, &function);
+    }
 
-        err |= _ST_create_from_DeclFonct(self, &function, funcNode);
+    return err;
+}
 
-        ArrayList_append(&self->functions, &function);
-    }
+ErrorType ProgramST_add_DeclFonct(ProgramST* self,
+                                  Tree tree,
+                                  FunctionST** function) {
+    FunctionST new_function;
+
+    ErrorType err = _ST_create_from_DeclFonct(self, &new_function, tree);
+    _ProgramST_append_function(self, &new_function);
+    *function = ArrayList_get(&self->functions, -1);
 
     return err;
 }
 
+void FunctionST_free_locals(FunctionST* self) {
+    _ST_free(&self->locals);
+    self->locals.type = SYMBOL_TABLE_LOCAL;
+}
+
 /**
  * @brief Add an hardcoded function to the progran
  * (putchar, getint, etc...)
@@ -479,7 +531,7 @@ static ErrorType _ProgramST_from_DeclFoncts(ProgramST* self, Tree tree) {
  * @param symbols Array of symbols to add as parameters.
  * Last element should be {0}
  * in order to stop the loop
- * (a NULL identifier is considered as the end of the array)
+ * (an ATOM_NONE identifier is considered as the end of the array)
  * NULL if none (void parameter)
  */
 static void ProgramST_add_default_function(ProgramST* prog,
@@ -491,6 +543,7 @@ static void ProgramST_add_default_function(ProgramST* prog,
         .symbol_type = SYMBOL_FUNCTION,
         .is_static = true,
         .is_default_function = true,
+        .function_id = ArrayList_get_length(&prog->functions),
         .type_size = _get_type_size(ret.type),
         .total_size = 1 * _get_type_size(ret.type),
     };
@@ -501,7 +554,7 @@ static void ProgramST_add_default_function(ProgramST* prog,
 
     // If there are parameters, add them to the function's symbol table
     if (symbols != NULL) {
-        // Loop until we find a NULL identifier (end of the array)
+        // Loop until we find an ATOM_NONE identifier (end of the array)
         for (const Symbol* param = symbols; param->identifier; ++param) {
             _ST_add(
                 &fun.parameters,
@@ -517,7 +570,8 @@ static void ProgramST_add_default_function(ProgramST* prog,
         }
     }
 
-    ArrayList_append(&prog->functions, &fun);
+    _ST_shrink(&fun.parameters);
+    _ProgramST_append_function(prog, &fun);
 }
 
 /**
@@ -533,12 +587,12 @@ static void _ST_add_default_functions(ProgramST* table) {
     ProgramST_add_default_function(
         table,
         (Symbol){
-            .identifier = "putchar",
+            .identifier = Intern_cstr("putchar"),
             .type = type_void,
         },
         (Symbol[]){
             (Symbol){
-                .identifier = "character",
+                .identifier = Intern_cstr("character"),
                 .type = type_byte,
             },
             {0}});
@@ -546,12 +600,12 @@ static void _ST_add_default_functions(ProgramST* table) {
     ProgramST_add_default_function(
         table,
         (Symbol){
-            .identifier = "putint",
+            .identifier = Intern_cstr("putint"),
             .type = type_void,
         },
         (Symbol[]){
             (Symbol){
-                .identifier = "number",
+                .identifier = Intern_cstr("number"),
                 .type = type_num,
             },
             {0}});
@@ -559,7 +613,7 @@ static void _ST_add_default_functions(ProgramST* table) {
     ProgramST_add_default_function(
         table,
         (Symbol){
-            .identifier = "getchar",
+            .identifier = Intern_cstr("getchar"),
             .type = type_byte,
         },
         NULL);
@@ -567,12 +621,24 @@ static void _ST_add_default_functions(ProgramST* table) {
     ProgramST_add_default_function(
         table,
         (Symbol){
-            .identifier = "getint",
+            .identifier = Intern_cstr("getint"),
             .type = type_num,
         },
         NULL);
 }
 
+void ProgramST_init(ProgramST* self) {
+    *self = (ProgramST){0};
+    _ST_init(&self->globals, SYMBOL_TABLE_GLOBAL);
+    ArrayList_init(&self->functions, sizeof(FunctionST), 0, NULL);
+    AtomMap_init(&self->function_index);
+    _ST_add_default_functions(self);
+}
+
+ErrorType ProgramST_add_globals(ProgramST* self, Tree tree) {
+    return ST_create_from_DeclVars(&self->globals, 0, tree);
+}
+
 /**
  * @brief Create a symbol table from a Prog tree
  * - globals field contains:
@@ -591,61 +657,121 @@ static void _ST_add_default_functions(ProgramST* table) {
 ErrorType ProgramST_from_Prog(ProgramST* self, Tree tree) {
     ErrorType err = ERR_NONE;
 
-    *self = (ProgramST){0};
-    _ST_init(&self->globals);
-    self->globals.type = SYMBOL_TABLE_GLOBAL;
-    ArrayList_init(&self->functions, sizeof(FunctionST), 10, NULL);
-    _ST_add_default_functions(self);
+    ProgramST_init(self);
 
-    // tree->firstChild is the a DeclVars tree of globals variables
-    err |= ST_create_from_DeclVars(&self->globals, 0, tree->firstChild);
+    // FIRSTCHILD(tree) is the a DeclVars tree of globals variables
+    err |= ProgramST_add_globals(self, FIRSTCHILD(tree));
 
-    // tree->firstChild->nextSibling is the first function to process
-    err |= _ProgramST_from_DeclFoncts(self, tree->firstChild->nextSibling);
+    // NEXTSIBLING(FIRSTCHILD(tree)) is the first function to process
+    err |= _ProgramST_from_DeclFoncts(self, NEXTSIBLING(FIRSTCHILD(tree)));
+
+    _ST_shrink(&self->globals);
+    ArrayList_shrink_to_fit(&self->functions);
 
     return err;
 }
 
-FunctionST* FunctionST_get_from_name(const ProgramST* self,
-                                     const char* func_name) {
-    for (int i = 0; i < ArrayList_get_length(&self->functions); ++i) {
-        FunctionST* function = ArrayList_get(&self->functions, i);
-        if (!strcmp(function->identifier, func_name)) {
-            return function;
+FunctionST* FunctionST_get_from_name(const ProgramST* self, Atom func_name) {
+    int i = AtomMap_get(&self->function_index, func_name);
+
+    return i < 0 ? NULL : ArrayList_get(&self->functions, i);
+}
+
+FunctionST* FunctionST_get_from_symbol(const ProgramST* self,
+                                       const Symbol* symbol) {
+    assert(symbol->symbol_type == SYMBOL_FUNCTION);
+
+    return ArrayList_get(&self->functions, symbol->function_id);
+}
+
+FunctionST* FunctionST_get_from_call(const ProgramST* self, const Node* node) {
+    if (node->symbol && node->symbol->symbol_type == SYMBOL_FUNCTION) {
+        return FunctionST_get_from_symbol(self, node->symbol);
+    }
+    return FunctionST_get_from_name(self, node->att.ident);
+}
+
+// Iterative traversal, expressions can be deeply nested
+void ProgramST_bind_DeclFonct(const ProgramST* self, Tree tree) {
+    assert(tree->label == DeclFonct);
+    const FunctionST* func = FunctionST_get_from_name(
+        self,
+        // DeclFonct->EnTeteFonct->Ident
+        NEXTSIBLING(FIRSTCHILD(FIRSTCHILD(tree)))->att.ident);
+    // DeclFonct->Corps->SuiteInstr
+    Node* body = NEXTSIBLING(FIRSTCHILD(SECONDCHILD(tree)));
+
+    ArrayList stack;  // [Node*]
+    ArrayList_init(&stack, sizeof(Node*), 64, NULL);
+    ArrayList_append(&stack, &body);
+
+    while (ArrayList_get_length(&stack)) {
+        Node* node = ArrayList_pop_v(&stack, Node*);
+
+        for (Node* child = FIRSTCHILD(node); child;
+             child = NEXTSIBLING(child)) {
+            ArrayList_append(&stack, &child);
+        }
+
+        if (node->label != Ident && node->label != ArrayLR) {
+            continue;
         }
+        node->symbol = ST_resolve(self, func, node->att.ident);
+    }
+
+    ArrayList_free(&stack);
+}
+
+void ProgramST_bind(const ProgramST* self, Tree tree) {
+    assert(tree->label == Prog);
+
+    for (Node* func = FIRSTCHILD(SECONDCHILD(tree)); func;
+         func = NEXTSIBLING(func)) {
+        ProgramST_bind_DeclFonct(self, func);
     }
-    return NULL;
 }
 
 int FunctionST_get_param_count(const FunctionST* self) {
     return ArrayList_get_length(&self->parameters.symbols);
 }
 
-void ST_print(const SymbolTable* self) {
-    for (int i = 0; i < ArrayList_get_length(&self->symbols); ++i) {
-        Symbol* symbol = ArrayList_get(&self->symbols, i);
-        Symbol_print(symbol);
+void ST_print(const SymbolTable* self, Emitter* out) {
+    size_t len = ArrayList_get_length(&self->symbols);
+    const Symbol** sorted = malloc(len * sizeof(Symbol*));
+    if (!sorted) {
+        return;
+    }
+
+    for (size_t i = 0; i < len; ++i) {
+        sorted[i] = ArrayList_get(&self->symbols, i);
+    }
+    qsort(sorted, len, sizeof(Symbol*), Symbol_cmp_name);
+
+    for (size_t i = 0; i < len; ++i) {
+        Symbol_print(sorted[i], out);
     }
+    free(sorted);
 }
 
-void FunctionST_print(const FunctionST* self) {
-    printf(
+void FunctionST_print(const FunctionST* self, Emitter* out) {
+    Emitter_printf(
+        out,
         BOLD UNDERLINE "FunctionST of %s(...) -> %s:\n" RESET,
-        self->identifier, Symbol_get_type_str(self->ret_type));
-    printf(BOLD "Parameters:\n" RESET);
-    ST_print(&self->parameters);
-    printf(BOLD "Locals:\n" RESET);
-    ST_print(&self->locals);
-}
-
-void ProgramST_print(const ProgramST* self) {
-    printf(BOLD UNDERLINE "ProgramST:\n" RESET);
-    printf(UNDERLINE "Globals:\n" RESET);
-    ST_print(&self->globals);
-    printf(UNDERLINE "Functions:\n\n" RESET);
+        Intern_str(self->identifier), Symbol_get_type_str(self->ret_type));
+    Emitter_puts(out, BOLD "Parameters:\n" RESET);
+    ST_print(&self->parameters, out);
+    Emitter_puts(out, BOLD "Locals:\n" RESET);
+    ST_print(&self->locals, out);
+}
+
+void ProgramST_print(const ProgramST* self, Emitter* out) {
+    Emitter_puts(out, BOLD UNDERLINE "ProgramST:\n" RESET);
+    Emitter_puts(out, UNDERLINE "Globals:\n" RESET);
+    ST_print(&self->globals, out);
+    Emitter_puts(out, UNDERLINE "Functions:\n\n" RESET);
     for (int i = 0; i < ArrayList_get_length(&self->functions); i++) {
         FunctionST* function = ArrayList_get(&self->functions, i);
-        FunctionST_print(function);
-        putchar('\n');
+        FunctionST_print(function, out);
+        Emitter_write(out, "\n", 1);
     }
 }
@@ -2,6 +2,8 @@
 #define SymbolTable_H
 
 #include "arraylist.h"
+#include "atommap.h"
+#include "emitter.h"
 #include "error.h"
 #include "symbol.h"
 #include "tree.h"
@@ -12,8 +14,14 @@ typedef enum STType {
     SYMBOL_TABLE_PARAM
 } STType;
 
+// Number of symbols above which a table is indexed by an AtomMap
+#define ST_INDEX_THRESHOLD 8
+
 typedef struct SymbolTable {
-    ArrayList symbols;  // [Symbol]
+    ArrayList symbols;  // [Symbol] in insertion order (symbol->index)
+    AtomMap index;      /*<
+        identifier -> position in symbols, only filled when there are
+        more than ST_INDEX_THRESHOLD symbols (linear search else) */
     size_t next_addr;
     STType type;
     int _next_addr_param; /*<
@@ -23,7 +31,7 @@ typedef struct SymbolTable {
 } SymbolTable;
 
 typedef struct FunctionST {
-    const char* identifier;
+    Atom identifier;
     type_t ret_type;
     SymbolTable parameters;
     SymbolTable locals;
@@ -31,7 +39,8 @@ typedef struct FunctionST {
 
 typedef struct ProgramST {
     SymbolTable globals;
-    ArrayList functions;  // [FunctionST]
+    ArrayList functions;  // [FunctionST] in definition order
+    AtomMap function_index;  // function name -> position in functions
 } ProgramST;
 
 /**
@@ -41,7 +50,7 @@ typedef struct ProgramST {
  * @param identifier Identifier of the symbol to get
  * @return Symbol A pointer to the symbol, or NULL if the symbol is not found
  */
-Symbol* ST_get(const SymbolTable* table, const char* identifier);
+Symbol* ST_get(const SymbolTable* table, Atom identifier);
 
 /**
  * @brief Get a symbol from its name, while respecting the scope
@@ -54,7 +63,7 @@ Symbol* ST_get(const SymbolTable* table, const char* identifier);
  */
 Symbol* ST_resolve(const ProgramST* table,
                    const FunctionST* func,
-                   const char* identifier);
+                   Atom identifier);
 
 /**
  * @brief Check if a called function was defined before use
@@ -79,6 +88,7 @@ const Symbol* FunctionST_get_param(const FunctionST* self, int i);
 /**
  * @brief Get a symbol from a node, while respecting the scope
  * (local > param > global)
+ * Returns the symbol cached by ProgramST_bind if the node is bound.
  * If the symbol is not found, prints an error and return NULL
  *
  * @param table ProgramST object
@@ -101,6 +111,78 @@ Symbol* ST_resolve_from_node(const ProgramST* table,
  */
 ErrorType ProgramST_from_Prog(ProgramST* self, Tree tree);
 
+/**
+ * @brief Initialize a program symbol table holding only the builtin
+ * functions, to be filled one declaration at a time
+ * (see ProgramST_add_globals and ProgramST_add_DeclFonct)
+ *
+ * @param self
+ */
+void ProgramST_init(ProgramST* self);
+
+/**
+ * @brief Add the global variables to the program
+ *
+ * @param self
+ * @param tree DeclVars tree of the global declarations
+ * @return ErrorType ERR_SEM_REDECLARED_SYMBOL
+ * if a symbol is already in the table
+ */
+ErrorType ProgramST_add_globals(ProgramST* self, Tree tree);
+
+/**
+ * @brief Add a function, its parameters and local variables
+ * to the program
+ *
+ * @param self
+ * @param tree DeclFonct tree
+ * @param function Set to the added function
+ * (valid until the next function is added)
+ * @return ErrorType ERR_SEM_REDECLARED_SYMBOL
+ * if a symbol is already in the table
+ */
+ErrorType ProgramST_add_DeclFonct(ProgramST* self,
+                                  Tree tree,
+                                  FunctionST** function);
+
+/**
+ * @brief Release the local variables of a function, once its body
+ * is compiled. Its signature is kept for the calls that follow.
+ *
+ * @param self
+ */
+void FunctionST_free_locals(FunctionST* self);
+
+/**
+ * @brief Resolve once every identifier used in the functions bodies,
+ * and cache the Symbol on each Ident/ArrayLR node
+ * (the FunctionST of a called function is found from its Symbol).
+ * Unresolved identifiers are left unbound, and reported by
+ * ST_resolve_from_node when used.
+ *
+ * @param self ProgramST filled by ProgramST_from_Prog
+ * @param tree Prog tree
+ */
+void ProgramST_bind(const ProgramST* self, Tree tree);
+
+/**
+ * @brief Same as ProgramST_bind, for a single function
+ *
+ * @param self
+ * @param tree DeclFonct tree
+ */
+void ProgramST_bind_DeclFonct(const ProgramST* self, Tree tree);
+
+/**
+ * @brief Get the FunctionST called by a function call node,
+ * from its cached binding if any.
+ *
+ * @param self
+ * @param node Ident node of the call
+ * @return FunctionST* NULL if the function is not found
+ */
+FunctionST* FunctionST_get_from_call(const ProgramST* self, const Node* node);
+
 /**
  * @brief Get a FunctionST from the function name. If the function is not found,
  * return NULL
@@ -109,8 +191,17 @@ ErrorType ProgramST_from_Prog(ProgramST* self, Tree tree);
  * @param func_name
  * @return FunctionST*
  */
-FunctionST* FunctionST_get_from_name(const ProgramST* self,
-                                     const char* func_name);
+FunctionST* FunctionST_get_from_name(const ProgramST* self, Atom func_name);
+
+/**
+ * @brief Get the FunctionST of a function symbol (from its function_id)
+ *
+ * @param self
+ * @param symbol Symbol of type SYMBOL_FUNCTION
+ * @return FunctionST*
+ */
+FunctionST* FunctionST_get_from_symbol(const ProgramST* self,
+                                       const Symbol* symbol);
 
 /**
  * @brief Get the number of parameters of a function
@@ -121,25 +212,28 @@ FunctionST* FunctionST_get_from_name(const ProgramST* self,
 int FunctionST_get_param_count(const FunctionST* self);
 
 /**
- * @brief Print the symbol table
+ * @brief Print the symbol table, sorted by identifier
  *
  * @param self SymbolTable object
+ * @param out
  */
-void ST_print(const SymbolTable* self);
+void ST_print(const SymbolTable* self, Emitter* out);
 
 /**
  * @brief Print the function symbol table
  *
  * @param self
+ * @param out
  */
-void FunctionST_print(const FunctionST* self);
+void FunctionST_print(const FunctionST* self, Emitter* out);
 
 /**
  * @brief Print the program symbol table
  *
  * @param self
+ * @param out
  */
-void ProgramST_print(const ProgramST* self);
+void ProgramST_print(const ProgramST* self, Emitter* out);
 
 /**
  * @brief Free the memory allocated by a SymbolTable object
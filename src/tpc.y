@@ -3,37 +3,50 @@
 #include <stdio.h>
 #include "../src/tree.h"
 #include "../src/parser.h"
+#include "../src/scanner.h"
 #include "../src/error.h"
+#include "../src/source.h"
+#include "../src/tpc_bison.h"
 
-void yyerror(Node** abr, char *msg);
-int yylex();
+// The parser stack grows with the nesting of parentheses and unary
+// operators, it is reallocated as needed up to this depth
+#define YYMAXDEPTH 10000000
+
+void yyerror(NodeId* abr, char *msg);
 extern unsigned int nbline;
 extern unsigned int nbchar;
+
+static ParserHandler STREAM_HANDLER = NULL; // Streaming mode if not NULL
+static void* STREAM_DATA = NULL;
+static NodeId FUNCTION_START; // First node of the function being parsed
+
+static void stream_function_start(NodeId previous);
+static NodeId stream_function(NodeId fonct);
 %}
-%parse-param {Node ** abr}
+%parse-param {NodeId * abr}
 %union {
-    struct Node* node;
+    NodeId node;
     char byte;
     int num;
-    char ident[64];
-    char key_word[5];
+    Atom ident;
+    Operator op;
+    type_t prim_type;
 }
 %type <node> Prog DeclVars Declarateurs DeclFoncts DeclFonct 
 %type <node> EnTeteFonct Parametres ListTypVar Corps
 %type <node> SuiteInstr Instr Exp TB FB M E T F LValue 
 %type <node> Arguments ListExp DeclArray DeclFonctArray ArrayLR
-%token <byte> ADDSUB DIVSTAR CHARACTER
+%token <byte> CHARACTER
+%token <op> ADDSUB DIVSTAR EQ ORDER
 %token <num> NUM
 %token <ident> IDENT VOID RETURN IF ELSE WHILE
-%token <key_word> OR AND EQ ORDER TYPE
+%token OR AND
+%token <prim_type> TYPE
 
-%destructor { free($$); } DeclVars Declarateurs DeclFoncts DeclFonct 
-%destructor { free($$); } EnTeteFonct Parametres ListTypVar Corps
-%destructor { free($$); } SuiteInstr Instr Exp TB FB M E T F LValue 
-%destructor { free($$); } Arguments ListExp DeclArray DeclFonctArray ArrayLR
+/* No %destructor for nodes : discarded nodes stay in the node array,
+   which is released as a whole by deleteNodes() */
 
 %expect 1
-/* Character in key_word not char -> in case of \n, \t, \r and \0*/
 %%
 Prog:  DeclVars DeclFoncts              {*abr = makeNode(Prog);
                                         addChild(*abr,$1);
@@ -42,7 +55,7 @@ Prog:  DeclVars DeclFoncts              {*abr = makeNode(Prog);
     ;
 DeclVars:
        DeclVars TYPE Declarateurs ';'   {$$ = $1;
-                                        Node * i = makeNode(Type);
+                                        NodeId i = makeNode(Type);
                                         addAttributKeyWord(i, $2);
                                         addChild(i, $3);
                                         addChild($$, i);};
@@ -50,7 +63,7 @@ DeclVars:
     ;
 Declarateurs:
        Declarateurs ',' IDENT           {$$ = $1;
-                                        Node* i = makeNode(Ident);
+                                        NodeId i = makeNode(Ident);
                                         addAttributIdent(i, $3);
                                         addSibling($$, i);};
     |  Declarateurs ',' DeclArray       {$$ = $1;
@@ -62,7 +75,7 @@ Declarateurs:
 DeclFonctArray:
     TYPE IDENT '[' ']'                  {$$ = makeNode(DeclFonctArray);
                                         addAttributKeyWord($$, $1);
-                                        Node* ident = makeNode(Ident);
+                                        NodeId ident = makeNode(Ident);
                                         addAttributIdent(ident, $2);
                                         addChild($$, ident);};
     ;
@@ -70,7 +83,7 @@ DeclFonctArray:
 DeclArray:
     IDENT '[' NUM ']'                   {$$ = makeNode(DeclArray);
                                         addAttributIdent($$,$1);
-                                        Node* num = makeNode(Num);
+                                        NodeId num = makeNode(Num);
                                         addAttributNum(num, $3);
                                         addChild($$, num);};
 
@@ -81,30 +94,33 @@ ArrayLR:
     ;
 DeclFoncts:
        DeclFoncts DeclFonct             {$$ = $1;
-                                        addChild($$,$2);};
+                                        if ($2) addChild($$,$2);};
     |  DeclFonct                        {$$ = makeNode(DeclFoncts);
-                                        addChild($$,$1);};
+                                        if ($1) addChild($$,$1);};
     ;
 DeclFonct:
        EnTeteFonct Corps                {$$ = makeNode(DeclFonct);
                                         addChild($$,$1);
-                                        addChild($$,$2);};
+                                        addChild($$,$2);
+                                        $$ = stream_function($$);};
     ;
 EnTeteFonct:
-       TYPE IDENT '(' Parametres ')'    {$$ = makeNode(EnTeteFonct);
-                                        Node* i = makeNode(Type);
+       TYPE IDENT '('                   {stream_function_start($<node>0);}
+       Parametres ')'                   {$$ = makeNode(EnTeteFonct);
+                                        NodeId i = makeNode(Type);
                                         addAttributKeyWord(i, $1);
                                         addChild($$, i);
-                                        Node* j = makeNode(Ident);
+                                        NodeId j = makeNode(Ident);
                                         addAttributIdent(j, $2);
                                         addChild($$, j);
-                                        addChild($$, $4);};
-    |  VOID IDENT '(' Parametres ')'    {$$ = makeNode(EnTeteFonct);
+                                        addChild($$, $5);};
+    |  VOID IDENT '('                   {stream_function_start($<node>0);}
+       Parametres ')'                   {$$ = makeNode(EnTeteFonct);
                                         addChild($$, makeNode(Void));
-                                        Node* j = makeNode(Ident);
+                                        NodeId j = makeNode(Ident);
                                         addAttributIdent(j, $2);
                                         addChild($$, j);
-                                        addChild($$, $4);};
+                                        addChild($$, $5);};
     ;
 
 Parametres:
@@ -113,18 +129,18 @@ Parametres:
     ;
 ListTypVar:
        ListTypVar ',' TYPE IDENT        {$$ = $1;
-                                        Node* i = makeNode(Type);
+                                        NodeId i = makeNode(Type);
                                         addAttributKeyWord(i, $3);
-                                        Node* j = makeNode(Ident);
+                                        NodeId j = makeNode(Ident);
                                         addAttributIdent(j, $4);
                                         addChild(i, j);
                                         addChild($$,i);};
     |  ListTypVar ',' DeclFonctArray    {$$ = $1;
                                         addChild($$, $3);};
     |  TYPE IDENT                       {$$ = makeNode(ListTypVar);
-                                        Node* i = makeNode(Type);
+                                        NodeId i = makeNode(Type);
                                         addAttributKeyWord(i, $1);
-                                        Node* j = makeNode(Ident);
+                                        NodeId j = makeNode(Ident);
                                         addAttributIdent(j, $2);
                                         addChild(i, j);
                                         addChild($$, i);};
@@ -174,31 +190,31 @@ TB  :  TB AND FB                        {$$ = makeNode(And);
     |  FB                               {$$ = $1;};
     ;
 FB  :  FB EQ M                          {$$ = makeNode(Eq);
-                                        addAttributKeyWord($$, $2);
+                                        addAttributOperator($$, $2);
                                         addChild($$, $1);
                                         addChild($$, $3);};
     |  M                                {$$ = $1;};
     ;
 M   :  M ORDER E                        {$$ = makeNode(Order);
-                                        addAttributKeyWord($$, $2);
+                                        addAttributOperator($$, $2);
                                         addChild($$, $1);
                                         addChild($$, $3);};
     |  E                                {$$ = $1;};
     ;
 E   :  E ADDSUB T                       {$$ = makeNode(Addsub);
-                                        addAttributByte($$, $2);
+                                        addAttributOperator($$, $2);
                                         addChild($$, $1);
                                         addChild($$, $3);};
     |  T                                {$$ = $1;};
     ;    
 T   :  T DIVSTAR F                      {$$ = makeNode(Divstar);
-                                        addAttributByte($$, $2);
+                                        addAttributOperator($$, $2);
                                         addChild($$, $1);
                                         addChild($$, $3);};
     |  F                                {$$ = $1;};
     ;
 F   :  ADDSUB F                         {$$ = makeNode(AddsubU);
-                                        addAttributByte($$, $1);
+                                        addAttributOperator($$, $1);
                                         addChild($$,$2);};
     |  '!' F                            {$$ = makeNode(Not);
                                         addChild($$,$2);};
@@ -228,17 +244,65 @@ ListExp:
                                         addChild($$,$1);};
     ;
 %%
-void yyerror(Node** abr, char* msg) {
+void yyerror(NodeId* abr, char* msg) {
     fprintf(stderr, "%s: line %u column %u\n", msg, nbline, nbchar);
 }
 
-ErrorType parser_bison(FILE* f, Node** abr) {
-    extern FILE* yyin;
-    yyin = f;
-    int retcode = yyparse(abr);
+/**
+ * @brief Called once the parser knows a function begins,
+ * before any node of the function is created
+ *
+ * @param previous Node below the function on the parser stack :
+ * DeclVars of the globals for the first function, DeclFoncts else
+ */
+static void stream_function_start(NodeId previous) {
+    if (!STREAM_HANDLER) {
+        return;
+    }
+    if (Node_get(previous)->label == DeclVars) {
+        // First function, the global declarations are complete
+        STREAM_HANDLER(Node_get(previous), STREAM_DATA);
+    }
+    FUNCTION_START = countNodes();
+}
+
+/**
+ * @brief Give a parsed function to the streaming handler, and release it
+ *
+ * @param fonct DeclFonct node
+ * @return NodeId fonct, or NODE_NONE if it was released
+ */
+static NodeId stream_function(NodeId fonct) {
+    if (!STREAM_HANDLER) {
+        return fonct;
+    }
+    STREAM_HANDLER(Node_get(fonct), STREAM_DATA);
+    truncateNodes(FUNCTION_START);
+    return NODE_NONE;
+}
+
+ErrorType parser_bison(Source* source, Node** abr) {
+    NodeId root = NODE_NONE;
+    Scanner_start(source);
+    int retcode = yyparse(&root);
+    Scanner_stop();
+    *abr = Node_get(root);
     return (
         retcode == 1 ? ERR_PARSE_SYNTAX
         : retcode == 2 ? ERR_NO_MEMORY
         : ERR_NONE
     );
 }
+
+ErrorType parser_bison_stream(Source* source,
+                              ParserHandler handler, void* data) {
+    Node* root;
+
+    STREAM_HANDLER = handler;
+    STREAM_DATA = data;
+    ErrorType err = parser_bison(source, &root);
+    STREAM_HANDLER = NULL;
+    STREAM_DATA = NULL;
+
+    return err;
+}
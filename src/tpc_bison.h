@@ -5,17 +5,70 @@
 
 #include "tree.h"
 #include "error.h"
+#include "source.h"
+
+/**
+ * @brief Make the flex scanner read source in place
+ *
+ * @param source Loaded source code
+ */
+void lexer_flex(Source* source);
+
+/**
+ * @brief Get the next token of the flex scanner (0 at the end of the source)
+ *
+ * @return int
+ */
+int yylex_flex(void);
+
+/**
+ * @brief Get the next token of the scanner selected by Scanner_select
+ * (0 at the end of the source), see scanner.h
+ *
+ * @return int
+ */
+int yylex(void);
+
+/**
+ * @brief Release the scanner state (not the scanned source)
+ *
+ * @return int
+ */
+int yylex_destroy(void);
 
 /**
  * @brief Run the bison parser
  * 
- * @param f Input file (TPC source code)
+ * @param source TPC source code, see Source_load
  * @param abr Generated Abstract Syntax Tree
  * @return ErrorType 
  * - ERR_PARSE_SYNTAX if the syntax is incorrect
  * - ERR_NO_MEMORY if there is not enough memory
  * - ERR_NONE else
  */
-ErrorType parser_bison(FILE* f, Node** abr);
+ErrorType parser_bison(Source* source, Node** abr);
+
+/**
+ * @brief Handler of the parsed subtrees in streaming mode
+ *
+ * @param tree DeclVars node of the global declarations (once, before
+ * the first function), then DeclFonct node of each function
+ * @param data Pointer given to parser_bison_stream
+ */
+typedef void (*ParserHandler)(Node* tree, void* data);
+
+/**
+ * @brief Run the bison parser in streaming mode : every function
+ * is given to handler as soon as it is parsed, and its nodes are
+ * released when handler returns, so the tree never holds more
+ * than one function.
+ *
+ * @param source TPC source code, see Source_load
+ * @param handler Called on each subtree
+ * @param data Passed to handler
+ * @return ErrorType Same as parser_bison
+ */
+ErrorType parser_bison_stream(Source* source,
+                              ParserHandler handler, void* data);
 
 #endif
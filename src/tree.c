@@ -1,172 +1,166 @@
 #include "tree.h"
 
-#include <stdbool.h>
+#include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <string.h>
+
 extern int nbline; /* from lexer */
 extern int nbchar; /* from lexer */
 
-const char *NODE_STRING[] = {
+#define NODES_INITIAL_CAPACITY 1024
+
+static const char *NODE_STRING[] = {
     FOREACH_NODE(GENERATE_STRING)};
 
-Node *makeNode(label_t label) {
-    Node *node = malloc(sizeof(Node));
-    if (!node) {
-        printf("Run out of memory\n");
-        exit(1);
+static const char *OPERATOR_STRING[] = {
+    [OP_ADD] = "+",
+    [OP_SUB] = "-",
+    [OP_MUL] = "*",
+    [OP_DIV] = "/",
+    [OP_MOD] = "%",
+    [OP_EQ] = "==",
+    [OP_NE] = "!=",
+    [OP_LT] = "<",
+    [OP_LE] = "<=",
+    [OP_GT] = ">",
+    [OP_GE] = ">=",
+};
+
+Node *NODES = NULL;
+static NodeId NB_NODES = 0;  // Index 0 is NODE_NONE
+static NodeId NODES_CAPACITY = 0;
+
+NodeId makeNode(label_t label) {
+    if (NB_NODES == 0) {
+        NB_NODES = 1;
+    }
+    if (NB_NODES >= NODES_CAPACITY) {
+        NodeId capacity = NODES_CAPACITY ? NODES_CAPACITY * 2
+                                         : NODES_INITIAL_CAPACITY;
+        // NodeId overflow is reported like an allocation failure
+        Node *nodes = capacity > NODES_CAPACITY
+                          ? realloc(NODES, (size_t)capacity * sizeof(Node))
+                          : NULL;
+        if (!nodes) {
+            printf("Run out of memory\n");
+            exit(1);
+        }
+        NODES = nodes;
+        NODES_CAPACITY = capacity;
     }
-    *node = (Node){
+
+    NODES[NB_NODES] = (Node){
         .label = label,
-        .firstChild = NULL,
-        .nextSibling = NULL,
+        .firstChild = NODE_NONE,
+        .nextSibling = NODE_NONE,
+        .lastSibling = NODE_NONE,
         .lineno = nbline,
         .column = nbchar,
         .type = type_void,
     };
-    return node;
+    return NB_NODES++;
 }
 
-void addAttributIdent(Node *node, char value[64]) {
-    node->type = type_ident;
-    // node->att.ident = value;
-    strncpy(node->att.ident, value, 64);
+void addAttributIdent(NodeId node, Atom value) {
+    NODES[node].type = type_ident;
+    NODES[node].att.ident = value;
 }
 
-void addAttributKeyWord(Node *node, char value[5]) {
-    node->type = type_key_word;
-    strncpy(node->att.key_word, value, 5);
+void addAttributKeyWord(NodeId node, type_t prim_type) {
+    NODES[node].type = type_key_word;
+    NODES[node].att.prim_type = prim_type;
 }
 
-void addAttributByte(Node *node, char value) {
-    node->type = type_byte;
-    node->att.byte = value;
+void addAttributOperator(NodeId node, Operator op) {
+    NODES[node].type = type_op;
+    NODES[node].att.op = op;
 }
 
-void addAttributNum(Node *node, int value) {
-    node->type = type_num;
-    node->att.num = value;
+void addAttributByte(NodeId node, char value) {
+    NODES[node].type = type_byte;
+    NODES[node].att.byte = value;
 }
 
-void addAttribut(Node *node, Attribut attrib, type_t type) {
-    node->type = type;
-    // strcpy(node->att.ident, attrib.ident);
-    node->att = attrib;
+void addAttributNum(NodeId node, int value) {
+    NODES[node].type = type_num;
+    NODES[node].att.num = value;
 }
 
-void addSibling(Node *node, Node *sibling) {
-    Node *curr = node;
-    while (curr->nextSibling != NULL) {
-        curr = curr->nextSibling;
+void addSibling(NodeId node, NodeId sibling) {
+    // Start from the cached end of the list, so appending is O(1)
+    NodeId curr = NODES[node].lastSibling ? NODES[node].lastSibling : node;
+    while (NODES[curr].nextSibling != NODE_NONE) {
+        curr = NODES[curr].nextSibling;
     }
-    curr->nextSibling = sibling;
+    NODES[curr].nextSibling = sibling;
+    NODES[node].lastSibling = NODES[sibling].lastSibling
+                                  ? NODES[sibling].lastSibling
+                                  : sibling;
 }
 
-void addChild(Node *parent, Node *child) {
-    if (parent->firstChild == NULL) {
-        parent->firstChild = child;
+void addChild(NodeId parent, NodeId child) {
+    if (NODES[parent].firstChild == NODE_NONE) {
+        NODES[parent].firstChild = child;
     } else {
-        addSibling(parent->firstChild, child);
+        addSibling(NODES[parent].firstChild, child);
     }
 }
 
-void deleteTree(Node *node) {
-    if (node->firstChild) {
-        deleteTree(node->firstChild);
-    }
-    if (node->nextSibling) {
-        deleteTree(node->nextSibling);
-    }
-    free(node);
+void deleteNodes(void) {
+    free(NODES);
+    NODES = NULL;
+    NB_NODES = NODES_CAPACITY = 0;
 }
 
-void printTree(Node *node) {
-    static char *unprintable_char[32] = {
-        [0] = "Null character",
-        [1] = "Start of Heading",
-        [2] = "Start of Text",
-        [3] = "End of Text",
-        [4] = "End of Transmission",
-        [5] = "Enquiry",
-        [6] = "Acknowledge",
-        [7] = "Bell, Alert",
-        [8] = "Backspace",
-        [9] = "Horizontal Tab",
-        [10] = "Line Feed",
-        [11] = "Vertical Tabulation",
-        [12] = "Form Feed",
-        [13] = "Carriage Return",
-        [14] = "Shift Out",
-        [15] = "Shift In",
-        [16] = "Data Link Escape",
-        [17] = "Device Control One (XON)",
-        [18] = "Device Control Two",
-        [19] = "Device Control Three (XOFF)",
-        [20] = "Device Control Four",
-        [21] = "Negative Acknowledge",
-        [22] = "Synchronous Idle",
-        [23] = "End of Transmission Block",
-        [24] = "Cancel",
-        [25] = "End of medium",
-        [26] = "Substitute",
-        [27] = "Escape",
-        [28] = "File Separator",
-        [29] = "Group Separator",
-        [30] = "Record Separator",
-        [31] = "Unit Separator",
-    };
-    static bool rightmost[128];        // tells if node is rightmost sibling
-    static int depth = 0;              // depth of current node
-    for (int i = 1; i < depth; i++) {  // 2502 = vertical line
-        printf(rightmost[i] ? "    " : "\u2502   ");
-    }
-    if (depth > 0) {  // 2514 = L form; 2500 = horizontal line;
-                      // 251c = vertical line and right horiz
-        printf(rightmost[depth] ? "\u2514\u2500\u2500 "
-                                : "\u251c\u2500\u2500 ");
+NodeId countNodes(void) {
+    return NB_NODES ? NB_NODES : 1;
+}
+
+void truncateNodes(NodeId count) {
+    assert(count >= 1 && count <= countNodes());
+    NB_NODES = count;
+}
+
+Node *resetNodes(NodeId count) {
+    assert(count >= 1);
+    NodeId capacity = count > NODES_INITIAL_CAPACITY ? count
+                                                     : NODES_INITIAL_CAPACITY;
+    deleteNodes();
+    NODES = malloc((size_t)capacity * sizeof(Node));
+    if (!NODES) {
+        printf("Run out of memory\n");
+        exit(1);
     }
+    NB_NODES = count;
+    NODES_CAPACITY = capacity;
+
+    return NODES;
+}
+
+const char *Operator_to_str(Operator op) {
+    return OPERATOR_STRING[op];
+}
 
-    printf("%s : ", NODE_STRING[node->label]);
-
-    // if (node->label == DeclArray || node->label == ArrayLR) {
-    //     printf("%s : ", NODE_STRING[node->label]);
-    // }
-
-    switch (node->type) {
-        case type_byte:
-            if (node->label == Character) {
-                if (node->att.byte < 32) {
-                    printf("'%s'\n", unprintable_char[(int)node->att.byte]);
-                } else if (node->att.byte > 126) {
-                    printf("%d\n", node->att.byte);
-                } else {
-                    printf("'%c'\n", node->att.byte);
-                }
-            } else {
-                printf("%c\n", node->att.byte);
-            }
-            break;
-        case type_num:
-            printf("%d\n", node->att.num);
-            break;
-        case type_ident:
-            printf("%s\n", node->att.ident);
-            break;
-        case type_key_word:
-            printf("%s\n", node->att.key_word);
-            break;
-        case type_void:
+Operator Operator_negate(Operator op) {
+    switch (op) {
+        case OP_EQ:
+            return OP_NE;
+        case OP_NE:
+            return OP_EQ;
+        case OP_LT:
+            return OP_GE;
+        case OP_LE:
+            return OP_GT;
+        case OP_GT:
+            return OP_LE;
+        case OP_GE:
+            return OP_LT;
         default:
-            // printf("%s\n", NODE_STRING[node->label]);
-            printf("\n");
-            break;
+            assert(0 && "Not a comparison");
+            return op;
     }
-    depth++;
-    for (Node *child = node->firstChild;
-         child != NULL;
-         child = child->nextSibling) {
-        rightmost[depth] = (child->nextSibling) ? false : true;
-        printTree(child);
-    }
-    depth--;
+}
+
+const char *Label_to_str(label_t label) {
+    return NODE_STRING[label];
 }
@@ -3,6 +3,10 @@
 #ifndef TREE_H
 #define TREE_H
 
+#include <stdint.h>
+
+#include "intern.h"
+
 #define FOREACH_NODE(NODE) \
     NODE(Prog)             \
     NODE(DeclVars)         \
@@ -54,18 +58,28 @@
 
 #define IS_EMPTY_TREE(tree) ((tree) == NULL)
 
-#define FOREACH_SIBLING(node) for (; (node); (node) = (node)->nextSibling)
+#define FOREACH_SIBLING(node) for (; (node); (node) = NEXTSIBLING(node))
 
 typedef enum {
     FOREACH_NODE(GENERATE_ENUM)
 } label_t;
 
-typedef union {
-    char byte;
-    int num;
-    char ident[65];
-    char key_word[6];
-} Attribut;
+/**
+ * @brief Operators, decoded once by the lexer
+ */
+typedef enum Operator {
+    OP_ADD,
+    OP_SUB,
+    OP_MUL,
+    OP_DIV,
+    OP_MOD,
+    OP_EQ,
+    OP_NE,
+    OP_LT,
+    OP_LE,
+    OP_GT,
+    OP_GE,
+} Operator;
 
 typedef enum {
     type_byte,
@@ -73,32 +87,154 @@ typedef enum {
     type_ident,
     type_key_word,
     type_void,
+    type_op,
 } type_t;
 
+/**
+ * @brief Value of a node, tagged by Node.type
+ * Literals are stored inline, as they fit in the node.
+ */
+typedef union {
+    char byte;         // type_byte : Character
+    int num;           // type_num : Num
+    Atom ident;        // type_ident : Ident, DeclArray, ArrayLR
+    type_t prim_type;  // type_key_word : Type, DeclFonctArray (int or char)
+    Operator op;       // type_op : Addsub, AddsubU, Divstar, Eq, Order
+} Attribut;
+
+/**
+ * @brief Index of a node in the node array, NODE_NONE for no node
+ */
+typedef uint32_t NodeId;
+
+#define NODE_NONE ((NodeId)0)
+
+struct Symbol;
+
+/* Node.expr_flags */
+#define EXPR_LVALUE 0x1    // Names a variable or an array element
+#define EXPR_CONSTANT 0x2  // Made of literals only
+
+/**
+ * @brief AST node. Every node lives in a single array (see Node_get),
+ * and refers to its children and siblings by index.
+ */
 typedef struct Node {
-    label_t label;
-    struct Node *firstChild, *nextSibling;
+    struct Symbol *symbol; /*<
+        Symbol of an Ident/ArrayLR node, cached by ProgramST_bind */
+    NodeId firstChild, nextSibling;
+    NodeId lastSibling; /*<
+        Last node of the sibling list,
+        only kept up to date on the first node of the list. */
     Attribut att;
-    type_t type;
     int lineno;
     int column;
+    uint8_t label;  // label_t
+    uint8_t type;   // type_t of att
+    uint8_t expr_type; /*<
+        type_t of the value of an expression node, set by Semantic_check */
+    uint8_t expr_flags;  // EXPR_* of an expression node, idem
+    uint8_t reg_need; /*<
+        Registers needed to evaluate an expression node (Sethi-Ullman
+        number), set by the code generator in registers mode */
 } Node, *Tree;
 
-Node *makeNode(label_t label);
-void addAttribut(Node *node, Attribut att, type_t type);
+/**
+ * @brief Array of every node. The array moves when it grows,
+ * so Node pointers are only valid until the next call to makeNode :
+ * NodeId are used while building the tree.
+ */
+extern Node *NODES;
+
+/**
+ * @brief Get the node of an index
+ *
+ * @param id
+ * @return Node* NULL if id is NODE_NONE
+ */
+static inline Node *Node_get(NodeId id) {
+    return id == NODE_NONE ? NULL : &NODES[id];
+}
+
+/**
+ * @brief Get the index of a node
+ *
+ * @param node
+ * @return NodeId
+ */
+static inline NodeId Node_id(const Node *node) {
+    return node ? (NodeId)(node - NODES) : NODE_NONE;
+}
+
+NodeId makeNode(label_t label);
+
+void addAttributIdent(NodeId node, Atom value);
+void addAttributKeyWord(NodeId node, type_t prim_type);
+void addAttributOperator(NodeId node, Operator op);
+void addAttributByte(NodeId node, char value);
+void addAttributNum(NodeId node, int value);
+
+void addSibling(NodeId node, NodeId sibling);
+void addChild(NodeId parent, NodeId child);
+/**
+ * @brief Release every node created by makeNode, without walking the trees
+ */
+void deleteNodes(void);
+
+/**
+ * @brief Get the number of nodes created so far.
+ * Nodes are numbered in creation order : every node created after
+ * this call gets an index >= the returned value.
+ *
+ * @return NodeId
+ */
+NodeId countNodes(void);
+
+/**
+ * @brief Forget the nodes created since countNodes returned count,
+ * their indices are reused by the next calls to makeNode
+ * (used to drop a subtree built after count, once it is processed)
+ *
+ * @param count Value returned by countNodes
+ */
+void truncateNodes(NodeId count);
+
+/**
+ * @brief Release every node, and make room for count new ones,
+ * to be filled by the caller (used to restore a saved tree)
+ *
+ * @param count Number of nodes, NODE_NONE included
+ * @return Node* Node array (NODES), with uninitialized nodes
+ */
+Node *resetNodes(NodeId count);
+
+/**
+ * @brief Get the spelling of an operator
+ *
+ * @param op
+ * @return const char*
+ */
+const char *Operator_to_str(Operator op);
 
-void addAttributIdent(Node *node, char value[64]);
-void addAttributKeyWord(Node *node, char value[5]);
-void addAttributByte(Node *node, char value);
-void addAttributNum(Node *node, int value);
+/**
+ * @brief Get the comparison true when a comparison is false
+ *
+ * @param op OP_EQ to OP_GE
+ * @return Operator
+ */
+Operator Operator_negate(Operator op);
 
-void addSibling(Node *node, Node *sibling);
-void addChild(Node *parent, Node *child);
-void deleteTree(Node *node);
-void printTree(Node *node);
+/**
+ * @brief Get the name of a node label
+ *
+ * @param label
+ * @return const char*
+ */
+const char *Label_to_str(label_t label);
 
-#define FIRSTCHILD(node) node->firstChild
-#define SECONDCHILD(node) node->firstChild->nextSibling
-#define THIRDCHILD(node) node->firstChild->nextSibling->nextSibling
+#define FIRSTCHILD(node) Node_get((node)->firstChild)
+#define NEXTSIBLING(node) Node_get((node)->nextSibling)
+#define SECONDCHILD(node) NEXTSIBLING(FIRSTCHILD(node))
+#define THIRDCHILD(node) NEXTSIBLING(SECONDCHILD(node))
 
 #endif
@@ -13,45 +13,104 @@
 #include <assert.h>
 #include <stdio.h>
 
+#include "arraylist.h"
 #include "codeWriter.h"
+#include "fold.h"
+#include "ir.h"
+#include "passes.h"
 #include "symbolTable.h"
 #include "tree.h"
 
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
 int GLOBAL_CMP;
 
+// Number of the labels of the next boolean logical operation
+static int BOOL_LABEL;
+
 // ! à retirer avant rendu debug parcours arbre laisser pour le moment
 static const char* NODE_STRING[] = {
     FOREACH_NODE(GENERATE_STRING)};
 
-static void _Instr_Return(const ProgramST* table,
-                          Tree tree, FILE* nasm,
-                          const FunctionST* func);
-static void _Instr_Assignation(const ProgramST* table,
-                               Tree tree, FILE* nasm,
-                               const FunctionST* func);
+/**
+ * @brief Function being lowered to IR
+ */
+typedef struct TreeReader {
+    const ProgramST* table;
+    const FunctionST* func;
+    IrFunction* ir;
+    ArrayList values;  // [IrTemp] Temps not used yet, the last on top
+} TreeReader;
+
+static void _Instr_Return(TreeReader* self, Tree tree);
+static void _Instr_Assignation(TreeReader* self, Tree tree);
+static void _Instr_Call(TreeReader* self, Tree tree);
 static void _TreeReader_DeclFoncts(const ProgramST* table,
-                                   Tree tree, FILE* nasm);
-static void TreeReader_SuiteInst(const ProgramST* table, Tree tree,
-                                 const FunctionST* func, FILE* nasm);
+                                   Tree tree, Emitter* nasm);
+static void TreeReader_SuiteInst(TreeReader* self, Tree tree);
+
+static void _Instr_If(TreeReader* self, Tree tree);
+
+static void _Instr_While(TreeReader* self, Tree tree);
+
+/**
+ * @brief Append an instruction defining a new temp, left on top
+ * of the values
+ *
+ * @param self
+ * @param instr Without its dst
+ * @return IrTemp
+ */
+static IrTemp _TreeReader_def(TreeReader* self, IrInstr instr) {
+    instr.dst = IrFunction_new_temp(self->ir);
+    IrFunction_append(self->ir, instr);
+    ArrayList_append(&self->values, &instr.dst);
+    return instr.dst;
+}
+
+/**
+ * @brief Take the temp on top of the values
+ *
+ * @param self
+ * @return IrTemp
+ */
+static IrTemp _TreeReader_use(TreeReader* self) {
+    return ArrayList_pop_v(&self->values, IrTemp);
+}
+
+/**
+ * @brief Append a label
+ *
+ * @param self
+ * @param label
+ */
+static void _TreeReader_label_here(TreeReader* self, int label) {
+    IrFunction_append(self->ir, (IrInstr){.op = IR_LABEL, .number = label});
+}
 
-static void _Instr_If(const ProgramST* table,
-                      Tree tree, FILE* nasm,
-                      const FunctionST* func);
+/**
+ * @brief Append a jump
+ *
+ * @param self
+ * @param op IR_JUMP, or IR_JUMP_ZERO or IR_JUMP_NONZERO on the value on top
+ * @param label
+ */
+static void _TreeReader_jump(TreeReader* self, IrOp op, int label) {
+    IrInstr jump = {.op = op, .number = label};
 
-static void _Instr_While(const ProgramST* table,
-                         Tree tree, FILE* nasm,
-                         const FunctionST* func);
+    if (op != IR_JUMP) {
+        jump.a = _TreeReader_use(self);
+    }
+    IrFunction_append(self->ir, jump);
+}
 
 /**
- * @brief Write code for a function body.
+ * @brief Lower a function body.
  *
- * @param table
+ * @param self
  * @param tree SuitInstr node, or a single instruction node
- * @param func
- * @param nasm
  */
-static void TreeReader_SuiteInst(const ProgramST* table, Tree tree,
-                                 const FunctionST* func, FILE* nasm) {
+static void TreeReader_SuiteInst(TreeReader* self, Tree tree) {
     assert(
         tree->label == SuiteInstr || tree->label == Return ||
         tree->label == Assignation || tree->label == Ident ||
@@ -60,25 +119,25 @@ static void TreeReader_SuiteInst(const ProgramST* table, Tree tree,
 
     Node* child = tree->label == SuiteInstr ? FIRSTCHILD(tree) : tree;
 
-    for (; child != NULL; child = child->nextSibling) {
+    for (; child != NULL; child = NEXTSIBLING(child)) {
         switch (child->label) {
             case Return:
-                _Instr_Return(table, child, nasm, func);
+                _Instr_Return(self, child);
                 break;
             case Ident:
-                CodeWriter_CallFunction(nasm, child, table, func);
+                _Instr_Call(self, child);
                 break;
             case Assignation:
-                _Instr_Assignation(table, child, nasm, func);
+                _Instr_Assignation(self, child);
                 break;
             case If:
-                _Instr_If(table, child, nasm, func);
+                _Instr_If(self, child);
                 break;
             case While:
-                _Instr_While(table, child, nasm, func);
+                _Instr_While(self, child);
                 break;
             case SuiteInstr:
-                TreeReader_SuiteInst(table, child, func, nasm);
+                TreeReader_SuiteInst(self, child);
                 break;
             case EmptyInstr:
                 break;
@@ -93,107 +152,389 @@ static void TreeReader_SuiteInst(const ProgramST* table, Tree tree,
         }
     }
 }
+
 /**
- * @brief
+ * @brief Lower a function body, which returns at its end
  *
- * @param prog
- * @param func
- * @param tree
- * @param nasm
+ * @param self
+ * @param tree Corps node
  */
-static void _TreeReader_Corps(const ProgramST* prog,
-                              const FunctionST* func,
-                              Tree tree, FILE* nasm) {
+static void _TreeReader_Corps(TreeReader* self, Tree tree) {
     assert(tree->label == Corps);
-    // Implement stack frame
-    CodeWriter_stackFrame_start(nasm, func);
-    TreeReader_SuiteInst(prog, SECONDCHILD(tree), func, nasm);
-    CodeWriter_stackFrame_end(nasm, func);
-    CodeWriter_Return(nasm);
+    TreeReader_SuiteInst(self, SECONDCHILD(tree));
+    IrFunction_append(self->ir, (IrInstr){.op = IR_RETURN});
 }
 
-/**
- * @brief Generate code for a function.
- * Writes function's label and its body (Corps).
- *
- * @param prog
- * @param tree Tree DeclFonct node
- * @param nasm
- * @return int
- */
-static void _TreeReader_DeclFonct(const ProgramST* prog,
-                                  Tree tree, FILE* nasm) {
+void TreeReader_DeclFonct(const ProgramST* prog,
+                          Tree tree, Emitter* nasm) {
     assert(tree->label == DeclFonct);
     FunctionST* func = FunctionST_get_from_name(
         prog,
         // DeclFonct->EnTeteFonct->Ident
-        FIRSTCHILD(tree)->firstChild->nextSibling->att.ident);
-    CodeWriter_FunctionLabel(nasm, func);
-    _TreeReader_Corps(prog, func, SECONDCHILD(tree), nasm);
+        NEXTSIBLING(FIRSTCHILD(FIRSTCHILD(tree)))->att.ident);
+    IrFunction ir;
+    TreeReader self = {.table = prog, .func = func, .ir = &ir};
+
+    PassTimer timer = Passes_start(PASS_LOWER);
+    Fold_DeclFonct(tree);
+    IrFunction_init(&ir, func);
+    ArrayList_init(&self.values, sizeof(IrTemp), 64, NULL);
+    _TreeReader_Corps(&self, SECONDCHILD(tree));
+    assert(!ArrayList_get_length(&self.values) && "Value left unused");
+    ArrayList_free(&self.values);
+    Passes_stop(&timer, &ir);
+
+    Passes_run(&ir);
+
+    timer = Passes_start(PASS_CODEGEN);
+    CodeWriter_Function(nasm, &ir);
+    Passes_stop(&timer, &ir);
+    IrFunction_free(&ir);
 }
 
 static void _TreeReader_DeclFoncts(const ProgramST* table,
-                                   Tree tree, FILE* nasm) {
+                                   Tree tree, Emitter* nasm) {
     // Si est pas dans le noeux c'est grave car la suite du parcours est foutu.
     assert(tree->label == DeclFoncts);
     // On parcourt les noeux DeclFonct
-    for (Node* child = tree->firstChild;
+    for (Node* child = FIRSTCHILD(tree);
          child != NULL;
-         child = child->nextSibling) {
-        _TreeReader_DeclFonct(table, child, nasm);
+         child = NEXTSIBLING(child)) {
+        TreeReader_DeclFonct(table, child, nasm);
     }
 }
 
-void TreeReader_Prog(const ProgramST* table, Tree tree, FILE* nasm) {
+void TreeReader_Header(const ProgramST* table, Emitter* nasm) {
+    CodeWriter_Init_File(nasm, &table->globals);
+    Emitter_end_phase(nasm, "header");
+}
+
+void TreeReader_Builtins(Emitter* nasm) {
+    Emitter_end_phase(nasm, "functions");
+    CodeWriter_load_builtins(nasm);
+    Emitter_end_phase(nasm, "builtins");
+}
+
+void TreeReader_Prog(const ProgramST* table, Tree tree, Emitter* nasm) {
     // Si est pas dans le noeux c'est grave car la suite du parcours est foutu.
     assert(tree->label == Prog);
 
-    CodeWriter_Init_File(nasm, &table->globals);
+    TreeReader_Header(table, nasm);
     _TreeReader_DeclFoncts(table, SECONDCHILD(tree), nasm);
-    CodeWriter_load_builtins(nasm);
+    TreeReader_Builtins(nasm);
 }
 
 /******************/
 /* Instr Unitaire */
 /******************/
 
-void TreeReader_Expr(const ProgramST* table,
-                     Tree tree, FILE* nasm,
-                     const FunctionST* func) {
+/**
+ * @brief Expression node waiting on the stack of _TreeReader_run
+ */
+typedef struct ExprTask {
+    Node* node;
+    int stage;     // Number of operands already evaluated
+    bool swapped;  // The right operand is evaluated first
+} ExprTask;
+
+/**
+ * @brief Condition waiting on the stack of _TreeReader_Cond
+ */
+typedef struct CondTask {
+    Node* node;  // NULL to append the label
+    int label;   // Jumped to when the value of node is when
+    bool when;
+} CondTask;
+
+static void _TreeReader_Expr(TreeReader* self, Tree tree);
+static void _TreeReader_Cond(TreeReader* self, Tree tree, int label,
+                             bool when);
+
+/**
+ * @brief Push an expression node to evaluate before the tasks below it
+ *
+ * @param tasks [ExprTask]
+ * @param node
+ * @param stage
+ */
+static void _TreeReader_push(ArrayList* tasks, Node* node, int stage) {
+    ExprTask task = {.node = node, .stage = stage};
+    ArrayList_append(tasks, &task);
+}
+
+/**
+ * @brief Get the number of registers needed to evaluate a binary
+ * operation from the needs of its operands (Sethi-Ullman)
+ *
+ * @param left
+ * @param right
+ * @return uint8_t
+ */
+static uint8_t _TreeReader_binary_need(uint8_t left, uint8_t right) {
+    if (left == right) {
+        return (left == UINT8_MAX) ? left : left + 1;
+    }
+
+    return MAX(left, right);
+}
+
+/**
+ * @brief Set the reg_need of each node of an expression, children first.
+ * A function call needs every register, as they are all spilled
+ * around it.
+ *
+ * @param tree
+ */
+static void _TreeReader_label(Node* tree) {
+    ArrayList tasks;
+    ExprTask task = {.node = tree};
+
+    ArrayList_init(&tasks, sizeof(ExprTask), 64, NULL);
+    ArrayList_append(&tasks, &task);
+    while (ArrayList_get_length(&tasks)) {
+        task = ArrayList_pop_v(&tasks, ExprTask);
+        Node* node = task.node;
+        if (task.stage == 0) {
+            task.stage = 1;
+            ArrayList_append(&tasks, &task);
+            Node* child = FIRSTCHILD(node);
+            if (node->label == Ident && child) {
+                child = FIRSTCHILD(child);  // Arguments of a call
+            }
+            for (; child; child = NEXTSIBLING(child)) {
+                ExprTask operand = {.node = child};
+                ArrayList_append(&tasks, &operand);
+            }
+            continue;
+        }
+        switch (node->label) {
+            case Ident:
+                node->reg_need = FIRSTCHILD(node) ? CODEWRITER_NB_SCRATCH : 1;
+                break;
+            case AddsubU:
+            case Not:
+            case ArrayLR:
+                node->reg_need = FIRSTCHILD(node)->reg_need;
+                break;
+            case Or:
+            case And:
+                // The left operand is no longer in a register
+                node->reg_need = MAX(FIRSTCHILD(node)->reg_need,
+                                     SECONDCHILD(node)->reg_need);
+                break;
+            case Addsub:
+            case Divstar:
+            case Eq:
+            case Order:
+                node->reg_need = _TreeReader_binary_need(
+                    FIRSTCHILD(node)->reg_need, SECONDCHILD(node)->reg_need);
+                break;
+            default:
+                node->reg_need = 1;
+        }
+    }
+    ArrayList_free(&tasks);
+}
+
+/**
+ * @brief Tell whether the right operand of a binary operation is
+ * evaluated first : it needs more registers than the left one, and
+ * holds no function call (a call needs every register). A call may
+ * write the variables read on its left, so it always runs after them.
+ *
+ * @param tree
+ * @return bool
+ */
+static bool _TreeReader_right_first(const Node* tree) {
+    uint8_t right = SECONDCHILD(tree)->reg_need;
+
+    return CodeWriter_get_mode() == CODEGEN_REGISTERS &&
+           right < CODEWRITER_NB_SCRATCH &&
+           right > FIRSTCHILD(tree)->reg_need;
+}
+
+/**
+ * @brief Push the arguments of a function call, so that they are
+ * evaluated from the last one to the first one
+ *
+ * @param tasks [ExprTask]
+ * @param call Ident node of the call
+ */
+static void _TreeReader_push_args(ArrayList* tasks, Node* call) {
+    for (Node* arg = FIRSTCHILD(FIRSTCHILD(call)); arg;
+         arg = NEXTSIBLING(arg)) {
+        _TreeReader_push(tasks, arg, 0);
+    }
+}
+
+/**
+ * @brief Append a function call, its arguments being the values on top
+ * (the first one on top)
+ *
+ * @param self
+ * @param call Ident node of the call
+ * @param used The result is a value, else it is dropped
+ */
+static void _TreeReader_call(TreeReader* self, const Node* call, bool used) {
+    int nb_args = 0;
+
+    for (const Node* arg = FIRSTCHILD(FIRSTCHILD(call)); arg;
+         arg = NEXTSIBLING(arg)) {
+        IrFunction_append(self->ir, (IrInstr){.op = IR_ARG,
+                                              .a = _TreeReader_use(self),
+                                              .number = nb_args++});
+    }
+
+    IrInstr instr = {.op = IR_CALL, .type = call->expr_type,
+                     .number = nb_args, .callee = call->att.ident};
+    const FunctionST* callee = FunctionST_get_from_call(self->table, call);
+    if (!callee || !FunctionST_is_defined_before_use(self->func, callee)) {
+        instr.flags = IR_FORWARD;
+    }
+    if (used) {
+        _TreeReader_def(self, instr);
+    } else {
+        IrFunction_append(self->ir, instr);
+    }
+}
+
+/**
+ * @brief Append the load of a variable, or of the address of an array
+ *
+ * @param self
+ * @param node Ident node, not a call
+ */
+static void _TreeReader_load(TreeReader* self, Node* node) {
+    const Symbol* symbol = ST_resolve_from_node(self->table, self->func, node);
+
+    switch (symbol->symbol_type) {
+        case SYMBOL_VALUE:
+            _TreeReader_def(self, (IrInstr){.op = IR_LOAD,
+                                            .type = node->expr_type,
+                                            .symbol = symbol});
+            break;
+        case SYMBOL_ARRAY:
+            // The array is not indexed, its address is loaded
+            _TreeReader_def(self, (IrInstr){.op = IR_ADDR,
+                                            .type = type_num,
+                                            .symbol = symbol});
+            break;
+        default:
+            assert(0 && "We shouldn't be there (LoadVar)");
+    }
+}
+
+/**
+ * @brief Lower an expression node up to its next operand :
+ * the node is pushed again for its next stage, then the operand
+ *
+ * @param self
+ * @param tasks [ExprTask]
+ * @param task Popped task
+ */
+static void _TreeReader_step(TreeReader* self, ArrayList* tasks,
+                             ExprTask task) {
+    Node* tree = task.node;
+
     switch (tree->label) {
         case AddsubU:
-            TreeReader_Expr(table, FIRSTCHILD(tree), nasm, func);
-            CodeWriter_Ope_Unaire(nasm, tree);
+        case Not:
+            if (task.stage == 0) {
+                _TreeReader_push(tasks, tree, 1);
+                _TreeReader_push(tasks, FIRSTCHILD(tree), 0);
+            } else if (tree->label == Not) {
+                _TreeReader_def(self, (IrInstr){.op = IR_NOT,
+                                                .a = _TreeReader_use(self)});
+            } else if (tree->att.op == OP_SUB) {
+                _TreeReader_def(self, (IrInstr){.op = IR_NEG,
+                                                .a = _TreeReader_use(self)});
+            }
             break;
         case Or:
-        case And:
-            CodeWriter_Ope_Bool(nasm, tree, table, func);
-            break;
-        case Not:
-            TreeReader_Expr(table, FIRSTCHILD(tree), nasm, func);
-            CodeWriter_Ope_Bool_Not(nasm);
+        case And: {
+            // Lazy evaluation : the operands jump to the label deciding
+            // the result, followed by its end label
+            bool is_and = tree->label == And;
+            int number = BOOL_LABEL++;
+            int label = IrFunction_new_label(
+                self->ir, is_and ? IR_LABEL_BOOL_FALSE : IR_LABEL_BOOL_TRUE,
+                number);
+            int end = IrFunction_new_label(self->ir, IR_LABEL_BOOL_END,
+                                           number);
+            _TreeReader_Cond(self, tree, label, !is_and);
+            // The result is defined on both paths
+            IrInstr result = {.op = IR_CONST, .type = type_num,
+                              .imm = is_and};
+            IrTemp dst = _TreeReader_def(self, result);
+            _TreeReader_jump(self, IR_JUMP, end);
+            _TreeReader_label_here(self, label);
+            result.dst = dst;
+            result.imm = !is_and;
+            IrFunction_append(self->ir, result);
+            _TreeReader_label_here(self, end);
             break;
+        }
         case Addsub:
         case Divstar:
-            TreeReader_Expr(table, FIRSTCHILD(tree), nasm, func);
-            TreeReader_Expr(table, SECONDCHILD(tree), nasm, func);
-            CodeWriter_Ope_Arith(nasm, tree);
+        case Eq:
+        case Order:
+            if (task.stage == 0) {
+                // Popped in the opposite order : left operand first,
+                // unless the right one needs more registers
+                ExprTask next = {.node = tree, .stage = 1,
+                                 .swapped = _TreeReader_right_first(tree)};
+                ArrayList_append(tasks, &next);
+                if (next.swapped) {
+                    _TreeReader_push(tasks, FIRSTCHILD(tree), 0);
+                    _TreeReader_push(tasks, SECONDCHILD(tree), 0);
+                } else {
+                    _TreeReader_push(tasks, SECONDCHILD(tree), 0);
+                    _TreeReader_push(tasks, FIRSTCHILD(tree), 0);
+                }
+            } else {
+                IrTemp top = _TreeReader_use(self);
+                IrTemp below = _TreeReader_use(self);
+                bool cmp = tree->label == Eq || tree->label == Order;
+                _TreeReader_def(self, (IrInstr){
+                                          .op = cmp ? IR_CMP : IR_BINARY,
+                                          .type = type_num,
+                                          .oper = tree->att.op,
+                                          .a = task.swapped ? top : below,
+                                          .b = task.swapped ? below : top,
+                                      });
+            }
             break;
         case Ident:
+            if (!FIRSTCHILD(tree)) {
+                _TreeReader_load(self, tree);
+            } else if (task.stage == 0) {
+                // Function call
+                _TreeReader_push(tasks, tree, 1);
+                _TreeReader_push_args(tasks, tree);
+            } else {
+                _TreeReader_call(self, tree, true);
+            }
+            break;
         case ArrayLR:
-            CodeWriter_LoadVar(nasm, tree, table, func);
+            if (task.stage == 0) {
+                _TreeReader_push(tasks, tree, 1);
+                _TreeReader_push(tasks, FIRSTCHILD(tree), 0);
+            } else {
+                _TreeReader_def(
+                    self, (IrInstr){.op = IR_LOAD_ELEM,
+                                    .type = tree->expr_type,
+                                    .a = _TreeReader_use(self),
+                                    .symbol = ST_resolve_from_node(
+                                        self->table, self->func, tree)});
+            }
             break;
         case Num:
-            CodeWriter_ConstantNumber(nasm, tree);
+            _TreeReader_def(self, (IrInstr){.op = IR_CONST, .type = type_num,
+                                            .imm = tree->att.num});
             break;
         case Character:
-            CodeWriter_ConstantCharacter(nasm, tree);
-            break;
-        case Eq:
-        case Order:
-            TreeReader_Expr(table, FIRSTCHILD(tree), nasm, func);
-            TreeReader_Expr(table, SECONDCHILD(tree), nasm, func);
-            CodeWriter_Cmp(nasm, tree, GLOBAL_CMP++);
+            _TreeReader_def(self, (IrInstr){.op = IR_CONST, .type = type_byte,
+                                            .imm = tree->att.byte});
             break;
         default:
             // ! Noeud non géré voloraiement ou non
@@ -203,69 +544,237 @@ void TreeReader_Expr(const ProgramST* table,
 }
 
 /**
- * @brief If the function is non-void (returns a value) move computed
- * expression to rax register (result of the expression).
- * If the function returns void, do nothing.
+ * @brief Lower the expressions on the stack of tasks, until it is empty.
+ * Iterative post-order traversal, expressions can be deeply nested.
  *
- * @param table
- * @param tree
- * @param nasm
- * @param func
- * @return int
+ * @param self
+ * @param tasks [ExprTask], emptied
  */
-static void _Instr_Return(const ProgramST* table,
-                          Tree tree, FILE* nasm,
-                          const FunctionST* func) {
-    // printf("Instr_Return\n");
-    const Symbol* sym = ST_get(&table->globals, func->identifier);
+static void _TreeReader_run(TreeReader* self, ArrayList* tasks) {
+    while (ArrayList_get_length(tasks)) {
+        ExprTask task = ArrayList_pop_v(tasks, ExprTask);
+        _TreeReader_step(self, tasks, task);
+    }
+}
 
-    if (sym->type != type_void) /* Non void */ {
+/**
+ * @brief Lower an expression, its value is left on top of the values
+ *
+ * @param self
+ * @param tree Any expression node
+ */
+static void _TreeReader_Expr(TreeReader* self, Tree tree) {
+    ArrayList tasks;
+
+    if (CodeWriter_get_mode() == CODEGEN_REGISTERS) {
+        _TreeReader_label(tree);
+    }
+    ArrayList_init(&tasks, sizeof(ExprTask), 64, NULL);
+    _TreeReader_push(&tasks, tree, 0);
+    _TreeReader_run(self, &tasks);
+    ArrayList_free(&tasks);
+}
+
+/**
+ * @brief Turn the comparison lowered last, whose value is on top of the
+ * values, into a jump taken on its result
+ *
+ * @param self
+ * @param label
+ * @param when Result of the comparison taking the jump
+ */
+static void _TreeReader_branch(TreeReader* self, int label, bool when) {
+    IrInstr* cmp = ArrayList_get(&self->ir->instrs, -1);
+    IrTemp value = _TreeReader_use(self);
+
+    assert(cmp->op == IR_CMP && cmp->dst == value);
+    (void)value;
+    cmp->op = IR_JUMP_CMP;
+    cmp->dst = IR_NO_TEMP;
+    cmp->number = label;
+    if (!when) {
+        cmp->oper = Operator_negate(cmp->oper);
+    }
+}
+
+/**
+ * @brief Lower a condition into jumps, without computing its value :
+ * a comparison jumps on its own result (cmp and jcc), the operands of
+ * && and || jump to the target or past the right operand
+ * (short-circuit), and ! swaps the result taking the jump.
+ * Iterative, conditions can be deeply nested.
+ *
+ * @param self
+ * @param tree Expression node
+ * @param label Label jumped to when the value of the condition is when,
+ * else the code after is reached
+ * @param when
+ */
+static void _TreeReader_Cond(TreeReader* self, Tree tree, int label,
+                             bool when) {
+    ArrayList tasks;
+    CondTask task = {.node = tree, .label = label, .when = when};
+
+    ArrayList_init(&tasks, sizeof(CondTask), 16, NULL);
+    ArrayList_append(&tasks, &task);
+    while (ArrayList_get_length(&tasks)) {
+        task = ArrayList_pop_v(&tasks, CondTask);
+        Node* node = task.node;
+
+        if (!node) {
+            _TreeReader_label_here(self, task.label);
+            continue;
+        }
+        switch (node->label) {
+            case Not:
+                task.node = FIRSTCHILD(node);
+                task.when = !task.when;
+                ArrayList_append(&tasks, &task);
+                break;
+            case And:
+            case Or: {
+                bool is_and = node->label == And;
+                CondTask left = {.node = FIRSTCHILD(node),
+                                 .label = task.label, .when = task.when};
+                CondTask right = {.node = SECONDCHILD(node),
+                                  .label = task.label, .when = task.when};
+                if (task.when == is_and) {
+                    // The left operand deciding the opposite result
+                    // skips the right one
+                    CondTask skip = {
+                        .label = IrFunction_new_label(
+                            self->ir,
+                            is_and ? IR_LABEL_BOOL_FALSE
+                                   : IR_LABEL_BOOL_TRUE,
+                            BOOL_LABEL++)};
+                    left.label = skip.label;
+                    left.when = !task.when;
+                    ArrayList_append(&tasks, &skip);
+                }
+                // Popped in the opposite order
+                ArrayList_append(&tasks, &right);
+                ArrayList_append(&tasks, &left);
+                break;
+            }
+            case Eq:
+            case Order:
+                _TreeReader_Expr(self, node);
+                _TreeReader_branch(self, task.label, task.when);
+                break;
+            case Num:
+            case Character: {
+                // Folded condition : the jump is always or never taken
+                bool value = node->label == Num ? node->att.num
+                                                : node->att.byte;
+                if (value == task.when) {
+                    _TreeReader_jump(self, IR_JUMP, task.label);
+                }
+                break;
+            }
+            default:
+                _TreeReader_Expr(self, node);
+                _TreeReader_jump(self,
+                                 task.when ? IR_JUMP_NONZERO : IR_JUMP_ZERO,
+                                 task.label);
+        }
+    }
+    ArrayList_free(&tasks);
+}
+
+/**
+ * @brief Lower a call instruction (its value is not used)
+ *
+ * @param self
+ * @param tree Ident node of the call
+ */
+static void _Instr_Call(TreeReader* self, Tree tree) {
+    ArrayList tasks;
+
+    if (CodeWriter_get_mode() == CODEGEN_REGISTERS) {
+        _TreeReader_label(tree);
+    }
+    ArrayList_init(&tasks, sizeof(ExprTask), 64, NULL);
+    _TreeReader_push_args(&tasks, tree);
+    _TreeReader_run(self, &tasks);
+    ArrayList_free(&tasks);
+    _TreeReader_call(self, tree, false);
+}
+
+/**
+ * @brief If the function is non-void (returns a value) return the value
+ * of the expression, else only return
+ *
+ * @param self
+ * @param tree Return node
+ */
+static void _Instr_Return(TreeReader* self, Tree tree) {
+    if (self->func->ret_type != type_void) /* Non void */ {
         // Verifiy if a value to returns exists, see _Instr_Return
         if (FIRSTCHILD(tree)) {
-            TreeReader_Expr(table, FIRSTCHILD(tree), nasm, func);
-            CodeWriter_Return_Expr(nasm);
-            CodeWriter_stackFrame_end(nasm, func);
-            CodeWriter_Return(nasm);
+            _TreeReader_Expr(self, FIRSTCHILD(tree));
+            IrFunction_append(self->ir,
+                              (IrInstr){.op = IR_RETURN,
+                                        .type = FIRSTCHILD(tree)->expr_type,
+                                        .a = _TreeReader_use(self)});
         }
     } else {
-        CodeWriter_stackFrame_end(nasm, func);
-        CodeWriter_Return(nasm);
+        IrFunction_append(self->ir, (IrInstr){.op = IR_RETURN});
     }
 }
 
-static void _Instr_Assignation(const ProgramST* table,
-                               Tree tree, FILE* nasm,
-                               const FunctionST* func) {
-    TreeReader_Expr(table, SECONDCHILD(tree), nasm, func);
-    CodeWriter_WriteVar(nasm, FIRSTCHILD(tree), table, func);
+static void _Instr_Assignation(TreeReader* self, Tree tree) {
+    Node* lvalue = FIRSTCHILD(tree);
+    const Symbol* symbol = ST_resolve_from_node(self->table, self->func,
+                                                lvalue);
+
+    _TreeReader_Expr(self, SECONDCHILD(tree));
+    if (lvalue->label == ArrayLR) {
+        assert(symbol->symbol_type == SYMBOL_ARRAY);
+        _TreeReader_Expr(self, FIRSTCHILD(lvalue));
+        IrTemp index = _TreeReader_use(self);
+        IrFunction_append(self->ir, (IrInstr){.op = IR_STORE_ELEM,
+                                              .type = lvalue->expr_type,
+                                              .a = index,
+                                              .b = _TreeReader_use(self),
+                                              .symbol = symbol});
+    } else {
+        assert(symbol->symbol_type == SYMBOL_VALUE);
+        IrFunction_append(self->ir, (IrInstr){.op = IR_STORE,
+                                              .type = lvalue->expr_type,
+                                              .a = _TreeReader_use(self),
+                                              .symbol = symbol});
+    }
 }
 
-static void _Instr_If(const ProgramST* table,
-                      Tree tree, FILE* nasm,
-                      const FunctionST* func) {
+static void _Instr_If(TreeReader* self, Tree tree) {
     assert(tree->label == If);
 
     int if_number = GLOBAL_CMP++;
-    TreeReader_Expr(table, FIRSTCHILD(tree), nasm, func);
-    CodeWriter_If_Init(nasm, if_number);
-    TreeReader_SuiteInst(table, SECONDCHILD(tree), func, nasm);
-    CodeWriter_If_Else(nasm, if_number);
+    int else_label = IrFunction_new_label(self->ir, IR_LABEL_ELSE, if_number);
+    int end_label = IrFunction_new_label(self->ir, IR_LABEL_END_IF,
+                                         if_number);
+
+    _TreeReader_Cond(self, FIRSTCHILD(tree), else_label, false);
+    TreeReader_SuiteInst(self, SECONDCHILD(tree));
+    _TreeReader_jump(self, IR_JUMP, end_label);
+    _TreeReader_label_here(self, else_label);
     if (THIRDCHILD(tree)) {
-        TreeReader_SuiteInst(table, THIRDCHILD(tree), func, nasm);
+        TreeReader_SuiteInst(self, THIRDCHILD(tree));
     }
-    CodeWriter_If_End(nasm, if_number);
+    _TreeReader_label_here(self, end_label);
 }
 
-static void _Instr_While(const ProgramST* table,
-                         Tree tree, FILE* nasm,
-                         const FunctionST* func) {
+static void _Instr_While(TreeReader* self, Tree tree) {
     int while_number = GLOBAL_CMP++;
+    int start_label = IrFunction_new_label(self->ir, IR_LABEL_WHILE_START,
+                                           while_number);
+    int body_label = IrFunction_new_label(self->ir, IR_LABEL_WHILE_BODY,
+                                          while_number);
 
-    CodeWriter_While_Init(nasm, while_number);
-
-    TreeReader_Expr(table, FIRSTCHILD(tree), nasm, func);
-    CodeWriter_While_Eval(nasm, while_number);
-
-    TreeReader_SuiteInst(table, SECONDCHILD(tree), func, nasm);
-    CodeWriter_While_End(nasm, while_number);
+    // The condition follows the body : an iteration takes a single jump
+    _TreeReader_jump(self, IR_JUMP, start_label);
+    _TreeReader_label_here(self, body_label);
+    TreeReader_SuiteInst(self, SECONDCHILD(tree));
+    _TreeReader_label_here(self, start_label);
+    _TreeReader_Cond(self, FIRSTCHILD(tree), body_label, true);
 }
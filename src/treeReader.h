@@ -10,28 +10,46 @@
 
 #include <stdio.h>
 
+#include "emitter.h"
 #include "symbolTable.h"
 #include "tree.h"
 
 /**
- * @brief Traverse the tree and write the nasm code
+ * @brief Traverse the tree and write the nasm code, one function
+ * at a time (see TreeReader_DeclFonct)
  * 
  * @param table pre-generated Program Symbol table
  * @param tree Bison's generated tree must be a `Program` node
- * @param nasm Output file
+ * @param nasm Output emitter, ends a phase after the header,
+ * the functions and the builtins
  */
 void TreeReader_Prog(const ProgramST* table,
-                     Tree tree, FILE* nasm);
+                     Tree tree, Emitter* nasm);
 
 /**
- * @brief Generate nasm code to evaluate an expression and
- * push the result on the stack
- * 
- * @param table Program's symbol table
- * @param tree Any expression node
- * @param nasm Output file
- * @param func Caller function's symbol table
+ * @brief Write the header of the assembly (global variables
+ * and entry point), ends the "header" phase
+ *
+ * @param table Program's symbol table, with every global variable
+ * @param nasm Output emitter
+ */
+void TreeReader_Header(const ProgramST* table, Emitter* nasm);
+
+/**
+ * @brief Generate code for a function : its body (Corps) is lowered
+ * to IR, optimized by the passes of the pipeline, then written.
+ *
+ * @param prog Program's symbol table
+ * @param tree DeclFonct node
+ * @param nasm Output emitter
+ */
+void TreeReader_DeclFonct(const ProgramST* prog,
+                          Tree tree, Emitter* nasm);
+
+/**
+ * @brief Write the builtin functions after the last function,
+ * ends the "functions" and "builtins" phases
+ *
+ * @param nasm Output emitter
  */
-void TreeReader_Expr(const ProgramST* table,
-                     Tree tree, FILE* nasm,
-                     const FunctionST* func);
+void TreeReader_Builtins(Emitter* nasm);
@@ -0,0 +1,418 @@
+#!/bin/python
+
+"""Throughput benchmarks of the TPC compiler on generated sources.
+
+Each benchmark generates inputs of growing size, runs the compiler on them
+and prints the time per element, so non-linear growth is easy to spot.
+"""
+
+import argparse
+import sys
+import tempfile
+import time
+from pathlib import Path
+from subprocess import run
+from typing import Callable, Dict, List
+
+PROJECT = Path(__file__).resolve().parents[1]
+EXECUTABLE = (PROJECT / "bin" / "tpcc").resolve()
+
+BENCHMARKS: Dict[str, Callable[[argparse.Namespace], None]] = {}
+
+
+def benchmark(func: Callable[[argparse.Namespace], None]):
+    """Register a benchmark under its function name"""
+    BENCHMARKS[func.__name__] = func
+    return func
+
+
+def timed_run(args: List[str], **kwargs) -> float:
+    """Run the compiler with args, and return the elapsed wall time
+
+    Args:
+        args (List[str]): Arguments given to the compiler
+
+    Returns:
+        float: Elapsed time in seconds
+    """
+    start = time.perf_counter()
+    run([EXECUTABLE, *args], check=True, capture_output=True, **kwargs)
+    return time.perf_counter() - start
+
+
+def straight_line_body(nb_statements: int) -> str:
+    """Generate a main function made of nb_statements assignations"""
+    lines = ["int main(void) {", "    int a;", "    a = 0;"]
+    lines += ["    a = a + 1;"] * (nb_statements - 1)
+    lines += ["    return 0;", "}", ""]
+    return "\n".join(lines)
+
+
+def call_chain(nb_functions: int) -> str:
+    """Generate nb_functions functions, each one calling the previous one"""
+    lines = ["int f0(int x) {", "    return x;", "}"]
+    for i in range(1, nb_functions):
+        lines += [f"int f{i}(int x) {{", f"    return f{i - 1}(x) + 1;", "}"]
+    lines += ["int main(void) {", f"    return f{nb_functions - 1}(0);", "}", ""]
+    return "\n".join(lines)
+
+
+def small_functions(nb_functions: int) -> str:
+    """Generate nb_functions functions with one local, and an empty main"""
+    lines = []
+    for i in range(nb_functions):
+        lines += [f"void f{i}(void) {{", "    int a;", "    a = 0;", "}"]
+    lines += ["int main(void) {", "    return 0;", "}", ""]
+    return "\n".join(lines)
+
+
+def implicit_casts(nb_statements: int) -> str:
+    """Generate a main function raising nb_statements warnings"""
+    lines = ["char c;", "int main(void) {"]
+    lines += ["    c = 300;"] * nb_statements
+    lines += ["    return 0;", "}", ""]
+    return "\n".join(lines)
+
+
+def commented_body(nb_statements: int) -> str:
+    """Generate a main function of nb_statements commented and indented
+    statements, as generated sources are"""
+    lines = ["int main(void) {", "    int counter_value;"]
+    for i in range(nb_statements):
+        lines += [f"        /* Statement {i} : increment the counter value,",
+                  "         * as generated by a source-to-source tool */",
+                  "        counter_value = counter_value + 1;"
+                  "  // and a trailing comment"]
+    lines += ["    return 0;", "}", ""]
+    return "\n".join(lines)
+
+
+def deep_expression(depth: int, leaning: str) -> str:
+    """Generate a main function returning an expression of depth operations,
+    nested in its left operands (a + a + ...) or its right operands
+    (a - (a - (...)))"""
+    if leaning == "left":
+        expr = "a" + " + a" * depth
+    else:
+        expr = "(a - " * depth + "a" + ")" * depth
+    lines = ["int main(void) {", "    int a;", "    a = 1;",
+             f"    return {expr};", "}", ""]
+    return "\n".join(lines)
+
+
+def arithmetic_loop(nb_iterations: int) -> str:
+    """Generate a main function evaluating an arithmetic expression
+    nb_iterations times"""
+    lines = ["int main(void) {", "    int i, s, a, b;",
+             "    i = 0;", "    s = 0;", "    a = 3;", "    b = 5;",
+             f"    while (i < {nb_iterations}) {{",
+             "        s = (s + (i * a - b) * (i + b) / (a + 1)"
+             " - (i % 7) * (b - a)) % 1000003;",
+             "        i = i + 1;", "    }",
+             "    putint(s);", "    return 0;", "}", ""]
+    return "\n".join(lines)
+
+
+def digits_loop(nb_iterations: int) -> str:
+    """Generate a main function summing the decimal digits of
+    nb_iterations numbers, with divisions and modulos by constants"""
+    lines = ["int main(void) {", "    int i, n, s;",
+             "    i = 0;", "    s = 0;",
+             f"    while (i < {nb_iterations}) {{",
+             "        n = i * 7919;",
+             "        while (n > 0) {",
+             "            s = s + n % 10;",
+             "            n = n / 10;",
+             "        }",
+             "        s = s % 1000003 + i / 3 - i % 7;",
+             "        i = i + 1;", "    }",
+             "    putint(s);", "    return 0;", "}", ""]
+    return "\n".join(lines)
+
+
+def calls_loop(nb_iterations: int) -> str:
+    """Generate a program calling small functions nb_iterations times :
+    a clamp with early returns, and a sum over an array parameter"""
+    lines = ["int clamp(int x, int low, int high) {",
+             "    if (x < low) {", "        return low;", "    }",
+             "    if (x > high) {", "        return high;", "    }",
+             "    return x;", "}",
+             "int sum3(int t[], int i) {",
+             "    return t[i % 4] + t[(i + 1) % 4] + t[(i + 2) % 4];", "}",
+             "int main(void) {", "    int i, s, t[4];",
+             "    i = 0;", "    s = 0;",
+             "    while (i < 4) {", "        t[i] = i * 3;",
+             "        i = i + 1;", "    }",
+             "    i = 0;",
+             f"    while (i < {nb_iterations}) {{",
+             "        s = s + clamp(i % 100 - 20, 0, 50) + sum3(t, i);",
+             "        i = i + 1;", "    }",
+             "    putint(s);", "    return 0;", "}", ""]
+    return "\n".join(lines)
+
+
+def run_time(src: Path, args: List[str]) -> float:
+    """Compile src with args (needs nasm), and time the run of the
+    program"""
+    asm, obj, exe = (src.with_suffix(suffix) for suffix in (".asm", ".o", ""))
+    timed_run([src, "-o", asm, *args])
+    run(["nasm", "-f", "elf64", asm, "-o", obj], check=True)
+    run(["gcc", obj, "-o", exe, "-nostartfiles", "-no-pie"],
+        check=True, capture_output=True)
+    start = time.perf_counter()
+    run([exe], check=True, capture_output=True)
+    return time.perf_counter() - start
+
+
+def sizes(args: argparse.Namespace, maximum: int) -> List[int]:
+    """Input sizes, doubled from maximum / 2**(steps - 1) up to maximum"""
+    maximum = int(maximum * args.scale)
+    return [maximum >> i for i in reversed(range(args.steps))]
+
+
+def report(name: str, nb_elements: int, unit: str, elapsed: float):
+    print(f"{name:<12} {nb_elements:>10} {unit:<10} {elapsed:8.3f} s "
+          f"{elapsed / nb_elements * 1e9:10.1f} ns/{unit}")
+
+
+@benchmark
+def parser(args: argparse.Namespace):
+    """AST construction time of a 1M-statements function body"""
+    with tempfile.TemporaryDirectory() as tmp:
+        for nb in sizes(args, 1_000_000):
+            src = Path(tmp) / "straight_line.tpc"
+            src.write_text(straight_line_body(nb))
+            report("parser", nb, "stmt", timed_run([src, "--only-tree"]))
+
+
+@benchmark
+def lexer(args: argparse.Namespace):
+    """Scanner throughput (as measured by --only-lex) on up to 2M statements"""
+    with tempfile.TemporaryDirectory() as tmp:
+        for nb in sizes(args, 2_000_000):
+            src = Path(tmp) / "straight_line.tpc"
+            src.write_text(straight_line_body(nb))
+            out = run([EXECUTABLE, src, "--only-lex"], check=True,
+                      capture_output=True, text=True).stdout
+            print(f"{'lexer':<12} {nb:>10} {'stmt':<10} {out.strip()}")
+
+
+@benchmark
+def scanners(args: argparse.Namespace):
+    """Throughput of the flex and hand-written scanners (--only-lex)
+    on up to 500k commented statements"""
+    with tempfile.TemporaryDirectory() as tmp:
+        for nb in sizes(args, 500_000):
+            src = Path(tmp) / "commented.tpc"
+            src.write_text(commented_body(nb))
+            for scanner in ("flex", "simd"):
+                out = run([EXECUTABLE, src, "--only-lex",
+                           f"--scanner={scanner}"], check=True,
+                          capture_output=True, text=True).stdout
+                throughput = out.split("bytes in ")[1].strip()
+                print(f"{'scanner ' + scanner:<12} {nb:>10} {'stmt':<10} "
+                      f"{throughput}")
+
+
+@benchmark
+def deep_expressions(args: argparse.Namespace):
+    """Compilation time of a single expression nested up to 1M times,
+    leaning to the left and to the right"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "deep.tpc"
+        out = Path(tmp) / "deep.asm"
+        for nb in sizes(args, 1_000_000):
+            for leaning in ("left", "right"):
+                src.write_text(deep_expression(nb, leaning))
+                report(f"deep {leaning}", nb, "level",
+                       timed_run([src, "-o", out]))
+
+
+@benchmark
+def codegen(args: argparse.Namespace):
+    """Run time of a program evaluating an arithmetic expression up to 50M
+    times, compiled for each --codegen mode and -O level (needs nasm)"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "arithmetic_loop.tpc"
+        for nb in sizes(args, 50_000_000):
+            src.write_text(arithmetic_loop(nb))
+            for mode in ("stack", "registers"):
+                for level in ("-O0", "-O1", "-O2"):
+                    elapsed = run_time(src, [f"--codegen={mode}", level])
+                    report(f"{mode} {level}", nb, "iteration", elapsed)
+
+
+@benchmark
+def division(args: argparse.Namespace):
+    """Run time of a program dividing by constants in a digits loop up to
+    20M times, with idiv (-O0) and multiplications by magic numbers (-O2),
+    for each --codegen mode (needs nasm)"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "digits_loop.tpc"
+        for nb in sizes(args, 20_000_000):
+            src.write_text(digits_loop(nb))
+            for mode in ("stack", "registers"):
+                for level in ("-O0", "-O2"):
+                    elapsed = run_time(src, [f"--codegen={mode}", level])
+                    report(f"{mode} {level}", nb, "iteration", elapsed)
+
+
+@benchmark
+def inlining(args: argparse.Namespace):
+    """Run time of a program calling small functions up to 20M times,
+    at -O2 with the calls kept (--inline-budget=0) and inlined,
+    for each --codegen mode (needs nasm)"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "calls_loop.tpc"
+        for nb in sizes(args, 20_000_000):
+            src.write_text(calls_loop(nb))
+            for mode in ("stack", "registers"):
+                for budget in (0, 32):  # 32 by default
+                    elapsed = run_time(src, [f"--codegen={mode}", "-O2",
+                                             f"--inline-budget={budget}"])
+                    report(f"{mode} {budget}", nb, "iteration", elapsed)
+
+
+@benchmark
+def emitter(args: argparse.Namespace):
+    """Code generation time of 500k statements, for each comments mode"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "straight_line.tpc"
+        out = Path(tmp) / "straight_line.asm"
+        for nb in sizes(args, 500_000):
+            src.write_text(straight_line_body(nb))
+            for mode in ("none", "brief", "full"):
+                elapsed = timed_run([src, "-o", out, f"--asm-comments={mode}"])
+                report(f"emit {mode}", nb, "stmt", elapsed)
+                print(f"{'':<12} {out.stat().st_size:>10} bytes")
+
+
+@benchmark
+def passes(args: argparse.Namespace):
+    """Time of each step of the compilation of 500k statements
+    (lowering, IR passes, code generation), for each -O level"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "straight_line.tpc"
+        out = Path(tmp) / "straight_line.asm"
+        for nb in sizes(args, 500_000):
+            src.write_text(straight_line_body(nb))
+            for level in ("-O0", "-O1", "-O2"):
+                stats = run([EXECUTABLE, src, "-o", out, level, "--stats"],
+                            check=True, capture_output=True, text=True)
+                for line in stats.stderr.splitlines():
+                    # pass <name> <time> ms <instructions> instrs
+                    if line.startswith("pass "):
+                        name, elapsed = line.split()[1:3]
+                        report(f"{level} {name}", nb, "stmt",
+                               float(elapsed) * 1e-3)
+
+
+@benchmark
+def calls(args: argparse.Namespace):
+    """Compilation time of a program made of 20k functions and call sites"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "call_chain.tpc"
+        out = Path(tmp) / "call_chain.asm"
+        for nb in sizes(args, 20_000):
+            src.write_text(call_chain(nb))
+            report("calls", nb, "call", timed_run([src, "-o", out]))
+
+
+@benchmark
+def symbols(args: argparse.Namespace):
+    """Peak memory of the symbol tables of up to 100k small functions"""
+    with tempfile.TemporaryDirectory() as tmp:
+        for nb in sizes(args, 100_000):
+            src = Path(tmp) / "small_functions.tpc"
+            src.write_text(small_functions(nb))
+            start = time.perf_counter()
+            stats = run([EXECUTABLE, src, "--only-semantic", "--stats"],
+                        check=True, capture_output=True, text=True).stderr
+            report("symbols", nb, "function", time.perf_counter() - start)
+            for line in stats.splitlines():
+                if line.startswith("peak RSS"):
+                    print(f"{'':<12} {line}")
+
+
+@benchmark
+def stream(args: argparse.Namespace):
+    """Peak memory of the whole program and --stream compilations"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "call_chain.tpc"
+        out = Path(tmp) / "call_chain.asm"
+        for nb in sizes(args, 100_000):
+            src.write_text(call_chain(nb))
+            for mode in ([], ["--stream"]):
+                start = time.perf_counter()
+                stats = run([EXECUTABLE, src, "-o", out, "--stats", *mode],
+                            check=True, capture_output=True, text=True).stderr
+                name = "stream" if mode else "whole"
+                report(name, nb, "function", time.perf_counter() - start)
+                for line in stats.splitlines():
+                    if line.startswith("peak RSS"):
+                        print(f"{'':<12} {line}")
+
+
+@benchmark
+def ast_cache(args: argparse.Namespace):
+    """Parse time against cache load time of a 1M-statements function"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "straight_line.tpc"
+        for nb in sizes(args, 1_000_000):
+            src.write_text(straight_line_body(nb))
+            cache = Path(tmp) / f"cache{nb}"
+            cache.mkdir()
+            report("parse", nb, "stmt", timed_run([src, "--only-tree"]))
+            timed_run([src, "--only-tree", f"--ast-cache={cache}"])
+            report("cache load", nb, "stmt",
+                   timed_run([src, "--only-tree", f"--ast-cache={cache}"]))
+
+
+@benchmark
+def dump(args: argparse.Namespace):
+    """Tree dump (-t) time of a 1M-statements function, for each format"""
+    with tempfile.TemporaryDirectory() as tmp:
+        src = Path(tmp) / "straight_line.tpc"
+        for nb in sizes(args, 1_000_000):
+            src.write_text(straight_line_body(nb))
+            for dump_format in ("text", "json", "binary"):
+                elapsed = timed_run([src, "-t", "-a",
+                                     f"--dump-format={dump_format}"])
+                report(f"dump {dump_format}", nb, "stmt", elapsed)
+
+
+@benchmark
+def diagnostics(args: argparse.Namespace):
+    """Semantic analysis time of a function raising 200k warnings"""
+    with tempfile.TemporaryDirectory() as tmp:
+        for nb in sizes(args, 200_000):
+            src = Path(tmp) / "implicit_casts.tpc"
+            src.write_text(implicit_casts(nb))
+            report("diagnostics", nb, "warning",
+                   timed_run([src, "--only-semantic"]))
+
+
+def parse_args():
+    argparser = argparse.ArgumentParser(prog="TPC compiler benchmarks")
+    argparser.add_argument(
+        "names", nargs="*", default=list(BENCHMARKS),
+        help=f"Benchmarks to run among {', '.join(BENCHMARKS)}"
+    )
+    argparser.add_argument(
+        "--steps", type=int, default=4,
+        help="Number of input sizes (each one doubles the previous one)"
+    )
+    argparser.add_argument(
+        "--scale", type=float, default=1.0,
+        help="Multiply the largest input size"
+    )
+    return argparser.parse_args()
+
+
+if __name__ == '__main__':
+    args = parse_args()
+
+    for name in args.names:
+        if name not in BENCHMARKS:
+            sys.exit(f"Unknown benchmark {name}")
+        BENCHMARKS[name](args)
@@ -6,11 +6,16 @@ import os
 import sys
 import argparse
 from pathlib import Path
-from subprocess import run
+from subprocess import CompletedProcess, run
 from typing import Tuple, List
 from dataclasses import dataclass
 from collections import namedtuple
+from itertools import product
+import json
+import random
 import re
+import signal
+import tempfile
 from unittest import skip
 
 # Get project's path
@@ -199,45 +204,54 @@ class SyntaxTest(unittest.TestCase):
         files = set(Path(".").glob("good/**/*.tpc")) - set(Path(".").glob("good/random/interactive/*.tpc"))
 
         for filename in sorted(files):
-            with self.subTest(str(filename)):
-                with open(filename, "r") as f:
-                    src_code = f.read()
-                # Compile with TPC Compiler
-                logger.debug(f"Test with {filename} ...")
-                run(
-                    [EXECUTABLE],
-                    cwd="../",
-                    input=src_code,
-                    text=True,
-                    check=True,
-                    capture_output=True
-                ) # TPC compiler will create the asm file under ../test/_anonymous.asm
-                run([
-                    "nasm", "-f", "elf64",
-                    "../_anonymous.asm", "-o", "bin/_anonymous.o"
-                ], check=True)
-                run([
-                    "gcc", "bin/_anonymous.o", "-o", "bin/tpcc_exec", "-nostartfiles", "-no-pie"
-                ], check=True)
-
+            with open(filename, "r") as f:
+                src_code = f.read()
+
+            # The expected output of a program whose order of evaluation
+            # is unspecified in C (TPC evaluates from left to right)
+            expected_out = filename.with_suffix(".out")
+            if expected_out.exists():
+                expected = CompletedProcess(
+                    [], 0, stdout=expected_out.read_text())
+            else:
                 # Compile with GCC
                 run([
                     "gcc", "-Wno-implicit-function-declaration",
                     "bin/builtins.o", "-x", "c", filename, "-o", "bin/gcc_exec"
                 ], check=True)
-
-                # Run TPCC's executable
-                p1 = run(["./bin/tpcc_exec"], capture_output=True, text=True, check=False)
-                p2 = run(["./bin/gcc_exec"], capture_output=True, text=True, check=False)
-
-                self.assertEqual(
-                    p1.returncode, p2.returncode,
-                    "TPCC compiled program return an invalid code"
-                )
-                self.assertEqual(
-                    p1.stdout, p2.stdout,
-                    "TPCC complied program didn't produced expected output on stdout"
-                )
+                expected = run(["./bin/gcc_exec"], capture_output=True, text=True, check=False)
+
+            for codegen, opt_level in product(("stack", "registers"), ("-O0", "-O1", "-O2")):
+                with self.subTest(str(filename), codegen=codegen, opt_level=opt_level):
+                    # Compile with TPC Compiler
+                    logger.debug(f"Test with {filename} ({codegen}, {opt_level}) ...")
+                    run(
+                        [EXECUTABLE, f"--codegen={codegen}", opt_level],
+                        cwd="../",
+                        input=src_code,
+                        text=True,
+                        check=True,
+                        capture_output=True
+                    ) # TPC compiler will create the asm file under ../test/_anonymous.asm
+                    run([
+                        "nasm", "-f", "elf64",
+                        "../_anonymous.asm", "-o", "bin/_anonymous.o"
+                    ], check=True)
+                    run([
+                        "gcc", "bin/_anonymous.o", "-o", "bin/tpcc_exec", "-nostartfiles", "-no-pie"
+                    ], check=True)
+
+                    # Run TPCC's executable
+                    p1 = run(["./bin/tpcc_exec"], capture_output=True, text=True, check=False)
+
+                    self.assertEqual(
+                        p1.returncode, expected.returncode,
+                        "TPCC compiled program return an invalid code"
+                    )
+                    self.assertEqual(
+                        p1.stdout, expected.stdout,
+                        "TPCC complied program didn't produced expected output on stdout"
+                    )
 
     def _valgrind_conditionnal_jumps(self, path_glob: str, expected_retcode: int):
         """Use valgrind against inputs, to check for conditionnal jumps"""
@@ -259,6 +273,571 @@ class SyntaxTest(unittest.TestCase):
         self._valgrind_conditionnal_jumps("good/random/*.tpc", 0)
         self._valgrind_conditionnal_jumps("syn-err/random/*.tpc", 1)
 
+    def test_7_stream_same_as_whole_program(self):
+        logger.debug("# Test --stream against whole program compilation :")
+        for path_glob in ("good/**/*.tpc", "sem-err/**/*.tpc", "warn/**/*.tpc"):
+            for filename in sorted(Path(".").glob(path_glob)):
+                with self.subTest(str(filename)):
+                    whole, stream = (
+                        run([EXECUTABLE, str(filename), "-o", "-", *args],
+                            capture_output=True, text=True, check=False)
+                        for args in ([], ["--stream"])
+                    )
+                    self.assertEqual(
+                        whole.returncode, stream.returncode,
+                        "--stream changed the return code"
+                    )
+                    if whole.returncode == 0:
+                        self.assertEqual(
+                            whole.stdout, stream.stdout,
+                            "--stream changed the generated assembly"
+                        )
+                    if path_glob.startswith("warn/"):
+                        self.assertEqual(
+                            whole.stderr, stream.stderr,
+                            "--stream changed the warnings"
+                        )
+        with tempfile.TemporaryDirectory() as tmp, \
+                self.subTest("output kept on error"):
+            bad = next(Path(".").glob("sem-err/**/*.tpc"))
+            good = next(Path(".").glob("good/**/*.tpc"))
+            output = Path(tmp) / "out.asm"
+            output.write_text("previous\n")
+            run([EXECUTABLE, str(bad), "-o", output, "--stream"],
+                capture_output=True, check=False)
+            self.assertEqual(output.read_text(), "previous\n",
+                             "--stream changed the output on error")
+            run([EXECUTABLE, str(good), "-o", output, "--stream"],
+                capture_output=True, check=True)
+            self.assertNotEqual(output.read_text(), "previous\n",
+                                "--stream did not write the output")
+            self.assertEqual([p.name for p in Path(tmp).iterdir()],
+                             ["out.asm"], "--stream left a temporary file")
+
+    def test_8_ast_cache_same_as_parsing(self):
+        logger.debug("# Test --ast-cache against parsing :")
+        with tempfile.TemporaryDirectory() as cache:
+            for path_glob in ("good/**/*.tpc", "sem-err/**/*.tpc",
+                              "warn/**/*.tpc"):
+                for filename in sorted(Path(".").glob(path_glob)):
+                    with self.subTest(str(filename)):
+                        parsed, stored, loaded = (
+                            run([EXECUTABLE, str(filename), "-o", "-",
+                                 *args], capture_output=True, text=True,
+                                check=False)
+                            for args in ([], [f"--ast-cache={cache}"],
+                                         [f"--ast-cache={cache}", "--stats"])
+                        )
+                        self.assertIn("hit", loaded.stderr,
+                                      "The tree was not loaded from the cache")
+                        self.assertEqual(
+                            (parsed.returncode, parsed.stdout),
+                            (stored.returncode, stored.stdout),
+                            "--ast-cache changed the compilation"
+                        )
+                        self.assertEqual(
+                            (parsed.returncode, parsed.stdout),
+                            (loaded.returncode, loaded.stdout),
+                            "The cached tree changed the compilation"
+                        )
+                        self.assertTrue(
+                            loaded.stderr.startswith(parsed.stderr),
+                            "The cached tree changed the diagnostics"
+                        )
+        # Damaged cache files are ignored : the nextSibling (at 4) of the
+        # node 1 pointing to itself, a bit flipped in its label (at 20),
+        # or more nodes (nb_nodes at 32) with a strings_size (at 48) that
+        # wraps the size of the sections around to the size of the file
+        filename = "good/core/CallFunction_2.tpc"
+        node = 64 + 24  # Size of the header, and of a node
+
+        def self_link(data: bytearray):
+            data[node + 4:node + 8] = (1).to_bytes(4, "little")
+
+        def flipped_label(data: bytearray):
+            data[node + 20] ^= 0x40
+
+        def wrapping_strings(data: bytearray):
+            nb_nodes = int.from_bytes(data[32:36], "little") + 1000
+            nb_lines = int.from_bytes(data[40:44], "little")
+            fixed = 64 + nb_nodes * 24 + nb_lines * 4
+            data[32:36] = nb_nodes.to_bytes(4, "little")
+            data[48:56] = ((len(data) - fixed) % 2**64).to_bytes(8, "little")
+
+        for damage in (self_link, flipped_label, wrapping_strings):
+            with tempfile.TemporaryDirectory() as cache, \
+                    self.subTest(damage.__name__):
+                run([EXECUTABLE, filename, "-o", "-",
+                     f"--ast-cache={cache}"], capture_output=True, check=True)
+                path = next(Path(cache).iterdir())
+                data = bytearray(path.read_bytes())
+                damage(data)
+                path.write_bytes(data)
+                parsed, loaded = (
+                    run([EXECUTABLE, filename, "-o", "-", *args],
+                        capture_output=True, text=True, check=False,
+                        timeout=10)
+                    for args in ([], [f"--ast-cache={cache}", "--stats"])
+                )
+                self.assertIn("miss", loaded.stderr,
+                              "The damaged file was loaded")
+                self.assertEqual(
+                    (parsed.returncode, parsed.stdout),
+                    (loaded.returncode, loaded.stdout),
+                    "The damaged file changed the compilation"
+                )
+
+    def test_9_dump_formats(self):
+        logger.debug("# Test the --dump-format of -t and -s :")
+
+        def count_nodes(tree) -> int:
+            nodes, pending = 0, [tree]
+            while pending:
+                nodes += 1
+                pending += pending.pop().get("children", [])
+            return nodes
+
+        for filename in sorted(Path(".").glob("good/**/*.tpc")):
+            with self.subTest(str(filename)):
+                text, as_json, binary = (
+                    run([EXECUTABLE, str(filename), "-t", "-a",
+                         f"--dump-format={dump_format}"],
+                        capture_output=True, check=True).stdout
+                    for dump_format in ("text", "json", "binary")
+                )
+                self.assertEqual(
+                    len(text.splitlines()), count_nodes(json.loads(as_json)),
+                    "The JSON tree does not have the nodes of the text tree"
+                )
+                self.assertTrue(binary.startswith(b"TPCAST\0"))
+
+                symtabs = json.loads(run(
+                    [EXECUTABLE, str(filename), "-s", "--only-semantic",
+                     "--dump-format=json"],
+                    capture_output=True, check=True).stdout)
+                self.assertIn("main", [function["name"]
+                                       for function in symtabs["functions"]])
+
+    def test_10_scanners_same_tokens(self):
+        logger.debug("# Test the hand-written scanner against flex :")
+        fragments = [
+            " ", "\t", "\r", "\n", " " * 40, "\n    ", "/*", "*/", "*",
+            "/", "//", "/* a\n b */", "/*" + "x\n" * 20 + "**/", "'", "\\",
+            "'a'", "'\\n'", "'\\q'", "''", "a", "_x9", "Z", "x" * 70,
+            "int", "char", "intx", "void", "if", "else", "while", "return",
+            "0", "007", "123", "99999999999", "<", "<=", ">", ">=", "==",
+            "=", "!", "!=", "|", "||", "&", "&&", "+", "-", "%", "{", "}",
+            "(", ")", "[", "]", ";", ",", "\x7f", "\xc3\xa9", "\x00",
+        ]
+        rng = random.Random(0)
+        with tempfile.TemporaryDirectory() as tmp:
+            inputs = sorted(Path(".").glob("**/*.tpc"))
+            for i in range(200):
+                path = Path(tmp) / f"random_{i}.tpc"
+                path.write_bytes("".join(
+                    rng.choice(fragments) for _ in range(rng.randrange(400))
+                ).encode("latin-1"))
+                inputs.append(path)
+
+            for filename in inputs:
+                with self.subTest(str(filename)):
+                    # Tokens and their positions, without the throughput
+                    flex, simd = (
+                        run([EXECUTABLE, str(filename), "-l",
+                             f"--scanner={scanner}"],
+                            capture_output=True, text=True,
+                            check=True).stdout.split("),")[0]
+                        for scanner in ("flex", "simd")
+                    )
+                    self.assertEqual(flex, simd, "The tokens differ")
+
+                    flex, simd = (
+                        run([EXECUTABLE, str(filename), "-a",
+                             f"--scanner={scanner}"],
+                            capture_output=True, check=False)
+                        for scanner in ("flex", "simd")
+                    )
+                    self.assertEqual(
+                        (flex.returncode, flex.stderr),
+                        (simd.returncode, simd.stderr),
+                        "The syntax errors differ"
+                    )
+
+    def test_11_deep_expressions(self):
+        logger.debug("# Test the compilation of deeply nested expressions :")
+        depth = 100_000
+        params = ", ".join(f"int p{i}" for i in range(depth))
+        expressions = {
+            "left": "a" + " + a" * depth,
+            "right": "(a - " * depth + "a" + ")" * depth,
+            "unary": "-!" * depth + "a",
+            "boolean": "(a && " * depth + "a" + ")" * depth,
+            "calls": "f(" * depth + "a" + ")" * depth,
+            "indexes": "t[" * depth + "0" + "]" * depth,
+            "arguments": "g(" + ", ".join(["a + 1"] * depth) + ")",
+        }
+        with tempfile.TemporaryDirectory() as tmp:
+            for name, expr in expressions.items():
+                with self.subTest(name):
+                    src = Path(tmp) / f"{name}.tpc"
+                    src.write_text(
+                        "int t[1];\n"
+                        "int f(int x) { return x; }\n"
+                        f"int g({params}) {{ return p0; }}\n"
+                        "int main(void) {\n"
+                        "    int a;\n"
+                        "    a = 1;\n"
+                        f"    g({expr}, {', '.join(['a'] * (depth - 1))});\n"
+                        f"    return {expr};\n"
+                        "}\n")
+                    res = run([EXECUTABLE, str(src), "-o",
+                               str(Path(tmp) / f"{name}.asm")],
+                              capture_output=True, text=True, check=False)
+                    self.assertEqual(res.returncode, 0, res.stderr[:500])
+
+    def test_12_emit_ir(self):
+        logger.debug("# Test the IR printed by --emit-ir :")
+        for filename in sorted(Path(".").glob("good/**/*.tpc")):
+            with self.subTest(str(filename)):
+                # Only the inlining adds instructions
+                irs = {
+                    opt_level: run(
+                        [EXECUTABLE, str(filename), "-o", "/dev/null",
+                         "--emit-ir", *opt_level.split()],
+                        capture_output=True, text=True, check=True
+                    ).stdout.splitlines()
+                    for opt_level in ("-O0", "-O1", "-O2 --inline-budget=0",
+                                      "-O2")
+                }
+                functions = [line for line in irs["-O0"]
+                             if line.startswith("function ")]
+                self.assertIn("function main:", functions)
+                for opt_level in ("-O1", "-O2 --inline-budget=0", "-O2"):
+                    lines = irs[opt_level]
+                    self.assertEqual(
+                        functions,
+                        [line for line in lines
+                         if line.startswith("function ")])
+                    if opt_level != "-O2":
+                        self.assertLessEqual(
+                            len(lines), len(irs["-O0"]),
+                            f"{opt_level} added instructions")
+                    # Only a label follows a jump or a return
+                    for line, next_line in zip(lines, lines[1:]):
+                        if line.split()[:1] in (["jmp"], ["ret"]):
+                            self.assertTrue(
+                                next_line == "" or next_line.startswith("."),
+                                f"Unreachable '{next_line}' ({opt_level})")
+
+    def test_13_constant_folding(self):
+        logger.debug("# Test the folding of constant expressions :")
+        filename = "good/core/Exp-fold_1.tpc"
+        folded, unfolded = (
+            run([EXECUTABLE, filename, "-o", "/dev/null", "--stats", *args],
+                capture_output=True, text=True, check=True)
+            for args in ([], ["--no-fold"])
+        )
+        folds = {
+            match[1]: int(match[2])
+            for match in re.finditer(r"^fold (\w+) +(\d+) nodes$",
+                                     folded.stderr, re.MULTILINE)
+        }
+        self.assertEqual(set(folds), {"constant", "identity", "boolean"})
+        for rule, count in folds.items():
+            self.assertGreater(count, 0, f"No {rule} folded")
+        self.assertNotIn("fold ", unfolded.stderr)
+
+        # A division by a constant zero still faults at run time
+        with tempfile.TemporaryDirectory() as tmp:
+            asm, obj, exe = (Path(tmp) / name
+                             for name in ("div.asm", "div.o", "div"))
+            for expr in ("1 / 0", "x % (1 - 1)", "(x / 0) * 0",
+                         "0 * (1 % 0)", "(x / 0) && 0"):
+                with self.subTest(expr):
+                    run([EXECUTABLE, "-o", str(asm)],
+                        input=("int main(void) {\n"
+                               "    int x;\n"
+                               "    x = 1;\n"
+                               f"    return {expr};\n"
+                               "}\n"),
+                        text=True, check=True, capture_output=True)
+                    run(["nasm", "-f", "elf64", str(asm), "-o", str(obj)],
+                        check=True)
+                    run(["gcc", str(obj), "-o", str(exe), "-nostartfiles",
+                         "-no-pie"], check=True)
+                    res = run([str(exe)], capture_output=True, check=False)
+                    self.assertEqual(res.returncode, -signal.SIGFPE,
+                                     f"{expr} did not fault")
+
+    def test_14_conditions_as_jumps(self):
+        logger.debug("# Test the code of conditions and comparisons :")
+        programs = {
+            "loop": "while (i < n) { i = i + 1; }",
+            "condition": "if (i < n && !(n == 3) || i >= 2) { i = 1; }",
+            "value": "i = (i < n) + (n == 3);",
+        }
+        jcc = re.compile(r"^j(?!mp)[a-z]+ ", re.MULTILINE)
+        for (name, body), codegen in product(programs.items(),
+                                             ("stack", "registers")):
+            with self.subTest(name, codegen=codegen):
+                asm = run(
+                    [EXECUTABLE, "-o", "-", "--asm-comments=none",
+                     f"--codegen={codegen}"],
+                    input=("int main(void) {\n"
+                           "    int i, n;\n"
+                           "    i = 0;\n"
+                           "    n = getint();\n"
+                           f"    {body}\n"
+                           "    return i;\n"
+                           "}\n"),
+                    capture_output=True, text=True, check=True
+                ).stdout
+                # Up to the next function
+                main = re.search(r"^main:$(.*?)^\w+:$", asm,
+                                 re.MULTILINE | re.DOTALL)[1]
+                sets = re.findall(r"^set[a-z]+ ", main, re.MULTILINE)
+                if name == "value":
+                    # Without branches
+                    self.assertEqual(len(sets), 2)
+                    self.assertEqual(jcc.findall(main), [])
+                    continue
+                # Without 0 or 1 compared again with 0
+                self.assertEqual(sets, [])
+                self.assertNotIn("cmp rax, 0", main)
+                if name == "loop":
+                    # A single jump per iteration
+                    body = main[main.index(".while_body_0:"):]
+                    self.assertEqual(len(jcc.findall(body)), 1)
+                    self.assertNotIn("jmp ", body)
+
+    def test_15_division_by_constants(self):
+        logger.debug("# Test the divisions by constants against idiv :")
+        int32 = 2 ** 31
+        int64 = 2 ** 63
+        divisors = [2, 3, 5, 6, 7, 10, 16, 25, 100, 125, 641, 1000, 4096,
+                    65536, 2 ** 30, int32 - 1, -2, -3, -7, -10, -16, -1000,
+                    -(int32 - 1), -int32]
+        numerators = {0, int32 - 1, -int32, int32, -int32 - 1, int64 - 1,
+                      -int64, 2 ** 62, -2 ** 62, 2 ** 32 + 1, -2 ** 32 - 1}
+        for d in divisors:
+            for n in (1, 2, abs(d) - 1, abs(d), abs(d) + 1, 2 * abs(d) - 1,
+                      abs(d) * 1000003, int64 - 1 - (int64 - 1) % abs(d)):
+                numerators.update((n, -n))
+        rand = random.Random(23)
+        numerators.update(rand.randrange(-int64, int64) for _ in range(40))
+        numerators.update(rand.randrange(-int32, int32) for _ in range(40))
+        numerators = sorted(numerators)
+
+        def literal(value: int) -> str:
+            """Expression of value with literals of the int range"""
+            if value < 0:
+                return f"(-({literal(-value - 1)}) - 1)"
+            if value < int32:
+                return str(value)
+            high, low = divmod(value, 2 ** 32)
+            return (f"(({high} * 65536 + {low >> 16}) * 65536 + "
+                    f"{low & 0xFFFF})")
+
+        def divide(n: int, d: int) -> Tuple[int, int]:
+            """Division rounded toward zero, as idiv"""
+            q = abs(n) // abs(d)
+            q = -q if (n < 0) != (d < 0) else q
+            return q, n - q * d
+
+        lines = ["int main(void) {",
+                 f"    int t[{len(numerators)}];",
+                 "    int i;"]
+        lines += [f"    t[{i}] = {literal(n)};"
+                  for i, n in enumerate(numerators)]
+        expected = []
+        for d in divisors:
+            lines += ["    i = 0;",
+                      f"    while (i < {len(numerators)}) {{",
+                      f"        putint(t[i] / {literal(d)});",
+                      "        putchar('\\n');",
+                      f"        putint(t[i] % {literal(d)});",
+                      "        putchar('\\n');",
+                      "        i = i + 1;",
+                      "    }"]
+            for n in numerators:
+                expected += divide(n, d)
+        lines += ["    return 0;", "}", ""]
+        source = "\n".join(lines)
+        expected = "".join(f"{value}\n" for value in expected)
+
+        with tempfile.TemporaryDirectory() as tmp:
+            asm, obj, exe = (Path(tmp) / name
+                             for name in ("div.asm", "div.o", "div"))
+            # -O0 divides with idiv
+            for opt, codegen in product(("-O0", "-O2"),
+                                        ("stack", "registers")):
+                with self.subTest(opt, codegen=codegen):
+                    run([EXECUTABLE, "-o", str(asm), opt,
+                         f"--codegen={codegen}"],
+                        input=source, text=True, check=True)
+                    if opt == "-O2":
+                        main = re.search(r"^main:$(.*?)^\w+:$",
+                                         asm.read_text(),
+                                         re.MULTILINE | re.DOTALL)[1]
+                        self.assertNotIn("idiv", main)
+                    run(["nasm", "-f", "elf64", str(asm), "-o", str(obj)],
+                        check=True)
+                    run(["gcc", str(obj), "-o", str(exe), "-nostartfiles",
+                         "-no-pie"], check=True)
+                    res = run([str(exe)], capture_output=True, text=True,
+                              check=True)
+                    self.assertEqual(res.stdout, expected)
+
+    def test_16_register_allocation(self):
+        logger.debug("# Test the variables kept in registers :")
+        saved = re.compile(r"^mov \[rbp -\d+\], (rbx|r1[2-5])$", re.MULTILINE)
+        restored = re.compile(r"^mov (rbx|r1[2-5]), qword \[rbp -\d+\]$",
+                              re.MULTILINE)
+        # 7 variables alive in the loop, for 5 registers
+        programs = {
+            "loop": ("int i, s;", ["i", "s"]),
+            "pressure": ("int i, a, b, c, d, e, f;",
+                         ["i", "a", "b", "c", "d", "e", "f"]),
+        }
+        for (name, (decl, names)), codegen, opt in product(
+                programs.items(), ("stack", "registers"), ("-O1", "-O2")):
+            with self.subTest(name, codegen=codegen, opt=opt):
+                body = "".join(f"        {var} = {var} + i;\n"
+                               for var in names[1:])
+                res = run(
+                    [EXECUTABLE, "-o", "-", "--asm-comments=none", "--stats",
+                     opt, f"--codegen={codegen}"],
+                    input=("int main(void) {\n"
+                           f"    {decl}\n"
+                           + "".join(f"    {var} = 0;\n" for var in names)
+                           + "    while (i < 100) {\n"
+                           + body
+                           + "        i = i + 1;\n"
+                           "    }\n"
+                           f"    return ({' + '.join(names[1:])}) % 256;\n"
+                           "}\n"),
+                    capture_output=True, text=True, check=True)
+                main = re.search(r"^main:$(.*?)^\w+:$", res.stdout,
+                                 re.MULTILINE | re.DOTALL)[1]
+                stats = {
+                    match[1]: int(match[2])
+                    for match in re.finditer(
+                        r"^regalloc (\w+) +(\d+) variables$", res.stderr,
+                        re.MULTILINE)
+                }
+                if opt == "-O1":
+                    self.assertEqual(stats, {})
+                    self.assertEqual(saved.findall(main), [])
+                    continue
+                in_frame = max(len(names) - 5, 0)
+                self.assertEqual(stats, {"registers": len(names) - in_frame,
+                                         "frame": in_frame})
+                # Saved by the prologue, restored by the epilogue
+                self.assertEqual(sorted(saved.findall(main)),
+                                 sorted(restored.findall(main)))
+                self.assertEqual(len(saved.findall(main)),
+                                 len(names) - in_frame)
+                loop = main[main.index(".while_body_0:"):
+                            main.index(".while_body_0\n")]
+                self.assertEqual(loop.count("[rbp"), 2 * in_frame)
+
+    def test_17_inlining(self):
+        logger.debug("# Test the inlining of calls :")
+        filename = "good/core/CallFunction-inline_1.tpc"
+        line = re.compile(r"^(inlined|kept call to) '(\w+)' (?:into|in) "
+                          r"'(\w+)' \((.*)\)$", re.MULTILINE)
+
+        def inline(*args, source=None):
+            res = run([EXECUTABLE, "-o", "-", "--asm-comments=none",
+                       "--inline-report", *args,
+                       *([] if source else [filename])],
+                      input=source, capture_output=True, text=True,
+                      check=True)
+            report = {(m[1], m[2], m[3], m[4]) for m in line.finditer(
+                res.stderr)}
+            calls = set(re.findall(r"^call (\w+)$", res.stdout,
+                                   re.MULTILINE))
+            return report, calls
+
+        for codegen in ("stack", "registers"):
+            with self.subTest(codegen=codegen):
+                report, calls = inline("-O2", f"--codegen={codegen}")
+                self.assertIn(("inlined", "max", "main", "11 instrs"),
+                              report)
+                self.assertIn(("inlined", "sum", "main", "22 instrs"),
+                              report)
+                self.assertIn(("inlined", "max", "biggest", "11 instrs"),
+                              report)
+                self.assertIn(("kept call to", "fact", "fact", "recursive"),
+                              report)
+                self.assertIn(("kept call to", "biggest", "main",
+                               "37 instrs, budget 32"), report)
+                # Their loops would run with an operand pending
+                self.assertIn(("kept call to", "sum", "main",
+                               "loop inside an expression"), report)
+                self.assertIn(("kept call to", "first_below", "main",
+                               "loop inside an expression"), report)
+                self.assertEqual(calls - {"main", "putint", "putchar"},
+                                 {"biggest", "fact", "sum", "first_below"})
+
+                # A larger budget inlines biggest, its calls already inlined
+                report, calls = inline("-O2", f"--codegen={codegen}",
+                                        "--inline-budget=37")
+                self.assertIn(("inlined", "biggest", "main", "37 instrs"),
+                              report)
+                self.assertEqual(calls - {"main", "putint", "putchar"},
+                                 {"fact", "sum", "first_below"})
+
+        # Disabled by a budget of 0, and below -O2
+        for args in (["-O2", "--inline-budget=0"], ["-O1"]):
+            with self.subTest(" ".join(args)):
+                report, calls = inline(*args)
+                self.assertEqual(report, set())
+                self.assertIn("max", calls)
+
+        # A function defined after its caller is not lowered yet
+        report, calls = inline("-O2", source=(
+            "int twice(int n) {\n"
+            "    return next(n) + next(n);\n"
+            "}\n"
+            "int main(void) {\n"
+            "    return twice(20);\n"
+            "}\n"
+            "int next(int n) {\n"
+            "    return n + 1;\n"
+            "}\n"))
+        self.assertEqual(report, {
+            ("kept call to", "next", "twice", "defined after the caller"),
+            ("kept call to", "twice", "main",
+             "calls a function defined after it"),
+        })
+        self.assertEqual(calls, {"main", "next", "twice"})
+
+        # A loop is not inlined with operands pending : the add after
+        # the endless loop is unreachable
+        for codegen in ("stack", "registers"):
+            with self.subTest("endless loop", codegen=codegen):
+                report, calls = inline("-O2", f"--codegen={codegen}",
+                                       source=(
+                    "int f(void) {\n"
+                    "    while (1) {\n"
+                    "    }\n"
+                    "    return 0;\n"
+                    "}\n"
+                    "int main(void) {\n"
+                    "    int x, y;\n"
+                    "    y = 2;\n"
+                    "    x = y + f();\n"
+                    "    f();\n"
+                    "    return x;\n"
+                    "}\n"))
+                self.assertEqual(report, {
+                    ("kept call to", "f", "main",
+                     "loop inside an expression"),
+                    ("inlined", "f", "main", "7 instrs"),
+                })
+                self.assertEqual(calls, {"main", "f"})
+
 def parse_args():
     parser = argparse.ArgumentParser(
         prog='Test syntax analyser'